@@ -8,12 +8,18 @@
 
 #include <TIM9_UnderRTOS_Radar_ISR.h>
 
+#include <FreeRTOS.h>
+
 static TIM_HandleTypeDef htim9;
+static TIM9UpdateCallback tim9Callback = NULL;
+static uint32_t tim9CyclesPerTick = 1;
+
+void Error_Handler(void);
 
 /**
  * Setup TIM9 to provide a simple repeating up counter with interrupts
  */
-static void InitTIM9UnderRTOSRadar(void)
+static void InitTIM9UnderRTOSRadar(uint32_t Prescaler, uint32_t Period)
 {
 
   /* USER CODE BEGIN TIM9_Init 0 */
@@ -26,9 +32,9 @@ static void InitTIM9UnderRTOSRadar(void)
 
   /* USER CODE END TIM9_Init 1 */
   htim9.Instance = TIM9;
-  htim9.Init.Prescaler = 0;
+  htim9.Init.Prescaler = Prescaler;
   htim9.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim9.Init.Period = 0;
+  htim9.Init.Period = Period;
   htim9.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
   htim9.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
   if (HAL_TIM_OC_Init(&htim9) != HAL_OK)
@@ -49,13 +55,76 @@ static void InitTIM9UnderRTOSRadar(void)
 
 }
 
+/**
+ * TIM9 runs from the APB2 timer clock, which is twice PCLK2 as soon as
+ * APB2 is divided
+ */
+static uint32_t TIM9ClockHz(void)
+{
+  const uint32_t pclk2 = HAL_RCC_GetPCLK2Freq();
+  if ((RCC->CFGR & RCC_CFGR_PPRE2) == RCC_HCLK_DIV1)
+  {
+    return pclk2;
+  }
+  return 2 * pclk2;
+}
+
+/**
+ * Start TIM9 as an external event source firing RateHz update interrupts.
+ * The interrupt is set to IrqPriority, which must be numerically at least
+ * configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, the handler is marked with
+ * DIS_ISR_ENTER()/DIS_ISR_EXIT() which mask like the FreeRTOS FromISR API.
+ * @param RateHz update interrupts per second (the timer clock is divided
+ * 			to fit the 16 bit counter), from 1 up to half the timer clock
+ * @param IrqPriority NVIC preemption priority of the TIM9 interrupt
+ * @param Callback called from the ISR for every update event, may be NULL
+ * @return HAL_ERROR if RateHz is out of range, the timer is not started then
+ */
+HAL_StatusTypeDef TIM9UnderRTOSRadarStart(uint32_t RateHz, uint32_t IrqPriority, TIM9UpdateCallback Callback)
+{
+  const uint32_t timerHz = TIM9ClockHz();
+  if ((RateHz == 0) || (RateHz > timerHz / 2))
+  {
+    return HAL_ERROR;
+  }
+  //the prescaler divides the timer ticks per event until they fit the counter
+  const uint32_t ticks = timerHz / RateHz;
+  const uint32_t prescaler = (ticks - 1) / 0x10000UL;
+  const uint32_t period = ticks / (prescaler + 1) - 1;
+
+  tim9CyclesPerTick = (SystemCoreClock / timerHz) * (prescaler + 1);
+  tim9Callback = Callback;
+
+  InitTIM9UnderRTOSRadar(prescaler, period);
+  HAL_NVIC_SetPriority(TIM1_BRK_TIM9_IRQn, IrqPriority, 0);
+  HAL_TIM_Base_Start_IT(&htim9);
+  return HAL_OK;
+}
+
+void TIM9UnderRTOSRadarStop(void)
+{
+  HAL_TIM_Base_Stop_IT(&htim9);
+  HAL_TIM_OC_DeInit(&htim9);
+  tim9Callback = NULL;
+}
+
 void TIM1_BRK_TIM9_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_BRK_TIM9_IRQn 0 */
+  //sample the cycle counter and TIM9 first, the timer counts up from 0
+  //since the update event, which gives the cycle the event happened
+  const uint32_t entryCycles = DWT->CYCCNT;
+  const uint32_t ticksSinceUpdate = TIM9->CNT;
+  DIS_ISR_ENTER();
 
+  if ((tim9Callback != NULL) && (__HAL_TIM_GET_FLAG(&htim9, TIM_FLAG_UPDATE) != RESET))
+  {
+    __HAL_TIM_CLEAR_IT(&htim9, TIM_IT_UPDATE);
+    tim9Callback(entryCycles - ticksSinceUpdate * tim9CyclesPerTick, entryCycles);
+  }
   /* USER CODE END TIM1_BRK_TIM9_IRQn 0 */
   HAL_TIM_IRQHandler(&htim9);
   /* USER CODE BEGIN TIM1_BRK_TIM9_IRQn 1 */
-
+  DIS_ISR_EXIT();
   /* USER CODE END TIM1_BRK_TIM9_IRQn 1 */
 }
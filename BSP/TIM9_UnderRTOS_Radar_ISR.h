@@ -1,6 +1,24 @@
 #ifndef TIM9_UNDERRTOS_RADAR_ISR_H_
 #define TIM9_UNDERRTOS_RADAR_ISR_H_
 
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
 #include <stm32f7xx_hal.h>
 
+/**
+ * called from the TIM9 ISR for every update event
+ * @param EventCycles DWT cycle count at which the update event happened
+ * @param EntryCycles DWT cycle count at the entry of the ISR
+ */
+typedef void (*TIM9UpdateCallback)(uint32_t EventCycles, uint32_t EntryCycles);
+
+HAL_StatusTypeDef TIM9UnderRTOSRadarStart(uint32_t RateHz, uint32_t IrqPriority, TIM9UpdateCallback Callback);
+void TIM9UnderRTOSRadarStop(void);
+
+#ifdef __cplusplus
+ }
+#endif
+
 #endif /* TIM9_UNDERRTOS_RADAR_ISR_H_ */
@@ -58,6 +58,8 @@ void initUart4Pins( void )
  *	NOTE:   If using DMA, the DmaTx or DmaRx pointers need to be pointing
  *			to valid  DMA_HandleTypeDef and the DMA peripheral should be
  *			initialized prior to calling this function
+ *	NOTE:	the UART handle is dropped on return, use STM_UartInitHandle
+ *			for the HAL transfer functions (and DMA in particular)
  * @param STM_UART_PERIPH STM32 peripheral name for the UART to initialize
  * @param Baudrate desired baudrate the UART will be setup to use
  * @param DmaTx pointer to DMA struct to use when transmitting via DMA
@@ -65,8 +67,23 @@ void initUart4Pins( void )
  */
 void STM_UartInit( USART_TypeDef* STM_UART_PERIPH, uint32_t Baudrate, DMA_HandleTypeDef* DmaTx, DMA_HandleTypeDef* DmaRx )
 {
-	HAL_StatusTypeDef retVal;
 	UART_HandleTypeDef uartInitStruct;
+	STM_UartInitHandle(&uartInitStruct, STM_UART_PERIPH, Baudrate, DmaTx, DmaRx);
+}
+
+/**
+ * Same as STM_UartInit, but initializes the UART handle of the caller,
+ * which has to outlive every transfer started with it.  The DMA handles
+ * are linked to the UART handle (their Parent points to it).
+ * @param Handle UART handle to initialize
+ * @param STM_UART_PERIPH STM32 peripheral name for the UART to initialize
+ * @param Baudrate desired baudrate the UART will be setup to use
+ * @param DmaTx pointer to DMA struct to use when transmitting via DMA
+ * @param DmaRx pointer to DMA struct to use when receiving via DMA
+ */
+void STM_UartInitHandle( UART_HandleTypeDef* Handle, USART_TypeDef* STM_UART_PERIPH, uint32_t Baudrate, DMA_HandleTypeDef* DmaTx, DMA_HandleTypeDef* DmaRx )
+{
+	HAL_StatusTypeDef retVal;
 	assert_param(	STM_UART_PERIPH == USART2 ||
 					STM_UART_PERIPH == UART4 );
 
@@ -81,19 +98,31 @@ void STM_UartInit( USART_TypeDef* STM_UART_PERIPH, uint32_t Baudrate, DMA_Handle
 		__UART4_CLK_ENABLE();
 	}
 
-	uartInitStruct.Instance = STM_UART_PERIPH;
-	uartInitStruct.Init.BaudRate = Baudrate;
-	uartInitStruct.Init.WordLength = UART_WORDLENGTH_8B;
-	uartInitStruct.Init.StopBits = UART_STOPBITS_1;
-	uartInitStruct.Init.Parity = UART_PARITY_NONE;
-	uartInitStruct.Init.Mode = UART_MODE_TX_RX;
-	uartInitStruct.Init.HwFlowCtl = UART_HWCONTROL_NONE;
-	uartInitStruct.Init.OverSampling = UART_OVERSAMPLING_8;
-	uartInitStruct.Init.OneBitSampling = UART_ONE_BIT_SAMPLE_DISABLE;
-	uartInitStruct.hdmatx = DmaTx;
-	uartInitStruct.hdmarx = DmaRx;
-	uartInitStruct.AdvancedInit.AdvFeatureInit = UART_ADVFEATURE_NO_INIT;
+	Handle->Instance = STM_UART_PERIPH;
+	Handle->Init.BaudRate = Baudrate;
+	Handle->Init.WordLength = UART_WORDLENGTH_8B;
+	Handle->Init.StopBits = UART_STOPBITS_1;
+	Handle->Init.Parity = UART_PARITY_NONE;
+	Handle->Init.Mode = UART_MODE_TX_RX;
+	Handle->Init.HwFlowCtl = UART_HWCONTROL_NONE;
+	Handle->Init.OverSampling = UART_OVERSAMPLING_8;
+	Handle->Init.OneBitSampling = UART_ONE_BIT_SAMPLE_DISABLE;
+	Handle->hdmatx = DmaTx;
+	Handle->hdmarx = DmaRx;
+	Handle->AdvancedInit.AdvFeatureInit = UART_ADVFEATURE_NO_INIT;
+	Handle->gState = HAL_UART_STATE_RESET;
+	Handle->RxState = HAL_UART_STATE_RESET;
+	Handle->Lock = HAL_UNLOCKED;
+
+	if(DmaTx != NULL)
+	{
+		DmaTx->Parent = Handle;
+	}
+	if(DmaRx != NULL)
+	{
+		DmaRx->Parent = Handle;
+	}
 
-	retVal = HAL_UART_Init(&uartInitStruct);
+	retVal = HAL_UART_Init(Handle);
 	assert_param(retVal == HAL_OK);
 }
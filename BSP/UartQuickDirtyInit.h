@@ -30,6 +30,7 @@
 
 #include <stm32f7xx_hal.h>
 void STM_UartInit( USART_TypeDef* STM_UART_PERIPH, uint32_t Baudrate, DMA_HandleTypeDef* DmaTx, DMA_HandleTypeDef* DmaRx );
+void STM_UartInitHandle( UART_HandleTypeDef* Handle, USART_TypeDef* STM_UART_PERIPH, uint32_t Baudrate, DMA_HandleTypeDef* DmaTx, DMA_HandleTypeDef* DmaRx );
 
 #ifdef __cplusplus
  }
@@ -26,7 +26,7 @@
 #include "usbd_core.h"
 
 /* USER CODE BEGIN Includes */
-
+#include "FreeRTOS.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -45,7 +45,15 @@ void Error_Handler(void);
 extern void SystemClock_Config(void);
 
 /* USER CODE BEGIN 0 */
-
+/**
+  * @brief This function handles USB On The Go FS global interrupt.
+  */
+void OTG_FS_IRQHandler(void)
+{
+  DIS_ISR_ENTER();
+  HAL_PCD_IRQHandler(&hpcd_USB_OTG_FS);
+  DIS_ISR_EXIT();
+}
 /* USER CODE END 0 */
 
 /* USER CODE BEGIN PFP */
@@ -93,11 +93,11 @@
 
 /* Memory management macros */
 
-/** Alias for memory allocation. */
-#define USBD_malloc         malloc
+/** Alias for memory allocation, the class data is statically allocated. */
+#define USBD_malloc         USBD_static_malloc
 
 /** Alias for memory release. */
-#define USBD_free           free
+#define USBD_free           USBD_static_free
 
 /** Alias for memory set. */
 #define USBD_memset         memset
@@ -153,6 +153,8 @@
   */
 
 /* Exported functions -------------------------------------------------------*/
+void *USBD_static_malloc(uint32_t size);
+void USBD_static_free(void *p);
 
 /**
   * @}
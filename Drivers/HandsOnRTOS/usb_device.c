@@ -48,6 +48,10 @@ USBD_HandleTypeDef hUsbDeviceFS;
  * -- Insert your variables declaration here --
  */
 /* USER CODE BEGIN 0 */
+//class data of the CDC class, the only allocation of the device library,
+//kept 32 bit aligned for the endpoint buffers within
+static uint32_t usbClassData[(sizeof(USBD_CDC_HandleTypeDef) + 3U) / 4U];
+static uint8_t usbClassDataUsed = 0;
 
 /* USER CODE END 0 */
 
@@ -55,6 +59,29 @@ USBD_HandleTypeDef hUsbDeviceFS;
  * -- Insert your external function declaration here --
  */
 /* USER CODE BEGIN 1 */
+/**
+  * Static replacement of malloc for the USB device library (USBD_malloc in
+  * usbd_conf.h).  There is a single class instance, which is only allocated
+  * and released from the USB interrupt, so one block is enough.
+  * @retval the class data or NULL if it is too small or still in use
+  */
+void *USBD_static_malloc(uint32_t size)
+{
+  if((size > sizeof(usbClassData)) || usbClassDataUsed)
+  {
+    return NULL;
+  }
+  usbClassDataUsed = 1;
+  return usbClassData;
+}
+
+void USBD_static_free(void *p)
+{
+  if(p == usbClassData)
+  {
+    usbClassDataUsed = 0;
+  }
+}
 
 /* USER CODE END 1 */
 
@@ -21,7 +21,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "usbd_cdc_if.h"
-#include "VirtualCommDriverMultiTask.h"
+#include "dis/osal/io/vcom_hooks.h"
 
 /* USER CODE BEGIN INCLUDE */
 
@@ -64,9 +64,9 @@
   */
 
 /************************* NOTE ***********************************
- * All of the functionality of this file can be moved into VirtualCommDriver.c to cleanup
- * the code-base, but instead, select parts are simply being overwritten by VirtualCommDriver.c
- * so the previous examples will still work
+ * The transmit and receive paths are taken over by dis::vcom
+ * (src/dis/osal/io/vcom.cpp), which replaces the transmit complete callback
+ * of the CDC class and is fed by CDC_Receive_FS
  */
 
 /* USER CODE BEGIN PRIVATE_DEFINES */
@@ -271,16 +271,10 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
 	/* USER CODE BEGIN 6 */
-	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-
+	//dis::vcom queues the data and re-arms the endpoint once there is room
+	//for the next packet, until then the host is NAKed
 	USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-	xStreamBufferSendFromISR(	*GetUsbRxStreamBuff(),
-								Buf,
-								*Len,
-								&xHigherPriorityTaskWoken);
-
-	USBD_CDC_ReceivePacket(&hUsbDeviceFS);
-	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+	dis_vcom_rx_complete(Buf, *Len);
 	return (USBD_OK);
 	/* USER CODE END 6 */
 }
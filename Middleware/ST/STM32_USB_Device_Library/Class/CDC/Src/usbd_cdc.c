@@ -471,8 +471,7 @@ __ALIGN_BEGIN uint8_t USBD_CDC_OtherSpeedCfgDesc[USB_CDC_CONFIG_DESC_SIZ] __ALIG
 static uint8_t  USBD_CDC_Init (USBD_HandleTypeDef *pdev, uint8_t cfgidx)
 {
   uint8_t ret = 0U;
-  static USBD_CDC_HandleTypeDef cdcStorage;
-  USBD_CDC_HandleTypeDef* hcdc = &cdcStorage;	//statically allocate space for usb cdc to avoid malloc
+  USBD_CDC_HandleTypeDef* hcdc = NULL;
 
   if(pdev->dev_speed == USBD_SPEED_HIGH)
   {
@@ -507,7 +506,13 @@ static uint8_t  USBD_CDC_Init (USBD_HandleTypeDef *pdev, uint8_t cfgidx)
   USBD_LL_OpenEP(pdev, CDC_CMD_EP, USBD_EP_TYPE_INTR, CDC_CMD_PACKET_SIZE);
   pdev->ep_in[CDC_CMD_EP & 0xFU].is_used = 1U;
 
-  pdev->pClassData = hcdc;
+  //USBD_malloc hands out static storage, see usbd_conf.h
+  pdev->pClassData = USBD_malloc(sizeof(USBD_CDC_HandleTypeDef));
+  if(pdev->pClassData == NULL)
+  {
+    return 1U;
+  }
+  hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
   memset(pdev->pClassData,0,sizeof(USBD_CDC_HandleTypeDef)); // THIS LINE WAS ADDED
 
 	/* Init  physical Interface components */
@@ -560,7 +565,7 @@ static uint8_t  USBD_CDC_DeInit (USBD_HandleTypeDef *pdev, uint8_t cfgidx)
   if(pdev->pClassData != NULL)
   {
     ((USBD_CDC_ItfTypeDef *)pdev->pUserData)->DeInit();
-//    USBD_free(pdev->pClassData);		not needed because malloc wasn't used
+    USBD_free(pdev->pClassData);
     pdev->pClassData = NULL;
   }
 
@@ -0,0 +1,44 @@
+/**
+ * Host stand-in for the LED's and the push button of the Nucleo-F767ZI.
+ * The LED's are silent, with DIS_HOST_LEDS set in the environment their
+ * changes are reported on stderr, stdout is left to the virtual com port.
+ */
+
+#include <Nucleo_F767ZI_GPIO.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int reportLeds = 0;
+
+//read once before main(), so the tasks never call getenv()
+__attribute__((constructor)) static void initLedReport( void )
+{
+	const char* value = getenv("DIS_HOST_LEDS");
+	reportLeds = (value != NULL) && (value[0] != '\0');
+}
+
+static void reportLed( const char* Text )
+{
+	if(reportLeds)
+	{
+		//write() instead of stdio, the calling task may be preempted at any time
+		(void)!write(STDERR_FILENO, Text, strlen(Text));
+	}
+}
+
+void GreenOn ( void ) {reportLed("led green on\n");}
+void GreenOff ( void ) {reportLed("led green off\n");}
+LED GreenLed = { GreenOn, GreenOff };
+
+void BlueOn ( void ) {reportLed("led blue on\n");}
+void BlueOff ( void ) {reportLed("led blue off\n");}
+LED BlueLed = { BlueOn, BlueOff };
+
+void RedOn ( void ) {reportLed("led red on\n");}
+void RedOff ( void ) {reportLed("led red off\n");}
+LED RedLed = { RedOn, RedOff };
+
+//the button is always pressed
+uint_fast8_t ReadPushButton( void ){ return 1;}
@@ -0,0 +1,59 @@
+/**
+ * Host stand-in for the board initialization of the Nucleo-F767ZI.
+ */
+
+#include <FreeRTOS.h>
+#include "Nucleo_F767ZI_Init.h"
+#include <stm32f7xx_hal.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//the host cycle counter counts nanoseconds, see dis/osal/utils/cycle_counter.hpp
+uint32_t SystemCoreClock = 1000000000UL;
+
+//state of the xorshift generator which replaces the RNG peripheral
+static uint32_t randState = 2463534242UL;
+
+void HWInit( void )
+{
+}
+
+void PWMInit( void )
+{
+}
+
+/**
+ * same mapping as the target (RNG->DR % Max + Min), the sequence is
+ * deterministic, so host runs are reproducible
+ */
+uint32_t StmRand( uint32_t Min, uint32_t Max )
+{
+	randState ^= randState << 13;
+	randState ^= randState >> 17;
+	randState ^= randState << 5;
+	return randState % Max + Min;
+}
+
+void HAL_NVIC_SetPriorityGrouping(uint32_t PriorityGroup)
+{
+	(void)PriorityGroup;
+}
+
+void Error_Handler(void)
+{
+	fprintf(stderr, "Error_Handler called\n");
+	abort();
+}
+
+void assert_failed(uint8_t *file, uint32_t line)
+{
+	fprintf(stderr, "assert_param failed: %s:%u\n", (const char*)file, (unsigned)line);
+	abort();
+}
+
+void vAssertCalled(const char* pcFile, unsigned long ulLine)
+{
+	fprintf(stderr, "configASSERT failed: %s:%lu\n", pcFile, ulLine);
+	abort();
+}
@@ -0,0 +1,132 @@
+/**
+ * Simulated TIM9 for the host build, the stand-in for
+ * BSP/TIM9_UnderRTOS_Radar_ISR.c.
+ *
+ * A timer thread sleeps until the next update event on the monotonic clock,
+ * which the host cycle counter counts in nanoseconds, and raises a simulated
+ * interrupt.  As on the target the event cycle is the time the update was
+ * due, so the wake up delay of the thread and of the signal are part of the
+ * measured interrupt latency.  Events which come while the interrupt is
+ * still pending are merged, like a set update flag.
+ *
+ * The timer thread is not a task, it only communicates through atomics with
+ * the interrupt handler.
+ */
+
+#include <TIM9_UnderRTOS_Radar_ISR.h>
+
+#include <FreeRTOS.h>
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+//simulated TIM1_BRK_TIM9 interrupt, 0 is the USB one
+#define tim9Interrupt 1
+
+static TIM9UpdateCallback tim9Callback = NULL;
+
+//a new start ends the thread of the previous one
+static atomic_uint tim9Generation = 0;
+static atomic_uint_least32_t tim9EventCycles = 0;
+static atomic_int tim9Pending = 0;
+
+//handed over to the timer thread, which frees it
+typedef struct
+{
+	unsigned Generation;
+	long PeriodNs;
+} tim9Run;
+
+static uint32_t tim9Cycles( void )
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)((uint64_t)now.tv_sec * 1000000000U + (uint64_t)now.tv_nsec);
+}
+
+static BaseType_t tim9Irq( void )
+{
+	const uint32_t entryCycles = tim9Cycles();
+	const uint32_t eventCycles = atomic_load(&tim9EventCycles);
+
+	atomic_store(&tim9Pending, 0);
+	if(tim9Callback != NULL)
+	{
+		tim9Callback(eventCycles, entryCycles);
+	}
+	return pdFALSE;
+}
+
+static void* tim9Timer( void* Arg )
+{
+	const tim9Run run = *(const tim9Run*)Arg;
+	struct timespec next;
+
+	free(Arg);
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	while(atomic_load(&tim9Generation) == run.Generation)
+	{
+		next.tv_nsec += run.PeriodNs;
+		while(next.tv_nsec >= 1000000000L)
+		{
+			next.tv_nsec -= 1000000000L;
+			next.tv_sec++;
+		}
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) != 0)
+		{
+		}
+
+		if(atomic_exchange(&tim9Pending, 1) == 0)
+		{
+			atomic_store(&tim9EventCycles, (uint32_t)((uint64_t)next.tv_sec * 1000000000U + (uint64_t)next.tv_nsec));
+			vPortGenerateSimulatedInterrupt(tim9Interrupt);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Starts the simulated update events at RateHz.  IrqPriority has no meaning
+ * for simulated interrupts.
+ * @return HAL_ERROR if RateHz is out of range, the timer is not started then
+ */
+HAL_StatusTypeDef TIM9UnderRTOSRadarStart(uint32_t RateHz, uint32_t IrqPriority, TIM9UpdateCallback Callback)
+{
+	pthread_t thread;
+	tim9Run *run;
+	sigset_t allSignals;
+	sigset_t originalSignals;
+
+	(void)IrqPriority;
+	if((RateHz == 0) || (RateHz > SystemCoreClock / 2))
+	{
+		return HAL_ERROR;
+	}
+
+	tim9Callback = Callback;
+	atomic_store(&tim9Pending, 0);
+	vPortSetInterruptHandler(tim9Interrupt, tim9Irq);
+
+	run = malloc(sizeof(*run));
+	assert_param(run != NULL);
+	run->Generation = atomic_fetch_add(&tim9Generation, 1) + 1;
+	run->PeriodNs = (long)(1000000000UL / RateHz);
+
+	sigfillset(&allSignals);
+	pthread_sigmask(SIG_BLOCK, &allSignals, &originalSignals);
+	assert_param(pthread_create(&thread, NULL, tim9Timer, run) == 0);
+	pthread_sigmask(SIG_SETMASK, &originalSignals, NULL);
+	pthread_detach(thread);
+	return HAL_OK;
+}
+
+void TIM9UnderRTOSRadarStop(void)
+{
+	atomic_fetch_add(&tim9Generation, 1);
+	tim9Callback = NULL;
+}
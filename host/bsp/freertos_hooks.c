@@ -0,0 +1,46 @@
+/**
+ * Application hooks and static kernel memory required by FreeRTOSConfig.h.
+ * They are weak, so an application can still provide its own.
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <unistd.h>
+
+/**
+ * The idle task sleeps until the next (simulated) interrupt instead of
+ * burning a core of the host.
+ */
+__attribute__((weak)) void vApplicationIdleHook( void )
+{
+	pause();
+}
+
+__attribute__((weak)) void vApplicationTickHook( void )
+{
+}
+
+__attribute__((weak)) void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer,
+														StackType_t **ppxIdleTaskStackBuffer,
+														uint32_t *pulIdleTaskStackSize )
+{
+	static StaticTask_t idleTaskTCB;
+	static StackType_t idleTaskStack[configMINIMAL_STACK_SIZE];
+
+	*ppxIdleTaskTCBBuffer = &idleTaskTCB;
+	*ppxIdleTaskStackBuffer = idleTaskStack;
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+__attribute__((weak)) void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer,
+														 StackType_t **ppxTimerTaskStackBuffer,
+														 uint32_t *pulTimerTaskStackSize )
+{
+	static StaticTask_t timerTaskTCB;
+	static StackType_t timerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+	*ppxTimerTaskTCBBuffer = &timerTaskTCB;
+	*ppxTimerTaskStackBuffer = timerTaskStack;
+	*pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
@@ -0,0 +1,17 @@
+#ifndef HOST_STM32F7XX_H
+#define HOST_STM32F7XX_H
+
+/**
+ * Host stand-in for the CMSIS device header, only what the USB device
+ * library and its glue code refer to.
+ */
+
+#include <stm32f7xx_hal.h>
+
+#define __IO volatile
+
+/* unique device ID, only read for the serial number string descriptor, which
+ * the simulated host does not request */
+#define UID_BASE 0x1FF0F420UL
+
+#endif /* HOST_STM32F7XX_H */
@@ -0,0 +1,38 @@
+#ifndef HOST_STM32F7XX_HAL_H
+#define HOST_STM32F7XX_HAL_H
+
+/**
+ * Host stand-in for the few parts of the STM32F7 HAL which the applications
+ * use directly, the peripherals themselves are simulated by the host BSP.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+typedef enum
+{
+	HAL_OK = 0x00U,
+	HAL_ERROR = 0x01U,
+	HAL_BUSY = 0x02U,
+	HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+#define NVIC_PRIORITYGROUP_4 ((uint32_t)0x00000003U)
+
+#define UNUSED(X) (void)X
+
+void HAL_NVIC_SetPriorityGrouping(uint32_t PriorityGroup);
+void Error_Handler(void);
+
+/* assert_param is always evaluated, as with USE_FULL_ASSERT on the target */
+void assert_failed(uint8_t* file, uint32_t line);
+#define assert_param(expr) ((expr) ? (void)0U : assert_failed((uint8_t *)__FILE__, __LINE__))
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif /* HOST_STM32F7XX_HAL_H */
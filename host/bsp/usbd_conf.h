@@ -0,0 +1,65 @@
+#ifndef __USBD_CONF__H__
+#define __USBD_CONF__H__
+
+/**
+ * Host stand-in for BSP/usbd_conf.h, with the same include guard, as sources
+ * next to the original pick it up first.  The configuration of the USB device
+ * library is the same as on the target, the peripheral (PCD) is simulated by
+ * usbd_conf_sim.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f7xx.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#define USBD_MAX_NUM_INTERFACES     1U
+#define USBD_MAX_NUM_CONFIGURATION     1U
+#define USBD_MAX_STR_DESC_SIZ     512U
+#define USBD_SUPPORT_USER_STRING     0U
+#define USBD_DEBUG_LEVEL     0U
+#define USBD_LPM_ENABLED     1U
+#define USBD_SELF_POWERED     1U
+
+/* #define for FS and HS identification */
+#define DEVICE_FS 		0
+#define DEVICE_HS 		1
+
+/* Memory management macros */
+#define USBD_malloc         USBD_static_malloc
+#define USBD_free           USBD_static_free
+#define USBD_memset         memset
+#define USBD_memcpy         memcpy
+#define USBD_Delay          USBD_LL_Delay
+
+#define USBD_UsrLog(...)
+#define USBD_ErrLog(...)
+#define USBD_DbgLog(...)
+
+/* the parts of the HAL PCD handle which the device library accesses */
+typedef struct
+{
+	uint32_t maxpacket;
+	uint8_t *xfer_buff;
+	uint32_t xfer_len;
+} PCD_EPTypeDef;
+
+typedef struct
+{
+	PCD_EPTypeDef IN_ep[16];
+	PCD_EPTypeDef OUT_ep[16];
+	void *pData;
+} PCD_HandleTypeDef;
+
+void *USBD_static_malloc(uint32_t size);
+void USBD_static_free(void *p);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif /* __USBD_CONF__H__ */
@@ -0,0 +1,451 @@
+/**
+ * Simulated USB OTG FS peripheral for the host build, the stand-in for
+ * BSP/usbd_conf.c.
+ *
+ * The ST device library (core and CDC class), usb_device.c, usbd_cdc_if.c and
+ * the virtual com port driver run unchanged on top of it.  The host end of
+ * the virtual com port is the process itself:
+ *  - a bus thread plays the full speed bus: once per 1ms frame it moves up
+ *    to usbPacketsPerFrame bulk packets of 64 bytes, IN packets are written
+ *    to stdout, OUT packets are taken from the data read from stdin
+ *  - completed transfers are reported by a simulated interrupt which calls
+ *    into the device library, just like the OTG FS interrupt on the target
+ *  - an OUT endpoint which is not armed NAKs, the data waits on the host
+ *  - closing stdin looks like an idle host
+ *
+ * The bus thread also checks the IN transfers like a host would: a transfer
+ * which is a multiple of the packet size has to be terminated by a zero
+ * length packet, otherwise the host could not tell where it ends.
+ *
+ * Neither the bus thread nor the stdin reader is a task, they must never
+ * handle a simulated interrupt and only communicate through atomics and a
+ * semaphore with the library, which also runs from within the interrupt.
+ */
+
+#include "usbd_core.h"
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+#define stdinBuffLen 4096
+
+//number of the bulk endpoints of the CDC class (0x81 IN, 0x01 OUT), the
+//direction bit is ignored as by the HAL: the class passes the plain
+//endpoint number when it sends the zero length packet
+#define usbDataEp 0x01U
+#define usbEpNumber(Addr) ((Addr) & 0x7FU)
+
+//bulk packets per frame, the theoretical maximum of full speed is 19
+#define usbPacketsPerFrame 19U
+#define usbFrameNs 1000000L
+
+//simulated OTG FS interrupt
+#define usbInterrupt 0
+
+typedef enum
+{
+	epIdle = 0,		//IN: no transfer, OUT: not armed (NAK)
+	epActive,		//owned by the bus
+	epComplete		//waiting for the interrupt
+} epState;
+
+static PCD_HandleTypeDef hpcd_USB_OTG_FS;
+
+//the transfer fields are written before the state is set to epActive
+static atomic_int usbInState = epIdle;
+static uint32_t usbInSent = 0;
+static int usbInAwaitZlp = 0;
+
+static atomic_int usbOutState = epIdle;
+static uint32_t usbOutCount = 0;
+
+static sem_t usbBusWake;
+
+//single producer (stdinReader) single consumer (usbBus) ring, the indices
+//are free running
+static uint8_t usbStdinBuff[stdinBuffLen];
+static atomic_size_t usbStdinHead = 0;
+static atomic_size_t usbStdinTail = 0;
+
+static void* usbBus( void* NotUsed );
+static void* stdinReader( void* NotUsed );
+static BaseType_t usbIrq( void );
+static void startThread( void* (*Function)( void* ) );
+static void enumerate( USBD_HandleTypeDef *pdev );
+static int busInPacket( void );
+static int busOutPacket( void );
+
+/******************************* LL Driver Interface ****************************/
+
+USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
+{
+	hpcd_USB_OTG_FS.pData = pdev;
+	pdev->pData = &hpcd_USB_OTG_FS;
+	return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_DeInit(USBD_HandleTypeDef *pdev)
+{
+	(void)pdev;
+	return USBD_OK;
+}
+
+/**
+ * the simulated host attaches and configures the device right away
+ */
+USBD_StatusTypeDef USBD_LL_Start(USBD_HandleTypeDef *pdev)
+{
+	assert_param(sem_init(&usbBusWake, 0, 0) == 0);
+	vPortSetInterruptHandler(usbInterrupt, usbIrq);
+
+	enumerate(pdev);
+
+	startThread(usbBus);
+	startThread(stdinReader);
+	return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_Stop(USBD_HandleTypeDef *pdev)
+{
+	(void)pdev;
+	return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_OpenEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t ep_type, uint16_t ep_mps)
+{
+	PCD_HandleTypeDef *hpcd = (PCD_HandleTypeDef*)pdev->pData;
+	(void)ep_type;
+
+	if((ep_addr & 0x80U) != 0U)
+	{
+		hpcd->IN_ep[ep_addr & 0xFU].maxpacket = ep_mps;
+	}
+	else
+	{
+		hpcd->OUT_ep[ep_addr & 0xFU].maxpacket = ep_mps;
+	}
+	return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_CloseEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+	(void)pdev;
+	(void)ep_addr;
+	return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_FlushEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+	(void)pdev;
+	(void)ep_addr;
+	return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_StallEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+	(void)pdev;
+	(void)ep_addr;
+	return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_ClearStallEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+	(void)pdev;
+	(void)ep_addr;
+	return USBD_OK;
+}
+
+uint8_t USBD_LL_IsStallEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+	(void)pdev;
+	(void)ep_addr;
+	return 0U;
+}
+
+USBD_StatusTypeDef USBD_LL_SetUSBAddress(USBD_HandleTypeDef *pdev, uint8_t dev_addr)
+{
+	(void)pdev;
+	(void)dev_addr;
+	return USBD_OK;
+}
+
+/**
+ * transfers on the control endpoint complete immediately, there is no host
+ * side reading them
+ */
+USBD_StatusTypeDef USBD_LL_Transmit(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint16_t size)
+{
+	PCD_HandleTypeDef *hpcd = (PCD_HandleTypeDef*)pdev->pData;
+
+	if(usbEpNumber(ep_addr) != usbDataEp)
+	{
+		return USBD_OK;
+	}
+	if(atomic_load(&usbInState) != epIdle)
+	{
+		return USBD_BUSY;
+	}
+
+	hpcd->IN_ep[usbDataEp].xfer_buff = pbuf;
+	hpcd->IN_ep[usbDataEp].xfer_len = size;
+	usbInSent = 0;
+	atomic_store(&usbInState, epActive);
+	sem_post(&usbBusWake);
+	return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_PrepareReceive(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint16_t size)
+{
+	PCD_HandleTypeDef *hpcd = (PCD_HandleTypeDef*)pdev->pData;
+
+	if(usbEpNumber(ep_addr) != usbDataEp)
+	{
+		return USBD_OK;
+	}
+
+	hpcd->OUT_ep[usbDataEp].xfer_buff = pbuf;
+	hpcd->OUT_ep[usbDataEp].xfer_len = size;
+	usbOutCount = 0;
+	atomic_store(&usbOutState, epActive);
+	sem_post(&usbBusWake);
+	return USBD_OK;
+}
+
+uint32_t USBD_LL_GetRxDataSize(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+	(void)pdev;
+	return (usbEpNumber(ep_addr) == usbDataEp) ? usbOutCount : 0U;
+}
+
+void USBD_LL_Delay(uint32_t Delay)
+{
+	usleep(Delay * 1000U);
+}
+
+/********************************** PRIVATE *************************************/
+
+static void startThread( void* (*Function)( void* ) )
+{
+	pthread_t thread;
+	sigset_t allSignals;
+	sigset_t originalSignals;
+
+	sigfillset(&allSignals);
+	pthread_sigmask(SIG_BLOCK, &allSignals, &originalSignals);
+	assert_param(pthread_create(&thread, NULL, Function, NULL) == 0);
+	pthread_sigmask(SIG_SETMASK, &originalSignals, NULL);
+	pthread_detach(thread);
+}
+
+/**
+ * bus reset, SET_ADDRESS and SET_CONFIGURATION as sent by a host, the
+ * configuration opens the CDC endpoints and calls CDC_Init_FS
+ */
+static void enumerate( USBD_HandleTypeDef *pdev )
+{
+	uint8_t setAddress[8] = { 0x00, USB_REQ_SET_ADDRESS, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	uint8_t setConfiguration[8] = { 0x00, USB_REQ_SET_CONFIGURATION, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	USBD_LL_SetSpeed(pdev, USBD_SPEED_FULL);
+	USBD_LL_Reset(pdev);
+	USBD_LL_SetupStage(pdev, setAddress);
+	USBD_LL_SetupStage(pdev, setConfiguration);
+	assert_param(pdev->dev_state == USBD_STATE_CONFIGURED);
+}
+
+static void* usbBus( void* NotUsed )
+{
+	struct timespec frame;
+	(void)NotUsed;
+
+	clock_gettime(CLOCK_MONOTONIC, &frame);
+	while(1)
+	{
+		frame.tv_nsec += usbFrameNs;
+		if(frame.tv_nsec >= 1000000000L)
+		{
+			frame.tv_nsec -= 1000000000L;
+			frame.tv_sec++;
+		}
+
+		uint32_t packets = 0;
+		while(packets < usbPacketsPerFrame)
+		{
+			int moved = busInPacket();
+			moved += busOutPacket();
+			if(moved > 0)
+			{
+				packets += (uint32_t)moved;
+				continue;
+			}
+
+			//nothing to do, wait for a new transfer until the frame is over
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			if((now.tv_sec > frame.tv_sec) || ((now.tv_sec == frame.tv_sec) && (now.tv_nsec >= frame.tv_nsec)))
+			{
+				break;
+			}
+			struct timespec timeout;
+			clock_gettime(CLOCK_REALTIME, &timeout);
+			timeout.tv_nsec += (frame.tv_sec - now.tv_sec) * 1000000000L + (frame.tv_nsec - now.tv_nsec);
+			timeout.tv_sec += timeout.tv_nsec / 1000000000L;
+			timeout.tv_nsec %= 1000000000L;
+			while((sem_timedwait(&usbBusWake, &timeout) != 0) && (errno == EINTR))
+			{
+			}
+		}
+
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &frame, NULL);
+	}
+	return NULL;
+}
+
+/**
+ * moves the next packet of the active IN transfer, the transfer completes
+ * with its last packet, which is short unless the transfer is a multiple of
+ * the packet size
+ * @returns number of packets moved
+ */
+static int busInPacket( void )
+{
+	PCD_EPTypeDef *ep = &hpcd_USB_OTG_FS.IN_ep[usbDataEp];
+
+	if(atomic_load(&usbInState) != epActive)
+	{
+		return 0;
+	}
+
+	uint32_t size = ep->xfer_len - usbInSent;
+	if(size > ep->maxpacket)
+	{
+		size = ep->maxpacket;
+	}
+
+	if(ep->xfer_len == 0U)
+	{
+		usbInAwaitZlp = 0;
+	}
+	else if((usbInSent == 0U) && usbInAwaitZlp)
+	{
+		fprintf(stderr, "usb: IN transfer started without the zero length packet ending the previous one\n");
+		abort();
+	}
+
+	size_t written = 0;
+	while(written < size)
+	{
+		const ssize_t result = write(STDOUT_FILENO, ep->xfer_buff + usbInSent + written, size - written);
+		if(result <= 0)
+		{
+			//nobody is listening anymore, drop the data
+			break;
+		}
+		written += (size_t)result;
+	}
+	usbInSent += size;
+
+	if(usbInSent == ep->xfer_len)
+	{
+		usbInAwaitZlp = (ep->xfer_len > 0U) && ((ep->xfer_len % ep->maxpacket) == 0U);
+		atomic_store(&usbInState, epComplete);
+		vPortGenerateSimulatedInterrupt(usbInterrupt);
+	}
+	return 1;
+}
+
+/**
+ * hands one packet of the data read from stdin to the armed OUT endpoint,
+ * the CDC class arms it for a single packet
+ * @returns number of packets moved
+ */
+static int busOutPacket( void )
+{
+	PCD_EPTypeDef *ep = &hpcd_USB_OTG_FS.OUT_ep[usbDataEp];
+	const size_t head = atomic_load(&usbStdinHead);
+	const size_t tail = atomic_load(&usbStdinTail);
+
+	if((atomic_load(&usbOutState) != epActive) || (head == tail))
+	{
+		return 0;
+	}
+
+	size_t size = head - tail;
+	if(size > ep->maxpacket)
+	{
+		size = ep->maxpacket;
+	}
+	if(size > ep->xfer_len)
+	{
+		size = ep->xfer_len;
+	}
+	for(size_t i = 0; i < size; i++)
+	{
+		ep->xfer_buff[i] = usbStdinBuff[(tail + i) % stdinBuffLen];
+	}
+	atomic_store(&usbStdinTail, tail + size);
+
+	usbOutCount = (uint32_t)size;
+	atomic_store(&usbOutState, epComplete);
+	vPortGenerateSimulatedInterrupt(usbInterrupt);
+	return 1;
+}
+
+static BaseType_t usbIrq( void )
+{
+	USBD_HandleTypeDef *pdev = (USBD_HandleTypeDef*)hpcd_USB_OTG_FS.pData;
+	int expected = epComplete;
+
+	//the library may start the next transfer from within the callbacks
+	if(atomic_compare_exchange_strong(&usbInState, &expected, epIdle))
+	{
+		USBD_LL_DataInStage(pdev, usbDataEp, hpcd_USB_OTG_FS.IN_ep[usbDataEp].xfer_buff);
+	}
+	expected = epComplete;
+	if(atomic_compare_exchange_strong(&usbOutState, &expected, epIdle))
+	{
+		USBD_LL_DataOutStage(pdev, usbDataEp, hpcd_USB_OTG_FS.OUT_ep[usbDataEp].xfer_buff);
+	}
+
+	//the callbacks request a context switch themselves
+	return pdFALSE;
+}
+
+static void* stdinReader( void* NotUsed )
+{
+	(void)NotUsed;
+	while(1)
+	{
+		const size_t head = atomic_load(&usbStdinHead);
+		const size_t used = head - atomic_load(&usbStdinTail);
+		if(used == stdinBuffLen)
+		{
+			//the host keeps the data while the device NAKs
+			usleep(1000);
+			continue;
+		}
+
+		const size_t index = head % stdinBuffLen;
+		size_t chunk = stdinBuffLen - used;
+		if(chunk > stdinBuffLen - index)
+		{
+			chunk = stdinBuffLen - index;
+		}
+
+		const ssize_t numBytes = read(STDIN_FILENO, &usbStdinBuff[index], chunk);
+		if(numBytes <= 0)
+		{
+			break;
+		}
+		atomic_store(&usbStdinHead, head + (size_t)numBytes);
+		sem_post(&usbBusWake);
+	}
+	return NULL;
+}
@@ -0,0 +1,485 @@
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for POSIX threads
+ * (Linux host builds).
+ *
+ * Every task runs on a thread of its own, but only the thread of the task
+ * selected by the scheduler is ever runnable, all other task threads wait on
+ * their event.  A context switch wakes the thread of the next task before the
+ * current thread suspends itself.
+ *
+ * Interrupts are simulated with signals, SIGALRM is the tick and SIGUSR1
+ * runs the handlers installed with vPortSetInterruptHandler().  Only the
+ * running task has these signals unblocked, so an interrupt is always
+ * handled on its thread and disabling interrupts means blocking the signals.
+ * If an interrupt requires a context switch, the interrupted thread suspends
+ * itself within the signal handler.
+ *
+ * NOTE: a task is preempted asynchronously, if that happens within a C
+ *       library function which takes a lock (stdio, malloc, ...), every
+ *       other task calling into the same function blocks the whole process.
+ *       Keep such calls in a single task or within a critical section.
+ * NOTE: deleted tasks leave their thread with pthread_exit(), which unwinds
+ *       the stack of the task.  Build with -fno-exceptions (as the firmware),
+ *       so no destructor of the task runs on the way.
+ *----------------------------------------------------------*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define portTICK_SIGNAL			SIGALRM
+#define portINTERRUPT_SIGNAL	SIGUSR1
+
+typedef struct
+{
+	pthread_mutex_t xMutex;
+	pthread_cond_t xCondition;
+	BaseType_t xSignaled;
+} Event_t;
+
+typedef struct
+{
+	pthread_t xThread;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+	volatile BaseType_t xDying;
+	Event_t xEvent;
+} Thread_t;
+
+/* The signals used as interrupts. */
+static sigset_t xInterruptSignals;
+
+/* Each task maintains its own critical nesting, it is saved and restored on
+every context switch, see prvSwitchThread(). */
+static volatile UBaseType_t uxCriticalNesting = 0;
+
+static volatile BaseType_t xSchedulerRunning = pdFALSE;
+static volatile BaseType_t xInsideInterrupt = pdFALSE;
+static volatile BaseType_t xSwitchRequiredFromInterrupt = pdFALSE;
+static Event_t xSchedulerEnd;
+
+static atomic_uint_least32_t ulPendingInterrupts = 0;
+static BaseType_t ( *pxInterruptHandlers[ portMAX_INTERRUPTS ] )( void );
+
+/*
+ * Runs the tick and the pending simulated interrupts.
+ */
+static void prvInterruptHandler( int iSignal );
+
+/*
+ * Entry point of every task thread.
+ */
+static void *prvThreadStart( void *pvThread );
+
+/*
+ * Used to catch tasks that attempt to return from their implementing function.
+ */
+static void prvTaskExitError( void );
+
+/*-----------------------------------------------------------*/
+
+static void prvEventInit( Event_t *pxEvent )
+{
+	pthread_mutex_init( &pxEvent->xMutex, NULL );
+	pthread_cond_init( &pxEvent->xCondition, NULL );
+	pxEvent->xSignaled = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvEventDelete( Event_t *pxEvent )
+{
+	pthread_cond_destroy( &pxEvent->xCondition );
+	pthread_mutex_destroy( &pxEvent->xMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvEventSignal( Event_t *pxEvent )
+{
+	pthread_mutex_lock( &pxEvent->xMutex );
+	pxEvent->xSignaled = pdTRUE;
+	pthread_cond_signal( &pxEvent->xCondition );
+	pthread_mutex_unlock( &pxEvent->xMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvEventWait( Event_t *pxEvent )
+{
+	pthread_mutex_lock( &pxEvent->xMutex );
+	while( pxEvent->xSignaled == pdFALSE )
+	{
+		pthread_cond_wait( &pxEvent->xCondition, &pxEvent->xMutex );
+	}
+	pxEvent->xSignaled = pdFALSE;
+	pthread_mutex_unlock( &pxEvent->xMutex );
+}
+/*-----------------------------------------------------------*/
+
+/* Runs before any static constructor, which may already create kernel
+objects (and so enter critical sections). */
+__attribute__(( constructor( 101 ) )) static void prvSetupSignals( void )
+{
+struct sigaction xAction;
+
+	sigemptyset( &xInterruptSignals );
+	sigaddset( &xInterruptSignals, portTICK_SIGNAL );
+	sigaddset( &xInterruptSignals, portINTERRUPT_SIGNAL );
+
+	/* Interrupts do not nest. */
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvInterruptHandler;
+	xAction.sa_mask = xInterruptSignals;
+	xAction.sa_flags = SA_RESTART;
+	sigaction( portTICK_SIGNAL, &xAction, NULL );
+	sigaction( portINTERRUPT_SIGNAL, &xAction, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static Thread_t *prvGetThreadFromTask( TaskHandle_t xTask )
+{
+StackType_t *pxTopOfStack;
+
+	/* pxTopOfStack is the first member of the TCB and points right below the
+	thread, see pxPortInitialiseStack(). */
+	pxTopOfStack = *( StackType_t ** ) xTask;
+	return ( Thread_t * ) ( pxTopOfStack + 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendSelf( Thread_t *pxThread )
+{
+	prvEventWait( &pxThread->xEvent );
+
+	if( pxThread->xDying != pdFALSE )
+	{
+		pthread_exit( NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThread( Thread_t *pxThreadToResume, Thread_t *pxThreadToSuspend )
+{
+UBaseType_t uxSavedCriticalNesting;
+
+	if( pxThreadToResume != pxThreadToSuspend )
+	{
+		uxSavedCriticalNesting = uxCriticalNesting;
+
+		prvEventSignal( &pxThreadToResume->xEvent );
+
+		/* A task that deleted itself does not run again. */
+		if( pxThreadToSuspend->xDying != pdFALSE )
+		{
+			pthread_exit( NULL );
+		}
+
+		prvSuspendSelf( pxThreadToSuspend );
+
+		uxCriticalNesting = uxSavedCriticalNesting;
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+sigset_t xOriginalMask;
+int iResult;
+
+	/* The thread itself runs on a stack provided by pthreads, the stack of
+	the task only holds the thread structure at its top. */
+	pxThread = ( Thread_t * ) ( ( ( portPOINTER_SIZE_TYPE ) ( pxTopOfStack + 1 ) - sizeof( Thread_t ) ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) );
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pxThread->xDying = pdFALSE;
+	prvEventInit( &pxThread->xEvent );
+
+	/* The new thread must not handle an interrupt before it got scheduled,
+	it inherits the blocked signals. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xOriginalMask );
+	iResult = pthread_create( &pxThread->xThread, NULL, prvThreadStart, pxThread );
+	pthread_sigmask( SIG_SETMASK, &xOriginalMask, NULL );
+	configASSERT( iResult == 0 );
+
+	return ( ( StackType_t * ) pxThread ) - 1;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadStart( void *pvThread )
+{
+Thread_t *pxThread = ( Thread_t * ) pvThread;
+
+	prvSuspendSelf( pxThread );
+
+	/* Scheduled for the first time, the task starts with interrupts
+	enabled. */
+	uxCriticalNesting = 0;
+	vPortEnableInterrupts();
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	prvTaskExitError();
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskExitError( void )
+{
+	/* A function that implements a task must not exit or attempt to return to
+	its caller as there is nothing to return to.  If a task wants to exit it
+	should instead call vTaskDelete( NULL ). */
+	configASSERT( pdFALSE );
+	vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+BaseType_t xPortStartScheduler( void )
+{
+struct itimerval xTimer;
+
+	/* The main thread never handles an interrupt, it only waits for
+	vPortEndScheduler(). */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+	prvEventInit( &xSchedulerEnd );
+
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = 1000000L / configTICK_RATE_HZ;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	/* Start the first task. */
+	uxCriticalNesting = 0;
+	xSchedulerRunning = pdTRUE;
+	prvEventSignal( &prvGetThreadFromTask( xTaskGetCurrentTaskHandle() )->xEvent );
+
+	/* Interrupts raised before the scheduler ran are still pending. */
+	if( atomic_load( &ulPendingInterrupts ) != 0 )
+	{
+		kill( getpid(), portINTERRUPT_SIGNAL );
+	}
+
+	prvEventWait( &xSchedulerEnd );
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+
+	memset( &xTimer, 0, sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+	xSchedulerRunning = pdFALSE;
+
+	prvEventSignal( &xSchedulerEnd );
+
+	/* The calling task never runs again, its thread is parked until the
+	process exits. */
+	for( ;; )
+	{
+		prvEventWait( &prvGetThreadFromTask( xTaskGetCurrentTaskHandle() )->xEvent );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+Thread_t *pxThreadToSuspend;
+Thread_t *pxThreadToResume;
+
+	if( xInsideInterrupt != pdFALSE )
+	{
+		/* The switch happens once the interrupt is done. */
+		xSwitchRequiredFromInterrupt = pdTRUE;
+		return;
+	}
+
+	vPortEnterCritical();
+	{
+		pxThreadToSuspend = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+		vTaskSwitchContext();
+		pxThreadToResume = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+
+		prvSwitchThread( pxThreadToResume, pxThreadToSuspend );
+	}
+	vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	pthread_sigmask( SIG_UNBLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xPortSetInterruptMask( void )
+{
+sigset_t xPrevious;
+
+	/* Returns whether the interrupts were masked already, which is always
+	the case within an interrupt. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xPrevious );
+	return ( UBaseType_t ) sigismember( &xPrevious, portTICK_SIGNAL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxMask )
+{
+	if( uxMask == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	vPortDisableInterrupts();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptHandler( int iSignal )
+{
+Thread_t *pxThreadToSuspend;
+Thread_t *pxThreadToResume;
+BaseType_t xSwitchRequired = pdFALSE;
+uint32_t ulPending;
+uint32_t ulInterrupt;
+int iSavedErrno = errno;
+
+	if( xSchedulerRunning == pdFALSE )
+	{
+		/* Raised too early or too late, the interrupt stays pending. */
+		return;
+	}
+
+	DIS_ISR_ENTER();
+
+	/* Kernel code called from here must not unblock the signals. */
+	uxCriticalNesting++;
+	xInsideInterrupt = pdTRUE;
+	pxThreadToSuspend = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+
+	if( iSignal == portTICK_SIGNAL )
+	{
+		if( xTaskIncrementTick() != pdFALSE )
+		{
+			xSwitchRequired = pdTRUE;
+		}
+	}
+
+	ulPending = atomic_exchange( &ulPendingInterrupts, 0 );
+	for( ulInterrupt = 0; ulPending != 0; ulInterrupt++, ulPending >>= 1 )
+	{
+		if( ( ( ulPending & 1UL ) != 0 ) && ( pxInterruptHandlers[ ulInterrupt ] != NULL ) )
+		{
+			if( pxInterruptHandlers[ ulInterrupt ]() != pdFALSE )
+			{
+				xSwitchRequired = pdTRUE;
+			}
+		}
+	}
+
+	if( xSwitchRequiredFromInterrupt != pdFALSE )
+	{
+		xSwitchRequiredFromInterrupt = pdFALSE;
+		xSwitchRequired = pdTRUE;
+	}
+
+	#if( configUSE_PREEMPTION == 1 )
+	{
+		if( xSwitchRequired != pdFALSE )
+		{
+			vTaskSwitchContext();
+		}
+	}
+	#endif
+	pxThreadToResume = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+
+	xInsideInterrupt = pdFALSE;
+	uxCriticalNesting--;
+
+	DIS_ISR_EXIT();
+
+	prvSwitchThread( pxThreadToResume, pxThreadToSuspend );
+	errno = iSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHandler( uint32_t ulInterruptNumber, BaseType_t ( *pxHandler )( void ) )
+{
+	configASSERT( ulInterruptNumber < portMAX_INTERRUPTS );
+	pxInterruptHandlers[ ulInterruptNumber ] = pxHandler;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGenerateSimulatedInterrupt( uint32_t ulInterruptNumber )
+{
+	configASSERT( ulInterruptNumber < portMAX_INTERRUPTS );
+	atomic_fetch_or( &ulPendingInterrupts, 1UL << ulInterruptNumber );
+
+	/* Delivered to whichever task runs with interrupts enabled. */
+	if( xSchedulerRunning != pdFALSE )
+	{
+		kill( getpid(), portINTERRUPT_SIGNAL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortIsInsideInterrupt( void )
+{
+	return xInsideInterrupt;
+}
+/*-----------------------------------------------------------*/
+
+void vPortThreadDying( void *pvTaskToDelete, volatile BaseType_t *pxPendYield )
+{
+	/* The thread exits as soon as it switched to the next task. */
+	prvGetThreadFromTask( pvTaskToDelete )->xDying = pdTRUE;
+	*pxPendYield = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortCancelThread( void *pxTaskToDelete )
+{
+Thread_t *pxThread = prvGetThreadFromTask( pxTaskToDelete );
+
+	/* A suspended thread wakes up and exits, one that deleted itself is
+	already gone.  Either way the thread structure is unused afterwards and
+	the kernel can free the stack. */
+	pxThread->xDying = pdTRUE;
+	prvEventSignal( &pxThread->xEvent );
+	pthread_join( pxThread->xThread, NULL );
+	prvEventDelete( &pxThread->xEvent );
+}
@@ -0,0 +1,37 @@
+#ifndef HOST_FREERTOS_CONFIG_H
+#define HOST_FREERTOS_CONFIG_H
+
+/*
+ * Kernel configuration of the host (POSIX port) build.
+ *
+ * The host runs the kernel with the very same settings as the firmware, only
+ * the few values which depend on the port are overridden below.  This header
+ * is found before include/FreeRTOSConfig.h, see host/meson.build.
+ */
+
+/* selects the host implementations within the dis:: OSAL */
+#define DIS_OSAL_POSIX 1
+
+#include "../../include/FreeRTOSConfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void vAssertCalled(const char* pcFile, unsigned long ulLine);
+#ifdef __cplusplus
+}
+#endif
+
+/* every stack word and pointer is twice as large as on the target */
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE ((size_t)(256 * 1024))
+
+/* report the failed assertion and abort, so a sanitizer or debugger shows
+ * the stack */
+#undef configASSERT
+#define configASSERT(x)                      \
+    if ((x) == 0) {                          \
+        vAssertCalled(__FILE__, __LINE__);   \
+    }
+
+#endif /* HOST_FREERTOS_CONFIG_H */
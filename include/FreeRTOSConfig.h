@@ -67,6 +67,8 @@
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
+/* slot 0 keeps the priority of a task writing into a dis::vcom buffer */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS  1
 #define configUSE_RECURSIVE_MUTEXES              1
 #define configUSE_COUNTING_SEMAPHORES            1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
@@ -100,7 +102,7 @@ to exclude the API function. */
 
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
+#define configGENERATE_RUN_TIME_STATS           1
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    1
 
@@ -154,6 +156,11 @@ standard names. */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
 
 //#include "SEGGER_SYSVIEW_FreeRTOS.h"
+
+/* run time stats based on the DWT cycle counter, see dis/osal/stats/cpu_load.hpp
+ * and the binary flight recorder, see dis/osal/trace/recorder.hpp */
+#define DIS_TRACE_RECORDER 1
+#include "dis/osal/kernel_hooks.h"
 /* USER CODE END Defines */ 
 
 #endif /* FREERTOS_CONFIG_H */
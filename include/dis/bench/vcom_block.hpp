@@ -0,0 +1,93 @@
+#ifndef DIS_BENCH_VCOM_BLOCK_HPP
+#define DIS_BENCH_VCOM_BLOCK_HPP
+
+// NOTE: this header is shared with the host tools (tools/vcom_bench), it
+// must not depend on FreeRTOS or the HAL.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dis::bench {
+
+/**
+ * The streams of the vcom_bench firmware (src/main_vcom_bench.cpp) consist
+ * of blocks of a fixed size per run, in both directions:
+ *
+ *   magic     u32   block_magic
+ *   sequence  u32   counts the blocks of a run, starting at 0
+ *   payload         pattern(sequence, offset) up to the block size
+ *
+ * all values little endian.  The payload depends on the sequence number, so
+ * a block which got mixed up with another one does not pass the check.
+ */
+inline constexpr std::uint32_t block_magic  = 0xB10CDA7AU;
+inline constexpr std::size_t block_header   = 8;
+/// smallest block, just the header
+inline constexpr std::size_t min_block_size = block_header;
+
+/// payload byte at `offset` (from the start of the block)
+[[nodiscard]] constexpr std::byte pattern(std::uint32_t sequence,
+                                          std::size_t offset) noexcept {
+    return static_cast<std::byte>((sequence * 7U + offset) & 0xFFU);
+}
+
+namespace detail {
+
+constexpr void put_u32(std::byte* out, std::uint32_t value) noexcept {
+    for (std::size_t i = 0; i < 4; ++i) {
+        out[i] = static_cast<std::byte>((value >> (8U * i)) & 0xFFU);
+    }
+}
+
+[[nodiscard]] constexpr std::uint32_t get_u32(const std::byte* in) noexcept {
+    std::uint32_t value = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        value |= std::to_integer<std::uint32_t>(in[i]) << (8U * i);
+    }
+    return value;
+}
+
+}  // namespace detail
+
+/// writes block `sequence`, `block` has at least min_block_size bytes
+constexpr void fill_block(std::span<std::byte> block,
+                          std::uint32_t sequence) noexcept {
+    detail::put_u32(block.data(), block_magic);
+    detail::put_u32(block.data() + 4, sequence);
+    for (std::size_t offset = block_header; offset < block.size(); ++offset) {
+        block[offset] = pattern(sequence, offset);
+    }
+}
+
+enum class block_state : std::uint8_t {
+    ok,
+    /// not the start of a block, the stream lost track
+    bad_magic,
+    /// header fine, but the payload does not match the sequence number
+    corrupt,
+};
+
+struct block_check {
+    block_state state{block_state::bad_magic};
+    std::uint32_t sequence{0};
+};
+
+/// checks a received block, `block` has at least min_block_size bytes
+[[nodiscard]] constexpr block_check check_block(
+    std::span<const std::byte> block) noexcept {
+    if (detail::get_u32(block.data()) != block_magic) {
+        return {block_state::bad_magic, 0};
+    }
+    const std::uint32_t sequence = detail::get_u32(block.data() + 4);
+    for (std::size_t offset = block_header; offset < block.size(); ++offset) {
+        if (block[offset] != pattern(sequence, offset)) {
+            return {block_state::corrupt, sequence};
+        }
+    }
+    return {block_state::ok, sequence};
+}
+
+}  // namespace dis::bench
+
+#endif  // DIS_BENCH_VCOM_BLOCK_HPP
@@ -0,0 +1,157 @@
+#ifndef DIS_DSP_BIQUAD_HPP
+#define DIS_DSP_BIQUAD_HPP
+
+#include "dis/dsp/fixed.hpp"
+#include "dis/dsp/simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace dis::dsp {
+
+/**
+ * The coefficients of one second order section,
+ *
+ *   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+ *
+ * i.e. the feedback coefficients with the sign flipped (as in CMSIS-DSP),
+ * all of them scaled by 2^-post_shift so they fit the sample format.
+ */
+template <class SAMPLE_T>
+struct biquad_coefficients {
+    SAMPLE_T b0{0};
+    SAMPLE_T b1{0};
+    SAMPLE_T b2{0};
+    SAMPLE_T a1{0};
+    SAMPLE_T a2{0};
+};
+
+/**
+ * A cascade of `STAGES_V` second order sections in direct form I, each one
+ * runs over the whole block before the next one.  The q15 sections take the
+ * two past inputs and outputs as packed pairs, one SMLALD each, q31 has no
+ * SIMD multiply and uses SMLAL.  The sum of products is accumulated in 64
+ * bits (wrapping), shifted by `15 - post_shift` (`31 - post_shift`) and
+ * saturated, bit exact with ref::biquad (see reference.hpp).
+ *
+ *   static dis::dsp::biquad<dis::dsp::q15_t, 2> s_highpass{sections, 1};
+ *   s_highpass.process(block, filtered);
+ */
+template <class SAMPLE_T, std::size_t STAGES_V>
+class biquad {
+    static_assert(std::is_same_v<SAMPLE_T, q15_t> ||
+                  std::is_same_v<SAMPLE_T, q31_t>);
+    static_assert(STAGES_V > 0);
+
+public:
+    using sample_type       = SAMPLE_T;
+    using coefficients_type = std::array<biquad_coefficients<SAMPLE_T>,
+                                         STAGES_V>;
+
+    /// keeps the shifted q15 accumulator within 32 bits
+    static constexpr unsigned max_post_shift =
+        std::is_same_v<SAMPLE_T, q15_t> ? 13U : 31U;
+
+    /// `post_shift` is clamped to `max_post_shift`
+    explicit biquad(const coefficients_type& coefficients,
+                    unsigned post_shift = 0) noexcept
+        : m_coefficients(coefficients),
+          m_shift(sample_bits - std::min(post_shift, max_post_shift)) {}
+
+    /**
+     * Filters `input` into `output` of the same size, which may be the same
+     * buffer.  The filter state carries over to the next call.
+     */
+    void process(std::span<const SAMPLE_T> input,
+                 std::span<SAMPLE_T> output) noexcept {
+        const SAMPLE_T* source = input.data();
+        for (std::size_t stage = 0; stage < STAGES_V; ++stage) {
+            process_stage(m_coefficients[stage], m_state[stage], source,
+                          output.data(), input.size());
+            source = output.data();
+        }
+    }
+
+    /// forgets the past input
+    void reset() noexcept { m_state.fill({}); }
+
+private:
+    static constexpr unsigned sample_bits =
+        std::is_same_v<SAMPLE_T, q15_t> ? 15U : 31U;
+
+    struct state {
+        SAMPLE_T x1{0};
+        SAMPLE_T x2{0};
+        SAMPLE_T y1{0};
+        SAMPLE_T y2{0};
+    };
+
+    void process_stage(const biquad_coefficients<q15_t>& c,
+                       state& s,
+                       const q15_t* input,
+                       q15_t* output,
+                       std::size_t size) const noexcept {
+        const simd::q15x2_t b12 = simd::pack_q15x2(c.b1, c.b2);
+        const simd::q15x2_t a12 = simd::pack_q15x2(c.a1, c.a2);
+        simd::q15x2_t x12       = simd::pack_q15x2(s.x1, s.x2);
+        simd::q15x2_t y12       = simd::pack_q15x2(s.y1, s.y2);
+        for (std::size_t n = 0; n < size; ++n) {
+            const q15_t x0   = input[n];
+            std::int64_t acc = std::int32_t{c.b0} * x0;
+            acc              = simd::smlald(b12, x12, acc);
+            acc              = simd::smlald(a12, y12, acc);
+            const auto y0    = static_cast<q15_t>(
+                simd::ssat16(static_cast<std::int32_t>(acc >> m_shift)));
+            // the new sample moves into the low half, the oldest drops out
+            x12       = (x12 << 16U) | static_cast<std::uint16_t>(x0);
+            y12       = (y12 << 16U) | static_cast<std::uint16_t>(y0);
+            output[n] = y0;
+        }
+        s = {simd::low(x12), simd::high(x12), simd::low(y12), simd::high(y12)};
+    }
+
+    void process_stage(const biquad_coefficients<q31_t>& c,
+                       state& s,
+                       const q31_t* input,
+                       q31_t* output,
+                       std::size_t size) const noexcept {
+        q31_t x1 = s.x1;
+        q31_t x2 = s.x2;
+        q31_t y1 = s.y1;
+        q31_t y2 = s.y2;
+        for (std::size_t n = 0; n < size; ++n) {
+            const q31_t x0    = input[n];
+            std::uint64_t acc = simd::mlal(c.b0, x0, 0);
+            acc               = simd::mlal(c.b1, x1, acc);
+            acc               = simd::mlal(c.b2, x2, acc);
+            acc               = simd::mlal(c.a1, y1, acc);
+            acc               = simd::mlal(c.a2, y2, acc);
+            const q31_t y0 =
+                detail::clip32(static_cast<std::int64_t>(acc) >> m_shift);
+            x2        = x1;
+            x1        = x0;
+            y2        = y1;
+            y1        = y0;
+            output[n] = y0;
+        }
+        s = {x1, x2, y1, y2};
+    }
+
+    coefficients_type m_coefficients;
+    std::array<state, STAGES_V> m_state{};
+    unsigned m_shift;
+};
+
+template <std::size_t STAGES_V>
+using biquad_q15 = biquad<q15_t, STAGES_V>;
+
+template <std::size_t STAGES_V>
+using biquad_q31 = biquad<q31_t, STAGES_V>;
+
+}  // namespace dis::dsp
+
+#endif  // DIS_DSP_BIQUAD_HPP
@@ -0,0 +1,163 @@
+#ifndef DIS_DSP_FIR_HPP
+#define DIS_DSP_FIR_HPP
+
+#include "dis/dsp/fixed.hpp"
+#include "dis/dsp/simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dis::dsp {
+
+namespace detail {
+
+/// sum of coefficients[k] * samples[k], two products per SMLALD
+[[nodiscard]] inline std::int64_t dot(const q15_t* coefficients,
+                                      const q15_t* samples,
+                                      std::size_t size) noexcept {
+    const std::size_t quads = size & ~std::size_t{3};
+    std::int64_t acc        = 0;
+    for (std::size_t k = 0; k < quads; k += 4) {
+        acc = simd::smlald(simd::read_q15x2(coefficients + k),
+                           simd::read_q15x2(samples + k), acc);
+        acc = simd::smlald(simd::read_q15x2(coefficients + k + 2),
+                           simd::read_q15x2(samples + k + 2), acc);
+    }
+    if ((size & 2U) != 0) {
+        acc = simd::smlald(simd::read_q15x2(coefficients + quads),
+                           simd::read_q15x2(samples + quads), acc);
+    }
+    if ((size & 1U) != 0) {
+        acc += std::int32_t{coefficients[size - 1]} * samples[size - 1];
+    }
+    return acc;
+}
+
+/// sum of coefficients[k] * samples[k], wrapping like SMLAL
+[[nodiscard]] inline std::int64_t dot(const q31_t* coefficients,
+                                      const q31_t* samples,
+                                      std::size_t size) noexcept {
+    // two accumulators hide the latency of the multiply accumulate
+    const std::size_t quads = size & ~std::size_t{3};
+    std::uint64_t even      = 0;
+    std::uint64_t odd       = 0;
+    for (std::size_t k = 0; k < quads; k += 4) {
+        even = simd::mlal(coefficients[k], samples[k], even);
+        odd  = simd::mlal(coefficients[k + 1], samples[k + 1], odd);
+        even = simd::mlal(coefficients[k + 2], samples[k + 2], even);
+        odd  = simd::mlal(coefficients[k + 3], samples[k + 3], odd);
+    }
+    for (std::size_t k = quads; k < size; ++k) {
+        even = simd::mlal(coefficients[k], samples[k], even);
+    }
+    return static_cast<std::int64_t>(even + odd);
+}
+
+/// the sum of products back to the sample format, truncated and saturated
+[[nodiscard]] inline q15_t narrow(std::int64_t acc, q15_t) noexcept {
+    return static_cast<q15_t>(
+        simd::ssat16(static_cast<std::int32_t>(acc >> 15)));
+}
+
+[[nodiscard]] inline q31_t narrow(std::int64_t acc, q31_t) noexcept {
+    return clip32(acc >> 31);
+}
+
+}  // namespace detail
+
+/**
+ * A FIR filter of `TAPS_V` coefficients which keeps every `DECIMATION_V`th
+ * output.  The input is processed in blocks of up to `BLOCK_V` samples,
+ * which are copied behind the last `TAPS_V - 1` samples of the previous
+ * block, so every output is one dot product over a contiguous window
+ * without any wrap around.  The dot product takes two taps per SMLALD for
+ * q15, for q31 there is no SIMD multiply and it is a plain unrolled SMLAL
+ * loop.  Products are accumulated in 64 bits, the output is truncated and
+ * saturated, bit exact with ref::fir (see reference.hpp).
+ *
+ *   static dis::dsp::fir_decimator_q15<32, 4, 256> s_lowpass{coefficients};
+ *   const std::size_t n = s_lowpass.process(block, decimated);
+ */
+template <class SAMPLE_T,
+          std::size_t TAPS_V,
+          std::size_t BLOCK_V,
+          std::size_t DECIMATION_V = 1>
+class fir {
+    static_assert(TAPS_V > 0 && BLOCK_V > 0 && DECIMATION_V > 0);
+    static_assert(TAPS_V < 0x10000U,
+                  "the shifted q15 accumulator has to fit in 32 bits");
+
+public:
+    using sample_type       = SAMPLE_T;
+    using coefficients_type = std::array<SAMPLE_T, TAPS_V>;
+
+    static constexpr std::size_t taps       = TAPS_V;
+    static constexpr std::size_t decimation = DECIMATION_V;
+
+    /// `coefficients[k]` weighs the input `k` samples back
+    explicit fir(const coefficients_type& coefficients) noexcept {
+        std::reverse_copy(coefficients.begin(), coefficients.end(),
+                          m_reversed.begin());
+    }
+
+    /**
+     * Filters `input` into `output`, which needs room for
+     * `(input.size() + decimation - 1) / decimation` samples.  Returns the
+     * number of samples written, the filter state carries over to the next
+     * call.
+     */
+    std::size_t process(std::span<const SAMPLE_T> input,
+                        std::span<SAMPLE_T> output) noexcept {
+        std::size_t written = 0;
+        while (!input.empty()) {
+            const std::size_t chunk = std::min(input.size(), BLOCK_V);
+            std::copy_n(input.begin(), chunk, m_window.begin() + history);
+
+            // the window of output `i` ends with input `i`
+            for (std::size_t i = DECIMATION_V - 1 - m_phase; i < chunk;
+                 i += DECIMATION_V) {
+                const std::int64_t acc =
+                    detail::dot(m_reversed.data(), m_window.data() + i, TAPS_V);
+                output[written++] = detail::narrow(acc, SAMPLE_T{});
+            }
+            m_phase = (m_phase + chunk) % DECIMATION_V;
+
+            std::copy_n(m_window.begin() + chunk, history, m_window.begin());
+            input = input.subspan(chunk);
+        }
+        return written;
+    }
+
+    /// forgets the past input
+    void reset() noexcept {
+        m_window.fill(SAMPLE_T{});
+        m_phase = 0;
+    }
+
+private:
+    static constexpr std::size_t history = TAPS_V - 1;
+
+    coefficients_type m_reversed{};
+    std::array<SAMPLE_T, history + BLOCK_V> m_window{};
+    /// inputs since the last output
+    std::size_t m_phase{0};
+};
+
+template <std::size_t TAPS_V, std::size_t BLOCK_V>
+using fir_q15 = fir<q15_t, TAPS_V, BLOCK_V>;
+
+template <std::size_t TAPS_V, std::size_t BLOCK_V>
+using fir_q31 = fir<q31_t, TAPS_V, BLOCK_V>;
+
+template <std::size_t TAPS_V, std::size_t FACTOR_V, std::size_t BLOCK_V>
+using fir_decimator_q15 = fir<q15_t, TAPS_V, BLOCK_V, FACTOR_V>;
+
+template <std::size_t TAPS_V, std::size_t FACTOR_V, std::size_t BLOCK_V>
+using fir_decimator_q31 = fir<q31_t, TAPS_V, BLOCK_V, FACTOR_V>;
+
+}  // namespace dis::dsp
+
+#endif  // DIS_DSP_FIR_HPP
@@ -0,0 +1,69 @@
+#ifndef DIS_DSP_FIXED_HPP
+#define DIS_DSP_FIXED_HPP
+
+// NOTE: dis::dsp is free of FreeRTOS and the HAL, it builds for the target
+// and the host alike.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace dis::dsp {
+
+/// 1.15 fixed point, [-1, 1)
+using q15_t = std::int16_t;
+/// 1.31 fixed point, [-1, 1)
+using q31_t = std::int32_t;
+
+template <class SAMPLE_T>
+struct min_max {
+    SAMPLE_T min{0};
+    SAMPLE_T max{0};
+};
+
+/// `value` in [-1, 1), rounded and saturated
+[[nodiscard]] constexpr q15_t to_q15(double value) noexcept {
+    const double scaled  = value * 32768.0;
+    const double rounded = scaled < 0 ? scaled - 0.5 : scaled + 0.5;
+    return static_cast<q15_t>(std::clamp(rounded, -32768.0, 32767.0));
+}
+
+/// `value` in [-1, 1), rounded and saturated
+[[nodiscard]] constexpr q31_t to_q31(double value) noexcept {
+    const double scaled  = value * 2147483648.0;
+    const double rounded = scaled < 0 ? scaled - 0.5 : scaled + 0.5;
+    return static_cast<q31_t>(
+        std::clamp(rounded, -2147483648.0, 2147483647.0));
+}
+
+namespace detail {
+
+[[nodiscard]] constexpr q31_t clip32(std::int64_t value) noexcept {
+    return static_cast<q31_t>(
+        std::clamp<std::int64_t>(value, INT32_MIN, INT32_MAX));
+}
+
+/// floor(sqrt(value)), bit by bit, so it is exact over the whole range
+[[nodiscard]] constexpr std::uint32_t isqrt(std::uint64_t value) noexcept {
+    std::uint64_t root = 0;
+    std::uint64_t bit  = std::uint64_t{1} << 62U;
+    while (bit > value) {
+        bit >>= 2U;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1U) + bit;
+        } else {
+            root >>= 1U;
+        }
+        bit >>= 2U;
+    }
+    return static_cast<std::uint32_t>(root);
+}
+
+}  // namespace detail
+
+}  // namespace dis::dsp
+
+#endif  // DIS_DSP_FIXED_HPP
@@ -0,0 +1,181 @@
+#ifndef DIS_DSP_REFERENCE_HPP
+#define DIS_DSP_REFERENCE_HPP
+
+#include "dis/dsp/biquad.hpp"
+#include "dis/dsp/fixed.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+// The kernels of dis::dsp written down the obvious way, one sample at a
+// time, in plain C++ without intrinsics.  They define the results the
+// optimized kernels have to reproduce bit by bit, and serve as the baseline
+// of the benchmark (see src/main_dsp_bench.cpp).
+
+namespace dis::dsp::ref {
+
+namespace detail {
+
+/// sum of products of up to 2^32 q15 pairs or wrapping sum of q31 pairs
+[[nodiscard]] constexpr std::int64_t product(std::int64_t acc,
+                                             std::int32_t x,
+                                             std::int32_t y) noexcept {
+    return static_cast<std::int64_t>(
+        static_cast<std::uint64_t>(acc) +
+        static_cast<std::uint64_t>(std::int64_t{x} * y));
+}
+
+/// truncated and saturated
+template <class SAMPLE_T>
+[[nodiscard]] constexpr SAMPLE_T narrow(std::int64_t acc,
+                                        unsigned shift) noexcept {
+    return static_cast<SAMPLE_T>(
+        std::clamp<std::int64_t>(acc >> shift,
+                                 std::numeric_limits<SAMPLE_T>::min(),
+                                 std::numeric_limits<SAMPLE_T>::max()));
+}
+
+template <class SAMPLE_T>
+inline constexpr unsigned sample_bits = std::is_same_v<SAMPLE_T, q15_t> ? 15U
+                                                                        : 31U;
+
+}  // namespace detail
+
+/// y[n] = sum of h[k] x[n-k], every `DECIMATION_V`th one
+template <class SAMPLE_T, std::size_t TAPS_V, std::size_t DECIMATION_V = 1>
+class fir {
+public:
+    using coefficients_type = std::array<SAMPLE_T, TAPS_V>;
+
+    explicit fir(const coefficients_type& coefficients) noexcept
+        : m_coefficients(coefficients) {}
+
+    std::size_t process(std::span<const SAMPLE_T> input,
+                        std::span<SAMPLE_T> output) noexcept {
+        std::size_t written = 0;
+        for (const SAMPLE_T x : input) {
+            m_head          = (m_head + TAPS_V - 1) % TAPS_V;
+            m_delay[m_head] = x;
+            if (++m_phase < DECIMATION_V) {
+                continue;
+            }
+            m_phase          = 0;
+            std::int64_t acc = 0;
+            for (std::size_t k = 0; k < TAPS_V; ++k) {
+                acc = detail::product(acc, m_coefficients[k],
+                                      m_delay[(m_head + k) % TAPS_V]);
+            }
+            output[written++] =
+                detail::narrow<SAMPLE_T>(acc, detail::sample_bits<SAMPLE_T>);
+        }
+        return written;
+    }
+
+private:
+    coefficients_type m_coefficients;
+    /// x[n-k] at `(m_head + k) % TAPS_V`
+    std::array<SAMPLE_T, TAPS_V> m_delay{};
+    std::size_t m_head{0};
+    std::size_t m_phase{0};
+};
+
+/// the sections one after another for every sample
+template <class SAMPLE_T, std::size_t STAGES_V>
+class biquad {
+public:
+    using coefficients_type = std::array<biquad_coefficients<SAMPLE_T>,
+                                         STAGES_V>;
+
+    explicit biquad(const coefficients_type& coefficients,
+                    unsigned post_shift = 0) noexcept
+        : m_coefficients(coefficients),
+          m_shift(detail::sample_bits<SAMPLE_T> -
+                  std::min(post_shift,
+                           dsp::biquad<SAMPLE_T, STAGES_V>::max_post_shift)) {}
+
+    void process(std::span<const SAMPLE_T> input,
+                 std::span<SAMPLE_T> output) noexcept {
+        for (std::size_t n = 0; n < input.size(); ++n) {
+            SAMPLE_T x = input[n];
+            for (std::size_t stage = 0; stage < STAGES_V; ++stage) {
+                const auto& c    = m_coefficients[stage];
+                auto& s          = m_state[stage];
+                std::int64_t acc = 0;
+                acc              = detail::product(acc, c.b0, x);
+                acc              = detail::product(acc, c.b1, s.x1);
+                acc              = detail::product(acc, c.b2, s.x2);
+                acc              = detail::product(acc, c.a1, s.y1);
+                acc              = detail::product(acc, c.a2, s.y2);
+                const auto y     = detail::narrow<SAMPLE_T>(acc, m_shift);
+                s                = {x, s.x1, y, s.y1};
+                x                = y;
+            }
+            output[n] = x;
+        }
+    }
+
+private:
+    struct state {
+        SAMPLE_T x1{0};
+        SAMPLE_T x2{0};
+        SAMPLE_T y1{0};
+        SAMPLE_T y2{0};
+    };
+
+    coefficients_type m_coefficients;
+    std::array<state, STAGES_V> m_state{};
+    unsigned m_shift;
+};
+
+template <class SAMPLE_T>
+[[nodiscard]] SAMPLE_T mean(std::span<const SAMPLE_T> samples) noexcept {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::int64_t sum = 0;
+    for (const SAMPLE_T x : samples) {
+        sum += x;
+    }
+    return static_cast<SAMPLE_T>(sum /
+                                 static_cast<std::int64_t>(samples.size()));
+}
+
+template <class SAMPLE_T>
+[[nodiscard]] SAMPLE_T rms(std::span<const SAMPLE_T> samples) noexcept {
+    if (samples.empty()) {
+        return 0;
+    }
+    // q30 squares as they are, q62 ones in q48
+    constexpr unsigned drop = std::is_same_v<SAMPLE_T, q15_t> ? 0U : 14U;
+    std::uint64_t sum       = 0;
+    for (const SAMPLE_T x : samples) {
+        sum += static_cast<std::uint64_t>(std::int64_t{x} * x) >> drop;
+    }
+    const std::uint64_t root = dsp::detail::isqrt(sum / samples.size())
+                               << (drop / 2);
+    return static_cast<SAMPLE_T>(std::min<std::uint64_t>(
+        root, std::numeric_limits<SAMPLE_T>::max()));
+}
+
+template <class SAMPLE_T>
+[[nodiscard]] min_max<SAMPLE_T> extremes(
+    std::span<const SAMPLE_T> samples) noexcept {
+    if (samples.empty()) {
+        return {};
+    }
+    min_max<SAMPLE_T> result{samples[0], samples[0]};
+    for (const SAMPLE_T x : samples) {
+        result.min = std::min(result.min, x);
+        result.max = std::max(result.max, x);
+    }
+    return result;
+}
+
+}  // namespace dis::dsp::ref
+
+#endif  // DIS_DSP_REFERENCE_HPP
@@ -0,0 +1,123 @@
+#ifndef DIS_DSP_SIMD_HPP
+#define DIS_DSP_SIMD_HPP
+
+#include "dis/dsp/fixed.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+// The DSP extension of the Cortex-M7 (SMLAD, SMLALD, SSAT, SSUB16/SEL, ...)
+// through the CMSIS intrinsics.  Elsewhere, e.g. on the host, the same
+// operations are emulated bit by bit, so the kernels give identical results
+// on both.
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define DIS_DSP_SIMD 1
+#include <cmsis_compiler.h>
+#else
+#define DIS_DSP_SIMD 0
+#endif
+
+namespace dis::dsp::simd {
+
+/// two q15 in one word, the one at the lower address in the low half
+using q15x2_t = std::uint32_t;
+
+[[nodiscard]] inline q15x2_t read_q15x2(const q15_t* samples) noexcept {
+    // compiles to a single (unaligned) load
+    q15x2_t pair = 0;
+    std::memcpy(&pair, samples, sizeof(pair));
+    return pair;
+}
+
+[[nodiscard]] constexpr q15x2_t pack_q15x2(q15_t low, q15_t high) noexcept {
+    return static_cast<std::uint16_t>(low) |
+           (static_cast<q15x2_t>(static_cast<std::uint16_t>(high)) << 16U);
+}
+
+[[nodiscard]] constexpr q15_t low(q15x2_t pair) noexcept {
+    return static_cast<q15_t>(pair & 0xFFFFU);
+}
+
+[[nodiscard]] constexpr q15_t high(q15x2_t pair) noexcept {
+    return static_cast<q15_t>(pair >> 16U);
+}
+
+#if DIS_DSP_SIMD
+
+/// saturates to the q15 range (SSAT)
+[[nodiscard]] inline std::int32_t ssat16(std::int32_t value) noexcept {
+    return __SSAT(value, 16);
+}
+
+/// acc + low * low + high * high (SMLAD)
+[[nodiscard]] inline std::int32_t smlad(q15x2_t x,
+                                        q15x2_t y,
+                                        std::int32_t acc) noexcept {
+    return static_cast<std::int32_t>(
+        __SMLAD(x, y, static_cast<std::uint32_t>(acc)));
+}
+
+/// acc + low * low + high * high, 64 bit accumulator (SMLALD)
+[[nodiscard]] inline std::int64_t smlald(q15x2_t x,
+                                         q15x2_t y,
+                                         std::int64_t acc) noexcept {
+    return static_cast<std::int64_t>(
+        __SMLALD(x, y, static_cast<std::uint64_t>(acc)));
+}
+
+/// halfword wise maximum (SSUB16 sets the GE flags SEL picks with)
+[[nodiscard]] inline q15x2_t max16x2(q15x2_t x, q15x2_t y) noexcept {
+    (void)__SSUB16(x, y);
+    return __SEL(x, y);
+}
+
+/// halfword wise minimum
+[[nodiscard]] inline q15x2_t min16x2(q15x2_t x, q15x2_t y) noexcept {
+    (void)__SSUB16(x, y);
+    return __SEL(y, x);
+}
+
+#else
+
+[[nodiscard]] constexpr std::int32_t ssat16(std::int32_t value) noexcept {
+    return std::clamp<std::int32_t>(value, INT16_MIN, INT16_MAX);
+}
+
+[[nodiscard]] constexpr std::int32_t smlad(q15x2_t x,
+                                           q15x2_t y,
+                                           std::int32_t acc) noexcept {
+    // wraps like the instruction, two products of -32768 already overflow
+    // an int
+    const std::uint32_t sum = static_cast<std::uint32_t>(low(x) * low(y)) +
+                              static_cast<std::uint32_t>(high(x) * high(y));
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(acc) + sum);
+}
+
+[[nodiscard]] constexpr std::int64_t smlald(q15x2_t x,
+                                            q15x2_t y,
+                                            std::int64_t acc) noexcept {
+    const std::int64_t sum = std::int64_t{low(x) * low(y)} + high(x) * high(y);
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(acc) +
+                                     static_cast<std::uint64_t>(sum));
+}
+
+[[nodiscard]] constexpr q15x2_t max16x2(q15x2_t x, q15x2_t y) noexcept {
+    return pack_q15x2(std::max(low(x), low(y)), std::max(high(x), high(y)));
+}
+
+[[nodiscard]] constexpr q15x2_t min16x2(q15x2_t x, q15x2_t y) noexcept {
+    return pack_q15x2(std::min(low(x), low(y)), std::min(high(x), high(y)));
+}
+
+#endif  // DIS_DSP_SIMD
+
+/// 64 bit multiply accumulate which wraps (SMLAL, the compiler emits it)
+[[nodiscard]] constexpr std::uint64_t mlal(q31_t x,
+                                           q31_t y,
+                                           std::uint64_t acc) noexcept {
+    return acc + static_cast<std::uint64_t>(std::int64_t{x} * y);
+}
+
+}  // namespace dis::dsp::simd
+
+#endif  // DIS_DSP_SIMD_HPP
@@ -0,0 +1,163 @@
+#ifndef DIS_DSP_STATISTICS_HPP
+#define DIS_DSP_STATISTICS_HPP
+
+#include "dis/dsp/fixed.hpp"
+#include "dis/dsp/simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Block statistics, bit exact with their ref:: counterparts (see
+// reference.hpp).  The mean is truncated towards zero, the rms is the
+// floor of the square root of the truncated mean square.  An empty block
+// gives 0.
+
+namespace dis::dsp {
+
+/// two samples per SMLAD against (1, 1)
+[[nodiscard]] inline q15_t mean_q15(std::span<const q15_t> samples) noexcept {
+    if (samples.empty()) {
+        return 0;
+    }
+    constexpr simd::q15x2_t ones = 0x00010001U;
+    // the sum of 2^15 samples fits the 32 bit accumulator with room to spare
+    constexpr std::size_t chunk_size = 0x8000U;
+
+    std::int64_t sum = 0;
+    const q15_t* p   = samples.data();
+    std::size_t left = samples.size();
+    while (left >= 2) {
+        const std::size_t chunk = std::min(left, chunk_size) & ~std::size_t{1};
+        std::int32_t acc        = 0;
+        for (std::size_t k = 0; k < chunk; k += 2) {
+            acc = simd::smlad(simd::read_q15x2(p + k), ones, acc);
+        }
+        sum += acc;
+        p += chunk;
+        left -= chunk;
+    }
+    if (left != 0) {
+        sum += *p;
+    }
+    return static_cast<q15_t>(sum / static_cast<std::int64_t>(samples.size()));
+}
+
+/// the squares of two samples per SMLALD
+[[nodiscard]] inline q15_t rms_q15(std::span<const q15_t> samples) noexcept {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::int64_t acc       = 0;
+    const std::size_t size = samples.size();
+    std::size_t k          = 0;
+    for (; k + 4 <= size; k += 4) {
+        const simd::q15x2_t first  = simd::read_q15x2(samples.data() + k);
+        const simd::q15x2_t second = simd::read_q15x2(samples.data() + k + 2);
+        acc = simd::smlald(first, first, acc);
+        acc = simd::smlald(second, second, acc);
+    }
+    for (; k < size; ++k) {
+        acc += std::int32_t{samples[k]} * samples[k];
+    }
+    // the mean square is in q30, its root in q15
+    const auto root = detail::isqrt(static_cast<std::uint64_t>(acc) / size);
+    return static_cast<q15_t>(std::min<std::uint32_t>(root, INT16_MAX));
+}
+
+/// two lanes of SSUB16 + SEL for the minimum and the maximum each
+[[nodiscard]] inline min_max<q15_t> min_max_q15(
+    std::span<const q15_t> samples) noexcept {
+    const std::size_t size = samples.size();
+    if (size < 2) {
+        return size == 0 ? min_max<q15_t>{}
+                         : min_max<q15_t>{samples[0], samples[0]};
+    }
+    simd::q15x2_t lows  = simd::read_q15x2(samples.data());
+    simd::q15x2_t highs = lows;
+    std::size_t k       = 2;
+    for (; k + 2 <= size; k += 2) {
+        const simd::q15x2_t pair = simd::read_q15x2(samples.data() + k);
+        lows                     = simd::min16x2(lows, pair);
+        highs                    = simd::max16x2(highs, pair);
+    }
+    min_max<q15_t> result{std::min(simd::low(lows), simd::high(lows)),
+                          std::max(simd::low(highs), simd::high(highs))};
+    if (k < size) {
+        result.min = std::min(result.min, samples[k]);
+        result.max = std::max(result.max, samples[k]);
+    }
+    return result;
+}
+
+[[nodiscard]] inline q31_t mean_q31(std::span<const q31_t> samples) noexcept {
+    if (samples.empty()) {
+        return 0;
+    }
+    // 2^32 samples before the sum could overflow, more than the memory
+    std::int64_t even      = 0;
+    std::int64_t odd       = 0;
+    const std::size_t size = samples.size();
+    std::size_t k          = 0;
+    for (; k + 2 <= size; k += 2) {
+        even += samples[k];
+        odd += samples[k + 1];
+    }
+    if (k < size) {
+        even += samples[k];
+    }
+    return static_cast<q31_t>((even + odd) /
+                              static_cast<std::int64_t>(size));
+}
+
+/// the squares are accumulated in q48, as 2^16 full scale ones fit
+[[nodiscard]] inline q31_t rms_q31(std::span<const q31_t> samples) noexcept {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::uint64_t even     = 0;
+    std::uint64_t odd      = 0;
+    const std::size_t size = samples.size();
+    std::size_t k          = 0;
+    for (; k + 2 <= size; k += 2) {
+        even += static_cast<std::uint64_t>(std::int64_t{samples[k]} *
+                                           samples[k]) >> 14U;
+        odd += static_cast<std::uint64_t>(std::int64_t{samples[k + 1]} *
+                                          samples[k + 1]) >> 14U;
+    }
+    if (k < size) {
+        even += static_cast<std::uint64_t>(std::int64_t{samples[k]} *
+                                           samples[k]) >> 14U;
+    }
+    // the root of the mean square in q48 is in q24
+    const std::uint64_t root = detail::isqrt((even + odd) / size);
+    return static_cast<q31_t>(std::min<std::uint64_t>(root << 7U, INT32_MAX));
+}
+
+[[nodiscard]] inline min_max<q31_t> min_max_q31(
+    std::span<const q31_t> samples) noexcept {
+    const std::size_t size = samples.size();
+    if (size == 0) {
+        return {};
+    }
+    // two independent chains, the compiler turns them into conditional moves
+    min_max<q31_t> even{samples[0], samples[0]};
+    min_max<q31_t> odd = even;
+    std::size_t k      = 1;
+    for (; k + 2 <= size; k += 2) {
+        even.min = std::min(even.min, samples[k]);
+        even.max = std::max(even.max, samples[k]);
+        odd.min  = std::min(odd.min, samples[k + 1]);
+        odd.max  = std::max(odd.max, samples[k + 1]);
+    }
+    if (k < size) {
+        even.min = std::min(even.min, samples[k]);
+        even.max = std::max(even.max, samples[k]);
+    }
+    return {std::min(even.min, odd.min), std::max(even.max, odd.max)};
+}
+
+}  // namespace dis::dsp
+
+#endif  // DIS_DSP_STATISTICS_HPP
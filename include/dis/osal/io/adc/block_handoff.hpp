@@ -0,0 +1,103 @@
+#ifndef DIS_OSAL_IO_ADC_BLOCK_HANDOFF_HPP
+#define DIS_OSAL_IO_ADC_BLOCK_HANDOFF_HPP
+
+// NOTE: only std::atomic between the two sides, tests/block_handoff_test.cpp
+// races a consumer against a simulated double buffered DMA on the host.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace dis::adc {
+
+/// a circular DMA transfer split in halves, one block each
+inline constexpr std::size_t block_count = 2;
+
+/// a block handed to the consumer, `sequence` counts the filled blocks
+struct block_ticket {
+    std::uint32_t sequence{0};
+    std::size_t index{0};
+};
+
+struct handoff_stats {
+    /// blocks the DMA completed
+    std::uint32_t filled{0};
+    /// blocks the consumer never got, it fell behind by a whole block
+    std::uint32_t skipped{0};
+    /// blocks the DMA started to overwrite while the consumer still read them
+    std::uint32_t torn{0};
+};
+
+/**
+ * Hands the blocks of a double buffered, circular DMA transfer from the
+ * interrupt to one consumer.  Block `sequence` lives in half `sequence %
+ * block_count`, which the DMA overwrites again as soon as the next block is
+ * complete.  So the consumer has one block time to process a block; if it
+ * falls behind further it continues with the newest complete block.
+ *
+ * `filled` is called by the half and full transfer interrupts only, the
+ * other functions by the consumer only, the two sides share nothing but an
+ * atomic counter.  `release` can only tell that the next block completed
+ * in the meantime, the few samples the DMA writes before its interrupt runs
+ * go unnoticed.
+ */
+class block_handoff {
+public:
+    /// the DMA completed half `index`
+    void filled(std::size_t index) noexcept {
+        std::uint32_t filled = m_filled.load(std::memory_order_relaxed);
+        if (filled % block_count != index) {
+            // an event got lost, the halves alternate
+            ++filled;
+        }
+        m_filled.store(filled + 1, std::memory_order_release);
+    }
+
+    /// the oldest block not yet handed out, nullopt if there is none
+    [[nodiscard]] std::optional<block_ticket> acquire() noexcept {
+        const std::uint32_t filled = m_filled.load(std::memory_order_acquire);
+        if (filled == m_next) {
+            return std::nullopt;
+        }
+        if (filled - m_next > 1) {
+            // all but the newest block are being overwritten already
+            m_skipped.fetch_add(filled - 1 - m_next, std::memory_order_relaxed);
+            m_next = filled - 1;
+        }
+        const std::uint32_t sequence = m_next++;
+        return block_ticket{sequence, sequence % block_count};
+    }
+
+    /// done with the block, false if the DMA overwrote it in the meantime
+    bool release(const block_ticket& ticket) noexcept {
+        const std::uint32_t filled = m_filled.load(std::memory_order_acquire);
+        if (filled - ticket.sequence > 1) {
+            m_torn.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /// a new transfer starts at the first half, while no interrupt runs
+    void reset() noexcept {
+        m_filled.store(0, std::memory_order_relaxed);
+        m_next = 0;
+    }
+
+    [[nodiscard]] handoff_stats stats() const noexcept {
+        return {m_filled.load(std::memory_order_relaxed),
+                m_skipped.load(std::memory_order_relaxed),
+                m_torn.load(std::memory_order_relaxed)};
+    }
+
+private:
+    std::atomic<std::uint32_t> m_filled{0};
+    std::uint32_t m_next{0};
+    std::atomic<std::uint32_t> m_skipped{0};
+    std::atomic<std::uint32_t> m_torn{0};
+};
+
+}  // namespace dis::adc
+
+#endif  // DIS_OSAL_IO_ADC_BLOCK_HANDOFF_HPP
@@ -0,0 +1,277 @@
+#ifndef DIS_OSAL_IO_ADC_SCANNER_HPP
+#define DIS_OSAL_IO_ADC_SCANNER_HPP
+
+#include "dis/osal/io/adc/block_handoff.hpp"
+
+#include <FreeRTOS.h>
+#include <stm32f7xx_hal.h>
+#include <task.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#ifndef DIS_ADC_IRQ_PRIORITY
+// the block interrupt notifies the consumer with the FromISR API
+#define DIS_ADC_IRQ_PRIORITY 6
+#endif
+
+namespace dis::adc {
+
+struct channel_config {
+    /// ADC_CHANNEL_x, the pin has to be in analog mode
+    std::uint32_t channel{0};
+    /// ADC_SAMPLETIME_x, a conversion takes the sample time + 12 cycles
+    std::uint32_t sample_time{ADC_SAMPLETIME_3CYCLES};
+};
+
+/// a block of samples, `SCANS_V` scans of all channels in a row
+template <std::size_t CHANNELS_V, std::size_t SCANS_V>
+struct block_view {
+    std::span<const std::uint16_t, CHANNELS_V * SCANS_V> samples;
+    block_ticket ticket{};
+
+    [[nodiscard]] std::uint16_t sample(std::size_t scan,
+                                       std::size_t channel) const noexcept {
+        return samples[scan * CHANNELS_V + channel];
+    }
+};
+
+/**
+ * Samples `CHANNELS_V` channels of ADC1 in scan mode, one scan per update
+ * of TIM6, with DMA2 stream 0 writing a double buffer of blocks of
+ * `SCANS_V` scans.  The half and full transfer interrupts hand every block
+ * to the consumer task with one notification, the CPU has no work per
+ * sample.  With the ADC clock at PCLK2/4 (27MHz) and the shortest sample
+ * time, a scan of `n` channels takes `n * 15` ADC cycles, i.e. one channel
+ * can be sampled at up to 1.8MHz.  The internal channels (VREFINT, the
+ * temperature sensor, VBAT) need a sample time of 10us at least.
+ *
+ *   static dis::adc::scanner<2, 256> s_adc{{{
+ *       {ADC_CHANNEL_3, ADC_SAMPLETIME_15CYCLES},
+ *       {ADC_CHANNEL_10, ADC_SAMPLETIME_15CYCLES},
+ *   }}};
+ *   void DMA2_Stream0_IRQHandler() {
+ *       DIS_ISR_ENTER();
+ *       s_adc.dma_irq_from_isr();
+ *       DIS_ISR_EXIT();
+ *   }
+ *
+ *   // in the consumer task
+ *   s_adc.start(200000, xTaskGetCurrentTaskHandle());
+ *   for (;;) {
+ *       if (const auto block = s_adc.next(portMAX_DELAY)) {
+ *           process(*block);
+ *           s_adc.release(*block);
+ *       }
+ *   }
+ *
+ * A block stays untouched for one block time after `next` returned it, see
+ * block_handoff.hpp.  The scanner owns ADC1 and TIM6 and must live as long
+ * as the sampling, i.e. forever.
+ */
+template <std::size_t CHANNELS_V, std::size_t SCANS_V>
+class scanner {
+    static_assert(CHANNELS_V > 0 && CHANNELS_V <= 16,
+                  "the regular sequence holds up to 16 conversions");
+    static_assert(SCANS_V > 0);
+    static_assert(block_count * CHANNELS_V * SCANS_V <= UINT16_MAX,
+                  "a DMA transfer is limited to 65535 items");
+
+public:
+    using config_type = std::array<channel_config, CHANNELS_V>;
+    using block_type  = block_view<CHANNELS_V, SCANS_V>;
+
+    static constexpr std::size_t block_samples = CHANNELS_V * SCANS_V;
+
+    explicit scanner(const config_type& channels) noexcept
+        : m_channels(channels) {}
+
+    scanner(const scanner&)            = delete;
+    scanner& operator=(const scanner&) = delete;
+
+    /**
+     * Starts sampling at `rate` scans per second, every block notifies
+     * `consumer`.  Returns false if the HAL refused the configuration or the
+     * rate is out of the range of TIM6.
+     */
+    bool start(std::uint32_t rate, TaskHandle_t consumer) noexcept {
+        m_consumer = consumer;
+        m_handoff.reset();
+        return init_adc() && init_dma() && init_timer(rate) && run();
+    }
+
+    void stop() noexcept {
+        (void)HAL_TIM_Base_Stop(&m_timer);
+        (void)HAL_ADC_Stop(&m_adc);
+        CLEAR_BIT(m_adc.Instance->CR2, ADC_CR2_DMA);
+        (void)HAL_DMA_Abort(&m_dma);
+    }
+
+    /**
+     * Waits for the next block, up to `timeout` for each notification.  Only
+     * the consumer task passed to `start` may call it.
+     */
+    [[nodiscard]] std::optional<block_type> next(TickType_t timeout) noexcept {
+        for (;;) {
+            if (const auto ticket = m_handoff.acquire()) {
+                return block_type{
+                    std::span<const std::uint16_t, block_samples>{
+                        m_buffer.data() + ticket->index * block_samples,
+                        block_samples},
+                    *ticket};
+            }
+            if (ulTaskNotifyTake(pdTRUE, timeout) == 0) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    /// done with the block, false if it got overwritten in the meantime
+    bool release(const block_type& block) noexcept {
+        return m_handoff.release(block.ticket);
+    }
+
+    [[nodiscard]] handoff_stats stats() const noexcept {
+        return m_handoff.stats();
+    }
+
+    /// the DMA did not keep up with the ADC, which stopped sampling
+    [[nodiscard]] bool overrun() const noexcept {
+        return (m_adc.Instance->SR & ADC_SR_OVR) != 0U;
+    }
+
+    /// in the interrupt of DMA2 stream 0
+    void dma_irq_from_isr() noexcept { HAL_DMA_IRQHandler(&m_dma); }
+
+private:
+    bool init_adc() noexcept {
+        __HAL_RCC_ADC1_CLK_ENABLE();
+
+        m_adc.Instance                   = ADC1;
+        m_adc.Init.ClockPrescaler        = ADC_CLOCK_SYNC_PCLK_DIV4;
+        m_adc.Init.Resolution            = ADC_RESOLUTION_12B;
+        m_adc.Init.ScanConvMode          = ENABLE;
+        m_adc.Init.ContinuousConvMode    = DISABLE;
+        m_adc.Init.DiscontinuousConvMode = DISABLE;
+        m_adc.Init.ExternalTrigConvEdge  = ADC_EXTERNALTRIGCONVEDGE_RISING;
+        m_adc.Init.ExternalTrigConv      = ADC_EXTERNALTRIGCONV_T6_TRGO;
+        m_adc.Init.DataAlign             = ADC_DATAALIGN_RIGHT;
+        m_adc.Init.NbrOfConversion       = CHANNELS_V;
+        m_adc.Init.DMAContinuousRequests = ENABLE;
+        m_adc.Init.EOCSelection          = ADC_EOC_SEQ_CONV;
+        if (HAL_ADC_Init(&m_adc) != HAL_OK) {
+            return false;
+        }
+
+        for (std::size_t rank = 0; rank < CHANNELS_V; ++rank) {
+            ADC_ChannelConfTypeDef config{};
+            config.Channel      = m_channels[rank].channel;
+            config.Rank         = static_cast<std::uint32_t>(rank + 1);
+            config.SamplingTime = m_channels[rank].sample_time;
+            if (HAL_ADC_ConfigChannel(&m_adc, &config) != HAL_OK) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool init_dma() noexcept {
+        __HAL_RCC_DMA2_CLK_ENABLE();
+
+        m_dma.Instance                 = DMA2_Stream0;
+        m_dma.Init.Channel             = DMA_CHANNEL_0;
+        m_dma.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+        m_dma.Init.PeriphInc           = DMA_PINC_DISABLE;
+        m_dma.Init.MemInc              = DMA_MINC_ENABLE;
+        m_dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+        m_dma.Init.MemDataAlignment    = DMA_MDATAALIGN_HALFWORD;
+        m_dma.Init.Mode                = DMA_CIRCULAR;
+        m_dma.Init.Priority            = DMA_PRIORITY_HIGH;
+        m_dma.Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+        if (HAL_DMA_Init(&m_dma) != HAL_OK) {
+            return false;
+        }
+        // driven directly instead of HAL_ADC_Start_DMA(), its parent is us
+        m_dma.Parent               = this;
+        m_dma.XferHalfCpltCallback = &half_filled;
+        m_dma.XferCpltCallback     = &full_filled;
+
+        HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, DIS_ADC_IRQ_PRIORITY, 0);
+        HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+        return true;
+    }
+
+    bool init_timer(std::uint32_t rate) noexcept {
+        __HAL_RCC_TIM6_CLK_ENABLE();
+
+        // the timers of APB1 run at twice PCLK1 unless it is undivided
+        std::uint32_t clock = HAL_RCC_GetPCLK1Freq();
+        if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_HCLK_DIV1) {
+            clock *= 2;
+        }
+        if (rate == 0 || rate > clock / 2) {
+            return false;
+        }
+        const std::uint32_t ticks     = clock / rate;
+        const std::uint32_t prescaler = (ticks - 1) / 0x10000U;
+
+        m_timer.Instance               = TIM6;
+        m_timer.Init.Prescaler         = prescaler;
+        m_timer.Init.CounterMode       = TIM_COUNTERMODE_UP;
+        m_timer.Init.Period            = ticks / (prescaler + 1) - 1;
+        m_timer.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+        if (HAL_TIM_Base_Init(&m_timer) != HAL_OK) {
+            return false;
+        }
+
+        TIM_MasterConfigTypeDef master{};
+        master.MasterOutputTrigger = TIM_TRGO_UPDATE;
+        master.MasterSlaveMode     = TIM_MASTERSLAVEMODE_DISABLE;
+        return HAL_TIMEx_MasterConfigSynchronization(&m_timer, &master) ==
+               HAL_OK;
+    }
+
+    bool run() noexcept {
+        if (HAL_DMA_Start_IT(&m_dma,
+                             reinterpret_cast<std::uint32_t>(&ADC1->DR),
+                             reinterpret_cast<std::uint32_t>(m_buffer.data()),
+                             m_buffer.size()) != HAL_OK) {
+            return false;
+        }
+        SET_BIT(m_adc.Instance->CR2, ADC_CR2_DMA);
+        return HAL_ADC_Start(&m_adc) == HAL_OK &&
+               HAL_TIM_Base_Start(&m_timer) == HAL_OK;
+    }
+
+    void filled_from_isr(std::size_t index) noexcept {
+        m_handoff.filled(index);
+        if (m_consumer != nullptr) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(m_consumer, &woken);
+            portYIELD_FROM_ISR(woken);
+        }
+    }
+
+    static void half_filled(DMA_HandleTypeDef* dma) {
+        static_cast<scanner*>(dma->Parent)->filled_from_isr(0);
+    }
+
+    static void full_filled(DMA_HandleTypeDef* dma) {
+        static_cast<scanner*>(dma->Parent)->filled_from_isr(1);
+    }
+
+    std::array<std::uint16_t, block_count * block_samples> m_buffer{};
+    config_type m_channels;
+    block_handoff m_handoff{};
+    TaskHandle_t m_consumer{nullptr};
+    ADC_HandleTypeDef m_adc{};
+    DMA_HandleTypeDef m_dma{};
+    TIM_HandleTypeDef m_timer{};
+};
+
+}  // namespace dis::adc
+
+#endif  // DIS_OSAL_IO_ADC_SCANNER_HPP
@@ -0,0 +1,110 @@
+#ifndef DIS_OSAL_IO_MUX_FORMAT_HPP
+#define DIS_OSAL_IO_MUX_FORMAT_HPP
+
+// NOTE: this header is shared with the host tools (tools/vcom_demux), it
+// must not depend on FreeRTOS or the HAL.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dis::io::mux {
+
+/**
+ * Every frame of a logical channel goes over the link as
+ *
+ *   sync      u8    frame_sync
+ *   channel   u8
+ *   size      u16   payload bytes
+ *   sequence  u16   per channel, counts the frames on the link
+ *   check     u16   CRC-16/CCITT-FALSE over the first 6 header bytes and
+ *                   the payload
+ *   payload
+ *
+ * all values little endian.  A receiver which lost track (or starts in the
+ * middle of a frame) searches for the next sync byte which is followed by a
+ * header with a matching check.
+ */
+inline constexpr std::uint8_t frame_sync       = 0xA5;
+inline constexpr std::size_t header_size       = 8;
+inline constexpr std::size_t max_channels      = 256;
+inline constexpr std::size_t max_frame_payload = 0xFFFF;
+
+struct header {
+    std::uint8_t channel{0};
+    std::uint16_t size{0};
+    std::uint16_t sequence{0};
+};
+
+namespace detail {
+
+constexpr std::array<std::uint16_t, 256> make_crc_table() noexcept {
+    std::array<std::uint16_t, 256> table{};
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        auto crc = static_cast<std::uint16_t>(i << 8U);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = static_cast<std::uint16_t>(
+                (crc & 0x8000U) ? (crc << 1U) ^ 0x1021U : crc << 1U);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+inline constexpr std::array<std::uint16_t, 256> crc_table = make_crc_table();
+
+}  // namespace detail
+
+inline constexpr std::uint16_t crc_init = 0xFFFF;
+
+[[nodiscard]] constexpr std::uint16_t crc16(
+    std::span<const std::byte> data,
+    std::uint16_t crc = crc_init) noexcept {
+    for (const std::byte value : data) {
+        const auto index = static_cast<std::uint8_t>(
+            (crc >> 8U) ^ std::to_integer<unsigned>(value));
+        crc = static_cast<std::uint16_t>((crc << 8U) ^
+                                         detail::crc_table[index]);
+    }
+    return crc;
+}
+
+/// writes the header without the check into out[0, 6)
+constexpr void encode(const header& head, std::byte* out) noexcept {
+    out[0] = std::byte{frame_sync};
+    out[1] = std::byte{head.channel};
+    out[2] = static_cast<std::byte>(head.size & 0xFFU);
+    out[3] = static_cast<std::byte>(head.size >> 8U);
+    out[4] = static_cast<std::byte>(head.sequence & 0xFFU);
+    out[5] = static_cast<std::byte>(head.sequence >> 8U);
+}
+
+/// completes a frame encoded at `frame`, its payload has to be in place
+constexpr void seal(std::byte* frame, std::size_t payload_size) noexcept {
+    std::uint16_t crc = crc16({frame, 6});
+    crc               = crc16({frame + header_size, payload_size}, crc);
+    frame[6]          = static_cast<std::byte>(crc & 0xFFU);
+    frame[7]          = static_cast<std::byte>(crc >> 8U);
+}
+
+/// header fields of `data` (at least header_size bytes), no checks
+[[nodiscard]] constexpr header decode(const std::byte* data) noexcept {
+    const auto u16 = [data](std::size_t at) {
+        return static_cast<std::uint16_t>(
+            std::to_integer<unsigned>(data[at]) |
+            (std::to_integer<unsigned>(data[at + 1]) << 8U));
+    };
+    return {std::to_integer<std::uint8_t>(data[1]), u16(2), u16(4)};
+}
+
+[[nodiscard]] constexpr std::uint16_t check_of(
+    const std::byte* data) noexcept {
+    return static_cast<std::uint16_t>(
+        std::to_integer<unsigned>(data[6]) |
+        (std::to_integer<unsigned>(data[7]) << 8U));
+}
+
+}  // namespace dis::io::mux
+
+#endif  // DIS_OSAL_IO_MUX_FORMAT_HPP
@@ -0,0 +1,343 @@
+#ifndef DIS_OSAL_IO_MUX_MULTIPLEXER_HPP
+#define DIS_OSAL_IO_MUX_MULTIPLEXER_HPP
+
+#include "dis/osal/io/mux/format.hpp"
+#include "dis/osal/io/mux/scheduler.hpp"
+#include "dis/osal/io/retarget.hpp"
+#include "dis/osal/io/transmit.hpp"
+#include "dis/osal/utils/cycle_counter.hpp"
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifndef DIS_MUX_STACK
+// in words, the pump task only copies frames into the port
+#define DIS_MUX_STACK 256
+#endif
+
+namespace dis::io::mux {
+
+/// a port with in place transmit buffers, like dis::vcom
+template <class PORT_T>
+concept reserving_port =
+    requires(std::size_t size, deadline until, const std::byte* reserved) {
+        { PORT_T::tx_bytes } -> std::convertible_to<std::size_t>;
+        { PORT_T::reserve(size, until) } -> std::same_as<std::byte*>;
+        PORT_T::commit(reserved);
+    };
+
+struct channel_stats {
+    /// frames handed to the port
+    std::uint32_t frames{0};
+    /// payload bytes of these frames
+    std::uint32_t bytes{0};
+    /// frames lost, the queue was full or the frame too large
+    std::uint32_t dropped{0};
+    /// time from `send` until the frame was handed to the port, in cycles
+    std::uint32_t latency_max{0};
+    std::uint64_t latency_total{0};
+
+    [[nodiscard]] std::uint32_t latency_mean() const noexcept {
+        return frames == 0
+                   ? 0
+                   : static_cast<std::uint32_t>(latency_total / frames);
+    }
+};
+
+/**
+ * Carries `CHANNELS_V` logical channels (e.g. logs, telemetry and
+ * commands) over one port, framed as described in format.hpp and split up
+ * again on the host by tools/vcom_demux.
+ *
+ * Every channel has its own queue of `QUEUE_BYTES_V` bytes.  `send` copies
+ * the frame into the queue of the channel with interrupts masked and never
+ * waits, a frame which does not fit is dropped (and counted), so a burst on
+ * one channel only ever loses frames of that channel.  A pump task picks the
+ * next frame with the scheduler (strict priority between levels, deficit
+ * round robin by weight within a level) whenever the port has room for it
+ * and writes it straight into a transmit buffer of the port.  As the port
+ * only takes frames while one of its buffers is open, a frame of a higher
+ * priority channel waits for at most the buffers already queued in the
+ * port, not for the backlog of the other channels.
+ *
+ *   using usb_port = dis::vcom<1024, 1024>;
+ *   static dis::io::mux::multiplexer<usb_port, 3, 2048> s_mux{{{
+ *       {.priority = 1, .weight = 1},  // telemetry
+ *       {.priority = 0, .weight = 3},  // commands
+ *       {.priority = 0, .weight = 1},  // logs
+ *   }}};
+ *   s_mux.start(tskIDLE_PRIORITY + 2);
+ *   dis::io::attach(dis::io::stream::out, s_mux.channel(2).get_sink());
+ *
+ * Must live as long as the pump task, i.e. forever.
+ */
+template <reserving_port PORT_T,
+          std::size_t CHANNELS_V,
+          std::size_t QUEUE_BYTES_V>
+class multiplexer {
+    static_assert(CHANNELS_V > 0 && CHANNELS_V <= max_channels);
+    static_assert((QUEUE_BYTES_V & (QUEUE_BYTES_V - 1)) == 0,
+                  "the queue size must be a power of two");
+    static_assert(PORT_T::tx_bytes > header_size,
+                  "the port has to take a frame header and payload");
+
+    // a queued frame is preceded by its size and the time of `send`
+    static constexpr std::size_t entry_header = 8;
+    static_assert(QUEUE_BYTES_V > entry_header);
+
+public:
+    using config_type = typename scheduler<CHANNELS_V>::config_type;
+
+    /// largest payload of a frame
+    static constexpr std::size_t max_payload =
+        std::min({PORT_T::tx_bytes - header_size, QUEUE_BYTES_V - entry_header,
+                  max_frame_payload});
+
+    /// one logical channel, a transmitter which never waits
+    class channel_port {
+    public:
+        /**
+         * Queues the data as one frame of at most `max_payload` bytes.
+         * Returns its size or 0 if it got dropped, the deadline is not
+         * used.
+         */
+        std::size_t transmit(segment_list data,
+                             deadline = deadline::never()) noexcept {
+            return m_mux->send(m_index, data);
+        }
+
+        /// sink for dis::io::attach, e.g. to carry stdout
+        [[nodiscard]] sink get_sink() noexcept {
+            sink device{};
+            device.write   = &write;
+            device.context = this;
+            return device;
+        }
+
+    private:
+        friend class multiplexer;
+
+        channel_port() noexcept = default;
+
+        static std::size_t write(void* context,
+                                 const char* data,
+                                 std::size_t size) noexcept {
+            // the stream is split into frames of `max_payload`
+            auto& self          = *static_cast<channel_port*>(context);
+            const segment part  = std::as_bytes(std::span{data, size});
+            std::size_t written = 0;
+            do {
+                const std::size_t chunk = std::min(size - written, max_payload);
+                if (self.m_mux->enqueue(self.m_index, {&part, 1}, written,
+                                        chunk) != chunk) {
+                    break;
+                }
+                written += chunk;
+            } while (written < size);
+            return written;
+        }
+
+        multiplexer* m_mux{nullptr};
+        std::size_t m_index{0};
+    };
+
+    /// `quantum` is the credit of a channel with weight 1 per round
+    explicit multiplexer(const config_type& config,
+                         std::size_t quantum = PORT_T::tx_bytes) noexcept
+        : m_scheduler(config, quantum) {
+        for (std::size_t index = 0; index < CHANNELS_V; ++index) {
+            m_channels[index].m_mux   = this;
+            m_channels[index].m_index = index;
+        }
+    }
+
+    multiplexer(const multiplexer&)            = delete;
+    multiplexer& operator=(const multiplexer&) = delete;
+
+    /// creates the pump task, frames queued before are kept
+    void start(UBaseType_t priority) noexcept {
+        if (m_pump != nullptr) {
+            return;
+        }
+        m_pump = xTaskCreateStatic(&run, "mux", m_stack.size(), this,
+                                   priority, m_stack.data(), &m_tcb);
+    }
+
+    [[nodiscard]] channel_port& channel(std::size_t index) noexcept {
+        return m_channels[index];
+    }
+
+    /**
+     * Queues `data` as one frame on channel `index`.  Usable from tasks and
+     * interrupts.  Returns the payload size or 0 if the frame got dropped.
+     */
+    std::size_t send(std::size_t index, segment_list data) noexcept {
+        return enqueue(index, data, 0, size_of(data));
+    }
+
+    [[nodiscard]] channel_stats stats(std::size_t index) const noexcept {
+        const UBaseType_t mask    = portSET_INTERRUPT_MASK_FROM_ISR();
+        const channel_stats stats = m_queues[index].stats;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        return stats;
+    }
+
+private:
+    /**
+     * Positions are free running.  `head` and the statistics are changed
+     * with interrupts masked, `tail` only by the pump, which reads the frame
+     * at `tail` without any lock held.
+     */
+    struct queue {
+        std::array<std::byte, QUEUE_BYTES_V> buffer{};
+        std::uint32_t head{0};
+        std::uint32_t tail{0};
+        std::uint16_t sequence{0};
+        channel_stats stats{};
+    };
+
+    static void write(queue& q,
+                      std::uint32_t position,
+                      std::span<const std::byte> data) noexcept {
+        const std::size_t offset = position % QUEUE_BYTES_V;
+        const std::size_t first =
+            std::min(data.size(), QUEUE_BYTES_V - offset);
+        std::memcpy(q.buffer.data() + offset, data.data(), first);
+        std::memcpy(q.buffer.data(), data.data() + first,
+                    data.size() - first);
+    }
+
+    static void read(const queue& q,
+                     std::uint32_t position,
+                     std::span<std::byte> data) noexcept {
+        const std::size_t offset = position % QUEUE_BYTES_V;
+        const std::size_t first =
+            std::min(data.size(), QUEUE_BYTES_V - offset);
+        std::memcpy(data.data(), q.buffer.data() + offset, first);
+        std::memcpy(data.data() + first, q.buffer.data(),
+                    data.size() - first);
+    }
+
+    /// queues `size` bytes of `data` starting at `offset` as one frame
+    std::size_t enqueue(std::size_t index,
+                        segment_list data,
+                        std::size_t offset,
+                        std::size_t size) noexcept {
+        queue& q         = m_queues[index];
+        const auto entry = static_cast<std::uint32_t>(entry_header + size);
+        const std::uint32_t header[2] = {static_cast<std::uint32_t>(size),
+                                         this_cpu::cycles()};
+
+        bool taken             = false;
+        const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        if (size <= max_payload &&
+            QUEUE_BYTES_V - (q.head - q.tail) >= entry) {
+            write(q, q.head, std::as_bytes(std::span{header}));
+            const std::size_t at = (q.head + entry_header) % QUEUE_BYTES_V;
+            const std::size_t first = std::min(size, QUEUE_BYTES_V - at);
+            (void)gather(data, offset, {q.buffer.data() + at, first});
+            (void)gather(data, offset + first,
+                         {q.buffer.data(), size - first});
+            q.head += entry;
+            taken = true;
+        } else {
+            ++q.stats.dropped;
+        }
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+        if (taken) {
+            wake_pump();
+        }
+        return taken ? size : 0;
+    }
+
+    void wake_pump() noexcept {
+        if (m_pump == nullptr) {
+            return;
+        }
+        if (xPortIsInsideInterrupt()) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(m_pump, &woken);
+            portYIELD_FROM_ISR(woken);
+        } else {
+            xTaskNotifyGive(m_pump);
+        }
+    }
+
+    /// size on the link of the oldest frame of the channel, 0 if none
+    std::size_t frame_size(std::size_t index) const noexcept {
+        const queue& q         = m_queues[index];
+        const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        const bool empty       = q.head == q.tail;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        if (empty) {
+            return 0;
+        }
+        std::uint32_t size = 0;
+        read(q, q.tail, std::as_writable_bytes(std::span{&size, 1}));
+        return header_size + size;
+    }
+
+    void forward(std::size_t index) noexcept {
+        queue& q = m_queues[index];
+        std::uint32_t header[2]{};
+        read(q, q.tail, std::as_writable_bytes(std::span{header}));
+        const std::uint32_t size = header[0];
+
+        // waits until a transmit buffer of the port is open
+        std::byte* frame =
+            PORT_T::reserve(header_size + size, deadline::never());
+        if (frame == nullptr) {
+            return;
+        }
+        encode({static_cast<std::uint8_t>(index),
+                static_cast<std::uint16_t>(size), q.sequence++},
+               frame);
+        read(q, q.tail + entry_header, {frame + header_size, size});
+        seal(frame, size);
+        PORT_T::commit(frame);
+
+        const std::uint32_t latency = this_cpu::cycles() - header[1];
+        const UBaseType_t mask      = portSET_INTERRUPT_MASK_FROM_ISR();
+        q.tail += static_cast<std::uint32_t>(entry_header + size);
+        ++q.stats.frames;
+        q.stats.bytes += size;
+        q.stats.latency_max = std::max(q.stats.latency_max, latency);
+        q.stats.latency_total += latency;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+        m_scheduler.sent(index, header_size + size);
+    }
+
+    static void run(void* self) {
+        auto& mux = *static_cast<multiplexer*>(self);
+        for (;;) {
+            const auto next = mux.m_scheduler.next(
+                [&mux](std::size_t index) { return mux.frame_size(index); });
+            if (next) {
+                mux.forward(*next);
+            } else {
+                (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+        }
+    }
+
+    std::array<queue, CHANNELS_V> m_queues{};
+    std::array<channel_port, CHANNELS_V> m_channels{};
+    scheduler<CHANNELS_V> m_scheduler;
+
+    TaskHandle_t m_pump{nullptr};
+    StaticTask_t m_tcb{};
+    std::array<StackType_t, DIS_MUX_STACK> m_stack{};
+};
+
+}  // namespace dis::io::mux
+
+#endif  // DIS_OSAL_IO_MUX_MULTIPLEXER_HPP
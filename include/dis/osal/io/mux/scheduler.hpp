@@ -0,0 +1,135 @@
+#ifndef DIS_OSAL_IO_MUX_SCHEDULER_HPP
+#define DIS_OSAL_IO_MUX_SCHEDULER_HPP
+
+// NOTE: no FreeRTOS in here, tests/scheduler_test.cpp runs the policy on the
+// host build
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace dis::io::mux {
+
+struct channel_config {
+    /// channels of a higher priority always go first
+    std::uint8_t priority{0};
+    /// share of the link among the channels of the same priority
+    std::uint16_t weight{1};
+};
+
+/**
+ * Picks the channel of the next frame: strict priority between the
+ * priority levels and deficit round robin among the channels of the same
+ * level.  Every visit of a backlogged channel in the round adds `weight *
+ * quantum` bytes to its deficit, it sends frames as long as they fit into
+ * the deficit.  So the channels of one level share the link in proportion
+ * to their weights, independent of their frame sizes, and an idle channel
+ * does not save up credit.
+ *
+ * All channels at one priority behave like plain (weighted) DRR, distinct
+ * priorities like a strict priority scheduler.
+ */
+template <std::size_t CHANNELS_V>
+class scheduler {
+    static_assert(CHANNELS_V > 0);
+
+public:
+    using config_type = std::array<channel_config, CHANNELS_V>;
+
+    explicit constexpr scheduler(const config_type& config,
+                                 std::size_t quantum) noexcept
+        : m_config(config), m_quantum(std::max<std::size_t>(quantum, 1)) {
+        // rank of the priority among the distinct priorities, every level
+        // keeps its own round, so serving a higher level does not disturb it
+        for (std::size_t channel = 0; channel < CHANNELS_V; ++channel) {
+            for (std::size_t other = 0; other < CHANNELS_V; ++other) {
+                if (config[other].priority < config[channel].priority &&
+                    first_of_priority(other)) {
+                    ++m_level[channel];
+                }
+            }
+        }
+    }
+
+    /**
+     * `frame_size(channel)` returns the size of the oldest frame of the
+     * channel, 0 if it has none.  Returns the channel which sends next, to
+     * be confirmed with `sent`, or nullopt if all channels are empty.
+     */
+    template <class FRAME_SIZE_FN_T>
+    [[nodiscard]] std::optional<std::size_t> next(
+        FRAME_SIZE_FN_T&& frame_size) noexcept {
+        std::array<std::size_t, CHANNELS_V> sizes{};
+        std::optional<std::size_t> level;
+        for (std::size_t channel = 0; channel < CHANNELS_V; ++channel) {
+            sizes[channel] = frame_size(channel);
+            if (sizes[channel] == 0) {
+                m_deficit[channel] = 0;
+            } else if (!level || m_level[channel] > *level) {
+                level = m_level[channel];
+            }
+        }
+        if (!level) {
+            return std::nullopt;
+        }
+
+        // the level has a backlogged channel, whose deficit grows every
+        // round, so this terminates
+        round& current = m_rounds[*level];
+        for (;;) {
+            const std::size_t channel = current.channel;
+            if (sizes[channel] != 0 && m_level[channel] == *level) {
+                if (!current.granted) {
+                    m_deficit[channel] +=
+                        std::max<std::size_t>(m_config[channel].weight, 1) *
+                        m_quantum;
+                    current.granted = true;
+                }
+                if (sizes[channel] <= m_deficit[channel]) {
+                    return channel;
+                }
+            }
+            current.channel = (current.channel + 1) % CHANNELS_V;
+            current.granted = false;
+        }
+    }
+
+    /// charges a frame of `size` bytes sent on `channel`
+    void sent(std::size_t channel, std::size_t size) noexcept {
+        m_deficit[channel] -= std::min(size, m_deficit[channel]);
+    }
+
+    [[nodiscard]] const config_type& config() const noexcept {
+        return m_config;
+    }
+
+private:
+    struct round {
+        std::size_t channel{0};
+        /// `channel` got its quantum of this round
+        bool granted{false};
+    };
+
+    [[nodiscard]] constexpr bool first_of_priority(
+        std::size_t channel) const noexcept {
+        for (std::size_t other = 0; other < channel; ++other) {
+            if (m_config[other].priority == m_config[channel].priority) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    config_type m_config;
+    std::size_t m_quantum;
+    std::array<std::size_t, CHANNELS_V> m_deficit{};
+    /// index of the priority of the channel among the distinct priorities
+    std::array<std::size_t, CHANNELS_V> m_level{};
+    std::array<round, CHANNELS_V> m_rounds{};
+};
+
+}  // namespace dis::io::mux
+
+#endif  // DIS_OSAL_IO_MUX_SCHEDULER_HPP
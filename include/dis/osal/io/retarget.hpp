@@ -0,0 +1,98 @@
+#ifndef DIS_OSAL_IO_RETARGET_HPP
+#define DIS_OSAL_IO_RETARGET_HPP
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ring sizes, both must be a power of two
+#ifndef DIS_IO_STDOUT_BUFFER
+#define DIS_IO_STDOUT_BUFFER 1024
+#endif
+
+#ifndef DIS_IO_STDERR_BUFFER
+#define DIS_IO_STDERR_BUFFER 256
+#endif
+
+// Not part of every image: the ones which use it add retarget_srcs of
+// meson.build, all others keep the character wise _write() of syscalls.c.
+
+namespace dis::io {
+
+/// the file descriptors newlib hands to _write() and _read()
+enum class stream : int {
+    in  = 0,
+    out = 1,
+    err = 2,
+};
+
+inline constexpr std::size_t stdout_capacity = DIS_IO_STDOUT_BUFFER;
+inline constexpr std::size_t stderr_capacity = DIS_IO_STDERR_BUFFER;
+
+/**
+ * Device behind a stream.  `write` is only called from one task at a time
+ * (the drain task, or the writer itself while the scheduler is not running)
+ * and may block until the device is done, the data stays valid and unchanged
+ * until it returns.  It returns the number of bytes taken, the rest gets
+ * dropped.  `read` is optional, it blocks until at least one byte arrived.
+ */
+struct sink {
+    std::size_t (*write)(void* context,
+                         const char* data,
+                         std::size_t size) noexcept {nullptr};
+    std::size_t (*read)(void* context,
+                        char* data,
+                        std::size_t size) noexcept {nullptr};
+    void* context{nullptr};
+};
+
+struct stream_stats {
+    /// bytes copied into the ring
+    std::uint32_t written{0};
+    /// bytes lost, either the ring was full or the sink did not take them
+    std::uint32_t dropped{0};
+    /// number of calls of sink::write
+    std::uint32_t flushes{0};
+};
+
+/**
+ * Connects a stream with a sink.  Output is collected in a per stream ring
+ * and handed to the sink once a newline got written or `flush_threshold`
+ * bytes are pending (stderr is always flushed right away).  Attach the sinks
+ * before the first output, a stream without sink falls back to the
+ * character wise __io_putchar()/__io_getchar() of syscalls.c.
+ */
+void attach(stream target,
+            const sink& device,
+            std::size_t flush_threshold = stdout_capacity / 2) noexcept;
+
+/**
+ * Creates the task which moves the rings into the sinks and makes stdin,
+ * stdout and stderr of newlib unbuffered, as newlib would otherwise share
+ * its own buffer between all tasks without a lock.  Until then, and while
+ * the scheduler is not running, the writing task empties the ring itself.
+ */
+void start(UBaseType_t priority) noexcept;
+
+/**
+ * Copies the data into the ring of the stream, the only work done by the
+ * calling task.  Thread safe, the ring is only locked while copying, never
+ * while the sink transmits.  Never waits for space, a write which does not
+ * fit is dropped (and counted).  Returns the number of bytes taken or -1 if
+ * the stream has no sink.
+ */
+int write(stream target, const char* data, std::size_t size) noexcept;
+
+/// blocks until at least one byte arrived, -1 if stdin has no reading sink
+int read(char* data, std::size_t size) noexcept;
+
+/// blocks until the pending output of the stream has been handed over
+void flush(stream target) noexcept;
+
+[[nodiscard]] stream_stats stats(stream target) noexcept;
+
+}  // namespace dis::io
+
+#endif  // DIS_OSAL_IO_RETARGET_HPP
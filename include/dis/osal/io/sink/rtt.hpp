@@ -0,0 +1,41 @@
+#ifndef DIS_OSAL_IO_SINK_RTT_HPP
+#define DIS_OSAL_IO_SINK_RTT_HPP
+
+#include "dis/osal/io/retarget.hpp"
+
+#include <SEGGER_RTT.h>
+
+namespace dis::io {
+
+/**
+ * SEGGER RTT up/down channel `CHANNEL_V` (0 is the terminal).  The channel
+ * is switched to trim mode: the data is copied into the RTT buffer as far as
+ * it fits, without a debugger attached the rest gets dropped instead of
+ * blocking the drain task.  Input is polled once per tick.
+ */
+template <unsigned CHANNEL_V = 0>
+[[nodiscard]] sink rtt_sink() noexcept {
+    SEGGER_RTT_Init();
+    SEGGER_RTT_SetFlagsUpBuffer(CHANNEL_V, SEGGER_RTT_MODE_NO_BLOCK_TRIM);
+
+    sink device{};
+    device.write = [](void*, const char* data,
+                      std::size_t size) noexcept -> std::size_t {
+        return SEGGER_RTT_Write(CHANNEL_V, data, size);
+    };
+    device.read = [](void*, char* data, std::size_t size) noexcept
+        -> std::size_t {
+        for (;;) {
+            const unsigned received = SEGGER_RTT_Read(CHANNEL_V, data, size);
+            if (received > 0) {
+                return received;
+            }
+            vTaskDelay(1);
+        }
+    };
+    return device;
+}
+
+}  // namespace dis::io
+
+#endif  // DIS_OSAL_IO_SINK_RTT_HPP
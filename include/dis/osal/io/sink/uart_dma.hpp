@@ -0,0 +1,140 @@
+#ifndef DIS_OSAL_IO_SINK_UART_DMA_HPP
+#define DIS_OSAL_IO_SINK_UART_DMA_HPP
+
+#include "dis/osal/io/retarget.hpp"
+#include "dis/osal/io/transmit.hpp"
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <stm32f7xx_hal.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace dis::io {
+
+/**
+ * Transmits straight out of the stream ring with the tx DMA of an UART
+ * initialized with STM_UartInit() (see BSP/UartQuickDirtyInit.h).  The drain
+ * task sleeps until the transfer completed, the completion has to be
+ * forwarded from HAL_UART_TxCpltCallback() and HAL_UART_ErrorCallback():
+ *
+ *   void HAL_UART_TxCpltCallback(UART_HandleTypeDef* uart) {
+ *       if (uart == &huart4) { s_console.transfer_done_from_isr(); }
+ *   }
+ *
+ * Before the scheduler runs the UART is written by polling.
+ *
+ * `transmit` sends frames from other tasks over the same UART, each segment
+ * with its own DMA transfer straight out of the caller's memory.  The UART
+ * is locked for the whole frame, so neither the stream output nor other
+ * frames get in between.  The deadline only bounds the wait for the lock,
+ * a frame which got started is always sent to the end.
+ */
+class uart_dma_sink {
+public:
+    explicit uart_dma_sink(UART_HandleTypeDef& uart) noexcept
+        : m_uart(&uart),
+          m_done(xSemaphoreCreateBinaryStatic(&m_done_buffer)),
+          m_lock(xSemaphoreCreateMutexStatic(&m_lock_buffer)) {}
+
+    uart_dma_sink(const uart_dma_sink&)            = delete;
+    uart_dma_sink& operator=(const uart_dma_sink&) = delete;
+
+    [[nodiscard]] sink get() noexcept {
+        sink device{};
+        device.write   = &write;
+        device.context = this;
+        return device;
+    }
+
+    std::size_t transmit(segment_list data,
+                         deadline until = deadline::never()) noexcept {
+        if (xSemaphoreTake(m_lock, until.remaining()) != pdPASS) {
+            return 0;
+        }
+        // less than the frame only if the UART failed
+        std::size_t sent = 0;
+        for (const segment& part : data) {
+            const std::size_t done =
+                send(reinterpret_cast<const char*>(part.data()), part.size());
+            sent += done;
+            if (done != part.size()) {
+                break;
+            }
+        }
+        xSemaphoreGive(m_lock);
+        return sent;
+    }
+
+    void transfer_done_from_isr() noexcept {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(m_done, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+
+private:
+    // upper bound of one transfer, 64kB at 9600 baud take ~70s, only hit if
+    // the UART hangs
+    static constexpr TickType_t transfer_timeout = pdMS_TO_TICKS(100000);
+
+    static std::size_t write(void* context,
+                             const char* data,
+                             std::size_t size) noexcept {
+        auto& self = *static_cast<uart_dma_sink*>(context);
+        if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+            return self.send(data, size);
+        }
+
+        (void)xSemaphoreTake(self.m_lock, portMAX_DELAY);
+        const std::size_t sent = self.send(data, size);
+        xSemaphoreGive(self.m_lock);
+        return sent;
+    }
+
+    // the caller holds m_lock unless the scheduler is not running yet
+    std::size_t send(const char* data, std::size_t size) noexcept {
+        // the HAL takes a mutable pointer, the data is only read
+        auto* bytes =
+            reinterpret_cast<std::uint8_t*>(const_cast<char*>(data));
+        const bool polling =
+            xTaskGetSchedulerState() != taskSCHEDULER_RUNNING;
+
+        std::size_t sent = 0;
+        while (sent < size) {
+            const auto chunk = static_cast<std::uint16_t>(
+                std::min<std::size_t>(size - sent, UINT16_MAX));
+            if (polling) {
+                if (HAL_UART_Transmit(m_uart, bytes + sent, chunk,
+                                      HAL_MAX_DELAY) != HAL_OK) {
+                    break;
+                }
+            } else {
+                if (HAL_UART_Transmit_DMA(m_uart, bytes + sent, chunk) !=
+                    HAL_OK) {
+                    break;
+                }
+                if (xSemaphoreTake(m_done, transfer_timeout) != pdPASS) {
+                    // the UART hangs, the part on the wire is unknown
+                    (void)HAL_UART_AbortTransmit(m_uart);
+                    (void)xSemaphoreTake(m_done, 0);
+                    break;
+                }
+            }
+            sent += chunk;
+        }
+        return sent;
+    }
+
+    UART_HandleTypeDef* m_uart;
+    StaticSemaphore_t m_done_buffer{};
+    SemaphoreHandle_t m_done;
+    StaticSemaphore_t m_lock_buffer{};
+    SemaphoreHandle_t m_lock;
+};
+
+static_assert(transmitter<uart_dma_sink>);
+
+}  // namespace dis::io
+
+#endif  // DIS_OSAL_IO_SINK_UART_DMA_HPP
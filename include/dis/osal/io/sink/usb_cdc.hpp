@@ -0,0 +1,50 @@
+#ifndef DIS_OSAL_IO_SINK_USB_CDC_HPP
+#define DIS_OSAL_IO_SINK_USB_CDC_HPP
+
+#include "dis/osal/io/retarget.hpp"
+#include "dis/osal/io/transmit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <span>
+
+namespace dis::io {
+
+/**
+ * USB CDC virtual com port `VCOM_T`, a dis::vcom (see dis/osal/io/vcom.hpp)
+ * which got initialized before.  The data is copied into the transmit
+ * buffers of the port, waiting at most `TIMEOUT_MS_V` for space.  Frames
+ * from other tasks go through the port itself, it is a transmitter.
+ */
+template <class VCOM_T, std::int32_t TIMEOUT_MS_V = 100>
+[[nodiscard]] sink usb_cdc_sink() noexcept {
+    sink device{};
+    device.write = [](void*, const char* data,
+                      std::size_t size) noexcept -> std::size_t {
+        // the stream is no frame, it goes out in pieces of a transfer
+        const auto until =
+            deadline::after(std::chrono::milliseconds{TIMEOUT_MS_V});
+        std::size_t written = 0;
+        while (written < size) {
+            const std::size_t chunk =
+                std::min(size - written, VCOM_T::tx_bytes);
+            const segment part =
+                std::as_bytes(std::span{data + written, chunk});
+            if (VCOM_T::transmit(segment_list{&part, 1}, until) != chunk) {
+                break;
+            }
+            written += chunk;
+        }
+        return written;
+    };
+    device.read = [](void*, char* data, std::size_t size) noexcept
+        -> std::size_t {
+        return VCOM_T::receive(std::as_writable_bytes(std::span{data, size}));
+    };
+    return device;
+}
+
+}  // namespace dis::io
+
+#endif  // DIS_OSAL_IO_SINK_USB_CDC_HPP
@@ -0,0 +1,119 @@
+#ifndef DIS_OSAL_IO_TRANSMIT_HPP
+#define DIS_OSAL_IO_TRANSMIT_HPP
+
+#include "dis/osal/thread/detail/thread_policy.hpp"
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace dis::io {
+
+/// one piece of a frame, e.g. header, payload and checksum
+using segment      = std::span<const std::byte>;
+using segment_list = std::span<const segment>;
+
+/**
+ * Latest point in time (in kernel ticks) a transmit may wait for the
+ * driver.  Only meaningful in task context.
+ */
+class deadline {
+public:
+    [[nodiscard]] static constexpr deadline never() noexcept {
+        return deadline{};
+    }
+    [[nodiscard]] static deadline at(TickType_t tick) noexcept {
+        return deadline{tick};
+    }
+    [[nodiscard]] static deadline after(
+        std::chrono::milliseconds time) noexcept {
+        return deadline{::xTaskGetTickCount() + freertos::to_ticks(time)};
+    }
+
+    [[nodiscard]] constexpr bool is_never() const noexcept { return m_never; }
+
+    /// ticks left, 0 once passed and portMAX_DELAY for never
+    [[nodiscard]] TickType_t remaining() const noexcept {
+        if (m_never) {
+            return freertos::infinity_delay;
+        }
+        using difference_type = std::make_signed_t<TickType_t>;
+        const auto left =
+            static_cast<difference_type>(m_until - ::xTaskGetTickCount());
+        return (left > 0) ? static_cast<TickType_t>(left) : 0;
+    }
+
+private:
+    constexpr deadline() noexcept = default;
+    explicit deadline(TickType_t until) noexcept
+        : m_until(until), m_never(false) {}
+
+    TickType_t m_until{0};
+    bool m_never{true};
+};
+
+[[nodiscard]] constexpr std::size_t size_of(segment_list data) noexcept {
+    std::size_t size = 0;
+    for (const segment& part : data) {
+        size += part.size();
+    }
+    return size;
+}
+
+/**
+ * Copies the bytes of `data` starting at `offset` (counted over all segments)
+ * into `target`, as many as fit.  Returns the number of bytes copied.
+ */
+inline std::size_t gather(segment_list data,
+                          std::size_t offset,
+                          std::span<std::byte> target) noexcept {
+    std::size_t copied = 0;
+    for (const segment& part : data) {
+        if (copied == target.size()) {
+            break;
+        }
+        if (offset >= part.size()) {
+            offset -= part.size();
+            continue;
+        }
+        const std::size_t size =
+            std::min(part.size() - offset, target.size() - copied);
+        std::memcpy(target.data() + copied, part.data() + offset, size);
+        copied += size;
+        offset = 0;
+    }
+    return copied;
+}
+
+/**
+ * Transmit interface shared by the drivers (see vcom.hpp and
+ * sink/uart_dma.hpp).  `transmit` queues the segments as one frame, which
+ * is not interleaved with the data of other tasks, waiting for the driver at
+ * most until the deadline.  A frame is taken as a whole or not at all: it
+ * returns the frame size, or 0 if the frame exceeds the limit of the driver
+ * or the deadline passed before it got queued.
+ */
+template <class PORT_T>
+concept transmitter =
+    requires(PORT_T& port, segment_list data, deadline until) {
+        { port.transmit(data, until) } noexcept -> std::same_as<std::size_t>;
+    };
+
+/// single buffer shorthand
+template <transmitter PORT_T>
+inline std::size_t transmit(PORT_T& port,
+                            segment data,
+                            deadline until = deadline::never()) noexcept {
+    return port.transmit(segment_list{&data, 1}, until);
+}
+
+}  // namespace dis::io
+
+#endif  // DIS_OSAL_IO_TRANSMIT_HPP
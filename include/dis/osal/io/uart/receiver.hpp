@@ -0,0 +1,272 @@
+#ifndef DIS_OSAL_IO_UART_RECEIVER_HPP
+#define DIS_OSAL_IO_UART_RECEIVER_HPP
+
+#include "dis/osal/io/uart/rx_cursor.hpp"
+
+#include <FreeRTOS.h>
+#include <stm32f7xx_hal.h>
+#include <stream_buffer.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#ifndef DIS_UART_RX_IRQ_PRIORITY
+// the handlers use the FromISR API, the UART and the DMA interrupt share
+// the priority so the ring is never serviced reentrant
+#define DIS_UART_RX_IRQ_PRIORITY 6
+#endif
+
+namespace dis::uart {
+
+/// the DMA stream (and request channel) wired to the receiver of an UART
+struct rx_channel {
+    DMA_Stream_TypeDef* stream{nullptr};
+    std::uint32_t request{0};
+    IRQn_Type dma_irq{};
+    IRQn_Type uart_irq{};
+};
+
+/// USART2 RX, DMA1 stream 5 channel 4
+[[nodiscard]] inline rx_channel usart2_rx() noexcept {
+    return {DMA1_Stream5, DMA_CHANNEL_4, DMA1_Stream5_IRQn, USART2_IRQn};
+}
+
+/// UART4 RX, DMA1 stream 2 channel 4
+[[nodiscard]] inline rx_channel uart4_rx() noexcept {
+    return {DMA1_Stream2, DMA_CHANNEL_4, DMA1_Stream2_IRQn, UART4_IRQn};
+}
+
+/// received bytes, straight out of the ring of the receiver
+struct rx_chunk {
+    std::span<const std::byte> first{};
+    std::span<const std::byte> second{};
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return first.size() + second.size();
+    }
+};
+
+/**
+ * Called from the interrupt with every chunk.  The data stays in place only
+ * until the DMA wraps around to it again, so it has to be consumed (or
+ * copied) right away.
+ */
+struct rx_handler {
+    void (*receive)(void* context, const rx_chunk& data) noexcept {nullptr};
+    void* context{nullptr};
+};
+
+struct rx_stats {
+    /// bytes taken out of the ring
+    std::uint32_t bytes{0};
+    /// hand-overs to the stream buffer or handler
+    std::uint32_t chunks{0};
+    /// idle line events, i.e. bursts which did not end at a half of the ring
+    std::uint32_t idle{0};
+    /// bytes which did not fit into the stream buffer
+    std::uint32_t dropped{0};
+    /// receptions the HAL aborted (overrun, framing, noise or DMA error)
+    std::uint32_t errors{0};
+    /// HAL_UART_ERROR_* bits of the last error
+    std::uint32_t last_error{0};
+};
+
+/**
+ * Receives an UART with a DMA stream which writes a ring of `RING_BYTES_V`
+ * bytes in circular mode, so no byte costs an interrupt.  The data is handed
+ * on whenever the line went idle (one character time without a start bit)
+ * and when the DMA passed the half or the end of the ring, i.e. a burst
+ * shorter than half the ring costs a single interrupt and a single
+ * notification of the reader, whatever its length.  At 4 Mbaud a 1kB ring
+ * gives the reader 1.25ms to take the first half before it gets overwritten.
+ *
+ * The chunks go either into a stream buffer (`xStreamBufferSendFromISR`,
+ * what does not fit is dropped and counted) or to a handler called in the
+ * interrupt.  The UART handle has to be initialized before, e.g. with
+ * STM_UartInitHandle() (see BSP/UartQuickDirtyInit.h), the receiver links
+ * its own DMA handle into it.  The interrupts have to be forwarded, marked
+ * with DIS_ISR_ENTER()/DIS_ISR_EXIT() for the CPU load accounting:
+ *
+ *   void USART2_IRQHandler() {
+ *       DIS_ISR_ENTER();
+ *       s_rx.uart_irq_from_isr();
+ *       DIS_ISR_EXIT();
+ *   }
+ *   void DMA1_Stream5_IRQHandler() {
+ *       DIS_ISR_ENTER();
+ *       s_rx.dma_irq_from_isr();
+ *       DIS_ISR_EXIT();
+ *   }
+ *   void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef* uart) {
+ *       s_rx.transfer_event_from_isr(uart);
+ *   }
+ *   void HAL_UART_RxCpltCallback(UART_HandleTypeDef* uart) {
+ *       s_rx.transfer_event_from_isr(uart);
+ *   }
+ *   void HAL_UART_ErrorCallback(UART_HandleTypeDef* uart) {
+ *       s_rx.error_from_isr(uart);
+ *   }
+ *
+ * The callbacks ignore other UARTs, so they can be chained.  The HAL stops
+ * a DMA reception on any receive error, the receiver hands on what arrived
+ * until then and restarts at the beginning of the ring.
+ *
+ * The CPU reads the ring right after the DMA wrote it, with the D-cache
+ * enabled the receiver has to live in a non cacheable region.  Must live as
+ * long as the reception, i.e. forever.
+ */
+template <std::size_t RING_BYTES_V>
+class receiver {
+    static_assert(RING_BYTES_V >= 2 && RING_BYTES_V % 2 == 0,
+                  "the half transfer event needs two equal halves");
+    static_assert(RING_BYTES_V <= UINT16_MAX,
+                  "a DMA transfer is limited to 65535 items");
+
+public:
+    explicit receiver(UART_HandleTypeDef& uart) noexcept : m_uart(&uart) {}
+
+    receiver(const receiver&)            = delete;
+    receiver& operator=(const receiver&) = delete;
+
+    /// starts the reception into `stream`, false if the HAL refused it
+    bool start(const rx_channel& channel,
+               StreamBufferHandle_t stream) noexcept {
+        m_stream = stream;
+        return begin(channel);
+    }
+
+    /// starts the reception, `handler` is called from the interrupt
+    bool start(const rx_channel& channel, const rx_handler& handler) noexcept {
+        m_handler = handler;
+        return begin(channel);
+    }
+
+    /// in place of HAL_UART_IRQHandler() in the USART/UART interrupt
+    void uart_irq_from_isr() noexcept {
+        if (__HAL_UART_GET_IT_SOURCE(m_uart, UART_IT_IDLE) != RESET &&
+            __HAL_UART_GET_FLAG(m_uart, UART_FLAG_IDLE) != RESET) {
+            __HAL_UART_CLEAR_IDLEFLAG(m_uart);
+            ++m_stats.idle;
+            service();
+        }
+        HAL_UART_IRQHandler(m_uart);
+    }
+
+    /// in the interrupt of the DMA stream
+    void dma_irq_from_isr() noexcept { HAL_DMA_IRQHandler(&m_dma); }
+
+    /// from HAL_UART_RxHalfCpltCallback() and HAL_UART_RxCpltCallback()
+    void transfer_event_from_isr(UART_HandleTypeDef* uart) noexcept {
+        if (uart == m_uart) {
+            service();
+        }
+    }
+
+    /// from HAL_UART_ErrorCallback()
+    void error_from_isr(UART_HandleTypeDef* uart) noexcept {
+        if (uart != m_uart || m_uart->RxState != HAL_UART_STATE_READY) {
+            // not this UART, or an error of the transmitter only
+            return;
+        }
+        ++m_stats.errors;
+        m_stats.last_error = m_uart->ErrorCode;
+        // the aborted stream keeps its counter
+        service();
+        (void)restart();
+    }
+
+    [[nodiscard]] rx_stats stats() const noexcept {
+        const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        const rx_stats stats   = m_stats;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        return stats;
+    }
+
+private:
+    bool begin(const rx_channel& channel) noexcept {
+        if (reinterpret_cast<std::uintptr_t>(channel.stream) >= DMA2_BASE) {
+            __HAL_RCC_DMA2_CLK_ENABLE();
+        } else {
+            __HAL_RCC_DMA1_CLK_ENABLE();
+        }
+
+        // direct mode (no FIFO), every byte the counter reports is in the ring
+        m_dma.Instance                 = channel.stream;
+        m_dma.Init.Channel             = channel.request;
+        m_dma.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+        m_dma.Init.PeriphInc           = DMA_PINC_DISABLE;
+        m_dma.Init.MemInc              = DMA_MINC_ENABLE;
+        m_dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        m_dma.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+        m_dma.Init.Mode                = DMA_CIRCULAR;
+        m_dma.Init.Priority            = DMA_PRIORITY_HIGH;
+        m_dma.Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+        if (HAL_DMA_Init(&m_dma) != HAL_OK) {
+            return false;
+        }
+        __HAL_LINKDMA(m_uart, hdmarx, m_dma);
+
+        HAL_NVIC_SetPriority(channel.dma_irq, DIS_UART_RX_IRQ_PRIORITY, 0);
+        HAL_NVIC_SetPriority(channel.uart_irq, DIS_UART_RX_IRQ_PRIORITY, 0);
+        HAL_NVIC_EnableIRQ(channel.dma_irq);
+        HAL_NVIC_EnableIRQ(channel.uart_irq);
+        return restart();
+    }
+
+    bool restart() noexcept {
+        m_cursor.reset();
+        if (HAL_UART_Receive_DMA(m_uart,
+                                 reinterpret_cast<std::uint8_t*>(m_ring.data()),
+                                 RING_BYTES_V) != HAL_OK) {
+            return false;
+        }
+        __HAL_UART_CLEAR_IDLEFLAG(m_uart);
+        __HAL_UART_ENABLE_IT(m_uart, UART_IT_IDLE);
+        return true;
+    }
+
+    [[nodiscard]] std::span<const std::byte> part(
+        const rx_range& range) const noexcept {
+        return {m_ring.data() + range.offset, range.size};
+    }
+
+    // runs in the UART or DMA interrupt, which never preempt each other
+    void service() noexcept {
+        const rx_ranges ranges =
+            m_cursor.advance(__HAL_DMA_GET_COUNTER(&m_dma));
+        if (ranges.empty()) {
+            return;
+        }
+        const rx_chunk data{part(ranges.first), part(ranges.second)};
+        ++m_stats.chunks;
+        m_stats.bytes += data.size();
+
+        if (m_stream != nullptr) {
+            BaseType_t woken  = pdFALSE;
+            std::size_t taken = xStreamBufferSendFromISR(
+                m_stream, data.first.data(), data.first.size(), &woken);
+            if (taken == data.first.size() && !data.second.empty()) {
+                taken += xStreamBufferSendFromISR(
+                    m_stream, data.second.data(), data.second.size(), &woken);
+            }
+            m_stats.dropped += data.size() - taken;
+            portYIELD_FROM_ISR(woken);
+        } else if (m_handler.receive != nullptr) {
+            m_handler.receive(m_handler.context, data);
+        }
+    }
+
+    std::array<std::byte, RING_BYTES_V> m_ring{};
+    rx_cursor m_cursor{RING_BYTES_V};
+    UART_HandleTypeDef* m_uart;
+    DMA_HandleTypeDef m_dma{};
+    StreamBufferHandle_t m_stream{nullptr};
+    rx_handler m_handler{};
+    rx_stats m_stats{};
+};
+
+}  // namespace dis::uart
+
+#endif  // DIS_OSAL_IO_UART_RECEIVER_HPP
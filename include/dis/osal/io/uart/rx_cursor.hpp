@@ -0,0 +1,80 @@
+#ifndef DIS_OSAL_IO_UART_RX_CURSOR_HPP
+#define DIS_OSAL_IO_UART_RX_CURSOR_HPP
+
+// NOTE: plain C++ without FreeRTOS or the HAL, tests/rx_cursor_test.cpp
+// replays the chunking against a simulated NDTR on the host.
+
+#include <cstddef>
+
+namespace dis::uart {
+
+/// part of the receive ring, `offset` from the start of the ring
+struct rx_range {
+    std::size_t offset{0};
+    std::size_t size{0};
+};
+
+/// the bytes which arrived since the last call, at most two parts as the
+/// data may wrap around the end of the ring
+struct rx_ranges {
+    rx_range first{};
+    rx_range second{};
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept {
+        return first.size + second.size;
+    }
+    [[nodiscard]] constexpr bool empty() const noexcept { return size() == 0; }
+};
+
+/**
+ * Tracks the read position in a ring which a circular DMA stream writes to.
+ * The stream only tells the bytes it has still to transfer until the end of
+ * the ring (NDTR), counting down from `size` and reloading with `size` after
+ * the last byte.  Right at the wrap the counter may read 0 for a moment,
+ * which is the same position as `size`.
+ *
+ * The writer must not get a whole ring ahead of the cursor: a lap is not
+ * visible in the counter, the ring just seems to hold the bytes of the last
+ * lap only.
+ */
+class rx_cursor {
+public:
+    explicit constexpr rx_cursor(std::size_t size) noexcept : m_size(size) {}
+
+    /// bytes written since the last call, `remaining` is the DMA counter
+    [[nodiscard]] constexpr rx_ranges advance(std::size_t remaining) noexcept {
+        const std::size_t position = write_position(remaining);
+        rx_ranges ranges{};
+        if (position > m_position) {
+            ranges.first = {m_position, position - m_position};
+        } else if (position < m_position) {
+            ranges.first  = {m_position, m_size - m_position};
+            ranges.second = {0, position};
+        }
+        m_position = position;
+        return ranges;
+    }
+
+    /// the DMA stream restarts at the beginning of the ring
+    constexpr void reset() noexcept { m_position = 0; }
+
+    [[nodiscard]] constexpr std::size_t position() const noexcept {
+        return m_position;
+    }
+    [[nodiscard]] constexpr std::size_t size() const noexcept {
+        return m_size;
+    }
+
+private:
+    [[nodiscard]] constexpr std::size_t write_position(
+        std::size_t remaining) const noexcept {
+        return remaining == 0 || remaining >= m_size ? 0 : m_size - remaining;
+    }
+
+    std::size_t m_size;
+    std::size_t m_position{0};
+};
+
+}  // namespace dis::uart
+
+#endif  // DIS_OSAL_IO_UART_RX_CURSOR_HPP
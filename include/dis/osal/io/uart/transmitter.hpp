@@ -0,0 +1,253 @@
+#ifndef DIS_OSAL_IO_UART_TRANSMITTER_HPP
+#define DIS_OSAL_IO_UART_TRANSMITTER_HPP
+
+#include "dis/osal/io/uart/tx_queue.hpp"
+#include "dis/osal/utils/cycle_counter.hpp"
+
+#include <FreeRTOS.h>
+#include <stm32f7xx_hal.h>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#ifndef DIS_UART_TX_IRQ_PRIORITY
+// the completion runs the done callbacks, which may use the FromISR API
+#define DIS_UART_TX_IRQ_PRIORITY 6
+#endif
+
+namespace dis::uart {
+
+/// the DMA stream (and request channel) wired to the transmitter of an UART
+struct tx_channel {
+    DMA_Stream_TypeDef* stream{nullptr};
+    std::uint32_t request{0};
+    IRQn_Type dma_irq{};
+};
+
+/// USART2 TX, DMA1 stream 6 channel 4
+[[nodiscard]] inline tx_channel usart2_tx() noexcept {
+    return {DMA1_Stream6, DMA_CHANNEL_4, DMA1_Stream6_IRQn};
+}
+
+/// UART4 TX, DMA1 stream 4 channel 4
+[[nodiscard]] inline tx_channel uart4_tx() noexcept {
+    return {DMA1_Stream4, DMA_CHANNEL_4, DMA1_Stream4_IRQn};
+}
+
+namespace detail {
+
+/// a DMA stream feeding the data register of an UART
+class dma_line {
+public:
+    explicit dma_line(UART_HandleTypeDef& uart) noexcept : m_uart(&uart) {}
+
+    bool start(std::span<const std::byte> data) noexcept {
+        return HAL_DMA_Start_IT(
+                   &m_dma, reinterpret_cast<std::uint32_t>(data.data()),
+                   reinterpret_cast<std::uint32_t>(&m_uart->Instance->TDR),
+                   static_cast<std::uint32_t>(data.size())) == HAL_OK;
+    }
+
+    [[nodiscard]] std::uint64_t now() noexcept {
+        return this_cpu::cycles64();
+    }
+
+    [[nodiscard]] std::uint32_t lock() noexcept {
+        return static_cast<std::uint32_t>(portSET_INTERRUPT_MASK_FROM_ISR());
+    }
+
+    void unlock(std::uint32_t state) noexcept {
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+    }
+
+    UART_HandleTypeDef* m_uart;
+    DMA_HandleTypeDef m_dma{};
+};
+
+}  // namespace detail
+
+/**
+ * Transmits buffers by reference with the tx DMA of an UART, queueing up to
+ * `DEPTH_V` of them (see tx_queue.hpp).  The next buffer is started from
+ * the DMA transfer complete interrupt, when the UART still has the last
+ * two bytes of the previous one to shift out, so back to back buffers go
+ * out without a gap on the line.
+ *
+ * The UART handle has to be initialized before, e.g. with
+ * STM_UartInitHandle() (see BSP/UartQuickDirtyInit.h).  The transmitter
+ * drives the DMA stream directly, not through HAL_UART_Transmit_DMA(), which
+ * would only allow the next transfer once the UART is done with the last
+ * bit, so it must not be mixed with the HAL transmit functions (or
+ * io::uart_dma_sink) on the same UART.  Reception, e.g. with
+ * dis::uart::receiver, is not affected.  The DMA interrupt has to be
+ * forwarded (see dis/osal/stats/cpu_load.hpp for the ISR marks):
+ *
+ *   void DMA1_Stream6_IRQHandler() {
+ *       DIS_ISR_ENTER();
+ *       s_tx.dma_irq_from_isr();
+ *       DIS_ISR_EXIT();
+ *   }
+ *
+ * Must live as long as the transfers, i.e. forever.
+ */
+template <std::size_t DEPTH_V>
+class transmitter {
+public:
+    explicit transmitter(UART_HandleTypeDef& uart) noexcept : m_queue(uart) {}
+
+    transmitter(const transmitter&)            = delete;
+    transmitter& operator=(const transmitter&) = delete;
+
+    /// false if the HAL refused the DMA stream
+    bool start(const tx_channel& channel) noexcept {
+        if (reinterpret_cast<std::uintptr_t>(channel.stream) >= DMA2_BASE) {
+            __HAL_RCC_DMA2_CLK_ENABLE();
+        } else {
+            __HAL_RCC_DMA1_CLK_ENABLE();
+        }
+
+        DMA_HandleTypeDef& dma       = m_queue.line().m_dma;
+        dma.Instance                 = channel.stream;
+        dma.Init.Channel             = channel.request;
+        dma.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+        dma.Init.PeriphInc           = DMA_PINC_DISABLE;
+        dma.Init.MemInc              = DMA_MINC_ENABLE;
+        dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        dma.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+        dma.Init.Mode                = DMA_NORMAL;
+        dma.Init.Priority            = DMA_PRIORITY_MEDIUM;
+        dma.Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+        if (HAL_DMA_Init(&dma) != HAL_OK) {
+            return false;
+        }
+        // the stream is not linked to the UART handle, its parent is us
+        dma.Parent            = this;
+        dma.XferCpltCallback  = &transfer_done;
+        dma.XferErrorCallback = &transfer_error;
+
+        UART_HandleTypeDef* uart = m_queue.line().m_uart;
+        SET_BIT(uart->Instance->CR3, USART_CR3_DMAT);
+
+        HAL_NVIC_SetPriority(channel.dma_irq, DIS_UART_TX_IRQ_PRIORITY, 0);
+        HAL_NVIC_EnableIRQ(channel.dma_irq);
+        m_queue.clear_stats();
+        return true;
+    }
+
+    /**
+     * Queues the buffer, never waits.  Returns false if the queue is full
+     * or the buffer too large (tx_queue::max_transfer), `done` is not called
+     * then.  Usable from tasks and interrupts.
+     */
+    bool send(const tx_descriptor& descriptor) noexcept {
+        return m_queue.submit(descriptor);
+    }
+
+    /// in the interrupt of the DMA stream
+    void dma_irq_from_isr() noexcept {
+        HAL_DMA_IRQHandler(&m_queue.line().m_dma);
+    }
+
+    /// buffers queued, the one on the line included
+    [[nodiscard]] std::size_t depth() noexcept { return m_queue.depth(); }
+
+    /// the times are in CPU cycles
+    [[nodiscard]] tx_stats stats() noexcept { return m_queue.stats(); }
+
+    void clear_stats() noexcept { m_queue.clear_stats(); }
+
+private:
+    static void transfer_done(DMA_HandleTypeDef* dma) {
+        static_cast<transmitter*>(dma->Parent)->m_queue.complete(true);
+    }
+
+    static void transfer_error(DMA_HandleTypeDef* dma) {
+        if ((dma->Instance->CR & DMA_SxCR_EN) != 0U) {
+            // FIFO and direct mode errors do not stop the stream
+            dma->ErrorCode = HAL_DMA_ERROR_NONE;
+            return;
+        }
+        static_cast<transmitter*>(dma->Parent)->m_queue.complete(false);
+    }
+
+    tx_queue<DEPTH_V, detail::dma_line> m_queue;
+};
+
+/**
+ * `BLOCKS_V` buffers of `BLOCK_BYTES_V` bytes which are owned by the
+ * transmitter while they are queued:
+ *
+ *   const auto block = s_pool.allocate();
+ *   const std::size_t size = fill(block);
+ *   if (!s_tx.send(s_pool.descriptor(block, size))) {
+ *       s_pool.free(block);
+ *   }
+ *
+ * Usable from tasks and interrupts.
+ */
+template <std::size_t BLOCKS_V, std::size_t BLOCK_BYTES_V>
+class tx_pool {
+    static_assert(BLOCKS_V > 0 && BLOCKS_V <= 32,
+                  "the free blocks are tracked in a 32 bit mask");
+
+public:
+    static constexpr std::size_t block_bytes = BLOCK_BYTES_V;
+
+    tx_pool() noexcept = default;
+
+    tx_pool(const tx_pool&)            = delete;
+    tx_pool& operator=(const tx_pool&) = delete;
+
+    /// a free block, empty if there is none
+    [[nodiscard]] std::span<std::byte> allocate() noexcept {
+        const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        std::span<std::byte> block{};
+        if (m_free != 0) {
+            const auto index =
+                static_cast<std::size_t>(std::countr_zero(m_free));
+            m_free &= ~(1U << index);
+            block = m_blocks[index];
+        }
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        return block;
+    }
+
+    /// returns a block which did not get sent
+    void free(std::span<const std::byte> block) noexcept {
+        const auto index = static_cast<std::size_t>(
+            (block.data() - m_blocks[0].data()) / BLOCK_BYTES_V);
+        const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        m_free |= 1U << index;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    }
+
+    /// the first `size` bytes of `block`, which returns once sent (or not)
+    [[nodiscard]] tx_descriptor descriptor(std::span<std::byte> block,
+                                           std::size_t size) noexcept {
+        return {block.first(size), &release, this};
+    }
+
+    [[nodiscard]] std::size_t available() const noexcept {
+        const UBaseType_t mask   = portSET_INTERRUPT_MASK_FROM_ISR();
+        const std::uint32_t bits = m_free;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        return static_cast<std::size_t>(std::popcount(bits));
+    }
+
+private:
+    static void release(void* context,
+                        const tx_descriptor& descriptor,
+                        bool) noexcept {
+        static_cast<tx_pool*>(context)->free(descriptor.data);
+    }
+
+    std::array<std::array<std::byte, BLOCK_BYTES_V>, BLOCKS_V> m_blocks{};
+    std::uint32_t m_free{BLOCKS_V == 32 ? ~0U : (1U << BLOCKS_V) - 1U};
+};
+
+}  // namespace dis::uart
+
+#endif  // DIS_OSAL_IO_UART_TRANSMITTER_HPP
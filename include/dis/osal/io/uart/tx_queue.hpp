@@ -0,0 +1,209 @@
+#ifndef DIS_OSAL_IO_UART_TX_QUEUE_HPP
+#define DIS_OSAL_IO_UART_TX_QUEUE_HPP
+
+// NOTE: the hardware is the LINE_T policy, tests/tx_queue_test.cpp plugs in
+// a simulated line which refuses starts and runs its own clock.
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dis::uart {
+
+/**
+ * A buffer to transmit, by reference: the data has to stay valid and
+ * unchanged until `done` got called.  `done` runs in the completion
+ * interrupt (or in `submit`, if the line refused the transfer), `sent` is
+ * false if the data did not (completely) go out.
+ */
+struct tx_descriptor {
+    std::span<const std::byte> data{};
+    void (*done)(void* context,
+                 const tx_descriptor& descriptor,
+                 bool sent) noexcept {nullptr};
+    void* context{nullptr};
+};
+
+struct tx_stats {
+    /// descriptors taken by `submit`
+    std::uint32_t queued{0};
+    /// descriptors which went out completely, and their bytes
+    std::uint32_t sent{0};
+    std::uint32_t bytes{0};
+    /// descriptors refused by `submit`, the queue was full or the data too
+    /// large for one transfer
+    std::uint32_t rejected{0};
+    /// descriptors the line refused or aborted
+    std::uint32_t failed{0};
+    /// completions which left the line idle, i.e. the producers did not
+    /// keep the queue filled (or simply had nothing more to send)
+    std::uint32_t underruns{0};
+    /// most descriptors queued at once, the one in flight included
+    std::uint32_t depth_max{0};
+    /// time the line was transmitting, and the time the stats cover, both
+    /// in the unit of the line clock
+    std::uint64_t busy{0};
+    std::uint64_t elapsed{0};
+
+    /// share of the time the line was transmitting, in 1/1000
+    [[nodiscard]] std::uint32_t utilization_permille() const noexcept {
+        return elapsed == 0
+                   ? 0
+                   : static_cast<std::uint32_t>(busy * 1000 / elapsed);
+    }
+};
+
+/**
+ * The hardware behind the queue.  `start` begins the transfer of `data`
+ * and reports its end by a call of tx_queue::complete (usually from the
+ * completion interrupt), `now` is a free running clock for the statistics
+ * and `lock`/`unlock` keep that interrupt (and other producers) out.
+ */
+template <class LINE_T>
+concept tx_line = requires(LINE_T& line,
+                           std::span<const std::byte> data,
+                           std::uint32_t state) {
+    { line.start(data) } noexcept -> std::same_as<bool>;
+    { line.now() } noexcept -> std::same_as<std::uint64_t>;
+    { line.lock() } noexcept -> std::same_as<std::uint32_t>;
+    { line.unlock(state) } noexcept;
+};
+
+/**
+ * Queue of up to `DEPTH_V` descriptors in front of a line.  The oldest
+ * descriptor is the one in flight; its completion starts the next one right
+ * away, before the producer of the finished one gets notified, so the line
+ * does not idle as long as the queue is not empty.  The payload is never
+ * copied.
+ */
+template <std::size_t DEPTH_V, tx_line LINE_T>
+class tx_queue {
+    static_assert(DEPTH_V > 0);
+
+public:
+    /// largest transfer of the line, a DMA stream counts 16 bit
+    static constexpr std::size_t max_transfer = UINT16_MAX;
+
+    template <class... ARG_Ts>
+    explicit tx_queue(ARG_Ts&&... args) noexcept
+        : m_line(static_cast<ARG_Ts&&>(args)...) {
+        clear_stats();
+    }
+
+    tx_queue(const tx_queue&)            = delete;
+    tx_queue& operator=(const tx_queue&) = delete;
+
+    /**
+     * Queues the descriptor and starts it if the line is idle.  Never
+     * waits, returns false (without calling `done`) if the descriptor was
+     * refused.
+     */
+    bool submit(const tx_descriptor& descriptor) noexcept {
+        const std::size_t size    = descriptor.data.size();
+        const std::uint32_t state = m_line.lock();
+        if (size == 0 || size > max_transfer || m_count == DEPTH_V) {
+            ++m_stats.rejected;
+            m_line.unlock(state);
+            return false;
+        }
+        m_ring[(m_head + m_count) % DEPTH_V] = descriptor;
+        ++m_count;
+        ++m_stats.queued;
+        m_stats.depth_max =
+            std::max(m_stats.depth_max, static_cast<std::uint32_t>(m_count));
+        // the first descriptor is started here, all others on completion
+        const bool idle = m_count == 1;
+        if (idle) {
+            m_busy_since = m_line.now();
+        }
+        m_line.unlock(state);
+
+        if (idle && !m_line.start(descriptor.data)) {
+            complete(false);
+        }
+        return true;
+    }
+
+    /// the transfer in flight ended, `sent` is false if it got aborted
+    void complete(bool sent) noexcept {
+        for (;;) {
+            const std::uint32_t state    = m_line.lock();
+            const tx_descriptor finished = m_ring[m_head];
+            m_head                       = (m_head + 1) % DEPTH_V;
+            --m_count;
+            if (sent) {
+                ++m_stats.sent;
+                m_stats.bytes +=
+                    static_cast<std::uint32_t>(finished.data.size());
+            } else {
+                ++m_stats.failed;
+            }
+
+            const std::uint64_t now = m_line.now();
+            m_stats.busy += now - m_busy_since;
+            m_busy_since = now;
+            if (m_count == 0) {
+                ++m_stats.underruns;
+            }
+            // the front only changes here, so it can be read unlocked
+            const bool more = m_count != 0;
+            m_line.unlock(state);
+
+            const bool started = !more || m_line.start(m_ring[m_head].data);
+            if (finished.done != nullptr) {
+                finished.done(finished.context, finished, sent);
+            }
+            if (started) {
+                return;
+            }
+            sent = false;
+        }
+    }
+
+    /// descriptors queued, the one in flight included
+    [[nodiscard]] std::size_t depth() noexcept {
+        const std::uint32_t state = m_line.lock();
+        const std::size_t count   = m_count;
+        m_line.unlock(state);
+        return count;
+    }
+
+    [[nodiscard]] tx_stats stats() noexcept {
+        const std::uint32_t state = m_line.lock();
+        tx_stats stats            = m_stats;
+        const std::uint64_t now   = m_line.now();
+        if (m_count != 0) {
+            stats.busy += now - m_busy_since;
+        }
+        stats.elapsed = now - m_since;
+        m_line.unlock(state);
+        return stats;
+    }
+
+    /// starts a new interval of the statistics
+    void clear_stats() noexcept {
+        const std::uint32_t state = m_line.lock();
+        m_stats                   = {};
+        m_since                   = m_line.now();
+        m_busy_since              = m_since;
+        m_line.unlock(state);
+    }
+
+    [[nodiscard]] LINE_T& line() noexcept { return m_line; }
+
+private:
+    LINE_T m_line;
+    std::array<tx_descriptor, DEPTH_V> m_ring{};
+    std::size_t m_head{0};
+    std::size_t m_count{0};
+    tx_stats m_stats{};
+    std::uint64_t m_since{0};
+    std::uint64_t m_busy_since{0};
+};
+
+}  // namespace dis::uart
+
+#endif  // DIS_OSAL_IO_UART_TX_QUEUE_HPP
@@ -0,0 +1,181 @@
+#ifndef DIS_OSAL_IO_VCOM_HPP
+#define DIS_OSAL_IO_VCOM_HPP
+
+#include "dis/osal/io/transmit.hpp"
+
+#include <FreeRTOS.h>
+#include <stream_buffer.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dis {
+
+/// counters of the receive path, they only ever grow
+struct vcom_rx_stats {
+    /// received and queued into the receive stream buffer
+    std::uint32_t bytes{0};
+    /// received but did not fit into the stream buffer
+    std::uint32_t dropped{0};
+    /// number of times the OUT endpoint was left NAKing
+    std::uint32_t pauses{0};
+    /// total time the OUT endpoint was NAKing, in ticks
+    std::uint32_t nak_ticks{0};
+};
+
+namespace detail {
+
+/// bulk packet size of the full speed CDC endpoints
+inline constexpr std::size_t vcom_packet_size = 64;
+
+struct vcom_slot {
+    /// reserved bytes
+    std::uint16_t len{0};
+    /// reservations not committed yet
+    std::uint16_t writers{0};
+    volatile std::uint8_t state{0};
+};
+
+/// the memory of a dis::vcom, handed to the (single) driver instance
+struct vcom_buffers {
+    std::span<std::byte> tx_data;
+    std::span<vcom_slot> tx_slots;
+    std::size_t tx_bytes{0};
+    StreamBufferHandle_t rx_stream{nullptr};
+};
+
+void vcom_init(const vcom_buffers& buffers, UBaseType_t priority) noexcept;
+[[nodiscard]] std::byte* vcom_reserve(std::size_t size,
+                                      io::deadline until) noexcept;
+void vcom_commit(const std::byte* reserved) noexcept;
+std::size_t vcom_transmit(io::segment_list data, io::deadline until) noexcept;
+std::size_t vcom_receive(std::span<std::byte> data,
+                         io::deadline until) noexcept;
+[[nodiscard]] vcom_rx_stats vcom_stats() noexcept;
+
+}  // namespace detail
+
+/**
+ * USB CDC virtual com port (full speed OTG peripheral) without any heap
+ * usage.  All buffers are static members of the instantiation, the sizes
+ * trade RAM for throughput:
+ *
+ * - `TX_BYTES_V` is the size of one transmit buffer and the largest
+ *   transfer, which also limits the frames `transmit` takes.  The default
+ *   of 1024 bytes (16 packets) keeps the bus busy for almost a whole USB
+ *   frame.
+ * - `TX_BUFFERS_V` buffers are used as a ring, while one is on the wire the
+ *   next one is filled.  More than two absorb larger bursts.
+ * - `RX_BYTES_V` is the receive stream buffer.  The OUT endpoint is only
+ *   armed while a full packet fits in there, otherwise the host gets NAKs
+ *   until `receive` made room, so make it a few packets larger than the
+ *   chunks the application reads at once.
+ *
+ * There is one USB device, so only one instantiation may be initialized.
+ *
+ *   using usb_port = dis::vcom<1024, 1024>;
+ *   usb_port::init(tskIDLE_PRIORITY + 2);
+ *
+ *   usb_port port;
+ *   dis::io::transmit(port, std::as_bytes(std::span{text}));
+ *
+ * Producers do not lock each other out, a producer reserves its bytes
+ * within the open buffer in a short critical section and copies its data
+ * without holding a lock.  Each reservation is contiguous within one
+ * transfer, a buffer goes on the wire once all of its reservations got
+ * committed.  From the reservation to the commit a producer runs with a
+ * raised priority (`DIS_VCOM_WRITER_PRIORITY`, the highest one by default),
+ * so a preempted producer can not hold up the others.
+ */
+template <std::size_t TX_BYTES_V,
+          std::size_t RX_BYTES_V,
+          std::size_t TX_BUFFERS_V = 2>
+class vcom {
+    static_assert(TX_BYTES_V > 0 && TX_BYTES_V <= UINT16_MAX,
+                  "a transmit buffer holds 1 to 65535 bytes");
+    static_assert(TX_BUFFERS_V >= 2, "at least two transmit buffers");
+    static_assert(RX_BYTES_V >= 2 * detail::vcom_packet_size,
+                  "the receive buffer has to hold at least two packets");
+
+public:
+    static constexpr std::size_t tx_bytes   = TX_BYTES_V;
+    static constexpr std::size_t tx_buffers = TX_BUFFERS_V;
+    static constexpr std::size_t rx_bytes   = RX_BYTES_V;
+
+    /**
+     * Starts the USB device and the task which hands the transmit buffers
+     * to the USB stack, it runs with `priority`.
+     */
+    static void init(UBaseType_t priority) noexcept {
+        StreamBufferHandle_t rx = xStreamBufferCreateStatic(
+            RX_BYTES_V, 1, s_rx_data.data(), &s_rx_control);
+        detail::vcom_init({s_tx_data, s_tx_slots, TX_BYTES_V, rx}, priority);
+    }
+
+    /**
+     * Queues `data` as one frame of up to `tx_bytes` within a single
+     * transfer.  Returns the frame size, or 0 if the frame is larger or the
+     * deadline passed while waiting for a free buffer, nothing of it is
+     * queued then.
+     */
+    static std::size_t transmit(
+        io::segment_list data,
+        io::deadline until = io::deadline::never()) noexcept {
+        return detail::vcom_transmit(data, until);
+    }
+
+    /**
+     * Reserves `size` (1 to `tx_bytes`) contiguous bytes within a transmit
+     * buffer to be written in place, nullptr if there was no room in time.
+     * The buffer is not sent before the reservation got committed.  Until
+     * then the calling task runs with a raised priority: write the bytes and
+     * commit right away, without any call which may block.  A task holds one
+     * reservation at a time.
+     */
+    [[nodiscard]] static std::byte* reserve(
+        std::size_t size,
+        io::deadline until = io::deadline::never()) noexcept {
+        if (size == 0 || size > TX_BYTES_V) {
+            return nullptr;
+        }
+        return detail::vcom_reserve(size, until);
+    }
+
+    /// queues all of the reserved bytes and restores the priority of the
+    /// task, exactly once per reservation
+    static void commit(const std::byte* reserved) noexcept {
+        detail::vcom_commit(reserved);
+    }
+
+    /**
+     * Reads up to `data.size()` received bytes, waiting until the deadline
+     * for the first one.  Re-arms the OUT endpoint if it was paused.
+     */
+    static std::size_t receive(
+        std::span<std::byte> data,
+        io::deadline until = io::deadline::never()) noexcept {
+        return detail::vcom_receive(data, until);
+    }
+
+    [[nodiscard]] static vcom_rx_stats rx_stats() noexcept {
+        return detail::vcom_stats();
+    }
+
+private:
+    // the USB FIFO is written word wise
+    alignas(4) static inline std::array<std::byte, TX_BYTES_V * TX_BUFFERS_V>
+        s_tx_data{};
+    static inline std::array<detail::vcom_slot, TX_BUFFERS_V> s_tx_slots{};
+
+    // a static stream buffer needs one byte more than its capacity
+    static inline std::array<std::uint8_t, RX_BYTES_V + 1> s_rx_data{};
+    static inline StaticStreamBuffer_t s_rx_control{};
+};
+
+static_assert(io::transmitter<vcom<1024, 1024>>);
+
+}  // namespace dis
+
+#endif  // DIS_OSAL_IO_VCOM_HPP
@@ -0,0 +1,22 @@
+#ifndef DIS_OSAL_IO_VCOM_HOOKS_H
+#define DIS_OSAL_IO_VCOM_HOOKS_H
+
+/*
+ * Entry points of the CDC interface (Drivers/HandsOnRTOS/usbd_cdc_if.c) into
+ * dis::vcom, see dis/osal/io/vcom.hpp.  Plain C, as is the USB device library.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* called from CDC_Receive_FS for every OUT packet, in the USB interrupt */
+void dis_vcom_rx_complete(const uint8_t* data, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DIS_OSAL_IO_VCOM_HOOKS_H */
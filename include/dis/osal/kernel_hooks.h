@@ -0,0 +1,245 @@
+#ifndef DIS_OSAL_KERNEL_HOOKS_H
+#define DIS_OSAL_KERNEL_HOOKS_H
+
+/*
+ * FreeRTOS trace and run time stats hooks of the dis:: OSAL.
+ *
+ * This header is included at the end of FreeRTOSConfig.h, so the trace
+ * macros below are expanded inside of the kernel sources (tasks.c, queue.c,
+ * stream_buffer.c) and may use kernel internals like pxCurrentTCB.  Only
+ * plain C is allowed here and the FreeRTOS port types are not yet known at
+ * this point.
+ *
+ * - configGENERATE_RUN_TIME_STATS: cycle counter based run time stats,
+ *   see dis/osal/stats/cpu_load.hpp
+ * - DIS_TRACE_RECORDER: binary flight recorder, see
+ *   dis/osal/trace/recorder.hpp
+ */
+
+#include <stdint.h>
+
+#ifndef DIS_TRACE_RECORDER
+#define DIS_TRACE_RECORDER 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+
+void dis_stats_configure_timer(void);
+uint32_t dis_stats_run_time_counter(void);
+
+uint32_t dis_stats_task_created(void* task, const char* name);
+void dis_stats_task_deleted(uint32_t slot);
+void dis_stats_task_switched_in(uint32_t slot);
+void dis_stats_task_switched_out(uint32_t slot, int still_ready);
+void dis_stats_tick(void);
+void dis_stats_isr_enter(void);
+void dis_stats_isr_exit(void);
+
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() dis_stats_configure_timer()
+#define portGET_RUN_TIME_COUNTER_VALUE() dis_stats_run_time_counter()
+
+#define DIS_STATS_HOOK(call) call
+#else
+#define DIS_STATS_HOOK(call)
+#endif /* (configGENERATE_RUN_TIME_STATS == 1) */
+
+#if (DIS_TRACE_RECORDER == 1)
+
+void dis_trace_event(uint8_t type, uint32_t id);
+void dis_trace_task_created(uint32_t task_number, const char* name);
+uint32_t dis_trace_object_created(uint8_t kind);
+void dis_trace_object_named(uint32_t object_number,
+                            uint8_t kind,
+                            const char* name);
+void dis_trace_isr_enter(void);
+void dis_trace_isr_exit(void);
+
+/* values of dis::trace::event_type, see dis/osal/trace/format.hpp */
+#define DIS_TRACE_TASK_SWITCHED_IN 1
+#define DIS_TRACE_TASK_DELETE 3
+#define DIS_TRACE_TASK_DELAY 4
+#define DIS_TRACE_TASK_SUSPEND 5
+#define DIS_TRACE_TASK_RESUME 6
+#define DIS_TRACE_TASK_READY 7
+#define DIS_TRACE_TASK_NOTIFY 8
+#define DIS_TRACE_TASK_NOTIFY_TAKE 9
+#define DIS_TRACE_TASK_NOTIFY_BLOCK 10
+#define DIS_TRACE_OBJECT_DELETE 65
+#define DIS_TRACE_QUEUE_SEND 66
+#define DIS_TRACE_QUEUE_SEND_FAILED 67
+#define DIS_TRACE_QUEUE_SEND_FROM_ISR 68
+#define DIS_TRACE_QUEUE_RECEIVE 69
+#define DIS_TRACE_QUEUE_RECEIVE_FAILED 70
+#define DIS_TRACE_QUEUE_RECEIVE_FROM_ISR 71
+#define DIS_TRACE_QUEUE_BLOCK_SEND 72
+#define DIS_TRACE_QUEUE_BLOCK_RECEIVE 73
+#define DIS_TRACE_STREAM_SEND 74
+#define DIS_TRACE_STREAM_SEND_FROM_ISR 75
+#define DIS_TRACE_STREAM_RECEIVE 76
+#define DIS_TRACE_STREAM_RECEIVE_FROM_ISR 77
+#define DIS_TRACE_STREAM_BLOCK_SEND 78
+#define DIS_TRACE_STREAM_BLOCK_RECEIVE 79
+
+/* values of dis::trace::object_kind */
+#define DIS_TRACE_KIND_QUEUE 1
+#define DIS_TRACE_KIND_STREAM_BUFFER 6
+
+#define DIS_TRACE_HOOK(call) call
+#else
+#define DIS_TRACE_HOOK(call)
+#endif /* (DIS_TRACE_RECORDER == 1) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#if (configGENERATE_RUN_TIME_STATS == 1) || (DIS_TRACE_RECORDER == 1)
+
+/* uxTaskNumber is reserved for third party trace code, the stats keep the
+ * index of the task slot in there */
+#define traceTASK_CREATE(pxNewTCB)                                      \
+    do {                                                                \
+        DIS_STATS_HOOK((pxNewTCB)->uxTaskNumber = dis_stats_task_created( \
+                           (void*)(pxNewTCB),                           \
+                           (const char*)(pxNewTCB)->pcTaskName));       \
+        DIS_TRACE_HOOK(dis_trace_task_created(                          \
+            (pxNewTCB)->uxTCBNumber, (const char*)(pxNewTCB)->pcTaskName)); \
+    } while (0)
+
+#define traceTASK_DELETE(pxTCB)                                        \
+    do {                                                               \
+        DIS_STATS_HOOK(dis_stats_task_deleted((pxTCB)->uxTaskNumber)); \
+        DIS_TRACE_HOOK(dis_trace_event(DIS_TRACE_TASK_DELETE,          \
+                                       (pxTCB)->uxTCBNumber));         \
+    } while (0)
+
+#define traceTASK_SWITCHED_IN()                                              \
+    do {                                                                     \
+        DIS_STATS_HOOK(dis_stats_task_switched_in(pxCurrentTCB->uxTaskNumber)); \
+        DIS_TRACE_HOOK(dis_trace_event(DIS_TRACE_TASK_SWITCHED_IN,           \
+                                       pxCurrentTCB->uxTCBNumber));          \
+    } while (0)
+
+/* a running task stays in its ready list, if it is not in there anymore it
+ * blocked or suspended itself, otherwise it got preempted (or yielded) */
+#define traceTASK_SWITCHED_OUT()                                         \
+    DIS_STATS_HOOK(dis_stats_task_switched_out(                          \
+        pxCurrentTCB->uxTaskNumber,                                      \
+        listIS_CONTAINED_WITHIN(                                         \
+            &(pxReadyTasksLists[pxCurrentTCB->uxPriority]),              \
+            &(pxCurrentTCB->xStateListItem))))
+
+#endif
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+
+#define traceTASK_INCREMENT_TICK(xTickCount) dis_stats_tick()
+
+#endif /* (configGENERATE_RUN_TIME_STATS == 1) */
+
+#if (DIS_TRACE_RECORDER == 1)
+
+#define traceTASK_DELAY() \
+    dis_trace_event(DIS_TRACE_TASK_DELAY, pxCurrentTCB->uxTCBNumber)
+#define traceTASK_DELAY_UNTIL(xTimeToWake) \
+    dis_trace_event(DIS_TRACE_TASK_DELAY, pxCurrentTCB->uxTCBNumber)
+#define traceTASK_SUSPEND(pxTCB) \
+    dis_trace_event(DIS_TRACE_TASK_SUSPEND, (pxTCB)->uxTCBNumber)
+#define traceTASK_RESUME(pxTCB) \
+    dis_trace_event(DIS_TRACE_TASK_RESUME, (pxTCB)->uxTCBNumber)
+#define traceTASK_RESUME_FROM_ISR(pxTCB) \
+    dis_trace_event(DIS_TRACE_TASK_RESUME, (pxTCB)->uxTCBNumber)
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB) \
+    dis_trace_event(DIS_TRACE_TASK_READY, (pxTCB)->uxTCBNumber)
+
+/* pxTCB is the notified task */
+#define traceTASK_NOTIFY() \
+    dis_trace_event(DIS_TRACE_TASK_NOTIFY, pxTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_FROM_ISR() \
+    dis_trace_event(DIS_TRACE_TASK_NOTIFY, pxTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR() \
+    dis_trace_event(DIS_TRACE_TASK_NOTIFY, pxTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_TAKE() \
+    dis_trace_event(DIS_TRACE_TASK_NOTIFY_TAKE, pxCurrentTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_WAIT() \
+    dis_trace_event(DIS_TRACE_TASK_NOTIFY_TAKE, pxCurrentTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_TAKE_BLOCK() \
+    dis_trace_event(DIS_TRACE_TASK_NOTIFY_BLOCK, pxCurrentTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_WAIT_BLOCK() \
+    dis_trace_event(DIS_TRACE_TASK_NOTIFY_BLOCK, pxCurrentTCB->uxTCBNumber)
+
+/* queues, semaphores and mutexes; the kind follows from ucQueueType */
+#define traceQUEUE_CREATE(pxNewQueue)                       \
+    (pxNewQueue)->uxQueueNumber = dis_trace_object_created( \
+        (uint8_t)(DIS_TRACE_KIND_QUEUE + (pxNewQueue)->ucQueueType))
+#define traceQUEUE_DELETE(pxQueue) \
+    dis_trace_event(DIS_TRACE_OBJECT_DELETE, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_REGISTRY_ADD(xQueue, pcQueueName)                        \
+    dis_trace_object_named(                                                 \
+        ((Queue_t*)(xQueue))->uxQueueNumber,                                \
+        (uint8_t)(DIS_TRACE_KIND_QUEUE + ((Queue_t*)(xQueue))->ucQueueType), \
+        (pcQueueName))
+#define traceQUEUE_SEND(pxQueue) \
+    dis_trace_event(DIS_TRACE_QUEUE_SEND, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_SEND_FAILED(pxQueue) \
+    dis_trace_event(DIS_TRACE_QUEUE_SEND_FAILED, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) \
+    dis_trace_event(DIS_TRACE_QUEUE_SEND_FROM_ISR, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_RECEIVE(pxQueue) \
+    dis_trace_event(DIS_TRACE_QUEUE_RECEIVE, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue) \
+    dis_trace_event(DIS_TRACE_QUEUE_RECEIVE_FAILED, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)       \
+    dis_trace_event(DIS_TRACE_QUEUE_RECEIVE_FROM_ISR, \
+                    (pxQueue)->uxQueueNumber)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) \
+    dis_trace_event(DIS_TRACE_QUEUE_BLOCK_SEND, (pxQueue)->uxQueueNumber)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) \
+    dis_trace_event(DIS_TRACE_QUEUE_BLOCK_RECEIVE, (pxQueue)->uxQueueNumber)
+
+/* stream and message buffers */
+#define traceSTREAM_BUFFER_CREATE(pxStreamBuffer, xIsMessageBuffer) \
+    (pxStreamBuffer)->uxStreamBufferNumber = dis_trace_object_created( \
+        (uint8_t)(DIS_TRACE_KIND_STREAM_BUFFER + ((xIsMessageBuffer) ? 1 : 0)))
+#define traceSTREAM_BUFFER_DELETE(xStreamBuffer) \
+    dis_trace_event(DIS_TRACE_OBJECT_DELETE,      \
+                    (xStreamBuffer)->uxStreamBufferNumber)
+#define traceSTREAM_BUFFER_SEND(xStreamBuffer, xBytesSent) \
+    dis_trace_event(DIS_TRACE_STREAM_SEND,                 \
+                    (xStreamBuffer)->uxStreamBufferNumber)
+#define traceSTREAM_BUFFER_SEND_FROM_ISR(xStreamBuffer, xBytesSent) \
+    dis_trace_event(DIS_TRACE_STREAM_SEND_FROM_ISR,                 \
+                    (xStreamBuffer)->uxStreamBufferNumber)
+#define traceSTREAM_BUFFER_RECEIVE(xStreamBuffer, xReceivedLength) \
+    dis_trace_event(DIS_TRACE_STREAM_RECEIVE,                      \
+                    (xStreamBuffer)->uxStreamBufferNumber)
+#define traceSTREAM_BUFFER_RECEIVE_FROM_ISR(xStreamBuffer, xReceivedLength) \
+    dis_trace_event(DIS_TRACE_STREAM_RECEIVE_FROM_ISR,                      \
+                    (xStreamBuffer)->uxStreamBufferNumber)
+#define traceBLOCKING_ON_STREAM_BUFFER_SEND(xStreamBuffer) \
+    dis_trace_event(DIS_TRACE_STREAM_BLOCK_SEND,           \
+                    (xStreamBuffer)->uxStreamBufferNumber)
+#define traceBLOCKING_ON_STREAM_BUFFER_RECEIVE(xStreamBuffer) \
+    dis_trace_event(DIS_TRACE_STREAM_BLOCK_RECEIVE,           \
+                    (xStreamBuffer)->uxStreamBufferNumber)
+
+#endif /* (DIS_TRACE_RECORDER == 1) */
+
+/* mark interrupt handlers for the ISR accounting/tracing */
+#define DIS_ISR_ENTER()                        \
+    do {                                       \
+        DIS_STATS_HOOK(dis_stats_isr_enter()); \
+        DIS_TRACE_HOOK(dis_trace_isr_enter()); \
+    } while (0)
+
+#define DIS_ISR_EXIT()                        \
+    do {                                      \
+        DIS_TRACE_HOOK(dis_trace_isr_exit()); \
+        DIS_STATS_HOOK(dis_stats_isr_exit()); \
+    } while (0)
+
+#endif /* DIS_OSAL_KERNEL_HOOKS_H */
@@ -0,0 +1,104 @@
+#ifndef DIS_OSAL_LOG_FORMAT_HPP
+#define DIS_OSAL_LOG_FORMAT_HPP
+
+// NOTE: this header is shared with the host tools (tools/log_decode), it
+// must not depend on FreeRTOS or the HAL.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dis::log {
+
+enum class level : std::uint8_t {
+    error = 1,
+    warning,
+    info,
+    debug,
+};
+
+/**
+ * Every log statement has a site description, which the linker collects
+ * from the input sections starting with site_input_section.  On the target
+ * the linker script places them in elf_site_section at address 0 and does
+ * not load it (INFO), the address of a description is the 16 bit id written
+ * to the ring.  The host build keeps them in site_section, the id is the
+ * offset from __start_dis_log_sites.  Either way the id is the offset of the
+ * description within its output section.
+ *
+ * A description consists of four NUL terminated strings:
+ *   <level digit><argument codes>, file, line, format
+ * with one code per argument:
+ *   b bool, c char, i int32, u uint32, I int64, U uint64, f float,
+ *   d double, s const char* (read from the ELF), p pointer
+ * Arguments are packed into 32 bit words, 64 bit values and host pointers
+ * take two words (low word first).  Replacement fields of the format are
+ * `{}` or `{:SPEC}` with SPEC = [0][WIDTH][.PRECISION][TYPE], `{{` and `}}`
+ * are literal braces.
+ */
+inline constexpr const char* site_input_section =
+    ".rodata._ZN3dis6detail8log_site";
+inline constexpr const char* site_section       = "dis_log_sites";
+inline constexpr const char* elf_site_section   = ".dis_log";
+inline constexpr std::size_t max_argument_words = 255;
+
+enum class slot_kind : std::uint8_t {
+    empty = 0,
+    head,
+    continuation,
+};
+
+/// a record takes one head slot followed by continuation slots for the
+/// argument words which do not fit into the head
+struct slot {
+    slot_kind kind;
+    /// argument words of the whole record (head slots only)
+    std::uint8_t words;
+    /// site id (head slots only)
+    std::uint16_t id;
+    /// head: timestamp (low word of the cycle counter) and argument words 0
+    /// and 1, continuation: three argument words
+    std::uint32_t data[3];
+};
+static_assert(sizeof(slot) == 16);
+
+inline constexpr std::size_t head_words         = 2;
+inline constexpr std::size_t continuation_words = 3;
+
+[[nodiscard]] constexpr std::size_t slots_for(std::size_t words) noexcept {
+    return words <= head_words ? 1
+                               : 1 + (words - head_words + continuation_words -
+                                      1) / continuation_words;
+}
+
+inline constexpr std::uint32_t dump_magic   = 0x474F4C44;  // "DLOG"
+inline constexpr std::uint16_t dump_version = 1;
+
+/**
+ * Layout of the log memory.  The header is followed by slot_capacity slots
+ * which are written round-robin: the oldest slot is at
+ * slots_written % slot_capacity once the ring wrapped, leading continuation
+ * slots belong to an overwritten record.
+ */
+struct dump_header {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t slot_size;
+    std::uint32_t cpu_hz;
+    std::uint32_t slot_capacity;
+    std::uint32_t slots_written;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(dump_header) == 24);
+
+template <std::size_t SLOTS_V>
+struct log_memory {
+    static_assert((SLOTS_V & (SLOTS_V - 1)) == 0,
+                  "slot capacity must be a power of two");
+
+    dump_header header;
+    slot slots[SLOTS_V];
+};
+
+}  // namespace dis::log
+
+#endif  // DIS_OSAL_LOG_FORMAT_HPP
@@ -0,0 +1,328 @@
+#ifndef DIS_OSAL_LOG_LOG_HPP
+#define DIS_OSAL_LOG_LOG_HPP
+
+#include "dis/osal/log/format.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+// Statements with a level above DIS_LOG_LEVEL are compiled out (their
+// arguments are still checked), 0 disables logging completely.
+#ifndef DIS_LOG_LEVEL
+#define DIS_LOG_LEVEL 3
+#endif
+
+#ifndef DIS_LOG_SLOTS
+#define DIS_LOG_SLOTS 256
+#endif
+
+namespace dis::log {
+
+/// number of slots kept in the ring (16 bytes each)
+inline constexpr std::size_t slot_capacity = DIS_LOG_SLOTS;
+inline constexpr unsigned level_value      = DIS_LOG_LEVEL;
+
+using memory_type = log_memory<slot_capacity>;
+
+/**
+ * Deferred binary logging.  A statement writes the id of its site
+ * description and the raw argument words into a lock-free ring in RAM, the
+ * text is only put together on the host by tools/log_decode with the help of
+ * the ELF file.  The oldest records get overwritten, logging is enabled from
+ * the start.
+ */
+void start() noexcept;
+void stop() noexcept;
+[[nodiscard]] bool is_running() noexcept;
+
+/**
+ * Raw log memory, laid out as described in dis/osal/log/format.hpp.  Stop
+ * logging before exporting it.  The same memory can be dumped with a
+ * debugger:  dump binary memory log.bin &dis_log_memory (&dis_log_memory + 1)
+ */
+[[nodiscard]] std::span<const std::byte> dump() noexcept;
+
+}  // namespace dis::log
+
+namespace dis::detail {
+
+/// string literal as template argument
+template <std::size_t SIZE_V>
+struct log_string {
+    char value[SIZE_V]{};
+
+    constexpr log_string(const char (&str)[SIZE_V]) noexcept {
+        std::copy_n(str, SIZE_V, value);
+    }
+
+    [[nodiscard]] static constexpr std::size_t size() noexcept {
+        return SIZE_V - 1;
+    }
+};
+
+[[nodiscard]] constexpr bool log_is_digit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+
+/// number of replacement fields, -1 if the format is broken
+[[nodiscard]] constexpr int log_count_fields(const char* fmt,
+                                             std::size_t size) noexcept {
+    constexpr std::string_view types = "bcdefgopsuxEGX";
+    int fields                       = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (fmt[i] == '}') {
+            if (i + 1 >= size || fmt[i + 1] != '}') {
+                return -1;
+            }
+            ++i;
+            continue;
+        }
+        if (fmt[i] != '{') {
+            continue;
+        }
+        if (i + 1 < size && fmt[i + 1] == '{') {
+            ++i;
+            continue;
+        }
+
+        // {} or {:[0][WIDTH][.PRECISION][TYPE]}
+        std::size_t pos = i + 1;
+        if (pos < size && fmt[pos] == ':') {
+            ++pos;
+            while (pos < size && log_is_digit(fmt[pos])) {
+                ++pos;
+            }
+            if (pos < size && fmt[pos] == '.') {
+                ++pos;
+                if (pos >= size || !log_is_digit(fmt[pos])) {
+                    return -1;
+                }
+                while (pos < size && log_is_digit(fmt[pos])) {
+                    ++pos;
+                }
+            }
+            if (pos < size && types.find(fmt[pos]) != std::string_view::npos) {
+                ++pos;
+            }
+        }
+        if (pos >= size || fmt[pos] != '}') {
+            return -1;
+        }
+        ++fields;
+        i = pos;
+    }
+    return fields;
+}
+
+template <class>
+inline constexpr bool log_unsupported_v = false;
+
+/// argument code of format.hpp
+template <class ARG_T>
+[[nodiscard]] constexpr char log_code() noexcept {
+    using value_type = std::decay_t<ARG_T>;
+    if constexpr (std::is_enum_v<value_type>) {
+        return log_code<std::underlying_type_t<value_type>>();
+    } else if constexpr (std::is_same_v<value_type, bool>) {
+        return 'b';
+    } else if constexpr (std::is_same_v<value_type, char>) {
+        return 'c';
+    } else if constexpr (std::is_integral_v<value_type> &&
+                         sizeof(value_type) <= sizeof(std::uint32_t)) {
+        return std::is_signed_v<value_type> ? 'i' : 'u';
+    } else if constexpr (std::is_integral_v<value_type> &&
+                         sizeof(value_type) == sizeof(std::uint64_t)) {
+        return std::is_signed_v<value_type> ? 'I' : 'U';
+    } else if constexpr (std::is_same_v<value_type, float>) {
+        return 'f';
+    } else if constexpr (std::is_same_v<value_type, double>) {
+        return 'd';
+    } else if constexpr (std::is_same_v<value_type, const char*> ||
+                         std::is_same_v<value_type, char*>) {
+        return 's';
+    } else if constexpr (std::is_pointer_v<value_type>) {
+        return 'p';
+    } else {
+        static_assert(log_unsupported_v<ARG_T>,
+                      "unsupported dis::log argument type");
+        return '\0';
+    }
+}
+
+/// number of 32 bit words of an argument
+template <class ARG_T>
+[[nodiscard]] constexpr std::size_t log_words() noexcept {
+    switch (log_code<ARG_T>()) {
+        case 'I':
+        case 'U':
+        case 'd':
+            return 2;
+        case 's':
+        case 'p':
+            return sizeof(void*) / sizeof(std::uint32_t);
+        default:
+            return 1;
+    }
+}
+
+template <class ARG_T>
+inline void log_pack(std::uint32_t*& out, const ARG_T& arg) noexcept {
+    using value_type = std::decay_t<ARG_T>;
+    if constexpr (std::is_enum_v<value_type>) {
+        log_pack(out, static_cast<std::underlying_type_t<value_type>>(arg));
+    } else if constexpr (std::is_pointer_v<value_type>) {
+        auto value = reinterpret_cast<std::uintptr_t>(arg);
+        for (std::size_t i = 0; i < log_words<ARG_T>(); ++i) {
+            *out++ = static_cast<std::uint32_t>(value);
+            value  = value >> 16 >> 16;
+        }
+    } else if constexpr (std::is_floating_point_v<value_type>) {
+        if constexpr (sizeof(value_type) == sizeof(std::uint32_t)) {
+            *out++ = std::bit_cast<std::uint32_t>(arg);
+        } else {
+            const auto value = std::bit_cast<std::uint64_t>(arg);
+            *out++           = static_cast<std::uint32_t>(value);
+            *out++           = static_cast<std::uint32_t>(value >> 32);
+        }
+    } else if constexpr (log_words<ARG_T>() == 2) {
+        const auto value = static_cast<std::uint64_t>(arg);
+        *out++           = static_cast<std::uint32_t>(value);
+        *out++           = static_cast<std::uint32_t>(value >> 32);
+    } else {
+        // sign extended, so the decoder may read narrow types as 32 bit
+        *out++ = static_cast<std::uint32_t>(arg);
+    }
+}
+
+[[nodiscard]] constexpr std::size_t log_digits(unsigned value) noexcept {
+    std::size_t digits = 1;
+    while (value >= 10) {
+        value /= 10;
+        ++digits;
+    }
+    return digits;
+}
+
+/**
+ * Site description of one log statement (see dis/osal/log/format.hpp).  The
+ * code only takes its address, the linker moves the description into the
+ * site section by the name of its (COMDAT) input section, as a section
+ * attribute is ignored for members of templates.
+ */
+template <::dis::log::level LEVEL_V,
+          log_string FILE_V,
+          unsigned LINE_V,
+          log_string FORMAT_V,
+          class... ARG_Ts>
+struct log_site {
+    static constexpr std::size_t size = 1 + sizeof...(ARG_Ts) + 1 +
+                                        FILE_V.size() + 1 +
+                                        log_digits(LINE_V) + 1 +
+                                        FORMAT_V.size() + 1;
+
+    [[nodiscard]] static constexpr std::array<char, size> make() noexcept {
+        std::array<char, size> result{};
+        std::size_t pos = 0;
+        result[pos++]   = static_cast<char>('0' + static_cast<int>(LEVEL_V));
+        ((result[pos++] = log_code<ARG_Ts>()), ...);
+        result[pos++] = '\0';
+        for (std::size_t i = 0; i < FILE_V.size(); ++i) {
+            result[pos++] = FILE_V.value[i];
+        }
+        result[pos++] = '\0';
+        const std::size_t digits = log_digits(LINE_V);
+        for (std::size_t i = 0, line = LINE_V; i < digits; ++i, line /= 10) {
+            result[pos + digits - 1 - i] = static_cast<char>('0' + line % 10);
+        }
+        pos += digits;
+        result[pos++] = '\0';
+        for (std::size_t i = 0; i < FORMAT_V.size(); ++i) {
+            result[pos++] = FORMAT_V.value[i];
+        }
+        result[pos] = '\0';
+        return result;
+    }
+
+    // packed, so the ids do not waste the 16 bit space on padding
+    alignas(1) static constexpr std::array<char, size> description = make();
+};
+
+/// reserves the slots and copies the record, safe to call from interrupts
+void log_commit(const char* site,
+                const std::uint32_t* words,
+                std::size_t count) noexcept;
+
+template <::dis::log::level LEVEL_V, log_string FORMAT_V, class... ARG_Ts>
+constexpr void log_check() noexcept {
+    constexpr int fields = log_count_fields(FORMAT_V.value, FORMAT_V.size());
+    static_assert(fields >= 0, "broken dis::log format string");
+    static_assert(fields == sizeof...(ARG_Ts),
+                  "number of dis::log arguments does not match the format");
+    static_assert((log_words<ARG_Ts>() + ... + 0) <=
+                  ::dis::log::max_argument_words);
+    static_assert(LEVEL_V >= ::dis::log::level::error &&
+                  LEVEL_V <= ::dis::log::level::debug);
+}
+
+// enabled
+template <::dis::log::level LEVEL_V,
+          log_string FILE_V,
+          unsigned LINE_V,
+          log_string FORMAT_V,
+          class... ARG_Ts>
+    requires(static_cast<unsigned>(LEVEL_V) <= ::dis::log::level_value)
+inline void log_write(const ARG_Ts&... args) noexcept {
+    log_check<LEVEL_V, FORMAT_V, ARG_Ts...>();
+    using site = log_site<LEVEL_V, FILE_V, LINE_V, FORMAT_V,
+                          std::decay_t<ARG_Ts>...>;
+
+    constexpr std::size_t words = (log_words<ARG_Ts>() + ... + 0);
+    if constexpr (words == 0) {
+        log_commit(site::description.data(), nullptr, 0);
+    } else {
+        std::array<std::uint32_t, words> packed;
+        std::uint32_t* out = packed.data();
+        (log_pack(out, args), ...);
+        log_commit(site::description.data(), packed.data(), words);
+    }
+}
+
+// disabled
+template <::dis::log::level LEVEL_V,
+          log_string FILE_V,
+          unsigned LINE_V,
+          log_string FORMAT_V,
+          class... ARG_Ts>
+    requires(static_cast<unsigned>(LEVEL_V) > ::dis::log::level_value)
+inline void log_write(const ARG_Ts&...) noexcept {
+    log_check<LEVEL_V, FORMAT_V, ARG_Ts...>();
+}
+
+}  // namespace dis::detail
+
+/**
+ * Logs a message, the arguments are stored as they are:
+ *   DIS_LOG_INFO("usb tx of {} bytes took {} cycles", size, cycles);
+ *   DIS_LOG_WARN("adc {:.2f} V out of range", volts);
+ * The format must be a string literal, see dis/osal/log/format.hpp for the
+ * replacement fields.  Safe to call from tasks and interrupts.
+ */
+#define DIS_LOG(Level, Format, ...)                                        \
+    ::dis::detail::log_write<Level, __FILE__, __LINE__, Format>(__VA_ARGS__)
+
+#define DIS_LOG_ERROR(Format, ...) \
+    DIS_LOG(::dis::log::level::error, Format __VA_OPT__(, ) __VA_ARGS__)
+#define DIS_LOG_WARN(Format, ...) \
+    DIS_LOG(::dis::log::level::warning, Format __VA_OPT__(, ) __VA_ARGS__)
+#define DIS_LOG_INFO(Format, ...) \
+    DIS_LOG(::dis::log::level::info, Format __VA_OPT__(, ) __VA_ARGS__)
+#define DIS_LOG_DEBUG(Format, ...) \
+    DIS_LOG(::dis::log::level::debug, Format __VA_OPT__(, ) __VA_ARGS__)
+
+#endif  // DIS_OSAL_LOG_LOG_HPP
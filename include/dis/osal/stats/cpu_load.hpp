@@ -0,0 +1,96 @@
+#ifndef DIS_OSAL_STATS_CPU_LOAD_HPP
+#define DIS_OSAL_STATS_CPU_LOAD_HPP
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef DIS_STATS_MAX_TASKS
+#define DIS_STATS_MAX_TASKS 16
+#endif
+
+#ifndef DIS_STATS_WINDOW_TICKS
+#define DIS_STATS_WINDOW_TICKS 100
+#endif
+
+#ifndef DIS_STATS_WINDOW_COUNT
+#define DIS_STATS_WINDOW_COUNT 10
+#endif
+
+namespace dis::stats {
+
+/// number of tasks which can be tracked, later tasks are not accounted
+inline constexpr std::size_t max_tasks = DIS_STATS_MAX_TASKS;
+/// length of one sampling window
+inline constexpr TickType_t window_ticks = DIS_STATS_WINDOW_TICKS;
+/// number of windows kept, cpu_load() can look back window_count - 1 windows
+inline constexpr std::size_t window_count = DIS_STATS_WINDOW_COUNT;
+
+struct task_load {
+    TaskHandle_t handle{nullptr};
+    const char* name{nullptr};
+    std::uint64_t cycles{0};
+    /// share of the observed time in 1/1000
+    std::uint32_t permille{0};
+    /// switched out because the task blocked, delayed or suspended itself
+    std::uint32_t voluntary_switches{0};
+    /// switched out while still ready (preempted or yielded)
+    std::uint32_t preemptions{0};
+};
+
+struct cpu_load_report {
+    std::uint64_t window_cycles{0};
+    std::uint64_t isr_cycles{0};
+    std::uint32_t isr_permille{0};
+    std::size_t task_count{0};
+    std::array<task_load, max_tasks> tasks{};
+};
+
+/**
+ * Per task and interrupt utilization over the last `windows` sampling
+ * windows (each window_ticks long).  Only integer arithmetic is used, no
+ * formatting takes place.  Tasks created after the last sample are reported
+ * from the moment they got created.
+ *
+ * ISR time is only known for handlers instrumented with DIS_ISR_ENTER() and
+ * DIS_ISR_EXIT() and is not accounted to the interrupted task.
+ *
+ * NOTE: must not be called from an interrupt, the report is returned by
+ *       value and has about max_tasks * 40 bytes, so keep it off small stacks
+ */
+[[nodiscard]] cpu_load_report cpu_load(std::size_t windows = 1) noexcept;
+
+/// accounting state at one point in time, see cpu_load_since()
+struct cpu_load_mark {
+    std::uint64_t timestamp{0};
+    std::uint64_t isr_cycles{0};
+    std::array<TaskHandle_t, max_tasks> handles{};
+    std::array<std::uint64_t, max_tasks> cycles{};
+    std::array<std::uint32_t, max_tasks> voluntary{};
+    std::array<std::uint32_t, max_tasks> preempted{};
+};
+
+/**
+ * Utilization from `begin` (taken with mark_cpu_load()) until now, for
+ * intervals which do not line up with the sampling windows or are longer
+ * than the history, e.g. one benchmark run:
+ *
+ *   const auto begin = dis::stats::mark_cpu_load();
+ *   run();
+ *   const auto report = dis::stats::cpu_load_since(begin);
+ *
+ * The 64 bit cycle counts do not wrap, so the interval may be of any length.
+ *
+ * NOTE: same restrictions as cpu_load(), a mark has about max_tasks * 20
+ *       bytes
+ */
+[[nodiscard]] cpu_load_mark mark_cpu_load() noexcept;
+[[nodiscard]] cpu_load_report cpu_load_since(
+    const cpu_load_mark& begin) noexcept;
+
+}  // namespace dis::stats
+
+#endif  // DIS_OSAL_STATS_CPU_LOAD_HPP
@@ -0,0 +1,194 @@
+#ifndef DIS_OSAL_STATS_PROFILE_HPP
+#define DIS_OSAL_STATS_PROFILE_HPP
+
+#include "dis/osal/utils/cycle_counter.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+// Sites with a level above DIS_PROFILE_LEVEL are compiled out, with 0 the
+// macros expand to nothing.
+#ifndef DIS_PROFILE_LEVEL
+#define DIS_PROFILE_LEVEL 0
+#endif
+
+namespace dis::stats {
+template <unsigned LEVEL_V>
+using profile_level = ::std::integral_constant<unsigned, LEVEL_V>;
+
+inline constexpr unsigned profile_level_value = DIS_PROFILE_LEVEL;
+
+enum class profile_kind : std::uint8_t {
+    scope,    ///< samples are durations in cycles
+    counter,  ///< samples are user values
+};
+
+/**
+ * Statistics of one instrumentation site.  Sites are constant initialized
+ * statics which the linker collects in the dis_profile_sites section, there
+ * is no registration at run time.
+ */
+struct profile_site {
+    /// bucket i counts the samples with std::bit_width(sample) == i, the last
+    /// bucket takes everything above
+    static constexpr std::size_t bucket_count = 32;
+
+    const char* name;
+    profile_kind kind;
+    std::uint32_t count{0};
+    std::uint32_t min{std::numeric_limits<std::uint32_t>::max()};
+    std::uint32_t max{0};
+    std::uint64_t sum{0};
+    std::array<std::uint32_t, bucket_count> histogram{};
+
+    constexpr profile_site(const char* site_name, profile_kind site_kind)
+        : name(site_name), kind(site_kind) {}
+
+    profile_site(const profile_site&)            = delete;
+    profile_site& operator=(const profile_site&) = delete;
+
+    /// safe to call from tasks and interrupts
+    void record(std::uint32_t sample) noexcept {
+        const std::size_t bucket =
+            std::min<std::size_t>(std::bit_width(sample), bucket_count - 1);
+
+        const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        ++count;
+        sum += sample;
+        min = sample < min ? sample : min;
+        max = sample > max ? sample : max;
+        ++histogram[bucket];
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    }
+
+    [[nodiscard]] std::uint32_t mean() const noexcept {
+        return count == 0 ? 0 : static_cast<std::uint32_t>(sum / count);
+    }
+
+    void reset() noexcept {
+        const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        count = 0;
+        min   = std::numeric_limits<std::uint32_t>::max();
+        max   = 0;
+        sum   = 0;
+        histogram.fill(0);
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    }
+};
+
+/// all sites which are compiled in, in link order
+[[nodiscard]] std::span<profile_site> profile_sites() noexcept;
+void profile_reset() noexcept;
+
+/// measures the cycles between construction and destruction
+class profile_scope {
+public:
+    explicit profile_scope(profile_site& site) noexcept
+        : m_site(site), m_start(this_cpu::cycles()) {}
+    ~profile_scope() noexcept { m_site.record(this_cpu::cycles() - m_start); }
+
+    profile_scope(const profile_scope&)            = delete;
+    profile_scope& operator=(const profile_scope&) = delete;
+
+private:
+    profile_site& m_site;
+    std::uint32_t m_start;
+};
+
+}  // namespace dis::stats
+
+namespace dis::detail {
+struct null_profile_scope {};
+
+// a site above the level never calls the lambda returning its profile_site, so
+// it records nothing and an optimized build drops it.  Unoptimized builds may
+// keep the unused site in the section, the counter value is still evaluated.
+template <class SITE_FN_T, unsigned LEVEL_V>
+    requires(LEVEL_V <= ::dis::stats::profile_level_value)
+[[nodiscard]] inline ::dis::stats::profile_scope make_profile_scope(
+    SITE_FN_T site_fn, ::dis::stats::profile_level<LEVEL_V>) noexcept {
+    static_assert(LEVEL_V > 0, "level of a profile site must not be 0");
+    return ::dis::stats::profile_scope{site_fn()};
+}
+
+template <class SITE_FN_T, unsigned LEVEL_V>
+    requires(LEVEL_V > ::dis::stats::profile_level_value)
+[[nodiscard]] inline null_profile_scope make_profile_scope(
+    SITE_FN_T, ::dis::stats::profile_level<LEVEL_V>) noexcept {
+    return {};
+}
+
+template <class SITE_FN_T>
+[[nodiscard]] inline auto make_profile_scope(SITE_FN_T site_fn) noexcept {
+    return make_profile_scope(site_fn, ::dis::stats::profile_level<1>{});
+}
+
+template <class SITE_FN_T, unsigned LEVEL_V>
+    requires(LEVEL_V <= ::dis::stats::profile_level_value)
+inline void profile_count(SITE_FN_T site_fn,
+                          std::uint32_t value,
+                          ::dis::stats::profile_level<LEVEL_V>) noexcept {
+    static_assert(LEVEL_V > 0, "level of a profile site must not be 0");
+    site_fn().record(value);
+}
+
+template <class SITE_FN_T, unsigned LEVEL_V>
+    requires(LEVEL_V > ::dis::stats::profile_level_value)
+inline void profile_count(SITE_FN_T,
+                          std::uint32_t,
+                          ::dis::stats::profile_level<LEVEL_V>) noexcept {}
+
+template <class SITE_FN_T>
+inline void profile_count(SITE_FN_T site_fn, std::uint32_t value) noexcept {
+    profile_count(site_fn, value, ::dis::stats::profile_level<1>{});
+}
+
+}  // namespace dis::detail
+
+#define DIS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define DIS_PROFILE_CONCAT(a, b) DIS_PROFILE_CONCAT_IMPL(a, b)
+
+#define DIS_PROFILE_SITE(Name, Kind)                                       \
+    []() noexcept -> ::dis::stats::profile_site& {                         \
+        [[gnu::section("dis_profile_sites")]] static constinit             \
+            ::dis::stats::profile_site site{Name, ::dis::stats::Kind};     \
+        return site;                                                       \
+    }
+
+#if DIS_PROFILE_LEVEL == 0
+
+// without profiling the arguments are not even evaluated
+#define DIS_PROFILE_SCOPE(Name, ...)
+#define DIS_PROFILE_COUNTER(Name, Value, ...) static_cast<void>(0)
+
+#else
+
+/**
+ * Measures the cycles until the end of the enclosing scope:
+ *   DIS_PROFILE_SCOPE("vcom_tx_copy");
+ *   DIS_PROFILE_SCOPE("control_loop", dis::stats::profile_level<2>{});
+ * The cycle counter has to be enabled (done by the run time stats).
+ */
+#define DIS_PROFILE_SCOPE(Name, ...)                                          \
+    [[maybe_unused]] const auto DIS_PROFILE_CONCAT(dis_profile_scope_,       \
+                                                   __LINE__) =               \
+        ::dis::detail::make_profile_scope(                                    \
+            DIS_PROFILE_SITE(Name, profile_kind::scope) __VA_OPT__(, )        \
+                __VA_ARGS__)
+
+/**
+ * Records an arbitrary sample, e.g. the number of bytes of a transfer:
+ *   DIS_PROFILE_COUNTER("vcom_tx_bytes", count);
+ */
+#define DIS_PROFILE_COUNTER(Name, Value, ...)                              \
+    ::dis::detail::profile_count(                                          \
+        DIS_PROFILE_SITE(Name, profile_kind::counter),                     \
+        static_cast<std::uint32_t>(Value) __VA_OPT__(, ) __VA_ARGS__)
+
+#endif  // DIS_PROFILE_LEVEL == 0
+
+#endif  // DIS_OSAL_STATS_PROFILE_HPP
@@ -0,0 +1,35 @@
+#ifndef DIS_OSAL_THREAD_BACKEND_HPP
+#define DIS_OSAL_THREAD_BACKEND_HPP
+
+// The thread types are templates over a backend, which bundles the policies
+// doing the actual work:
+//
+//   struct backend {
+//       using mutex_policy     = ...;  // create(mutex_tag), take, give, ...
+//       using semaphore_policy = ...;  // create<LEAST_MAX>(desired), ...
+//       using thread_policy    = ...;  // sleep_for(milliseconds), yield()
+//   };
+//
+// All policies consist of static functions only, so the wrappers compile to
+// the same code as direct calls.  The default backend is FreeRTOS, building
+// with DIS_OSAL_BACKEND_STD defined switches it to the standard library (no
+// FreeRTOS headers are needed then).  Both can be mixed in one program by
+// naming the backend, e.g. dis::basic_mutex<dis::std_backend>.
+
+#if defined(DIS_OSAL_BACKEND_STD)
+#include "dis/osal/thread/backend/std.hpp"
+#else
+#include "dis/osal/thread/backend/freertos.hpp"
+#endif
+
+namespace dis {
+
+#if defined(DIS_OSAL_BACKEND_STD)
+using default_backend = std_backend;
+#else
+using default_backend = freertos_backend;
+#endif
+
+}  // namespace dis
+
+#endif  // DIS_OSAL_THREAD_BACKEND_HPP
@@ -0,0 +1,18 @@
+#ifndef DIS_OSAL_THREAD_BACKEND_FREERTOS_HPP
+#define DIS_OSAL_THREAD_BACKEND_FREERTOS_HPP
+
+#include "dis/osal/thread/detail/semaphore_policy.hpp"
+#include "dis/osal/thread/detail/thread_policy.hpp"
+
+namespace dis {
+
+/// kernel objects of FreeRTOS, every call is inlined into the kernel API
+struct freertos_backend {
+    using mutex_policy     = detail::semaphore_policy;
+    using semaphore_policy = detail::semaphore_policy;
+    using thread_policy    = detail::thread_policy;
+};
+
+}  // namespace dis
+
+#endif  // DIS_OSAL_THREAD_BACKEND_FREERTOS_HPP
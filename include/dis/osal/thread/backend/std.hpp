@@ -0,0 +1,20 @@
+#ifndef DIS_OSAL_THREAD_BACKEND_STD_HPP
+#define DIS_OSAL_THREAD_BACKEND_STD_HPP
+
+#include "dis/osal/thread/detail/std_mutex_policy.hpp"
+#include "dis/osal/thread/detail/std_semaphore_policy.hpp"
+#include "dis/osal/thread/detail/std_thread_policy.hpp"
+
+namespace dis {
+
+/// std::mutex, std::condition_variable and std::thread, for native builds
+/// without a kernel which run under perf, valgrind or the sanitizers
+struct std_backend {
+    using mutex_policy     = detail::std_mutex_policy;
+    using semaphore_policy = detail::std_semaphore_policy;
+    using thread_policy    = detail::std_thread_policy;
+};
+
+}  // namespace dis
+
+#endif  // DIS_OSAL_THREAD_BACKEND_STD_HPP
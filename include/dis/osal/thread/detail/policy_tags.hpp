@@ -0,0 +1,12 @@
+#ifndef DIS_OSAL_THREAD_DETAIL_POLICY_TAGS_HPP
+#define DIS_OSAL_THREAD_DETAIL_POLICY_TAGS_HPP
+
+namespace dis::detail {
+
+struct mutex_tag {};
+struct cnt_semaphore_tag {};
+struct bin_semaphore_tag {};
+
+}  // namespace dis::detail
+
+#endif  // DIS_OSAL_THREAD_DETAIL_POLICY_TAGS_HPP
@@ -3,19 +3,29 @@
 
 #include "dis/osal/utils/cpu.hpp"
 #include "dis/osal/debug/contracts.hpp"
+#include "dis/osal/thread/detail/policy_tags.hpp"
+#include "dis/osal/thread/detail/thread_policy.hpp"
 
 #include <FreeRTOS.h>
 #include <semphr.h>
 
-namespace dis::detail {
+#include <chrono>
+#include <cstddef>
 
-struct mutex_tag {};
-struct cnt_semaphore_tag {};
-struct bin_semaphore_tag {};
+namespace dis::detail {
 
 struct semaphore_policy {
     using count_type         = std::ptrdiff_t;
     using native_handle_type = ::SemaphoreHandle_t;
+    using timeout_type       = ::TickType_t;
+
+    static constexpr timeout_type infinity = freertos::infinity_delay;
+    static constexpr timeout_type no_wait  = 0;
+
+    static inline constexpr auto to_timeout(
+        std::chrono::milliseconds time) noexcept -> timeout_type {
+        return freertos::to_ticks(time);
+    }
 
     static inline void destroy(native_handle_type& handle) noexcept {
         if (handle) {
@@ -57,12 +67,12 @@ struct semaphore_policy {
         dis_expects((desired <= 1));
         native_handle_type sem = ::xSemaphoreCreateBinary();
         dis_ensures((sem != nullptr));
-        take(sem, desired);
+        give(sem, desired);
         return sem;
     }
 
     static inline bool take(native_handle_type& sem,
-                            TickType_t ticks) noexcept {
+                            timeout_type ticks) noexcept {
         if (!this_cpu::is_in_isr()) {
             return (::xSemaphoreTake(sem, ticks) == pdTRUE);
         }
@@ -0,0 +1,56 @@
+#ifndef DIS_OSAL_THREAD_DETAIL_STD_MUTEX_POLICY_HPP
+#define DIS_OSAL_THREAD_DETAIL_STD_MUTEX_POLICY_HPP
+
+#include "dis/osal/debug/contracts.hpp"
+#include "dis/osal/thread/detail/policy_tags.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <new>
+
+namespace dis::detail {
+
+// a plain pthread mutex underneath, so helgrind and drd understand the locking
+struct std_mutex_policy {
+    using native_handle_type = std::timed_mutex*;
+    using timeout_type       = std::chrono::milliseconds;
+
+    static constexpr timeout_type infinity = timeout_type::max();
+    static constexpr timeout_type no_wait  = timeout_type::zero();
+
+    static inline constexpr auto to_timeout(
+        std::chrono::milliseconds time) noexcept -> timeout_type {
+        return time;
+    }
+
+    static inline void destroy(native_handle_type& handle) noexcept {
+        delete handle;
+    }
+
+    static inline auto create(mutex_tag) noexcept -> native_handle_type {
+        native_handle_type mtx = new (std::nothrow) std::timed_mutex{};
+        dis_ensures((mtx != nullptr));
+        return mtx;
+    }
+
+    static inline bool take(native_handle_type& mtx,
+                            timeout_type timeout) noexcept {
+        if (timeout == infinity) {
+            mtx->lock();
+            return true;
+        }
+        if (timeout == no_wait) {
+            return mtx->try_lock();
+        }
+        return mtx->try_lock_for(timeout);
+    }
+
+    static inline bool give(native_handle_type& mtx) noexcept {
+        mtx->unlock();
+        return true;
+    }
+};
+
+}  // namespace dis::detail
+
+#endif  // DIS_OSAL_THREAD_DETAIL_STD_MUTEX_POLICY_HPP
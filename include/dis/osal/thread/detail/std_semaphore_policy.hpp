@@ -0,0 +1,100 @@
+#ifndef DIS_OSAL_THREAD_DETAIL_STD_SEMAPHORE_POLICY_HPP
+#define DIS_OSAL_THREAD_DETAIL_STD_SEMAPHORE_POLICY_HPP
+
+#include "dis/osal/debug/contracts.hpp"
+#include "dis/osal/thread/detail/policy_tags.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+namespace dis::detail {
+
+// same semantics as the kernel semaphores: a give on a full semaphore fails
+struct std_semaphore_policy {
+    using count_type   = std::ptrdiff_t;
+    using timeout_type = std::chrono::milliseconds;
+
+    struct control_block {
+        std::mutex mtx{};
+        std::condition_variable cv{};
+        count_type count{0};
+        count_type max{0};
+    };
+    using native_handle_type = control_block*;
+
+    static constexpr timeout_type infinity = timeout_type::max();
+    static constexpr timeout_type no_wait  = timeout_type::zero();
+
+    static inline constexpr auto to_timeout(
+        std::chrono::milliseconds time) noexcept -> timeout_type {
+        return time;
+    }
+
+    static inline void destroy(native_handle_type& handle) noexcept {
+        delete handle;
+    }
+
+    template <count_type LEAST_MAX_VALUE>
+    static inline auto create(count_type desired) noexcept
+        -> native_handle_type {
+        if constexpr (LEAST_MAX_VALUE == 1) {
+            return create(bin_semaphore_tag{}, desired);
+        } else {
+            return create(cnt_semaphore_tag{}, LEAST_MAX_VALUE, desired);
+        }
+    }
+
+    static inline auto create(cnt_semaphore_tag,
+                              count_type max,
+                              count_type desired) noexcept
+        -> native_handle_type {
+        dis_expects((desired >= 0));
+        dis_expects((desired <= max));
+        native_handle_type sem = new (std::nothrow) control_block{};
+        dis_ensures((sem != nullptr));
+        sem->count = desired;
+        sem->max   = max;
+        return sem;
+    }
+
+    static inline auto create(bin_semaphore_tag, count_type desired) noexcept
+        -> native_handle_type {
+        return create(cnt_semaphore_tag{}, 1, desired);
+    }
+
+    static inline bool take(native_handle_type& sem,
+                            timeout_type timeout) noexcept {
+        std::unique_lock lock{sem->mtx};
+        const auto available = [sem] { return sem->count > 0; };
+        if (timeout == infinity) {
+            sem->cv.wait(lock, available);
+        } else if (!sem->cv.wait_for(lock, timeout, available)) {
+            return false;
+        }
+        --sem->count;
+        return true;
+    }
+
+    static inline bool give(native_handle_type& sem,
+                            count_type desired = 1) noexcept {
+        // notified with the lock held, a woken waiter may destroy the
+        // semaphore as soon as the lock is released
+        std::lock_guard lock{sem->mtx};
+        const count_type given = std::min(desired, sem->max - sem->count);
+        sem->count += given;
+        if (given == 1) {
+            sem->cv.notify_one();
+        } else if (given > 1) {
+            sem->cv.notify_all();
+        }
+        return given == desired;
+    }
+};
+
+}  // namespace dis::detail
+
+#endif  // DIS_OSAL_THREAD_DETAIL_STD_SEMAPHORE_POLICY_HPP
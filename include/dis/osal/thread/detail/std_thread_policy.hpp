@@ -0,0 +1,19 @@
+#ifndef DIS_OSAL_THREAD_DETAIL_STD_THREAD_POLICY_HPP
+#define DIS_OSAL_THREAD_DETAIL_STD_THREAD_POLICY_HPP
+
+#include <chrono>
+#include <thread>
+
+namespace dis::detail {
+
+struct std_thread_policy {
+    static inline void sleep_for(std::chrono::milliseconds sleep) noexcept {
+        std::this_thread::sleep_for(sleep);
+    }
+
+    static inline void yield() noexcept { std::this_thread::yield(); }
+};
+
+}  // namespace dis::detail
+
+#endif  // DIS_OSAL_THREAD_DETAIL_STD_THREAD_POLICY_HPP
@@ -0,0 +1,32 @@
+#ifndef DIS_OSAL_THREAD_DETAIL_THREAD_POLICY_HPP
+#define DIS_OSAL_THREAD_DETAIL_THREAD_POLICY_HPP
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <chrono>
+
+namespace dis {
+namespace freertos {
+constexpr TickType_t infinity_delay = portMAX_DELAY;
+constexpr TickType_t tick_rate_ms   = portTICK_RATE_MS;
+inline constexpr TickType_t to_ticks(std::chrono::milliseconds time) noexcept {
+    const auto ticks = (time.count() * configTICK_RATE_HZ) / 1000;
+    return static_cast<TickType_t>(ticks);
+}
+}  // namespace freertos
+
+namespace detail {
+
+struct thread_policy {
+    static inline void sleep_for(std::chrono::milliseconds sleep) noexcept {
+        ::vTaskDelay(freertos::to_ticks(sleep));
+    }
+
+    static inline void yield() noexcept { taskYIELD(); }
+};
+
+}  // namespace detail
+}  // namespace dis
+
+#endif  // DIS_OSAL_THREAD_DETAIL_THREAD_POLICY_HPP
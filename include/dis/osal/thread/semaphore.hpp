@@ -1,25 +1,25 @@
 #ifndef DIS_OSAL_THREAD_SEMAPHORE_HPP
 #define DIS_OSAL_THREAD_SEMAPHORE_HPP
 
+#include "dis/osal/thread/backend.hpp"
 #include "dis/osal/thread/thread.hpp"
-#include "dis/osal/thread/detail/semaphore_policy.hpp"
-#include "dis/osal/utils/cpu.hpp"
 
-#include <FreeRTOS.h>
-#include <semphr.h>
+#include <chrono>
+#include <cstddef>
+#include <utility>
 
 namespace dis {
 
-template <std::ptrdiff_t LEAST_MAX_V>
+template <std::ptrdiff_t LEAST_MAX_V, class BACKEND_T = default_backend>
 class counting_semaphore {
-    using policy_type = detail::semaphore_policy;
+    using policy_type = typename BACKEND_T::semaphore_policy;
 
 public:
     using count_type         = typename policy_type::count_type;
     using native_handle_type = typename policy_type::native_handle_type;
 
     counting_semaphore(count_type desired = 0) noexcept
-        : m_handle{policy_type::create<LEAST_MAX_V>(desired)} {}
+        : m_handle{policy_type::template create<LEAST_MAX_V>(desired)} {}
 
     ~counting_semaphore() noexcept { policy_type::destroy(m_handle); }
 
@@ -45,23 +45,25 @@ public:
         policy_type::give(m_handle, update);
     }
     inline void aquire() {
-        policy_type::take(m_handle, freertos::infinity_delay);
+        policy_type::take(m_handle, policy_type::infinity);
     }
     [[nodiscard]] inline bool try_aquire() {
-        return policy_type::take(m_handle, 0);
+        return policy_type::take(m_handle, policy_type::no_wait);
     }
 
     template <class REP_T, class PERIOD_T>
     [[nodiscard]] inline bool try_aquire_for(
         const std::chrono::duration<REP_T, PERIOD_T>& time) noexcept {
-        return policy_type::take(m_handle, freertos::to_ticks(time));
+        return policy_type::take(m_handle, policy_type::to_timeout(time));
     }
 
 private:
     native_handle_type m_handle{nullptr};
 };
 
-using binary_semaphore = counting_semaphore<1>;
+template <class BACKEND_T = default_backend>
+using basic_binary_semaphore = counting_semaphore<1, BACKEND_T>;
+using binary_semaphore       = basic_binary_semaphore<>;
 
 }  // namespace dis
 #endif  // DIS_OSAL_THREAD_SEMAPHORE_HPP
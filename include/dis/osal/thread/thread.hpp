@@ -1,37 +1,25 @@
 #ifndef DIS_OSAL_THREAD_THREAD_HPP
 #define DIS_OSAL_THREAD_THREAD_HPP
 
-#include "dis/osal/debug/contracts.hpp"
-
-#include <FreeRTOS.h>
-#include <task.h>
+#include "dis/osal/thread/backend.hpp"
 
 #include <chrono>
 
-namespace dis {
-namespace freertos {
-constexpr TickType_t infinity_delay = portMAX_DELAY;
-constexpr TickType_t tick_rate_ms   = portTICK_RATE_MS;
-inline constexpr TickType_t to_ticks(std::chrono::milliseconds time) noexcept {
-    const auto ticks = (time.count() * configTICK_RATE_HZ) / 1000;
-    return static_cast<TickType_t>(ticks);
-}
-}  // namespace freertos
-
-namespace this_thread {
-
-void sleep_for(const std::chrono::milliseconds& sleep) noexcept {
-    const auto ticks = freertos::to_ticks(sleep);
-    ::vTaskDelay(ticks);
-}
+namespace dis::this_thread {
 
-template <class REP_T, class PERIOD_T>
-void sleep_for(const std::chrono::duration<REP_T, PERIOD_T>& sleep) noexcept {
+template <class BACKEND_T = default_backend, class REP_T, class PERIOD_T>
+inline void sleep_for(
+    const std::chrono::duration<REP_T, PERIOD_T>& sleep) noexcept {
     const auto sleep_ms =
         std::chrono::duration_cast<std::chrono::milliseconds>(sleep);
-    sleep_for(sleep_ms);
+    BACKEND_T::thread_policy::sleep_for(sleep_ms);
+}
+
+template <class BACKEND_T = default_backend>
+inline void yield() noexcept {
+    BACKEND_T::thread_policy::yield();
 }
-}  // namespace this_thread
-}  // namespace dis
+
+}  // namespace dis::this_thread
 
 #endif  // DIS_OSAL_THREAD_THREAD_HPP
@@ -0,0 +1,116 @@
+#ifndef DIS_OSAL_TRACE_FORMAT_HPP
+#define DIS_OSAL_TRACE_FORMAT_HPP
+
+// NOTE: this header is shared with the host tools (tools/trace2chrome), it
+// must not depend on FreeRTOS or the HAL.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dis::trace {
+
+enum class event_type : std::uint8_t {
+    none = 0,
+
+    // id: task number (uxTCBNumber)
+    task_switched_in = 1,
+    task_create,
+    task_delete,
+    task_delay,
+    task_suspend,
+    task_resume,
+    task_ready,
+    task_notify,
+    task_notify_take,
+    task_notify_block,
+
+    // id: exception number (IPSR)
+    isr_enter = 32,
+    isr_exit,
+
+    // id: object number (uxQueueNumber/uxStreamBufferNumber)
+    object_create = 64,
+    object_delete,
+    queue_send,
+    queue_send_failed,
+    queue_send_from_isr,
+    queue_receive,
+    queue_receive_failed,
+    queue_receive_from_isr,
+    queue_block_send,
+    queue_block_receive,
+    stream_send,
+    stream_send_from_isr,
+    stream_receive,
+    stream_receive_from_isr,
+    stream_block_send,
+    stream_block_receive,
+
+    // id: user defined
+    user = 128,
+};
+
+enum class object_kind : std::uint8_t {
+    task = 0,
+    queue,
+    mutex,
+    counting_semaphore,
+    binary_semaphore,
+    recursive_mutex,
+    stream_buffer,
+    message_buffer,
+};
+
+/// compact event, the timestamp is the low word of the cycle counter
+struct event {
+    std::uint32_t timestamp;
+    event_type type;
+    /// object_kind for object_create, otherwise 0
+    std::uint8_t detail;
+    std::uint16_t id;
+};
+static_assert(sizeof(event) == 8);
+
+struct name_entry {
+    std::uint16_t id;
+    object_kind kind;
+    std::uint8_t reserved;
+    char name[16];
+};
+static_assert(sizeof(name_entry) == 20);
+
+inline constexpr std::uint32_t dump_magic   = 0x54534944;  // "DIST"
+inline constexpr std::uint16_t dump_version = 1;
+
+/**
+ * Layout of the recorder memory.  The header is followed by name_capacity
+ * name entries and event_capacity events, the event ring is written
+ * round-robin: the oldest event is at events_written % event_capacity once
+ * the ring wrapped.
+ */
+struct dump_header {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t event_size;
+    std::uint32_t cpu_hz;
+    std::uint32_t event_capacity;
+    std::uint32_t name_capacity;
+    std::uint32_t events_written;
+    std::uint32_t names_written;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(dump_header) == 32);
+
+template <std::size_t EVENTS_V, std::size_t NAMES_V>
+struct recorder_memory {
+    static_assert((EVENTS_V & (EVENTS_V - 1)) == 0,
+                  "event capacity must be a power of two");
+
+    dump_header header;
+    name_entry names[NAMES_V];
+    event events[EVENTS_V];
+};
+
+}  // namespace dis::trace
+
+#endif  // DIS_OSAL_TRACE_FORMAT_HPP
@@ -0,0 +1,49 @@
+#ifndef DIS_OSAL_TRACE_RECORDER_HPP
+#define DIS_OSAL_TRACE_RECORDER_HPP
+
+#include "dis/osal/trace/format.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#ifndef DIS_TRACE_EVENTS
+#define DIS_TRACE_EVENTS 1024
+#endif
+
+#ifndef DIS_TRACE_NAMES
+#define DIS_TRACE_NAMES 32
+#endif
+
+namespace dis::trace {
+
+/// number of events kept in the ring (8 bytes each)
+inline constexpr std::size_t event_capacity = DIS_TRACE_EVENTS;
+/// number of task/object names kept
+inline constexpr std::size_t name_capacity = DIS_TRACE_NAMES;
+
+using memory_type = recorder_memory<event_capacity, name_capacity>;
+
+/**
+ * Always-on flight recorder.  The kernel trace hooks (see
+ * dis/osal/kernel_hooks.h) write their events into a lock-free ring in RAM,
+ * the oldest events get overwritten.  Recording is enabled from the start.
+ */
+void start() noexcept;
+void stop() noexcept;
+[[nodiscard]] bool is_running() noexcept;
+
+/// records an application defined event, safe to call from interrupts
+void user_event(std::uint16_t id) noexcept;
+
+/**
+ * Raw recorder memory, laid out as described in dis/osal/trace/format.hpp.
+ * Stop the recorder before exporting it.  The same memory can be dumped with
+ * a debugger:  dump binary memory trace.bin &dis_trace_memory
+ * (&dis_trace_memory + 1)
+ */
+[[nodiscard]] std::span<const std::byte> dump() noexcept;
+
+}  // namespace dis::trace
+
+#endif  // DIS_OSAL_TRACE_RECORDER_HPP
@@ -0,0 +1,81 @@
+#ifndef DIS_OSAL_UTILS_CYCLE_COUNTER_HPP
+#define DIS_OSAL_UTILS_CYCLE_COUNTER_HPP
+
+#include <FreeRTOS.h>
+
+#if defined(DIS_OSAL_POSIX)
+#include <time.h>
+#else
+#include <stm32f7xx.h>
+#endif
+
+#include <cstdint>
+
+namespace dis::this_cpu {
+#if defined(DIS_OSAL_POSIX)
+
+// The host build counts nanoseconds of the monotonic clock as cycles, the
+// host BSP sets SystemCoreClock to 1GHz accordingly.
+
+inline void enable_cycle_counter() noexcept {}
+
+[[nodiscard]] inline std::uint64_t cycles64() noexcept {
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<std::uint64_t>(now.tv_sec) * 1000000000U +
+           static_cast<std::uint64_t>(now.tv_nsec);
+}
+
+[[nodiscard]] inline std::uint32_t cycles() noexcept {
+    return static_cast<std::uint32_t>(cycles64());
+}
+
+#else
+
+namespace detail {
+inline std::uint32_t cycles_last_low = 0;
+inline std::uint32_t cycles_high     = 0;
+}  // namespace detail
+
+/**
+ * Enables the DWT cycle counter (CYCCNT).  The Cortex-M7 requires the DWT
+ * registers to be unlocked before CTRL can be written.
+ */
+inline void enable_cycle_counter() noexcept {
+    CoreDebug->DEMCR = CoreDebug->DEMCR | CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR         = 0xC5ACCE55;
+    DWT->CYCCNT      = 0;
+    DWT->CTRL        = DWT->CTRL | DWT_CTRL_CYCCNTENA_Msk;
+    detail::cycles_last_low = 0;
+    detail::cycles_high     = 0;
+}
+
+[[nodiscard]] inline std::uint32_t cycles() noexcept { return DWT->CYCCNT; }
+
+/**
+ * CYCCNT extended to 64 bit.  The extension only sees a wrap if it is called
+ * at least once per 2^32 cycles (~19.9s at 216MHz), the kernel tick hook
+ * takes care of that.  Safe to call from tasks and interrupts.
+ */
+[[nodiscard]] inline std::uint64_t cycles64() noexcept {
+    const UBaseType_t mask  = portSET_INTERRUPT_MASK_FROM_ISR();
+    const std::uint32_t low = DWT->CYCCNT;
+    if (low < detail::cycles_last_low) {
+        ++detail::cycles_high;
+    }
+    detail::cycles_last_low = low;
+    const std::uint64_t result =
+        (static_cast<std::uint64_t>(detail::cycles_high) << 32U) | low;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    return result;
+}
+
+#endif  // defined(DIS_OSAL_POSIX)
+
+[[nodiscard]] inline std::uint32_t cycles_per_second() noexcept {
+    return SystemCoreClock;
+}
+
+}  // namespace dis::this_cpu
+
+#endif  // DIS_OSAL_UTILS_CYCLE_COUNTER_HPP
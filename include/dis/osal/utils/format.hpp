@@ -0,0 +1,833 @@
+#ifndef DIS_OSAL_UTILS_FORMAT_HPP
+#define DIS_OSAL_UTILS_FORMAT_HPP
+
+// NOTE: a subset of the std::format syntax:
+// https://en.cppreference.com/w/cpp/utility/format/spec
+// this header is shared with the host tools, it must not depend on FreeRTOS
+// or the HAL.
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace dis {
+
+/// like std::format_to_n_result, `size` is the length of the whole output,
+/// which is larger than the buffer if the output was truncated
+struct format_to_result {
+    char* out;
+    std::size_t size;
+};
+
+}  // namespace dis
+
+namespace dis::detail {
+
+enum class format_kind : std::uint8_t {
+    none,
+    boolean,
+    character,
+    signed_integer,
+    unsigned_integer,
+    floating,
+    string,
+    pointer,
+};
+
+template <class ARG_T>
+[[nodiscard]] consteval format_kind format_kind_of() noexcept {
+    using value_type = std::remove_cv_t<std::decay_t<ARG_T>>;
+    if constexpr (std::is_same_v<value_type, bool>) {
+        return format_kind::boolean;
+    } else if constexpr (std::is_same_v<value_type, char>) {
+        return format_kind::character;
+    } else if constexpr (std::is_integral_v<value_type> &&
+                         sizeof(value_type) <= sizeof(std::uint64_t)) {
+        return std::is_signed_v<value_type> ? format_kind::signed_integer
+                                            : format_kind::unsigned_integer;
+    } else if constexpr (std::is_same_v<value_type, float> ||
+                         std::is_same_v<value_type, double>) {
+        return format_kind::floating;
+    } else if constexpr (std::is_same_v<value_type, const char*> ||
+                         std::is_same_v<value_type, char*> ||
+                         std::is_same_v<value_type, std::string_view>) {
+        return format_kind::string;
+    } else if constexpr (std::is_same_v<value_type, const void*> ||
+                         std::is_same_v<value_type, void*> ||
+                         std::is_same_v<value_type, std::nullptr_t>) {
+        return format_kind::pointer;
+    } else {
+        return format_kind::none;
+    }
+}
+
+enum class format_align : std::uint8_t { none, left, right, center };
+enum class format_sign : std::uint8_t { minus, plus, space };
+
+/// a replacement field and the literal text in front of it
+struct format_spec {
+    std::uint16_t literal_begin{0};
+    std::uint16_t literal_end{0};
+    std::uint16_t width{0};
+    std::int16_t precision{-1};
+    char fill{' '};
+    char type{'\0'};
+    format_align align{format_align::none};
+    format_sign sign{format_sign::minus};
+    bool alternate{false};
+    bool zero_pad{false};
+};
+
+/// type erased argument, so all call sites share one formatter
+struct format_arg {
+    format_kind kind;
+    union {
+        std::uint64_t u;
+        std::int64_t i;
+        double d;
+        const void* p;
+        struct {
+            const char* data;
+            std::size_t size;
+        } s;
+    };
+};
+
+// not constexpr, so a call in the constructor of format_string fails to
+// compile and shows the message
+inline void format_error(const char*) noexcept {}
+
+[[nodiscard]] constexpr bool format_is_digit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+
+consteval void format_check(format_spec& spec, format_kind kind) noexcept {
+    const char type     = spec.type;
+    const bool integral = type == 'b' || type == 'B' || type == 'd' ||
+                          type == 'o' || type == 'x' || type == 'X';
+    const bool numeric_flags = spec.sign != format_sign::minus ||
+                               spec.alternate || spec.zero_pad;
+
+    switch (kind) {
+        case format_kind::none:
+            format_error("argument type is not supported by dis::format_to");
+            return;
+        case format_kind::boolean:
+        case format_kind::character:
+            if (type == '\0' ||
+                (type == 's' && kind == format_kind::boolean) ||
+                (type == 'c' && kind == format_kind::character)) {
+                if (numeric_flags) {
+                    format_error("sign, # and 0 need an integer type");
+                }
+            } else if (!integral) {
+                format_error("invalid type for bool or char");
+            }
+            if (spec.precision >= 0) {
+                format_error("precision is not allowed for bool or char");
+            }
+            return;
+        case format_kind::signed_integer:
+        case format_kind::unsigned_integer:
+            if (type != '\0' && type != 'c' && !integral) {
+                format_error("invalid type for an integer");
+            }
+            if (type == 'c' && numeric_flags) {
+                format_error("sign, # and 0 are not allowed with c");
+            }
+            if (spec.precision >= 0) {
+                format_error("precision is not allowed for integers");
+            }
+            return;
+        case format_kind::floating:
+            if (type != 'f' && type != 'F') {
+                format_error(
+                    "floating point needs the fixed point type: {:.Nf}");
+            }
+            if (spec.precision < 0) {
+                spec.precision = 6;
+            }
+            if (spec.precision > 9) {
+                format_error("precision of floating point is limited to 9");
+            }
+            return;
+        case format_kind::string:
+            if (type != '\0' && type != 's') {
+                format_error("invalid type for a string");
+            }
+            if (numeric_flags) {
+                format_error("sign, # and 0 are not allowed for strings");
+            }
+            return;
+        case format_kind::pointer:
+            if (type != '\0' && type != 'p') {
+                format_error("invalid type for a pointer");
+            }
+            if (numeric_flags || spec.precision >= 0) {
+                format_error("only width and alignment for pointers");
+            }
+            return;
+    }
+}
+
+/**
+ * Parses the replacement field at fmt[pos] (the opening brace) into spec and
+ * returns the position of the closing brace.
+ */
+consteval std::size_t format_parse_field(std::string_view fmt,
+                                         std::size_t pos,
+                                         format_spec& spec) noexcept {
+    ++pos;
+    if (pos < fmt.size() && format_is_digit(fmt[pos])) {
+        format_error("argument indices are not supported");
+    }
+    if (pos < fmt.size() && fmt[pos] == ':') {
+        ++pos;
+        auto align_of = [](char c) {
+            return c == '<'   ? format_align::left
+                   : c == '>' ? format_align::right
+                   : c == '^' ? format_align::center
+                              : format_align::none;
+        };
+        if (pos + 1 < fmt.size() &&
+            align_of(fmt[pos + 1]) != format_align::none) {
+            if (fmt[pos] == '{' || fmt[pos] == '}') {
+                format_error("invalid fill character");
+            }
+            spec.fill  = fmt[pos];
+            spec.align = align_of(fmt[pos + 1]);
+            pos += 2;
+        } else if (pos < fmt.size() &&
+                   align_of(fmt[pos]) != format_align::none) {
+            spec.align = align_of(fmt[pos]);
+            ++pos;
+        }
+        if (pos < fmt.size() && (fmt[pos] == '+' || fmt[pos] == '-' ||
+                                 fmt[pos] == ' ')) {
+            spec.sign = fmt[pos] == '+'   ? format_sign::plus
+                        : fmt[pos] == ' ' ? format_sign::space
+                                          : format_sign::minus;
+            ++pos;
+        }
+        if (pos < fmt.size() && fmt[pos] == '#') {
+            spec.alternate = true;
+            ++pos;
+        }
+        if (pos < fmt.size() && fmt[pos] == '0') {
+            // ignored if an alignment is given, like std::format
+            spec.zero_pad = spec.align == format_align::none;
+            ++pos;
+        }
+        std::uint32_t width = 0;
+        for (; pos < fmt.size() && format_is_digit(fmt[pos]); ++pos) {
+            width = width * 10 + static_cast<std::uint32_t>(fmt[pos] - '0');
+            if (width > 0xFFFF) {
+                format_error("width is too large");
+            }
+        }
+        spec.width = static_cast<std::uint16_t>(width);
+        if (pos < fmt.size() && fmt[pos] == '.') {
+            ++pos;
+            if (pos >= fmt.size() || !format_is_digit(fmt[pos])) {
+                format_error("missing precision, dynamic precision is not "
+                             "supported");
+            }
+            std::uint32_t precision = 0;
+            for (; pos < fmt.size() && format_is_digit(fmt[pos]); ++pos) {
+                precision = precision * 10 +
+                            static_cast<std::uint32_t>(fmt[pos] - '0');
+                if (precision > 0x7FFF) {
+                    format_error("precision is too large");
+                }
+            }
+            spec.precision = static_cast<std::int16_t>(precision);
+        }
+        if (pos < fmt.size() &&
+            std::string_view("bBcdoxXsfFp").find(fmt[pos]) !=
+                std::string_view::npos) {
+            spec.type = fmt[pos];
+            ++pos;
+        }
+    }
+    if (pos >= fmt.size() || fmt[pos] != '}') {
+        format_error("invalid replacement field, dynamic width, precision "
+                     "and the types a A e E g G are not supported");
+    }
+    return pos;
+}
+
+}  // namespace dis::detail
+
+namespace dis {
+
+/**
+ * Format string which is checked against the arguments and parsed at compile
+ * time, the counterpart of std::format_string.
+ */
+template <class... ARG_Ts>
+class basic_format_string {
+public:
+    template <class STRING_T>
+        requires std::is_convertible_v<const STRING_T&, std::string_view>
+    consteval basic_format_string(const STRING_T& str) noexcept
+        : m_str(str) {
+        if (m_str.size() > 0xFFFF) {
+            detail::format_error("format string is too long");
+        }
+        constexpr std::array<detail::format_kind, sizeof...(ARG_Ts)> kinds{
+            detail::format_kind_of<ARG_Ts>()...};
+
+        std::size_t field = 0;
+        std::size_t begin = 0;
+        for (std::size_t pos = 0; pos < m_str.size(); ++pos) {
+            const char c = m_str[pos];
+            if (c == '}') {
+                if (pos + 1 >= m_str.size() || m_str[pos + 1] != '}') {
+                    detail::format_error("unmatched } in format string");
+                }
+                ++pos;
+                continue;
+            }
+            if (c != '{') {
+                continue;
+            }
+            if (pos + 1 < m_str.size() && m_str[pos + 1] == '{') {
+                ++pos;
+                continue;
+            }
+            if (field >= sizeof...(ARG_Ts)) {
+                detail::format_error("more replacement fields than arguments");
+                return;
+            }
+            detail::format_spec& spec = m_fields[field];
+            spec.literal_begin        = static_cast<std::uint16_t>(begin);
+            spec.literal_end          = static_cast<std::uint16_t>(pos);
+            pos                       = detail::format_parse_field(m_str, pos,
+                                                                   spec);
+            detail::format_check(spec, kinds[field]);
+            begin = pos + 1;
+            ++field;
+        }
+        if (field != sizeof...(ARG_Ts)) {
+            detail::format_error("more arguments than replacement fields");
+        }
+        m_tail = static_cast<std::uint16_t>(begin);
+    }
+
+    [[nodiscard]] constexpr std::string_view get() const noexcept {
+        return m_str;
+    }
+
+    [[nodiscard]] constexpr std::span<const detail::format_spec> fields()
+        const noexcept {
+        return m_fields;
+    }
+
+    /// start of the literal text behind the last field
+    [[nodiscard]] constexpr std::size_t tail() const noexcept {
+        return m_tail;
+    }
+
+private:
+    std::string_view m_str;
+    std::array<detail::format_spec, sizeof...(ARG_Ts)> m_fields{};
+    std::uint16_t m_tail{0};
+};
+
+template <class... ARG_Ts>
+using format_string = basic_format_string<std::type_identity_t<ARG_Ts>...>;
+
+}  // namespace dis
+
+namespace dis::detail {
+
+class format_writer {
+public:
+    explicit format_writer(std::span<char> out) noexcept
+        : m_out(out.data()), m_end(out.data() + out.size()) {}
+
+    void put(char c) noexcept {
+        if (m_out != m_end) {
+            *m_out++ = c;
+        }
+        ++m_size;
+    }
+
+    // an empty buffer or string may be a null pointer, which memcpy and
+    // memset must not get even for 0 bytes
+    void write(const char* text, std::size_t size) noexcept {
+        const auto room = static_cast<std::size_t>(m_end - m_out);
+        const std::size_t count = size < room ? size : room;
+        m_size += size;
+        if (count == 0) {
+            return;
+        }
+        std::memcpy(m_out, text, count);
+        m_out += count;
+    }
+
+    void fill(char c, std::size_t count) noexcept {
+        const auto room = static_cast<std::size_t>(m_end - m_out);
+        const std::size_t filled = count < room ? count : room;
+        m_size += count;
+        if (filled == 0) {
+            return;
+        }
+        std::memset(m_out, c, filled);
+        m_out += filled;
+    }
+
+    [[nodiscard]] format_to_result result() const noexcept {
+        return {m_out, m_size};
+    }
+
+private:
+    char* m_out;
+    char* m_end;
+    std::size_t m_size{0};
+};
+
+inline constexpr char format_digit_pairs[] =
+    "0001020304050607080910111213141516171819202122232425262728293031323334"
+    "3536373839404142434445464748495051525354555657585960616263646566676869"
+    "707172737475767778798081828384858687888990919293949596979899";
+
+/// writes the decimal digits of value backwards from end, returns the start
+inline char* format_decimal32(char* end, std::uint32_t value) noexcept {
+    while (value >= 100) {
+        const std::uint32_t pair = (value % 100) * 2;
+        value /= 100;
+        *--end = format_digit_pairs[pair + 1];
+        *--end = format_digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--end = format_digit_pairs[value * 2 + 1];
+        *--end = format_digit_pairs[value * 2];
+    } else {
+        *--end = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+inline char* format_decimal(char* end, std::uint64_t value) noexcept {
+    // splits off 9 digits at a time, so the loop works with 32 bit divisions
+    // (the 64 bit division is a library call on the Cortex-M)
+    while (value > 0xFFFFFFFFU) {
+        auto low = static_cast<std::uint32_t>(value % 1000000000U);
+        value /= 1000000000U;
+        for (int i = 0; i < 9; ++i) {
+            *--end = static_cast<char>('0' + low % 10);
+            low /= 10;
+        }
+    }
+    return format_decimal32(end, static_cast<std::uint32_t>(value));
+}
+
+inline char* format_power2(char* end,
+                           std::uint64_t value,
+                           unsigned shift,
+                           bool upper) noexcept {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    const unsigned mask = (1U << shift) - 1;
+    do {
+        *--end = digits[value & mask];
+        value >>= shift;
+    } while (value != 0);
+    return end;
+}
+
+/// writes the fill in front of a field of `size` characters and returns the
+/// number of fill characters due behind it
+inline std::size_t format_fill_before(format_writer& out,
+                                      const format_spec& spec,
+                                      format_align fallback,
+                                      std::size_t size) noexcept {
+    const std::size_t padding = spec.width > size ? spec.width - size : 0;
+    const format_align align =
+        spec.align == format_align::none ? fallback : spec.align;
+    const std::size_t before = align == format_align::right    ? padding
+                               : align == format_align::center ? padding / 2
+                                                               : 0;
+    out.fill(spec.fill, before);
+    return padding - before;
+}
+
+inline void format_pad(format_writer& out,
+                       const format_spec& spec,
+                       format_align fallback,
+                       const char* text,
+                       std::size_t size) noexcept {
+    const std::size_t after = format_fill_before(out, spec, fallback, size);
+    out.write(text, size);
+    out.fill(spec.fill, after);
+}
+
+/// writes sign and prefix, zero padding and digits of a number
+inline void format_number(format_writer& out,
+                          const format_spec& spec,
+                          const char* prefix,
+                          std::size_t prefix_size,
+                          const char* digits,
+                          std::size_t digits_size) noexcept {
+    if (spec.zero_pad) {
+        const std::size_t size = prefix_size + digits_size;
+        out.write(prefix, prefix_size);
+        out.fill('0', spec.width > size ? spec.width - size : 0);
+        out.write(digits, digits_size);
+        return;
+    }
+    // sign, prefix and digits are adjacent in the buffer of the caller
+    format_pad(out, spec, format_align::right, digits - prefix_size,
+               prefix_size + digits_size);
+}
+
+[[nodiscard]] inline char format_sign_of(const format_spec& spec,
+                                         bool negative) noexcept {
+    return negative                            ? '-'
+           : spec.sign == format_sign::plus  ? '+'
+           : spec.sign == format_sign::space ? ' '
+                                             : '\0';
+}
+
+inline void format_integer(format_writer& out,
+                           const format_spec& spec,
+                           std::uint64_t magnitude,
+                           bool negative) noexcept {
+    if (spec.type == 'c') {
+        // std::format rejects values which are no char, as it can not throw
+        // this writes a '?' instead
+        const char c =
+            negative || magnitude > 0xFFU ? '?' : static_cast<char>(magnitude);
+        format_pad(out, spec, format_align::left, &c, 1);
+        return;
+    }
+
+    // sign, "0b" and 64 binary digits
+    char buffer[3 + 64];
+    char* const end = buffer + sizeof(buffer);
+    char* digits    = nullptr;
+    switch (spec.type) {
+        case 'b':
+        case 'B': digits = format_power2(end, magnitude, 1, false); break;
+        case 'o': digits = format_power2(end, magnitude, 3, false); break;
+        case 'x':
+        case 'X':
+            digits = format_power2(end, magnitude, 4, spec.type == 'X');
+            break;
+        default: digits = format_decimal(end, magnitude); break;
+    }
+
+    char* prefix = digits;
+    if (spec.alternate) {
+        switch (spec.type) {
+            case 'b':
+            case 'B':
+            case 'x':
+            case 'X':
+                *--prefix = spec.type;
+                *--prefix = '0';
+                break;
+            case 'o':
+                if (magnitude != 0) {
+                    *--prefix = '0';
+                }
+                break;
+            default: break;
+        }
+    }
+    if (const char sign = format_sign_of(spec, negative); sign != '\0') {
+        *--prefix = sign;
+    }
+    format_number(out, spec, prefix, static_cast<std::size_t>(digits - prefix),
+                  digits, static_cast<std::size_t>(end - digits));
+}
+
+/**
+ * Fixed point output of a double of 2^64 and above, which is integral and
+ * exactly mantissa * 2^exponent.  It is expanded into base 10^9 limbs, 35 of
+ * them hold the 309 digits of the largest double.  Kept out of line, so the
+ * limbs only take stack space when they are needed.
+ */
+[[gnu::noinline]] inline void format_fixed_large(format_writer& out,
+                                                 const format_spec& spec,
+                                                 bool negative,
+                                                 double value) noexcept {
+    int exponent = 0;
+    while (value >= 9007199254740992.0) {  // 2^53
+        value *= 0.5;
+        ++exponent;
+    }
+    std::array<std::uint32_t, 35> limbs{};
+    const auto mantissa = static_cast<std::uint64_t>(value);
+    limbs[0]            = static_cast<std::uint32_t>(mantissa % 1000000000U);
+    limbs[1]            = static_cast<std::uint32_t>(mantissa / 1000000000U);
+    std::size_t used    = 2;
+    while (exponent > 0) {
+        const int shift = exponent < 29 ? exponent : 29;
+        exponent -= shift;
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < used; ++i) {
+            const std::uint64_t limb =
+                (std::uint64_t{limbs[i]} << shift) + carry;
+            limbs[i] = static_cast<std::uint32_t>(limb % 1000000000U);
+            carry    = limb / 1000000000U;
+        }
+        if (carry != 0) {
+            limbs[used++] = static_cast<std::uint32_t>(carry);
+        }
+    }
+
+    char chunk[10];
+    char* const chunk_end = chunk + sizeof(chunk);
+    const char* top       = format_decimal32(chunk_end, limbs[used - 1]);
+    const auto top_size   = static_cast<std::size_t>(chunk_end - top);
+    const auto precision  = static_cast<std::size_t>(spec.precision);
+    const bool point      = precision != 0 || spec.alternate;
+    const char sign       = format_sign_of(spec, negative);
+
+    const std::size_t prefix_size = sign != '\0' ? 1 : 0;
+    const std::size_t size        = prefix_size + top_size + 9 * (used - 1) +
+                                    (point ? 1 + precision : 0);
+
+    std::size_t after = 0;
+    if (spec.zero_pad) {
+        out.write(&sign, prefix_size);
+        out.fill('0', spec.width > size ? spec.width - size : 0);
+    } else {
+        after = format_fill_before(out, spec, format_align::right, size);
+        out.write(&sign, prefix_size);
+    }
+    out.write(top, top_size);
+    for (std::size_t i = used - 1; i-- > 0;) {
+        std::uint32_t limb = limbs[i];
+        for (char* pos = chunk_end; pos != chunk_end - 9;) {
+            *--pos = static_cast<char>('0' + limb % 10);
+            limb /= 10;
+        }
+        out.write(chunk_end - 9, 9);
+    }
+    if (point) {
+        // no fractional bits left
+        out.put('.');
+        out.fill('0', precision);
+    }
+    out.fill(spec.fill, after);
+}
+
+inline void format_fixed(format_writer& out,
+                         const format_spec& spec,
+                         double value) noexcept {
+    constexpr std::uint32_t powers[] = {
+        1,      10,      100,      1000,      10000,
+        100000, 1000000, 10000000, 100000000, 1000000000};
+    const bool negative    = std::signbit(value);
+    const double magnitude = negative ? -value : value;
+
+    if (magnitude != magnitude || magnitude > 1.7976931348623157e308) {
+        const bool upper = spec.type == 'F';
+        char text[4]     = {format_sign_of(spec, negative)};
+        char* begin      = text[0] != '\0' ? text : text + 1;
+        std::memcpy(text + 1,
+                    magnitude != magnitude ? (upper ? "NAN" : "nan")
+                                           : (upper ? "INF" : "inf"),
+                    3);
+        // no zero padding for inf and nan
+        format_pad(out, spec, format_align::right, begin,
+                   static_cast<std::size_t>(text + sizeof(text) - begin));
+        return;
+    }
+    if (magnitude >= 18446744073709551616.0) {  // 2^64
+        format_fixed_large(out, spec, negative, magnitude);
+        return;
+    }
+
+    const auto precision = static_cast<unsigned>(spec.precision);
+    auto integral        = static_cast<std::uint64_t>(magnitude);
+    // the difference is exact, the product is not, but the fused
+    // multiply-add yields its rounding error (the FPU of the Cortex-M7 has
+    // one).  So the digits are rounded half to even on the exact value, like
+    // std::format does.
+    const double part      = magnitude - static_cast<double>(integral);
+    const double scale     = powers[precision];
+    const double rest      = part * scale;
+    const double error     = std::fma(part, scale, -rest);
+    std::uint32_t fraction = static_cast<std::uint32_t>(rest);
+    const double half      = rest - fraction;
+    const bool odd         = precision != 0 ? (fraction & 1U) != 0
+                                            : (integral & 1U) != 0;
+    if (half > 0.5 || (half == 0.5 && (error > 0 || (error == 0 && odd)))) {
+        if (++fraction == powers[precision]) {
+            fraction = 0;
+            ++integral;
+        }
+    }
+
+    // sign, 20 integral digits, point and 9 fractional digits
+    char buffer[1 + 20 + 1 + 9];
+    char* const end   = buffer + sizeof(buffer);
+    char* const point = end - precision;
+    for (char* pos = end; pos != point;) {
+        *--pos = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    char* digits = point;
+    if (precision != 0 || spec.alternate) {
+        *--digits = '.';
+    }
+    digits = format_decimal(digits, integral);
+
+    char* prefix = digits;
+    if (const char sign = format_sign_of(spec, negative); sign != '\0') {
+        *--prefix = sign;
+    }
+    format_number(out, spec, prefix, static_cast<std::size_t>(digits - prefix),
+                  digits, static_cast<std::size_t>(end - digits));
+}
+
+inline void format_one(format_writer& out,
+                       const format_spec& spec,
+                       const format_arg& arg) noexcept {
+    switch (arg.kind) {
+        case format_kind::boolean:
+            if (spec.type == '\0' || spec.type == 's') {
+                format_pad(out, spec, format_align::left,
+                           arg.u != 0 ? "true" : "false", arg.u != 0 ? 4 : 5);
+            } else {
+                format_integer(out, spec, arg.u, false);
+            }
+            return;
+        case format_kind::character:
+            if (spec.type == '\0' || spec.type == 'c') {
+                const char c = static_cast<char>(arg.u);
+                format_pad(out, spec, format_align::left, &c, 1);
+            } else {
+                format_integer(out, spec, arg.u, false);
+            }
+            return;
+        case format_kind::signed_integer:
+            format_integer(out, spec,
+                           arg.i < 0 ? 0 - static_cast<std::uint64_t>(arg.i)
+                                     : static_cast<std::uint64_t>(arg.i),
+                           arg.i < 0);
+            return;
+        case format_kind::unsigned_integer:
+            format_integer(out, spec, arg.u, false);
+            return;
+        case format_kind::floating: format_fixed(out, spec, arg.d); return;
+        case format_kind::string: {
+            std::size_t size = arg.s.size;
+            if (spec.precision >= 0 &&
+                static_cast<std::size_t>(spec.precision) < size) {
+                size = static_cast<std::size_t>(spec.precision);
+            }
+            format_pad(out, spec, format_align::left, arg.s.data, size);
+            return;
+        }
+        case format_kind::pointer: {
+            format_spec hex = spec;
+            hex.type        = 'x';
+            hex.alternate   = true;
+            format_integer(out, hex, reinterpret_cast<std::uintptr_t>(arg.p),
+                           false);
+            return;
+        }
+        case format_kind::none: return;
+    }
+}
+
+/// copies literal text, the braces in it are escaped
+inline void format_literal(format_writer& out,
+                           const char* begin,
+                           const char* end) noexcept {
+    while (begin != end) {
+        const char* brace = begin;
+        while (brace != end && *brace != '{' && *brace != '}') {
+            ++brace;
+        }
+        if (brace == end) {
+            out.write(begin, static_cast<std::size_t>(end - begin));
+            return;
+        }
+        out.write(begin, static_cast<std::size_t>(brace - begin) + 1);
+        begin = brace + 2;
+    }
+}
+
+inline format_to_result vformat_to(std::span<char> buffer,
+                                   std::string_view fmt,
+                                   std::span<const format_spec> fields,
+                                   std::size_t tail,
+                                   const format_arg* args) noexcept {
+    format_writer out(buffer);
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        const format_spec& spec = fields[i];
+        format_literal(out, fmt.data() + spec.literal_begin,
+                       fmt.data() + spec.literal_end);
+        format_one(out, spec, args[i]);
+    }
+    format_literal(out, fmt.data() + tail, fmt.data() + fmt.size());
+    return out.result();
+}
+
+template <class ARG_T>
+[[nodiscard]] inline format_arg make_format_arg(const ARG_T& value) noexcept {
+    constexpr format_kind kind = format_kind_of<ARG_T>();
+    format_arg arg{kind, {0}};
+    if constexpr (kind == format_kind::boolean ||
+                  kind == format_kind::character) {
+        arg.u = static_cast<unsigned char>(value);
+    } else if constexpr (kind == format_kind::signed_integer) {
+        arg.i = value;
+    } else if constexpr (kind == format_kind::unsigned_integer) {
+        arg.u = value;
+    } else if constexpr (kind == format_kind::floating) {
+        arg.d = value;
+    } else if constexpr (kind == format_kind::string) {
+        const std::string_view text(value);
+        arg.s = {text.data(), text.size()};
+    } else if constexpr (kind == format_kind::pointer) {
+        arg.p = value;
+    }
+    return arg;
+}
+
+}  // namespace dis::detail
+
+namespace dis {
+
+/**
+ * Formats the arguments into buffer, a subset of std::format_to_n which
+ * neither allocates nor depends on the locale and only needs a few hundred
+ * bytes of stack:
+ *   char line[64];
+ *   auto res = dis::format_to(line, "adc {:>4} = {:.3f} V\n", raw, volts);
+ *   send(line, res.out - line);
+ * Replacement fields are `{}` or `{:[[FILL]ALIGN][SIGN][#][0][WIDTH]
+ * [.PRECISION][TYPE]}`.  Supported are bool, char, integers, strings,
+ * void pointers and float and double with the fixed point types f and F
+ * (precision 0 to 9).  The output is the one of std::format, it is truncated
+ * to the buffer and not NUL terminated.  An integer outside 0 to 255 with
+ * type c, which std::format rejects, is written as '?'.
+ */
+template <class... ARG_Ts>
+inline format_to_result format_to(std::span<char> buffer,
+                                  format_string<ARG_Ts...> fmt,
+                                  const ARG_Ts&... args) noexcept {
+    if constexpr (sizeof...(ARG_Ts) == 0) {
+        return detail::vformat_to(buffer, fmt.get(), {}, fmt.tail(), nullptr);
+    } else {
+        const std::array<detail::format_arg, sizeof...(ARG_Ts)> erased{
+            detail::make_format_arg(args)...};
+        return detail::vformat_to(buffer, fmt.get(), fmt.fields(),
+                                  fmt.tail(), erased.data());
+    }
+}
+
+}  // namespace dis
+
+#endif  // DIS_OSAL_UTILS_FORMAT_HPP
@@ -0,0 +1,338 @@
+#ifndef DIS_OSAL_UTILS_HISTOGRAM_HPP
+#define DIS_OSAL_UTILS_HISTOGRAM_HPP
+
+// NOTE: log-linear bucketing as used by HdrHistogram:
+// http://hdrhistogram.org/
+// this header is shared with the host tools, it must not depend on FreeRTOS
+// or the HAL.
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace dis {
+
+/**
+ * Maps 32 bit values to buckets.  Values below 2^SUB_BITS_V get a bucket of
+ * their own, above that every power of two range is split into 2^SUB_BITS_V
+ * equally wide buckets, so a bucket is never wider than 1/2^SUB_BITS_V of
+ * its values.  Values with more than VALUE_BITS_V bits are saturated.
+ */
+template <unsigned SUB_BITS_V, unsigned VALUE_BITS_V>
+struct histogram_layout {
+    static_assert(SUB_BITS_V > 0 && SUB_BITS_V < VALUE_BITS_V);
+    static_assert(VALUE_BITS_V <= 32);
+
+    static constexpr unsigned sub_bits_value   = SUB_BITS_V;
+    static constexpr unsigned value_bits_value = VALUE_BITS_V;
+    static constexpr std::uint32_t sub_count   = 1U << SUB_BITS_V;
+    static constexpr std::size_t bucket_count =
+        (VALUE_BITS_V - SUB_BITS_V + 1) * sub_count;
+    static constexpr std::uint32_t max_value =
+        static_cast<std::uint32_t>((std::uint64_t{1} << VALUE_BITS_V) - 1);
+
+    [[nodiscard]] static constexpr std::size_t index(
+        std::uint32_t value) noexcept {
+        value = value > max_value ? max_value : value;
+        if (value < sub_count) {
+            return value;
+        }
+        const unsigned shift = std::bit_width(value) - SUB_BITS_V - 1;
+        return shift * sub_count + (value >> shift);
+    }
+
+    [[nodiscard]] static constexpr std::uint32_t lowest(
+        std::size_t idx) noexcept {
+        if (idx < sub_count) {
+            return static_cast<std::uint32_t>(idx);
+        }
+        const auto shift = static_cast<unsigned>(idx / sub_count - 1);
+        return static_cast<std::uint32_t>(idx - shift * sub_count) << shift;
+    }
+
+    [[nodiscard]] static constexpr std::uint32_t highest(
+        std::size_t idx) noexcept {
+        if (idx < sub_count) {
+            return static_cast<std::uint32_t>(idx);
+        }
+        const auto shift = static_cast<unsigned>(idx / sub_count - 1);
+        return lowest(idx) + ((std::uint32_t{1} << shift) - 1);
+    }
+};
+
+/**
+ * Plain copy of a histogram, used for queries, merging and export.
+ */
+template <unsigned SUB_BITS_V = 4, unsigned VALUE_BITS_V = 32>
+class histogram_snapshot {
+public:
+    using layout = histogram_layout<SUB_BITS_V, VALUE_BITS_V>;
+
+    static constexpr std::uint8_t format_version = 1;
+    /// worst case size of serialize(): header, bucket count and two 5 byte
+    /// varints per bucket
+    static constexpr std::size_t max_serialized_size =
+        3 + 5 + layout::bucket_count * 10;
+
+    void record(std::uint32_t value, std::uint32_t count = 1) noexcept {
+        m_counts[layout::index(value)] += count;
+    }
+
+    void merge(const histogram_snapshot& other) noexcept {
+        for (std::size_t i = 0; i < layout::bucket_count; ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+    }
+
+    [[nodiscard]] std::uint64_t count() const noexcept {
+        std::uint64_t total = 0;
+        for (const auto c : m_counts) {
+            total += c;
+        }
+        return total;
+    }
+
+    [[nodiscard]] std::uint32_t bucket(std::size_t idx) const noexcept {
+        return m_counts[idx];
+    }
+
+    /// lowest value equivalent of the smallest sample, 0 if empty
+    [[nodiscard]] std::uint32_t min() const noexcept {
+        for (std::size_t i = 0; i < layout::bucket_count; ++i) {
+            if (m_counts[i] != 0) {
+                return layout::lowest(i);
+            }
+        }
+        return 0;
+    }
+
+    /// highest value equivalent of the largest sample, 0 if empty
+    [[nodiscard]] std::uint32_t max() const noexcept {
+        for (std::size_t i = layout::bucket_count; i > 0; --i) {
+            if (m_counts[i - 1] != 0) {
+                return layout::highest(i - 1);
+            }
+        }
+        return 0;
+    }
+
+    /// mean based on the bucket midpoints
+    [[nodiscard]] double mean() const noexcept {
+        double sum          = 0.0;
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < layout::bucket_count; ++i) {
+            if (m_counts[i] != 0) {
+                const double mid =
+                    (static_cast<double>(layout::lowest(i)) +
+                     static_cast<double>(layout::highest(i))) /
+                    2.0;
+                sum += mid * m_counts[i];
+                total += m_counts[i];
+            }
+        }
+        return total == 0 ? 0.0 : sum / static_cast<double>(total);
+    }
+
+    /**
+     * Value below or equal to which `percent` percent of the samples fall.
+     * The highest value of the bucket is reported, so the result is never
+     * too small and at most 1/2^SUB_BITS_V (relative) too large.
+     */
+    [[nodiscard]] std::uint32_t percentile(double percent) const noexcept {
+        const std::uint64_t total = count();
+        if (total == 0) {
+            return 0;
+        }
+        percent = percent < 0.0 ? 0.0 : (percent > 100.0 ? 100.0 : percent);
+        // the smallest rank with at least `percent` of the samples at or
+        // below it, multiplied first so whole percentages stay exact
+        auto rank = static_cast<std::uint64_t>(
+            std::ceil(percent * static_cast<double>(total) / 100.0));
+        rank = rank == 0 ? 1 : (rank > total ? total : rank);
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < layout::bucket_count; ++i) {
+            seen += m_counts[i];
+            if (seen >= rank) {
+                return layout::highest(i);
+            }
+        }
+        return max();
+    }
+
+    void reset() noexcept { m_counts.fill(0); }
+
+    /**
+     * Compact encoding: version, SUB_BITS_V, VALUE_BITS_V, the number of
+     * used buckets and for every used bucket the distance to the previous
+     * used bucket and its count, all numbers as LEB128 varints.
+     * @return written bytes, 0 if `out` is too small
+     */
+    [[nodiscard]] std::size_t serialize(
+        std::span<std::byte> out) const noexcept {
+        std::size_t used = 0;
+        for (const auto c : m_counts) {
+            used += (c != 0) ? 1 : 0;
+        }
+
+        writer w{out};
+        w.put(format_version);
+        w.put(static_cast<std::uint8_t>(SUB_BITS_V));
+        w.put(static_cast<std::uint8_t>(VALUE_BITS_V));
+        w.put_varint(static_cast<std::uint32_t>(used));
+        std::size_t previous = 0;
+        for (std::size_t i = 0; i < layout::bucket_count; ++i) {
+            if (m_counts[i] != 0) {
+                w.put_varint(static_cast<std::uint32_t>(i - previous));
+                w.put_varint(m_counts[i]);
+                previous = i;
+            }
+        }
+        return w.ok ? w.pos : 0;
+    }
+
+    [[nodiscard]] static std::optional<histogram_snapshot> deserialize(
+        std::span<const std::byte> in) noexcept {
+        reader r{in};
+        const auto version    = r.get();
+        const auto sub_bits   = r.get();
+        const auto value_bits = r.get();
+        if (!r.ok || version != format_version || sub_bits != SUB_BITS_V ||
+            value_bits != VALUE_BITS_V) {
+            return std::nullopt;
+        }
+
+        histogram_snapshot result;
+        const std::uint32_t used = r.get_varint();
+        std::size_t idx          = 0;
+        for (std::uint32_t n = 0; n < used && r.ok; ++n) {
+            idx += r.get_varint();
+            const std::uint32_t c = r.get_varint();
+            if (idx >= layout::bucket_count) {
+                return std::nullopt;
+            }
+            result.m_counts[idx] = c;
+        }
+        if (!r.ok) {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+private:
+    template <unsigned, unsigned>
+    friend class histogram;
+
+    struct writer {
+        std::span<std::byte> out;
+        std::size_t pos{0};
+        bool ok{true};
+
+        void put(std::uint8_t byte) noexcept {
+            if (pos < out.size()) {
+                out[pos++] = static_cast<std::byte>(byte);
+            } else {
+                ok = false;
+            }
+        }
+
+        void put_varint(std::uint32_t value) noexcept {
+            while (value >= 0x80) {
+                put(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            put(static_cast<std::uint8_t>(value));
+        }
+    };
+
+    struct reader {
+        std::span<const std::byte> in;
+        std::size_t pos{0};
+        bool ok{true};
+
+        std::uint8_t get() noexcept {
+            if (pos < in.size()) {
+                return static_cast<std::uint8_t>(in[pos++]);
+            }
+            ok = false;
+            return 0;
+        }
+
+        std::uint32_t get_varint() noexcept {
+            std::uint32_t value = 0;
+            for (unsigned shift = 0; shift < 35 && ok; shift += 7) {
+                const std::uint8_t byte = get();
+                value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            ok = false;
+            return 0;
+        }
+    };
+
+    std::array<std::uint32_t, layout::bucket_count> m_counts{};
+};
+
+/**
+ * Fixed memory latency histogram (HDR style log-linear buckets).  record()
+ * is a single relaxed atomic increment, so it is wait free and can be used
+ * from interrupts.  With the defaults the histogram covers the full 32 bit
+ * range with 464 buckets (1856 bytes) and a relative error below 6.25%.
+ *
+ * NOTE: queries work on a snapshot(), which has the same size as the
+ *       histogram, keep it off small stacks
+ */
+template <unsigned SUB_BITS_V = 4, unsigned VALUE_BITS_V = 32>
+class histogram {
+public:
+    using layout        = histogram_layout<SUB_BITS_V, VALUE_BITS_V>;
+    using snapshot_type = histogram_snapshot<SUB_BITS_V, VALUE_BITS_V>;
+
+    constexpr histogram() noexcept = default;
+
+    histogram(const histogram&)            = delete;
+    histogram& operator=(const histogram&) = delete;
+
+    void record(std::uint32_t value) noexcept {
+        m_counts[layout::index(value)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// consistent per bucket, records during the copy may or may not be seen
+    [[nodiscard]] snapshot_type snapshot() const noexcept {
+        snapshot_type result;
+        for (std::size_t i = 0; i < layout::bucket_count; ++i) {
+            result.m_counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    /// takes a snapshot and clears the histogram, no sample gets lost
+    [[nodiscard]] snapshot_type exchange() noexcept {
+        snapshot_type result;
+        for (std::size_t i = 0; i < layout::bucket_count; ++i) {
+            result.m_counts[i] =
+                m_counts[i].exchange(0, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    void reset() noexcept {
+        for (auto& c : m_counts) {
+            c.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::array<std::atomic<std::uint32_t>, layout::bucket_count> m_counts{};
+};
+
+}  // namespace dis
+
+#endif  // DIS_OSAL_UTILS_HISTOGRAM_HPP
@@ -0,0 +1,278 @@
+#include "dis/osal/io/retarget.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+#ifndef DIS_IO_DRAIN_STACK
+// in words, the sinks run on this stack
+#define DIS_IO_DRAIN_STACK 256
+#endif
+
+namespace dis::io {
+namespace {
+
+static_assert((stdout_capacity & (stdout_capacity - 1)) == 0,
+              "DIS_IO_STDOUT_BUFFER must be a power of two");
+static_assert((stderr_capacity & (stderr_capacity - 1)) == 0,
+              "DIS_IO_STDERR_BUFFER must be a power of two");
+
+/**
+ * Positions are free running, only their difference is used.  `head` and
+ * the statistics are changed with interrupts masked, `tail` only by the
+ * task which set `draining`, so the sink works on [tail, flush_at) without
+ * any lock held.
+ */
+struct ring {
+    char* buffer{nullptr};
+    std::uint32_t capacity{0};
+    std::uint32_t head{0};
+    std::uint32_t tail{0};
+    /// head at the last flush request, the sink gets everything up to here
+    std::uint32_t flush_at{0};
+    std::uint32_t threshold{0};
+    bool draining{false};
+    sink device{};
+    stream_stats stats{};
+};
+
+std::array<char, stdout_capacity> s_out_buffer{};
+std::array<char, stderr_capacity> s_err_buffer{};
+
+ring s_out{.buffer = s_out_buffer.data(), .capacity = stdout_capacity};
+ring s_err{.buffer = s_err_buffer.data(), .capacity = stderr_capacity};
+sink s_in{};
+
+TaskHandle_t s_drain_handle = nullptr;
+StaticTask_t s_drain_tcb{};
+std::array<StackType_t, DIS_IO_DRAIN_STACK> s_drain_stack{};
+
+// usable from tasks and interrupts, also before the scheduler got started
+class interrupt_mask {
+public:
+    interrupt_mask() noexcept : m_mask(portSET_INTERRUPT_MASK_FROM_ISR()) {}
+    ~interrupt_mask() { portCLEAR_INTERRUPT_MASK_FROM_ISR(m_mask); }
+
+    interrupt_mask(const interrupt_mask&)            = delete;
+    interrupt_mask& operator=(const interrupt_mask&) = delete;
+
+private:
+    UBaseType_t m_mask;
+};
+
+inline ring* ring_of(stream target) noexcept {
+    switch (target) {
+        case stream::out:
+            return &s_out;
+        case stream::err:
+            return &s_err;
+        default:
+            return nullptr;
+    }
+}
+
+inline bool scheduler_running() noexcept {
+    return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+/// hands [tail, flush_at) to the sink, returns at once if another task does
+void drain(ring& r) noexcept {
+    {
+        interrupt_mask lock;
+        if (r.draining) {
+            return;
+        }
+        r.draining = true;
+    }
+
+    for (;;) {
+        std::uint32_t tail = 0;
+        std::uint32_t size = 0;
+        {
+            interrupt_mask lock;
+            tail = r.tail;
+            size = r.flush_at - tail;
+            if (size == 0) {
+                r.draining = false;
+                return;
+            }
+        }
+
+        // the sink works on the ring memory itself, a wrapped range takes
+        // two calls
+        const std::uint32_t offset = tail & (r.capacity - 1);
+        const std::uint32_t chunk  = std::min(size, r.capacity - offset);
+        const std::size_t taken =
+            r.device.write(r.device.context, r.buffer + offset, chunk);
+
+        interrupt_mask lock;
+        r.tail += chunk;
+        r.stats.dropped += chunk - static_cast<std::uint32_t>(
+                                       std::min<std::size_t>(taken, chunk));
+        ++r.stats.flushes;
+    }
+}
+
+/// empties the ring now or leaves it to the drain task
+void request_drain(ring& r) noexcept {
+    if (s_drain_handle != nullptr && scheduler_running()) {
+        if (xPortIsInsideInterrupt()) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(s_drain_handle, &woken);
+            portYIELD_FROM_ISR(woken);
+        } else {
+            xTaskNotifyGive(s_drain_handle);
+        }
+    } else if (!xPortIsInsideInterrupt()) {
+        // a sink may block, from an interrupt the data waits for the next
+        // write of a task
+        drain(r);
+    }
+}
+
+void drain_task(void*) {
+    for (;;) {
+        drain(s_err);
+        drain(s_out);
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+}  // namespace
+
+void attach(stream target,
+            const sink& device,
+            std::size_t flush_threshold) noexcept {
+    if (target == stream::in) {
+        s_in = device;
+        return;
+    }
+    ring* r = ring_of(target);
+    if (r == nullptr) {
+        return;
+    }
+
+    interrupt_mask lock;
+    r->device = device;
+    // stderr is unbuffered, the rest flushes at the latest when half full
+    r->threshold =
+        (target == stream::err)
+            ? 1U
+            : static_cast<std::uint32_t>(
+                  std::clamp<std::size_t>(flush_threshold, 1, r->capacity));
+}
+
+void start(UBaseType_t priority) noexcept {
+    if (s_drain_handle != nullptr) {
+        return;
+    }
+    std::setvbuf(stdin, nullptr, _IONBF, 0);
+    std::setvbuf(stdout, nullptr, _IONBF, 0);
+    std::setvbuf(stderr, nullptr, _IONBF, 0);
+
+    s_drain_handle =
+        xTaskCreateStatic(drain_task, "dis_io", s_drain_stack.size(), nullptr,
+                          priority, s_drain_stack.data(), &s_drain_tcb);
+}
+
+int write(stream target, const char* data, std::size_t size) noexcept {
+    ring* r = ring_of(target);
+    if (r == nullptr || r->device.write == nullptr) {
+        return -1;
+    }
+    const bool newline = std::memchr(data, '\n', size) != nullptr;
+
+    bool flush = false;
+    std::uint32_t taken = 0;
+    {
+        interrupt_mask lock;
+        // a write which does not fit is dropped as a whole, so the output
+        // keeps complete lines, only writes larger than the ring get cut
+        const std::uint32_t free = r->capacity - (r->head - r->tail);
+        if (size <= free) {
+            taken = static_cast<std::uint32_t>(size);
+        } else if (size > r->capacity) {
+            taken = free;
+        }
+
+        const std::uint32_t offset = r->head & (r->capacity - 1);
+        const std::uint32_t first  = std::min(taken, r->capacity - offset);
+        std::memcpy(r->buffer + offset, data, first);
+        std::memcpy(r->buffer, data + first, taken - first);
+
+        r->head += taken;
+        r->stats.written += taken;
+        r->stats.dropped += static_cast<std::uint32_t>(size - taken);
+
+        flush = newline || taken < size ||
+                (r->head - r->tail) >= r->threshold;
+        if (flush) {
+            r->flush_at = r->head;
+        }
+    }
+
+    if (flush) {
+        request_drain(*r);
+    }
+    return static_cast<int>(taken);
+}
+
+int read(char* data, std::size_t size) noexcept {
+    if (s_in.read == nullptr) {
+        return -1;
+    }
+    return static_cast<int>(s_in.read(s_in.context, data, size));
+}
+
+void flush(stream target) noexcept {
+    ring* r = ring_of(target);
+    if (r == nullptr || r->device.write == nullptr) {
+        return;
+    }
+    std::uint32_t until = 0;
+    {
+        interrupt_mask lock;
+        r->flush_at = r->head;
+        until       = r->head;
+    }
+    request_drain(*r);
+
+    // another task may still be busy with the ring
+    while (static_cast<std::int32_t>(until - r->tail) > 0 &&
+           scheduler_running() &&
+           xTaskGetCurrentTaskHandle() != s_drain_handle) {
+        vTaskDelay(1);
+    }
+}
+
+stream_stats stats(stream target) noexcept {
+    const ring* r = ring_of(target);
+    if (r == nullptr) {
+        return {};
+    }
+    interrupt_mask lock;
+    return r->stats;
+}
+
+}  // namespace dis::io
+
+// entry points of the newlib syscalls (src/syscalls.c)
+extern "C" {
+
+int dis_io_write(int file, const char* data, int len) {
+    const int taken = dis::io::write(static_cast<dis::io::stream>(file), data,
+                                     static_cast<std::size_t>(len));
+    // newlib retries a short write, the overflow is already counted as
+    // dropped
+    return (taken < 0) ? -1 : len;
+}
+
+int dis_io_read(int file, char* data, int len) {
+    if (file != static_cast<int>(dis::io::stream::in)) {
+        return -1;
+    }
+    return dis::io::read(data, static_cast<std::size_t>(len));
+}
+
+}  // extern "C"
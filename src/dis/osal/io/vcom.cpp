@@ -0,0 +1,355 @@
+#include "dis/osal/io/vcom.hpp"
+
+#include "dis/osal/io/vcom_hooks.h"
+#include "dis/osal/stats/profile.hpp"
+
+#include <semphr.h>
+#include <task.h>
+#include <usb_device.h>
+#include <usbd_cdc.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#ifndef DIS_VCOM_STACK
+// in words, only hands the buffers to the USB stack
+#define DIS_VCOM_STACK 256
+#endif
+
+#ifndef DIS_VCOM_WRITER_PRIORITY
+// a producer runs with at least this priority while it holds a reservation
+#define DIS_VCOM_WRITER_PRIORITY (configMAX_PRIORITIES - 1)
+#endif
+
+// defined in usb_device.c
+extern "C" USBD_HandleTypeDef hUsbDeviceFS;
+
+namespace dis::detail {
+namespace {
+
+static_assert(vcom_packet_size == CDC_DATA_FS_MAX_PACKET_SIZE);
+static_assert(DIS_VCOM_WRITER_PRIORITY < configMAX_PRIORITIES);
+
+// keeps the priority + 1 of a task holding a reservation, 0 otherwise
+constexpr BaseType_t writer_priority_slot = 0;
+static_assert(writer_priority_slot < configNUM_THREAD_LOCAL_STORAGE_POINTERS);
+
+/**
+ * Transmit pipeline
+ *
+ * Producers copy (or, after vcom_reserve, write) their data straight into
+ * one of the USB transfer buffers, there is no intermediate stream buffer.
+ * The buffers are used as a ring: while one of them is on the wire, the next
+ * one is filled.  The transfer complete interrupt recycles the buffer and
+ * directly starts the next one if it is already closed, so the bus does not
+ * idle between full buffers.  Otherwise it wakes up the tx task, which sends
+ * partially filled buffers.  A transfer spans the whole buffer, the CDC
+ * class terminates transfers which are a multiple of the packet size with a
+ * zero length packet.
+ *
+ * A producer reserves its bytes within the open buffer in a short critical
+ * section, copies and then commits.  Until the commit the buffer can not go
+ * on the wire, so a producer preempted in between would hold up all others
+ * once they ran out of buffers, whatever their priority.  The producer
+ * therefore runs with DIS_VCOM_WRITER_PRIORITY from the reservation to the
+ * commit, which bounds the time to the copy (interrupts and tasks of that
+ * priority still run).  Its own priority is kept in its thread local storage
+ * slot meanwhile, so a task holds one reservation at a time.  s_free_slots
+ * counts the free buffers, a producer takes one before it opens the next
+ * buffer of the ring.  Whoever finds the open buffer full closes it, so all
+ * producers move on to the next buffer together.
+ *
+ * Receive flow control
+ *
+ * Each OUT packet is queued into the rx stream buffer.  The endpoint is only
+ * armed for the next packet while the stream buffer has room for a full one,
+ * otherwise it is left NAKing: the host keeps the data and retries until
+ * vcom_receive made room and re-armed the endpoint.
+ */
+enum slot_state : std::uint8_t {
+    // recycled, may be opened by a producer
+    slot_free = 0,
+    // producers append to it
+    slot_open,
+    // waiting for the transfer
+    slot_closed,
+    // owned by the USB stack
+    slot_sending,
+};
+
+vcom_buffers s_buffers{};
+// open or most recently used by the producers
+std::size_t s_fill_slot = 0;
+// next buffer to go on the wire
+std::size_t s_send_slot = 0;
+// a transfer is in progress
+volatile bool s_tx_busy = false;
+
+SemaphoreHandle_t s_free_slots = nullptr;
+StaticSemaphore_t s_free_slots_buffer{};
+
+TaskHandle_t s_tx_handle = nullptr;
+StaticTask_t s_tx_tcb{};
+std::array<StackType_t, DIS_VCOM_STACK> s_tx_stack{};
+
+// the OUT endpoint is not armed, the host gets NAKs
+volatile bool s_rx_paused = false;
+TickType_t s_rx_paused_at = 0;
+vcom_rx_stats s_rx_stats{};
+
+inline std::byte* slot_data(std::size_t index) noexcept {
+    return s_buffers.tx_data.data() + index * s_buffers.tx_bytes;
+}
+
+/**
+ * Marks the oldest buffer as sending if it is ready to go: either closed, or
+ * still open but holding data, and nobody is writing to it anymore.  Called
+ * within a critical section while no transfer is in progress.
+ */
+vcom_slot* take_slot() noexcept {
+    vcom_slot& oldest = s_buffers.tx_slots[s_send_slot];
+    if (oldest.writers == 0 &&
+        (oldest.state == slot_closed ||
+         (oldest.state == slot_open && oldest.len > 0))) {
+        oldest.state = slot_sending;
+        s_tx_busy    = true;
+        return &oldest;
+    }
+    return nullptr;
+}
+
+void start_slot(vcom_slot& slot) noexcept {
+    const auto index =
+        static_cast<std::size_t>(&slot - s_buffers.tx_slots.data());
+    USBD_CDC_SetTxBuffer(&hUsbDeviceFS,
+                         reinterpret_cast<std::uint8_t*>(slot_data(index)),
+                         slot.len);
+    USBD_CDC_TransmitPacket(&hUsbDeviceFS);
+}
+
+/// called from the CDC class once a transfer (including its zero length
+/// packet) completed, TxState is already reset
+void tx_complete() {
+    BaseType_t woken = pdFALSE;
+    vcom_slot* next  = nullptr;
+
+    const UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    s_buffers.tx_slots[s_send_slot].state = slot_free;
+    s_send_slot = (s_send_slot + 1) % s_buffers.tx_slots.size();
+    s_tx_busy   = false;
+    if (s_buffers.tx_slots[s_send_slot].state == slot_closed) {
+        next = take_slot();
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+
+    if (next != nullptr) {
+        start_slot(*next);
+    } else {
+        vTaskNotifyGiveFromISR(s_tx_handle, &woken);
+    }
+    xSemaphoreGiveFromISR(s_free_slots, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * Woken by the producers and by tx_complete.  While no transfer is in
+ * progress, the oldest buffer is sent once all of its reservations are
+ * committed, the open one only if it holds data.
+ */
+void tx_task(void*) {
+    USBD_CDC_HandleTypeDef* cdc = nullptr;
+    while (cdc == nullptr) {
+        cdc = static_cast<USBD_CDC_HandleTypeDef*>(hUsbDeviceFS.pClassData);
+        vTaskDelay(10);
+    }
+    // wait for a transfer started by somebody else
+    while (cdc->TxState != 0) {
+        vTaskDelay(1);
+    }
+    cdc->TxCallBack = tx_complete;
+
+    for (;;) {
+        vcom_slot* slot = nullptr;
+        taskENTER_CRITICAL();
+        if (!s_tx_busy) {
+            slot = take_slot();
+        }
+        taskEXIT_CRITICAL();
+
+        if (slot != nullptr) {
+            start_slot(*slot);
+        }
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/// re-arms the paused OUT endpoint once a full packet fits again, the
+/// critical section keeps rx_complete out
+void resume_rx() noexcept {
+    taskENTER_CRITICAL();
+    if (s_rx_paused && xStreamBufferSpacesAvailable(s_buffers.rx_stream) >=
+                           CDC_DATA_FS_OUT_PACKET_SIZE) {
+        s_rx_paused = false;
+        s_rx_stats.nak_ticks += xTaskGetTickCount() - s_rx_paused_at;
+        USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+    }
+    taskEXIT_CRITICAL();
+}
+
+/// queues an OUT packet, the endpoint stays NAKing until resume_rx found
+/// room for the next one
+void rx_complete(const std::uint8_t* data, std::uint32_t size) noexcept {
+    BaseType_t woken = pdFALSE;
+    const std::size_t queued =
+        xStreamBufferSendFromISR(s_buffers.rx_stream, data, size, &woken);
+    s_rx_stats.bytes += static_cast<std::uint32_t>(queued);
+    s_rx_stats.dropped += size - static_cast<std::uint32_t>(queued);
+
+    if (xStreamBufferSpacesAvailable(s_buffers.rx_stream) >=
+        CDC_DATA_FS_OUT_PACKET_SIZE) {
+        USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+    } else {
+        s_rx_paused    = true;
+        s_rx_paused_at = xTaskGetTickCountFromISR();
+        ++s_rx_stats.pauses;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+}  // namespace
+
+void vcom_init(const vcom_buffers& buffers, UBaseType_t priority) noexcept {
+    configASSERT(s_tx_handle == nullptr);
+    configASSERT(buffers.rx_stream != nullptr);
+    s_buffers = buffers;
+
+    // the first buffer starts out open
+    s_buffers.tx_slots[0].state = slot_open;
+    const auto slots = static_cast<UBaseType_t>(s_buffers.tx_slots.size());
+    s_free_slots =
+        xSemaphoreCreateCountingStatic(slots, slots - 1, &s_free_slots_buffer);
+
+    s_tx_handle =
+        xTaskCreateStatic(tx_task, "usbTx", s_tx_stack.size(), nullptr,
+                          priority, s_tx_stack.data(), &s_tx_tcb);
+
+    // last, the first packet may arrive right away
+    MX_USB_DEVICE_Init();
+}
+
+std::byte* vcom_reserve(std::size_t size, io::deadline until) noexcept {
+    for (;;) {
+        taskENTER_CRITICAL();
+        vcom_slot& slot = s_buffers.tx_slots[s_fill_slot];
+        if (slot.state == slot_open) {
+            if (s_buffers.tx_bytes - slot.len >= size) {
+                std::byte* reserved = slot_data(s_fill_slot) + slot.len;
+                slot.len += static_cast<std::uint16_t>(size);
+                ++slot.writers;
+                // restored by vcom_commit, raising the own priority never
+                // yields
+                const UBaseType_t priority = uxTaskPriorityGet(nullptr);
+                configASSERT(pvTaskGetThreadLocalStoragePointer(
+                                 nullptr, writer_priority_slot) == nullptr);
+                vTaskSetThreadLocalStoragePointer(
+                    nullptr, writer_priority_slot,
+                    reinterpret_cast<void*>(priority + 1));
+                if (priority < DIS_VCOM_WRITER_PRIORITY) {
+                    vTaskPrioritySet(nullptr, DIS_VCOM_WRITER_PRIORITY);
+                }
+                taskEXIT_CRITICAL();
+                return reserved;
+            }
+            slot.state = slot_closed;
+        }
+        taskEXIT_CRITICAL();
+
+        // the closed buffer may go on the wire right away
+        xTaskNotifyGive(s_tx_handle);
+
+        if (xSemaphoreTake(s_free_slots, until.remaining()) != pdPASS) {
+            return nullptr;
+        }
+
+        // buffers are recycled in order, so the next one is free now.
+        // Another producer may have opened it in the meantime, the free
+        // buffer we were given is returned then
+        bool opened = false;
+        taskENTER_CRITICAL();
+        if (s_buffers.tx_slots[s_fill_slot].state != slot_open) {
+            s_fill_slot = (s_fill_slot + 1) % s_buffers.tx_slots.size();
+            vcom_slot& next = s_buffers.tx_slots[s_fill_slot];
+            next.len        = 0;
+            next.writers    = 0;
+            next.state      = slot_open;
+            opened          = true;
+        }
+        taskEXIT_CRITICAL();
+
+        if (!opened) {
+            xSemaphoreGive(s_free_slots);
+        }
+    }
+}
+
+void vcom_commit(const std::byte* reserved) noexcept {
+    // reservations never cross buffers
+    const auto index = static_cast<std::size_t>(
+        (reserved - s_buffers.tx_data.data()) / s_buffers.tx_bytes);
+
+    taskENTER_CRITICAL();
+    --s_buffers.tx_slots[index].writers;
+    taskEXIT_CRITICAL();
+    xTaskNotifyGive(s_tx_handle);
+
+    // back to the own priority last, this may switch to the tx task
+    const auto priority = reinterpret_cast<std::uintptr_t>(
+        pvTaskGetThreadLocalStoragePointer(nullptr, writer_priority_slot));
+    configASSERT(priority != 0);
+    vTaskSetThreadLocalStoragePointer(nullptr, writer_priority_slot, nullptr);
+    vTaskPrioritySet(nullptr, static_cast<UBaseType_t>(priority - 1));
+}
+
+std::size_t vcom_transmit(io::segment_list data, io::deadline until) noexcept {
+    // one reservation for the whole frame, so it is never torn apart by
+    // other producers or the deadline
+    const std::size_t size = io::size_of(data);
+    if (size == 0 || size > s_buffers.tx_bytes) {
+        return 0;
+    }
+    std::byte* reserved = vcom_reserve(size, until);
+    if (reserved == nullptr) {
+        return 0;
+    }
+    {
+        DIS_PROFILE_SCOPE("vcom_tx_copy");
+        (void)io::gather(data, 0, {reserved, size});
+    }
+    vcom_commit(reserved);
+    return size;
+}
+
+std::size_t vcom_receive(std::span<std::byte> data,
+                         io::deadline until) noexcept {
+    const std::size_t size = xStreamBufferReceive(
+        s_buffers.rx_stream, data.data(), data.size(), until.remaining());
+    resume_rx();
+    return size;
+}
+
+vcom_rx_stats vcom_stats() noexcept {
+    taskENTER_CRITICAL();
+    vcom_rx_stats stats = s_rx_stats;
+    if (s_rx_paused) {
+        // include the pause which is still going on
+        stats.nak_ticks += xTaskGetTickCount() - s_rx_paused_at;
+    }
+    taskEXIT_CRITICAL();
+    return stats;
+}
+
+}  // namespace dis::detail
+
+extern "C" void dis_vcom_rx_complete(const uint8_t* data, uint32_t size) {
+    dis::detail::rx_complete(data, size);
+}
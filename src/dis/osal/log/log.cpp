@@ -0,0 +1,97 @@
+#include "dis/osal/log/log.hpp"
+#include "dis/osal/utils/cycle_counter.hpp"
+
+#include <atomic>
+
+// exported with C linkage, so a debugger finds it by name.  Statements may
+// run before main(), so the header is initialized statically, the clock is
+// only known at run time.
+extern "C" {
+dis::log::memory_type dis_log_memory{
+    .header = {.magic         = dis::log::dump_magic,
+               .version       = dis::log::dump_version,
+               .slot_size     = sizeof(dis::log::slot),
+               .cpu_hz        = 0,
+               .slot_capacity = dis::log::slot_capacity,
+               .slots_written = 0,
+               .reserved      = 0},
+    .slots  = {},
+};
+
+#if defined(DIS_OSAL_POSIX)
+// provided by the linker for sections named like a C identifier
+extern const char __start_dis_log_sites[] __attribute__((weak));
+#endif
+}
+
+namespace dis::log {
+namespace {
+
+constexpr std::uint32_t slot_mask = slot_capacity - 1;
+
+volatile bool s_running = true;
+
+inline auto& header() noexcept { return dis_log_memory.header; }
+
+inline std::uint16_t site_id(const char* site) noexcept {
+#if defined(DIS_OSAL_POSIX)
+    return static_cast<std::uint16_t>(site - __start_dis_log_sites);
+#else
+    // the linker script places the site section at address 0
+    return static_cast<std::uint16_t>(reinterpret_cast<std::uintptr_t>(site));
+#endif
+}
+
+}  // namespace
+
+void start() noexcept { s_running = true; }
+void stop() noexcept { s_running = false; }
+bool is_running() noexcept { return s_running; }
+
+std::span<const std::byte> dump() noexcept {
+    // the clock may have been changed since the start
+    header().cpu_hz = this_cpu::cycles_per_second();
+    return std::as_bytes(std::span{&dis_log_memory, 1});
+}
+
+}  // namespace dis::log
+
+namespace dis::detail {
+
+using namespace dis::log;
+
+void log_commit(const char* site,
+                const std::uint32_t* words,
+                std::size_t count) noexcept {
+    if (!s_running) {
+        return;
+    }
+    // like dis::trace, reserving the slots is the only synchronization
+    // needed, a preempting statement gets the slots behind ours
+    const std::uint32_t first =
+        std::atomic_ref<std::uint32_t>(header().slots_written)
+            .fetch_add(static_cast<std::uint32_t>(slots_for(count)),
+                       std::memory_order_relaxed);
+
+    slot& head   = dis_log_memory.slots[first & slot_mask];
+    head.kind    = slot_kind::head;
+    head.words   = static_cast<std::uint8_t>(count);
+    head.id      = site_id(site);
+    head.data[0] = static_cast<std::uint32_t>(this_cpu::cycles());
+
+    std::size_t word = 0;
+    for (; word < count && word < head_words; ++word) {
+        head.data[1 + word] = words[word];
+    }
+    for (std::uint32_t idx = first + 1; word < count; ++idx) {
+        slot& cont = dis_log_memory.slots[idx & slot_mask];
+        cont.kind  = slot_kind::continuation;
+        cont.words = 0;
+        cont.id    = 0;
+        for (std::size_t i = 0; i < continuation_words; ++i, ++word) {
+            cont.data[i] = word < count ? words[word] : 0;
+        }
+    }
+}
+
+}  // namespace dis::detail
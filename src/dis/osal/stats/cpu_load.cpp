@@ -0,0 +1,229 @@
+#include "dis/osal/stats/cpu_load.hpp"
+#include "dis/osal/utils/cycle_counter.hpp"
+
+#include <algorithm>
+
+#ifndef DIS_STATS_RUN_TIME_SHIFT
+// run time counter handed to the kernel in CYCCNT / 256 (843kHz at 216MHz),
+// the 32 bit counters of vTaskGetRunTimeStats then wrap after ~85 minutes
+#define DIS_STATS_RUN_TIME_SHIFT 8
+#endif
+
+namespace dis::stats {
+namespace {
+
+struct task_slot {
+    TaskHandle_t handle{nullptr};
+    const char* name{nullptr};
+    std::uint64_t cycles{0};
+    std::uint32_t voluntary{0};
+    std::uint32_t preempted{0};
+};
+
+using snapshot = cpu_load_mark;
+
+// all state is only modified from within the kernel (scheduler locked or
+// inside of the tick interrupt) or with interrupts masked
+std::array<task_slot, max_tasks> s_slots{};
+std::array<snapshot, window_count> s_history{};
+std::size_t s_history_head     = 0;
+std::size_t s_history_size     = 0;
+TickType_t s_ticks_in_window   = 0;
+
+std::uint32_t s_current_slot   = 0;
+std::uint64_t s_switched_in_at = 0;
+std::uint64_t s_isr_at_switch  = 0;
+
+std::uint64_t s_isr_cycles     = 0;
+std::uint64_t s_isr_entered_at = 0;
+std::uint32_t s_isr_nesting    = 0;
+
+// kept out of the (small) stack of the calling task
+snapshot s_live{};
+
+inline std::uint64_t isr_cycles_until(std::uint64_t now) noexcept {
+    return (s_isr_nesting > 0) ? s_isr_cycles + (now - s_isr_entered_at)
+                               : s_isr_cycles;
+}
+
+void take_snapshot(snapshot& snap) noexcept {
+    const std::uint64_t now = this_cpu::cycles64();
+    const std::uint64_t isr = isr_cycles_until(now);
+
+    snap.timestamp  = now;
+    snap.isr_cycles = isr;
+    for (std::size_t idx = 0; idx < max_tasks; ++idx) {
+        snap.handles[idx]   = s_slots[idx].handle;
+        snap.cycles[idx]    = s_slots[idx].cycles;
+        snap.voluntary[idx] = s_slots[idx].voluntary;
+        snap.preempted[idx] = s_slots[idx].preempted;
+    }
+
+    // the running task has not been accounted for its current slice yet
+    if (s_current_slot > 0) {
+        snap.cycles[s_current_slot - 1] +=
+            (now - s_switched_in_at) - (isr - s_isr_at_switch);
+    }
+}
+
+void push_snapshot() noexcept {
+    s_history_head = (s_history_head + 1) % window_count;
+    take_snapshot(s_history[s_history_head]);
+    s_history_size = std::min(s_history_size + 1, window_count);
+}
+
+inline std::uint32_t permille(std::uint64_t part, std::uint64_t total) {
+    return (total > 0) ? static_cast<std::uint32_t>((part * 1000U) / total)
+                       : 0U;
+}
+
+/// called within a critical section
+cpu_load_report make_report(const snapshot& begin,
+                            const snapshot& end) noexcept {
+    cpu_load_report report{};
+    report.window_cycles = end.timestamp - begin.timestamp;
+    report.isr_cycles    = end.isr_cycles - begin.isr_cycles;
+    report.isr_permille  = permille(report.isr_cycles, report.window_cycles);
+
+    for (std::size_t idx = 0; idx < max_tasks; ++idx) {
+        if (end.handles[idx] == nullptr) {
+            continue;
+        }
+        // slot got reused (or the task was created) within the window
+        const bool same_task = (begin.handles[idx] == end.handles[idx]);
+
+        task_load& load = report.tasks[report.task_count++];
+        load.handle     = end.handles[idx];
+        load.name       = s_slots[idx].name;
+        load.cycles = end.cycles[idx] - (same_task ? begin.cycles[idx] : 0U);
+        load.voluntary_switches =
+            end.voluntary[idx] - (same_task ? begin.voluntary[idx] : 0U);
+        load.preemptions =
+            end.preempted[idx] - (same_task ? begin.preempted[idx] : 0U);
+        load.permille = permille(load.cycles, report.window_cycles);
+    }
+    return report;
+}
+
+}  // namespace
+
+cpu_load_report cpu_load(std::size_t windows) noexcept {
+    taskENTER_CRITICAL();
+    const snapshot* end = &s_history[s_history_head];
+    std::size_t back    = 0;
+    if (s_history_size < 2) {
+        // not a single window completed yet, report everything up to now
+        take_snapshot(s_live);
+        end = &s_live;
+    } else {
+        back = std::clamp<std::size_t>(windows, 1, s_history_size - 1);
+    }
+    const snapshot& begin =
+        s_history[(s_history_head + window_count - back) % window_count];
+    const cpu_load_report report = make_report(begin, *end);
+    taskEXIT_CRITICAL();
+
+    return report;
+}
+
+cpu_load_mark mark_cpu_load() noexcept {
+    cpu_load_mark mark{};
+    taskENTER_CRITICAL();
+    take_snapshot(mark);
+    taskEXIT_CRITICAL();
+    return mark;
+}
+
+cpu_load_report cpu_load_since(const cpu_load_mark& begin) noexcept {
+    taskENTER_CRITICAL();
+    take_snapshot(s_live);
+    const cpu_load_report report = make_report(begin, s_live);
+    taskEXIT_CRITICAL();
+
+    return report;
+}
+
+}  // namespace dis::stats
+
+using namespace dis::stats;
+
+extern "C" {
+
+void dis_stats_configure_timer(void) {
+    dis::this_cpu::enable_cycle_counter();
+    s_history_head    = 0;
+    s_history_size    = 0;
+    s_ticks_in_window = 0;
+    s_isr_cycles      = 0;
+    s_isr_nesting     = 0;
+    push_snapshot();
+}
+
+uint32_t dis_stats_run_time_counter(void) {
+    return static_cast<uint32_t>(dis::this_cpu::cycles64() >>
+                                 DIS_STATS_RUN_TIME_SHIFT);
+}
+
+uint32_t dis_stats_task_created(void* task, const char* name) {
+    for (std::size_t idx = 0; idx < max_tasks; ++idx) {
+        if (s_slots[idx].handle == nullptr) {
+            s_slots[idx] = {static_cast<TaskHandle_t>(task), name, 0, 0, 0};
+            return static_cast<uint32_t>(idx + 1);
+        }
+    }
+    return 0;
+}
+
+void dis_stats_task_deleted(uint32_t slot) {
+    if (slot > 0) {
+        s_slots[slot - 1].handle = nullptr;
+    }
+}
+
+void dis_stats_task_switched_in(uint32_t slot) {
+    s_current_slot   = slot;
+    s_switched_in_at = dis::this_cpu::cycles64();
+    s_isr_at_switch  = s_isr_cycles;
+}
+
+void dis_stats_task_switched_out(uint32_t slot, int still_ready) {
+    const std::uint64_t now = dis::this_cpu::cycles64();
+    if (slot > 0) {
+        task_slot& task = s_slots[slot - 1];
+        task.cycles +=
+            (now - s_switched_in_at) - (s_isr_cycles - s_isr_at_switch);
+        if (still_ready) {
+            ++task.preempted;
+        } else {
+            ++task.voluntary;
+        }
+    }
+    s_current_slot = 0;
+}
+
+void dis_stats_tick(void) {
+    // also keeps the 64 bit extension of the cycle counter up to date
+    (void)dis::this_cpu::cycles64();
+    if (++s_ticks_in_window >= window_ticks) {
+        s_ticks_in_window = 0;
+        push_snapshot();
+    }
+}
+
+void dis_stats_isr_enter(void) {
+    const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    if (s_isr_nesting++ == 0) {
+        s_isr_entered_at = dis::this_cpu::cycles64();
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+void dis_stats_isr_exit(void) {
+    const UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    if (--s_isr_nesting == 0) {
+        s_isr_cycles += dis::this_cpu::cycles64() - s_isr_entered_at;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+}  // extern "C"
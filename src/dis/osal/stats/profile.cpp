@@ -0,0 +1,36 @@
+#include "dis/osal/stats/profile.hpp"
+
+#if defined(DIS_OSAL_POSIX)
+// generated by the host linker for every section with a C identifier as
+// name, weak as the section is missing if no site is compiled in
+extern "C" {
+extern dis::stats::profile_site __start_dis_profile_sites[]
+    __attribute__((weak));
+extern dis::stats::profile_site __stop_dis_profile_sites[]
+    __attribute__((weak));
+}
+#else
+// provided by the linker script around the dis_profile_sites section
+extern "C" {
+extern dis::stats::profile_site __dis_profile_sites_start[];
+extern dis::stats::profile_site __dis_profile_sites_end[];
+}
+#endif
+
+namespace dis::stats {
+
+std::span<profile_site> profile_sites() noexcept {
+#if defined(DIS_OSAL_POSIX)
+    return {__start_dis_profile_sites, __stop_dis_profile_sites};
+#else
+    return {__dis_profile_sites_start, __dis_profile_sites_end};
+#endif
+}
+
+void profile_reset() noexcept {
+    for (auto& site : profile_sites()) {
+        site.reset();
+    }
+}
+
+}  // namespace dis::stats
@@ -0,0 +1,129 @@
+#include "dis/osal/trace/recorder.hpp"
+#include "dis/osal/utils/cycle_counter.hpp"
+
+#include <atomic>
+#include <cstring>
+
+// exported with C linkage, so a debugger finds it by name.  Objects may be
+// created before main(), so the header is initialized statically, the clock
+// is only known at run time.
+extern "C" {
+dis::trace::memory_type dis_trace_memory{
+    .header = {.magic          = dis::trace::dump_magic,
+               .version        = dis::trace::dump_version,
+               .event_size     = sizeof(dis::trace::event),
+               .cpu_hz         = 0,
+               .event_capacity = dis::trace::event_capacity,
+               .name_capacity  = dis::trace::name_capacity,
+               .events_written = 0,
+               .names_written  = 0,
+               .reserved       = 0},
+    .names  = {},
+    .events = {},
+};
+}
+
+namespace dis::trace {
+namespace {
+
+constexpr std::uint32_t event_mask = event_capacity - 1;
+
+volatile bool s_running = true;
+std::atomic<std::uint32_t> s_next_object_number{0};
+
+inline auto& header() noexcept { return dis_trace_memory.header; }
+
+inline void record(event_type type,
+                   std::uint32_t id,
+                   std::uint8_t detail = 0) noexcept {
+    if (!s_running) {
+        return;
+    }
+    // the stamp is taken with the slot, else an interrupt in between would
+    // record an earlier slot with a later stamp.  Filling the slot needs no
+    // lock, an interrupt that preempts us simply gets the next one.
+    const UBaseType_t mask        = portSET_INTERRUPT_MASK_FROM_ISR();
+    const std::uint32_t timestamp = this_cpu::cycles();
+    const std::uint32_t idx =
+        std::atomic_ref<std::uint32_t>(header().events_written)
+            .fetch_add(1, std::memory_order_relaxed);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    event& evt = dis_trace_memory.events[idx & event_mask];
+    evt        = {timestamp, type, detail, static_cast<std::uint16_t>(id)};
+}
+
+void add_name(std::uint32_t id, object_kind kind, const char* name) noexcept {
+    const std::uint32_t idx =
+        std::atomic_ref<std::uint32_t>(header().names_written)
+            .fetch_add(1, std::memory_order_relaxed);
+    name_entry& entry = dis_trace_memory.names[idx % name_capacity];
+    entry.id          = static_cast<std::uint16_t>(id);
+    entry.kind        = kind;
+    entry.reserved    = 0;
+    std::strncpy(entry.name, name, sizeof(entry.name) - 1);
+    entry.name[sizeof(entry.name) - 1] = '\0';
+}
+
+inline std::uint32_t exception_number() noexcept {
+#if defined(DIS_OSAL_POSIX)
+    // the POSIX port runs all simulated interrupts from one signal handler
+    return 0;
+#else
+    return __get_IPSR() & 0x1FFU;
+#endif
+}
+
+}  // namespace
+
+void start() noexcept { s_running = true; }
+void stop() noexcept { s_running = false; }
+bool is_running() noexcept { return s_running; }
+
+void user_event(std::uint16_t id) noexcept { record(event_type::user, id); }
+
+std::span<const std::byte> dump() noexcept {
+    // the clock may have been changed since the start
+    header().cpu_hz = this_cpu::cycles_per_second();
+    return std::as_bytes(std::span{&dis_trace_memory, 1});
+}
+
+}  // namespace dis::trace
+
+using namespace dis::trace;
+
+extern "C" {
+
+void dis_trace_event(uint8_t type, uint32_t id) {
+    record(static_cast<event_type>(type), id);
+}
+
+void dis_trace_task_created(uint32_t task_number, const char* name) {
+    header().cpu_hz = dis::this_cpu::cycles_per_second();
+    add_name(task_number, object_kind::task, name);
+    record(event_type::task_create, task_number,
+           static_cast<std::uint8_t>(object_kind::task));
+}
+
+uint32_t dis_trace_object_created(uint8_t kind) {
+    const std::uint32_t number =
+        s_next_object_number.fetch_add(1, std::memory_order_relaxed) + 1;
+    record(event_type::object_create, number, kind);
+    return number;
+}
+
+void dis_trace_object_named(uint32_t object_number,
+                            uint8_t kind,
+                            const char* name) {
+    add_name(object_number, static_cast<object_kind>(kind), name);
+}
+
+void dis_trace_isr_enter(void) {
+    record(event_type::isr_enter, exception_number());
+}
+
+void dis_trace_isr_exit(void) {
+    record(event_type::isr_exit, exception_number());
+}
+
+}  // extern "C"
@@ -0,0 +1,177 @@
+/**
+ * ADC1 scan acquisition with dis::adc::scanner
+ *
+ * A0 (PA3, ADC1_IN3) and A1 (PC0, ADC1_IN10) of the Arduino header get
+ * sampled `scan_rate` times per second, triggered by TIM6, and the DMA
+ * hands blocks of `block_scans` scans to the consumer task, one
+ * notification per block.  The task keeps the mean, minimum and maximum
+ * of each channel and once a second sends a line over USB CDC:
+ *
+ *   adc blocks=781 skipped=0 torn=0 overrun=0 a0=2047/12/4083 a1=...
+ *
+ * with the blocks of the last second and their mean/min/max in raw 12 bit
+ * counts, the skipped and torn blocks count since the start.  A line which
+ * does not fit into the USB buffer right away is dropped, so a slow host
+ * never holds up the consumer.  The green LED shows that blocks arrive,
+ * the red one that the consumer fell behind (skipped or torn blocks) or the
+ * ADC overran.
+ */
+
+#include "dis/osal/io/adc/scanner.hpp"
+#include "dis/osal/io/vcom.hpp"
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <Nucleo_F767ZI_GPIO.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <span>
+
+// 128 * 4 = 512 bytes
+//(recommended min stack size per task)
+#define STACK_SIZE 128
+
+namespace {
+
+using usb_port = dis::vcom<1024, 1024>;
+
+constexpr std::size_t channels     = 2;
+constexpr std::size_t block_scans  = 256;
+constexpr std::uint32_t scan_rate  = 200000;
+constexpr UBaseType_t adc_priority = configMAX_PRIORITIES - 2;
+constexpr TickType_t report_period = pdMS_TO_TICKS(1000);
+
+using scanner_type = dis::adc::scanner<channels, block_scans>;
+
+scanner_type s_adc{{{
+    {ADC_CHANNEL_3, ADC_SAMPLETIME_15CYCLES},
+    {ADC_CHANNEL_10, ADC_SAMPLETIME_15CYCLES},
+}}};
+
+struct channel_summary {
+    std::uint64_t sum{0};
+    std::uint32_t count{0};
+    std::uint16_t min{UINT16_MAX};
+    std::uint16_t max{0};
+};
+
+void init_pins() {
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+
+    GPIO_InitTypeDef pin{};
+    pin.Mode = GPIO_MODE_ANALOG;
+    pin.Pull = GPIO_NOPULL;
+    pin.Pin  = GPIO_PIN_3;
+    HAL_GPIO_Init(GPIOA, &pin);
+    pin.Pin = GPIO_PIN_0;
+    HAL_GPIO_Init(GPIOC, &pin);
+}
+
+void report(std::uint32_t blocks,
+            const std::array<channel_summary, channels>& summary) {
+    static char line[160];
+    const dis::adc::handoff_stats stats = s_adc.stats();
+    int len = std::snprintf(
+        line, sizeof(line),
+        "adc blocks=%" PRIu32 " skipped=%" PRIu32 " torn=%" PRIu32
+        " overrun=%d",
+        blocks, stats.skipped, stats.torn, s_adc.overrun() ? 1 : 0);
+    for (std::size_t channel = 0; channel < channels; ++channel) {
+        const channel_summary& part = summary[channel];
+        const auto mean             = static_cast<std::uint32_t>(
+            part.count == 0 ? 0 : part.sum / part.count);
+        len += std::snprintf(line + len, sizeof(line) - len,
+                             " a%u=%" PRIu32 "/%u/%u",
+                             static_cast<unsigned>(channel), mean,
+                             static_cast<unsigned>(part.min),
+                             static_cast<unsigned>(part.max));
+    }
+    len += std::snprintf(line + len, sizeof(line) - len, "\n");
+
+    // never waits for the host
+    usb_port port;
+    (void)dis::io::transmit(
+        port,
+        std::as_bytes(std::span{line, static_cast<std::size_t>(len)}),
+        dis::io::deadline::at(xTaskGetTickCount()));
+
+    if (stats.skipped != 0 || stats.torn != 0 || s_adc.overrun()) {
+        RedLed.On();
+    }
+}
+
+void adc_task(void*) {
+    assert_param(s_adc.start(scan_rate, xTaskGetCurrentTaskHandle()));
+
+    std::array<channel_summary, channels> summary{};
+    std::uint32_t blocks   = 0;
+    TickType_t last_report = xTaskGetTickCount();
+    bool led               = false;
+    for (;;) {
+        if (const auto block = s_adc.next(report_period)) {
+            std::array<channel_summary, channels> part = summary;
+            for (std::size_t scan = 0; scan < block_scans; ++scan) {
+                for (std::size_t channel = 0; channel < channels; ++channel) {
+                    const std::uint16_t sample = block->sample(scan, channel);
+                    channel_summary& sum       = part[channel];
+                    sum.sum += sample;
+                    sum.min = std::min(sum.min, sample);
+                    sum.max = std::max(sum.max, sample);
+                }
+            }
+            // a block the DMA overwrote while it got read is left out
+            if (s_adc.release(*block)) {
+                for (channel_summary& sum : part) {
+                    sum.count += block_scans;
+                }
+                summary = part;
+                if (++blocks % 64 == 0) {
+                    led = !led;
+                    led ? GreenLed.On() : GreenLed.Off();
+                }
+            }
+        }
+
+        if (xTaskGetTickCount() - last_report >= report_period) {
+            last_report = xTaskGetTickCount();
+            report(blocks, summary);
+            summary = {};
+            blocks  = 0;
+        }
+    }
+}
+
+}  // namespace
+
+extern "C" void DMA2_Stream0_IRQHandler(void) {
+    DIS_ISR_ENTER();
+    s_adc.dma_irq_from_isr();
+    DIS_ISR_EXIT();
+}
+
+int main(void) {
+    HWInit();
+    HAL_NVIC_SetPriorityGrouping(
+        NVIC_PRIORITYGROUP_4);  // ensure proper priority grouping for freeRTOS
+
+    usb_port::init(tskIDLE_PRIORITY + 2);
+    init_pins();
+
+    assert_param(xTaskCreate(adc_task, "adc", STACK_SIZE * 4, NULL,
+                             adc_priority, NULL) == pdPASS);
+
+    // start the scheduler - shouldn't return unless there's a problem
+    vTaskStartScheduler();
+
+    // if you've wound up here, there is likely an issue with overrunning the
+    // freeRTOS heap
+    while (1) {
+    }
+}
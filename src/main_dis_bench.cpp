@@ -0,0 +1,454 @@
+/**
+ * Microbenchmarks of the kernel primitives and the dis:: OSAL wrappers
+ *
+ * Every benchmark is run `iterations` times, each iteration is measured with
+ * the cycle counter (the cost of reading the counter is subtracted).  The
+ * results are streamed over USB CDC as one line per benchmark:
+ *
+ *   begin dis_bench version=1 cpu_hz=216000000 iterations=1000 overhead=1
+ *   bench name=queue_send_receive size=64 min=412 median=420 p99=455
+ *   ...
+ *   end
+ *
+ * All values are cycles, `size` is the item size or chunk size in bytes for
+ * the benchmarks which take one.  The format is kept stable, so two runs can
+ * be diffed to catch regressions in FreeRTOSConfig.h or the dis:: wrappers.
+ * The suite starts as soon as the host sends any byte over the virtual com
+ * port and repeats on every further byte.
+ */
+
+#include "dis/osal/io/vcom.hpp"
+#include "dis/osal/log/log.hpp"
+#include "dis/osal/thread/mutex.hpp"
+#include "dis/osal/thread/semaphore.hpp"
+#include "dis/osal/utils/cycle_counter.hpp"
+#include "dis/osal/utils/format.hpp"
+
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <stream_buffer.h>
+#include <task.h>
+#include <timers.h>
+
+#include <Nucleo_F767ZI_GPIO.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <span>
+
+// 128 * 4 = 512 bytes
+//(recommended min stack size per task)
+#define STACK_SIZE 128
+
+namespace {
+
+using usb_port = dis::vcom<1024, 1024>;
+
+constexpr std::size_t iterations       = 1000;
+constexpr UBaseType_t bench_priority   = configMAX_PRIORITIES - 2;
+constexpr UBaseType_t partner_priority = configMAX_PRIORITIES - 1;
+
+constexpr std::array<std::size_t, 4> queue_item_sizes{4, 16, 64, 256};
+constexpr std::array<std::size_t, 4> stream_chunk_sizes{16, 64, 256, 1024};
+constexpr std::size_t max_payload = 1024;
+
+struct result {
+    std::uint32_t min;
+    std::uint32_t median;
+    std::uint32_t p99;
+};
+
+std::array<std::uint32_t, iterations> s_samples{};
+std::uint32_t s_overhead = 0;
+
+std::array<std::uint8_t, max_payload> s_tx_payload{};
+std::array<std::uint8_t, max_payload> s_rx_payload{};
+
+// state shared with the partner tasks
+TaskHandle_t s_bench_handle     = nullptr;
+TaskHandle_t s_partner_handle   = nullptr;
+volatile bool s_stamp_valid     = false;
+volatile std::uint32_t s_stamp  = 0;
+volatile std::uint32_t s_sample = 0;
+
+inline std::uint32_t now() noexcept { return dis::this_cpu::cycles(); }
+
+inline std::uint32_t corrected(std::uint32_t cycles) noexcept {
+    return cycles > s_overhead ? cycles - s_overhead : 0;
+}
+
+/// runs `once` (which returns the cycles of one iteration) and evaluates
+template <class FN_T>
+result measure(FN_T&& once) {
+    for (auto& sample : s_samples) {
+        sample = corrected(once());
+    }
+    std::sort(s_samples.begin(), s_samples.end());
+    return {s_samples.front(), s_samples[iterations / 2],
+            s_samples[(iterations * 99) / 100]};
+}
+
+void send(const char* text, int len) {
+    if (len > 0) {
+        usb_port port;
+        (void)dis::io::transmit(
+            port,
+            std::as_bytes(std::span{text, static_cast<std::size_t>(len)}),
+            dis::io::deadline::after(std::chrono::seconds{1}));
+    }
+}
+
+void report(const char* name, const result& res, std::size_t size = 0) {
+    static char line[128];
+    int len = 0;
+    if (size == 0) {
+        len = std::snprintf(line, sizeof(line),
+                            "bench name=%s min=%" PRIu32 " median=%" PRIu32
+                            " p99=%" PRIu32 "\n",
+                            name, res.min, res.median, res.p99);
+    } else {
+        len = std::snprintf(line, sizeof(line),
+                            "bench name=%s size=%u min=%" PRIu32
+                            " median=%" PRIu32 " p99=%" PRIu32 "\n",
+                            name, static_cast<unsigned>(size), res.min,
+                            res.median, res.p99);
+    }
+    send(line, len);
+}
+
+/// starts a partner task, which is deleted again by stop_partner()
+void start_partner(TaskFunction_t fn, UBaseType_t priority) {
+    s_stamp_valid = false;
+    assert_param(xTaskCreate(fn, "partner", STACK_SIZE, NULL, priority,
+                             &s_partner_handle) == pdPASS);
+}
+
+void stop_partner() {
+    vTaskDelete(s_partner_handle);
+    s_partner_handle = nullptr;
+    // let the idle task free the TCB and stack of the partner
+    vTaskDelay(1);
+}
+
+/*************************** context switch ***************************/
+
+// same priority as the benchmark task, both yield to each other
+void yield_partner(void*) {
+    while (true) {
+        if (s_stamp_valid) {
+            s_sample      = now() - s_stamp;
+            s_stamp_valid = false;
+        }
+        taskYIELD();
+    }
+}
+
+void bench_context_switch() {
+    // the partner spins at our priority, it is stopped before reporting so
+    // the USB transmit task gets to run again
+    start_partner(yield_partner, bench_priority);
+    const result res = measure([] {
+        s_stamp       = now();
+        s_stamp_valid = true;
+        taskYIELD();
+        return s_sample;
+    });
+    stop_partner();
+    report("context_switch", res);
+}
+
+/**************************** task notify *****************************/
+
+// higher priority than the benchmark task, so a notification switches to it
+void notify_partner(void*) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        s_sample = now() - s_stamp;
+    }
+}
+
+void bench_task_notify() {
+    start_partner(notify_partner, partner_priority);
+    const result wake = measure([] {
+        s_stamp = now();
+        xTaskNotifyGive(s_partner_handle);
+        return s_sample;
+    });
+    stop_partner();
+    report("task_notify_wake", wake);
+
+    report("task_notify_give_take", measure([] {
+               const std::uint32_t start = now();
+               xTaskNotifyGive(s_bench_handle);
+               ulTaskNotifyTake(pdTRUE, 0);
+               return now() - start;
+           }));
+}
+
+/******************************* mutex ********************************/
+
+dis::mutex* s_mutex = nullptr;
+
+// blocks on the mutex held by the benchmark task and measures the hand over
+void mutex_partner(void*) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        s_mutex->lock();
+        s_sample = now() - s_stamp;
+        s_mutex->unlock();
+    }
+}
+
+void bench_mutex() {
+    dis::mutex mtx{};
+    s_mutex = &mtx;
+
+    report("mutex_lock_unlock", measure([&mtx] {
+               const std::uint32_t start = now();
+               mtx.lock();
+               mtx.unlock();
+               return now() - start;
+           }));
+
+    start_partner(mutex_partner, partner_priority);
+    const result handoff = measure([&mtx] {
+        mtx.lock();
+        // the partner preempts us and blocks on the mutex
+        xTaskNotifyGive(s_partner_handle);
+        s_stamp = now();
+        mtx.unlock();
+        return s_sample;
+    });
+    stop_partner();
+    s_mutex = nullptr;
+    report("mutex_contended_handoff", handoff);
+}
+
+/***************************** semaphore ******************************/
+
+void bench_semaphore() {
+    dis::binary_semaphore binary(0);
+    report("binary_semaphore_give_take", measure([&binary] {
+               const std::uint32_t start = now();
+               binary.release();
+               (void)binary.try_aquire();
+               return now() - start;
+           }));
+
+    dis::counting_semaphore<8> counting(0);
+    report("counting_semaphore_give_take", measure([&counting] {
+               const std::uint32_t start = now();
+               counting.release();
+               (void)counting.try_aquire();
+               return now() - start;
+           }));
+}
+
+/******************************* queue ********************************/
+
+void bench_queue() {
+    for (const auto size : queue_item_sizes) {
+        QueueHandle_t queue = xQueueCreate(1, size);
+        assert_param(queue != NULL);
+        report("queue_send_receive",
+               measure([queue] {
+                   const std::uint32_t start = now();
+                   xQueueSend(queue, s_tx_payload.data(), 0);
+                   xQueueReceive(queue, s_rx_payload.data(), 0);
+                   return now() - start;
+               }),
+               size);
+        vQueueDelete(queue);
+    }
+}
+
+/*************************** stream buffer ****************************/
+
+void bench_stream_buffer() {
+    StreamBufferHandle_t stream = xStreamBufferCreate(2 * max_payload, 1);
+    assert_param(stream != NULL);
+    for (const auto size : stream_chunk_sizes) {
+        report("stream_buffer_send_receive",
+               measure([stream, size] {
+                   const std::uint32_t start = now();
+                   xStreamBufferSend(stream, s_tx_payload.data(), size, 0);
+                   xStreamBufferReceive(stream, s_rx_payload.data(), size, 0);
+                   return now() - start;
+               }),
+               size);
+    }
+    vStreamBufferDelete(stream);
+}
+
+/******************************* timer ********************************/
+
+void timer_callback(TimerHandle_t) {}
+
+void bench_timer() {
+    TimerHandle_t timer =
+        xTimerCreate("bench", 1000 / portTICK_PERIOD_MS, pdFALSE, NULL,
+                     timer_callback);
+    assert_param(timer != NULL);
+    report("timer_start_stop", measure([timer] {
+               const std::uint32_t start = now();
+               xTimerStart(timer, 0);
+               xTimerStop(timer, 0);
+               const std::uint32_t cycles = now() - start;
+               // the timer task has a lower priority, let it drain the
+               // command queue before it runs full
+               vTaskDelay(1);
+               return cycles;
+           }));
+    xTimerDelete(timer, portMAX_DELAY);
+}
+
+/******************************* format *******************************/
+
+// the arguments are read from volatiles, so they are not constant folded
+volatile int s_format_int         = -1234567;
+volatile unsigned s_format_hex    = 0xC0FFEEU;
+volatile float s_format_float     = 3.14159F;
+const char* volatile s_format_str = "adc0";
+char s_format_text[128];
+
+/// measures `format`, which returns the length of its output
+template <class FN_T>
+void report_format(const char* name, FN_T&& format) {
+    const result res = measure([&format] {
+        const std::uint32_t start = now();
+        format();
+        return now() - start;
+    });
+    report(name, res, static_cast<std::size_t>(format()));
+}
+
+void bench_format() {
+    // pairs of the same output, size is the length of the text
+    report_format("snprintf_int", [] {
+        return std::snprintf(s_format_text, sizeof(s_format_text), "%d",
+                             s_format_int);
+    });
+    report_format("format_to_int", [] {
+        return dis::format_to(s_format_text, "{}", s_format_int).size;
+    });
+
+    report_format("snprintf_hex", [] {
+        return std::snprintf(s_format_text, sizeof(s_format_text), "%08x",
+                             s_format_hex);
+    });
+    report_format("format_to_hex", [] {
+        return dis::format_to(s_format_text, "{:08x}", s_format_hex).size;
+    });
+
+    report_format("snprintf_fixed", [] {
+        return std::snprintf(s_format_text, sizeof(s_format_text), "%.3f",
+                             static_cast<double>(s_format_float));
+    });
+    report_format("format_to_fixed", [] {
+        return dis::format_to(s_format_text, "{:.3f}", s_format_float).size;
+    });
+
+    report_format("snprintf_line", [] {
+        return std::snprintf(s_format_text, sizeof(s_format_text),
+                             "%-6s raw=%8d volts=%.3f flags=0x%04x\n",
+                             s_format_str, s_format_int,
+                             static_cast<double>(s_format_float),
+                             s_format_hex & 0xFFFFU);
+    });
+    report_format("format_to_line", [] {
+        return dis::format_to(s_format_text,
+                              "{:<6} raw={:8} volts={:.3f} flags={:#06x}\n",
+                              s_format_str, s_format_int, s_format_float,
+                              s_format_hex & 0xFFFFU)
+            .size;
+    });
+}
+
+/******************************** log *********************************/
+
+void bench_log() {
+    // the ring wraps, a statement costs the same either way
+    report("log_0_args", measure([] {
+               const std::uint32_t start = now();
+               DIS_LOG_INFO("bench");
+               return now() - start;
+           }));
+    report("log_4_args", measure([] {
+               const std::uint32_t start = now();
+               DIS_LOG_INFO("bench {} {:x} {:.3f} {}", s_format_int,
+                            s_format_hex, s_format_float, s_format_str);
+               return now() - start;
+           }));
+}
+
+/**********************************************************************/
+
+void calibrate() {
+    s_overhead = 0;
+    s_overhead = measure([] {
+                     const std::uint32_t start = now();
+                     return now() - start;
+                 }).min;
+}
+
+void bench_task(void*) {
+    static char line[128];
+    for (std::size_t i = 0; i < max_payload; ++i) {
+        s_tx_payload[i] = static_cast<std::uint8_t>(i);
+    }
+
+    while (true) {
+        // any byte from the host starts the suite
+        std::byte start{};
+        (void)usb_port::receive({&start, 1});
+
+        GreenLed.On();
+        calibrate();
+        const int len = std::snprintf(
+            line, sizeof(line),
+            "begin dis_bench version=1 cpu_hz=%" PRIu32
+            " iterations=%u overhead=%" PRIu32 "\n",
+            dis::this_cpu::cycles_per_second(),
+            static_cast<unsigned>(iterations), s_overhead);
+        send(line, len);
+
+        bench_context_switch();
+        bench_task_notify();
+        bench_mutex();
+        bench_semaphore();
+        bench_queue();
+        bench_stream_buffer();
+        bench_timer();
+        bench_format();
+        bench_log();
+
+        send("end\n", 4);
+        GreenLed.Off();
+    }
+}
+
+}  // namespace
+
+int main(void) {
+    HWInit();
+    HAL_NVIC_SetPriorityGrouping(
+        NVIC_PRIORITYGROUP_4);  // ensure proper priority grouping for freeRTOS
+
+    usb_port::init(tskIDLE_PRIORITY + 2);
+
+    assert_param(xTaskCreate(bench_task, "bench", STACK_SIZE * 8, NULL,
+                             bench_priority, &s_bench_handle) == pdPASS);
+
+    // start the scheduler - shouldn't return unless there's a problem
+    vTaskStartScheduler();
+
+    // if you've wound up here, there is likely an issue with overrunning the
+    // freeRTOS heap
+    while (1) {
+    }
+}
@@ -0,0 +1,393 @@
+/**
+ * Benchmark and cross check of the dis::dsp fixed point kernels
+ *
+ * Every kernel runs against its plain reference (dis/dsp/reference.hpp) on
+ * the same pseudo random blocks, including full scale samples to exercise
+ * the saturation.  The outputs have to match bit by bit.  Both are timed
+ * with the cycle counter, the fastest of `rounds` blocks counts.  The
+ * results are streamed over USB CDC as one line per kernel:
+ *
+ *   begin dsp_bench version=1 cpu_hz=216000000 simd=1 samples=1024 rounds=16
+ *   kernel name=fir_q15 param=32 exact=yes ref_cps=41.20 opt_cps=9.85
+ *   ...
+ *   end mismatches=0
+ *
+ * `param` is the number of taps (FIR) or sections (biquad), 0 for the
+ * statistics.  `ref_cps` and `opt_cps` are cycles per input sample.  The
+ * host build runs the same kernels with the emulated intrinsics (simd=0),
+ * there `exact` checks the emulation and the cycles are nanoseconds.  The
+ * suite starts as soon as the host sends any byte over the virtual com port
+ * and repeats on every further byte.
+ */
+
+#include "dis/dsp/biquad.hpp"
+#include "dis/dsp/fir.hpp"
+#include "dis/dsp/reference.hpp"
+#include "dis/dsp/statistics.hpp"
+#include "dis/osal/io/vcom.hpp"
+#include "dis/osal/utils/cycle_counter.hpp"
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <Nucleo_F767ZI_GPIO.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <span>
+#include <type_traits>
+
+// 128 * 4 = 512 bytes
+//(recommended min stack size per task)
+#define STACK_SIZE 128
+
+namespace {
+
+using dis::dsp::q15_t;
+using dis::dsp::q31_t;
+using usb_port = dis::vcom<1024, 1024>;
+
+constexpr std::size_t block_samples  = 1024;
+constexpr std::size_t rounds         = 16;
+constexpr UBaseType_t bench_priority = configMAX_PRIORITIES - 2;
+constexpr std::size_t fir_taps       = 32;
+constexpr std::size_t fir_block      = 256;
+constexpr std::size_t decimation     = 4;
+constexpr std::size_t biquad_stages  = 2;
+constexpr unsigned biquad_post_shift = 1;
+
+struct result {
+    std::uint32_t ref_cycles{UINT32_MAX};
+    std::uint32_t opt_cycles{UINT32_MAX};
+    bool exact{true};
+};
+
+std::array<q15_t, block_samples> s_input_q15{};
+std::array<q15_t, block_samples> s_ref_q15{};
+std::array<q15_t, block_samples> s_opt_q15{};
+std::array<q31_t, block_samples> s_input_q31{};
+std::array<q31_t, block_samples> s_ref_q31{};
+std::array<q31_t, block_samples> s_opt_q31{};
+
+std::uint32_t s_overhead   = 0;
+std::uint32_t s_mismatches = 0;
+
+inline std::uint32_t now() noexcept { return dis::this_cpu::cycles(); }
+
+inline std::uint32_t corrected(std::uint32_t cycles) noexcept {
+    return cycles > s_overhead ? cycles - s_overhead : 0;
+}
+
+/// noise at half scale with every 16th sample at full scale
+void fill_input(std::uint32_t seed) {
+    std::uint32_t state = seed * 2654435761U + 1U;
+    for (std::size_t i = 0; i < block_samples; ++i) {
+        state = state * 1664525U + 1013904223U;
+        auto sample = static_cast<std::int32_t>(state) / 2;
+        if ((state >> 8U) % 16U == 0U) {
+            sample = (state & 0x80000000U) != 0U ? INT32_MIN : INT32_MAX;
+        }
+        s_input_q31[i] = sample;
+        s_input_q15[i] = static_cast<q15_t>(sample >> 16);
+    }
+}
+
+/**
+ * Runs `ref` and `opt` (which return the number of samples they wrote to
+ * `ref_out` and `opt_out`) on `rounds` blocks of fresh input.  The fastest
+ * round counts, so neither pays for the cache misses of the first one.
+ */
+template <class SAMPLE_T, class REF_FN, class OPT_FN>
+result compare(std::span<const SAMPLE_T> ref_out,
+               std::span<const SAMPLE_T> opt_out,
+               REF_FN&& ref,
+               OPT_FN&& opt) {
+    result res{};
+    for (std::size_t round = 0; round < rounds; ++round) {
+        fill_input(static_cast<std::uint32_t>(round));
+
+        std::uint32_t start            = now();
+        const std::size_t ref_n        = ref();
+        const std::uint32_t ref_cycles = corrected(now() - start);
+
+        start                          = now();
+        const std::size_t opt_n        = opt();
+        const std::uint32_t opt_cycles = corrected(now() - start);
+
+        res.ref_cycles = std::min(res.ref_cycles, ref_cycles);
+        res.opt_cycles = std::min(res.opt_cycles, opt_cycles);
+        const bool same = ref_n == opt_n &&
+                          std::equal(ref_out.begin(), ref_out.begin() + ref_n,
+                                     opt_out.begin());
+        res.exact       = res.exact && same;
+    }
+    return res;
+}
+
+void send(const char* text, int len) {
+    if (len > 0) {
+        usb_port port;
+        (void)dis::io::transmit(
+            port,
+            std::as_bytes(std::span{text, static_cast<std::size_t>(len)}),
+            dis::io::deadline::after(std::chrono::seconds{1}));
+    }
+}
+
+void report(const char* name, std::size_t param, const result& res) {
+    static char line[128];
+    // cycles per sample with two decimals
+    const auto ref_cps = static_cast<std::uint32_t>(
+        std::uint64_t{res.ref_cycles} * 100U / block_samples);
+    const auto opt_cps = static_cast<std::uint32_t>(
+        std::uint64_t{res.opt_cycles} * 100U / block_samples);
+    const int len = std::snprintf(
+        line, sizeof(line),
+        "kernel name=%s param=%u exact=%s ref_cps=%" PRIu32 ".%02" PRIu32
+        " opt_cps=%" PRIu32 ".%02" PRIu32 "\n",
+        name, static_cast<unsigned>(param), res.exact ? "yes" : "no",
+        ref_cps / 100U, ref_cps % 100U, opt_cps / 100U, opt_cps % 100U);
+    send(line, len);
+    if (!res.exact) {
+        ++s_mismatches;
+    }
+}
+
+/******************************** FIR *********************************/
+
+/// a triangular low pass, the taps sum up to 0.9
+template <class SAMPLE_T>
+std::array<SAMPLE_T, fir_taps> lowpass() {
+    constexpr std::size_t half = fir_taps / 2;
+    constexpr double sum       = half * (half + 1);
+    std::array<SAMPLE_T, fir_taps> taps{};
+    for (std::size_t k = 0; k < fir_taps; ++k) {
+        const std::size_t rank = std::min(k + 1, fir_taps - k);
+        const double weight    = 0.9 * static_cast<double>(rank) / sum;
+        if constexpr (std::is_same_v<SAMPLE_T, q15_t>) {
+            taps[k] = dis::dsp::to_q15(weight);
+        } else {
+            taps[k] = dis::dsp::to_q31(weight);
+        }
+    }
+    return taps;
+}
+
+template <class SAMPLE_T, std::size_t DECIMATION_V>
+result bench_fir(std::span<const SAMPLE_T> input,
+                 std::span<SAMPLE_T> ref_out,
+                 std::span<SAMPLE_T> opt_out) {
+    const auto taps = lowpass<SAMPLE_T>();
+    dis::dsp::ref::fir<SAMPLE_T, fir_taps, DECIMATION_V> ref{taps};
+    dis::dsp::fir<SAMPLE_T, fir_taps, fir_block, DECIMATION_V> opt{taps};
+    return compare<SAMPLE_T>(
+        ref_out, opt_out, [&] { return ref.process(input, ref_out); },
+        [&] { return opt.process(input, opt_out); });
+}
+
+void bench_fir() {
+    report("fir_q15", fir_taps,
+           bench_fir<q15_t, 1>(s_input_q15, s_ref_q15, s_opt_q15));
+    report("fir_q31", fir_taps,
+           bench_fir<q31_t, 1>(s_input_q31, s_ref_q31, s_opt_q31));
+    report("fir_decimator_q15", fir_taps,
+           bench_fir<q15_t, decimation>(s_input_q15, s_ref_q15, s_opt_q15));
+    report("fir_decimator_q31", fir_taps,
+           bench_fir<q31_t, decimation>(s_input_q31, s_ref_q31, s_opt_q31));
+}
+
+/******************************* biquad *******************************/
+
+/// a 4th order Butterworth low pass at fs/8, halved for the post shift
+template <class SAMPLE_T>
+std::array<dis::dsp::biquad_coefficients<SAMPLE_T>, biquad_stages>
+butterworth() {
+    constexpr std::array<std::array<double, 5>, biquad_stages> sections{{
+        {0.04429, 0.08858, 0.04429, 0.42770, -0.10486},
+        {0.05763, 0.11526, 0.05763, 0.55651, -0.28703},
+    }};
+    std::array<dis::dsp::biquad_coefficients<SAMPLE_T>, biquad_stages>
+        coefficients{};
+    for (std::size_t stage = 0; stage < biquad_stages; ++stage) {
+        std::array<SAMPLE_T, 5> c{};
+        for (std::size_t i = 0; i < c.size(); ++i) {
+            if constexpr (std::is_same_v<SAMPLE_T, q15_t>) {
+                c[i] = dis::dsp::to_q15(sections[stage][i]);
+            } else {
+                c[i] = dis::dsp::to_q31(sections[stage][i]);
+            }
+        }
+        coefficients[stage] = {c[0], c[1], c[2], c[3], c[4]};
+    }
+    return coefficients;
+}
+
+template <class SAMPLE_T>
+result bench_biquad(std::span<const SAMPLE_T> input,
+                    std::span<SAMPLE_T> ref_out,
+                    std::span<SAMPLE_T> opt_out) {
+    const auto coefficients = butterworth<SAMPLE_T>();
+    dis::dsp::ref::biquad<SAMPLE_T, biquad_stages> ref{coefficients,
+                                                       biquad_post_shift};
+    dis::dsp::biquad<SAMPLE_T, biquad_stages> opt{coefficients,
+                                                  biquad_post_shift};
+    return compare<SAMPLE_T>(
+        ref_out, opt_out,
+        [&] {
+            ref.process(input, ref_out);
+            return input.size();
+        },
+        [&] {
+            opt.process(input, opt_out);
+            return input.size();
+        });
+}
+
+void bench_biquad() {
+    report("biquad_q15", biquad_stages,
+           bench_biquad<q15_t>(s_input_q15, s_ref_q15, s_opt_q15));
+    report("biquad_q31", biquad_stages,
+           bench_biquad<q31_t>(s_input_q31, s_ref_q31, s_opt_q31));
+}
+
+/***************************** statistics *****************************/
+
+/// `ref` and `opt` compute a value of a block, it is stored as the output
+template <class SAMPLE_T, class REF_FN, class OPT_FN>
+result bench_statistic(std::span<SAMPLE_T> ref_out,
+                       std::span<SAMPLE_T> opt_out,
+                       REF_FN&& ref,
+                       OPT_FN&& opt) {
+    return compare<SAMPLE_T>(
+        ref_out, opt_out,
+        [&] {
+            ref_out[0] = ref();
+            return std::size_t{1};
+        },
+        [&] {
+            opt_out[0] = opt();
+            return std::size_t{1};
+        });
+}
+
+/// min and max as two outputs
+template <class SAMPLE_T, class REF_FN, class OPT_FN>
+result bench_extremes(std::span<SAMPLE_T> ref_out,
+                      std::span<SAMPLE_T> opt_out,
+                      REF_FN&& ref,
+                      OPT_FN&& opt) {
+    return compare<SAMPLE_T>(
+        ref_out, opt_out,
+        [&] {
+            const auto extremes = ref();
+            ref_out[0]          = extremes.min;
+            ref_out[1]          = extremes.max;
+            return std::size_t{2};
+        },
+        [&] {
+            const auto extremes = opt();
+            opt_out[0]          = extremes.min;
+            opt_out[1]          = extremes.max;
+            return std::size_t{2};
+        });
+}
+
+void bench_statistics() {
+    namespace dsp = dis::dsp;
+    const std::span<const q15_t> q15{s_input_q15};
+    const std::span<const q31_t> q31{s_input_q31};
+
+    report("mean_q15", 0,
+           bench_statistic<q15_t>(
+               s_ref_q15, s_opt_q15, [&] { return dsp::ref::mean(q15); },
+               [&] { return dsp::mean_q15(q15); }));
+    report("rms_q15", 0,
+           bench_statistic<q15_t>(
+               s_ref_q15, s_opt_q15, [&] { return dsp::ref::rms(q15); },
+               [&] { return dsp::rms_q15(q15); }));
+    report("min_max_q15", 0,
+           bench_extremes<q15_t>(
+               s_ref_q15, s_opt_q15, [&] { return dsp::ref::extremes(q15); },
+               [&] { return dsp::min_max_q15(q15); }));
+
+    report("mean_q31", 0,
+           bench_statistic<q31_t>(
+               s_ref_q31, s_opt_q31, [&] { return dsp::ref::mean(q31); },
+               [&] { return dsp::mean_q31(q31); }));
+    report("rms_q31", 0,
+           bench_statistic<q31_t>(
+               s_ref_q31, s_opt_q31, [&] { return dsp::ref::rms(q31); },
+               [&] { return dsp::rms_q31(q31); }));
+    report("min_max_q31", 0,
+           bench_extremes<q31_t>(
+               s_ref_q31, s_opt_q31, [&] { return dsp::ref::extremes(q31); },
+               [&] { return dsp::min_max_q31(q31); }));
+}
+
+/**********************************************************************/
+
+void calibrate() {
+    s_overhead = UINT32_MAX;
+    for (std::size_t i = 0; i < rounds; ++i) {
+        const std::uint32_t start = now();
+        s_overhead                = std::min(s_overhead, now() - start);
+    }
+}
+
+void bench_task(void*) {
+    static char line[128];
+    while (true) {
+        // any byte from the host starts the suite
+        std::byte start{};
+        (void)usb_port::receive({&start, 1});
+
+        GreenLed.On();
+        calibrate();
+        s_mismatches  = 0;
+        const int len = std::snprintf(
+            line, sizeof(line),
+            "begin dsp_bench version=1 cpu_hz=%" PRIu32
+            " simd=%d samples=%u rounds=%u\n",
+            dis::this_cpu::cycles_per_second(), DIS_DSP_SIMD,
+            static_cast<unsigned>(block_samples),
+            static_cast<unsigned>(rounds));
+        send(line, len);
+
+        bench_fir();
+        bench_biquad();
+        bench_statistics();
+
+        const int end_len = std::snprintf(line, sizeof(line),
+                                          "end mismatches=%" PRIu32 "\n",
+                                          s_mismatches);
+        send(line, end_len);
+        GreenLed.Off();
+    }
+}
+
+}  // namespace
+
+int main(void) {
+    HWInit();
+    HAL_NVIC_SetPriorityGrouping(
+        NVIC_PRIORITYGROUP_4);  // ensure proper priority grouping for freeRTOS
+
+    usb_port::init(tskIDLE_PRIORITY + 2);
+
+    // the filters keep their windows on the stack
+    assert_param(xTaskCreate(bench_task, "bench", STACK_SIZE * 8, NULL,
+                             bench_priority, NULL) == pdPASS);
+
+    // start the scheduler - shouldn't return unless there's a problem
+    vTaskStartScheduler();
+
+    // if you've wound up here, there is likely an issue with overrunning the
+    // freeRTOS heap
+    while (1) {
+    }
+}
@@ -0,0 +1,331 @@
+/**
+ * Interrupt to task latency benchmark
+ *
+ * TIM9 fires update interrupts at a configurable rate.  Every event is time
+ * stamped with the cycle counter at four stages:
+ *  - event:  the timer update (reconstructed from the TIM9 counter)
+ *  - entry:  first instruction of the TIM9 ISR
+ *  - give:   right before the FromISR call which wakes the task
+ *  - task:   first instruction of the woken task
+ * for each wake up mechanism (semaphore, task notification, stream buffer
+ * and queue).  The distributions are collected in dis::histogram and
+ * streamed over USB CDC once a run is complete, see tools/irq_latency for
+ * the format and the analysis.
+ *
+ * The benchmark starts as soon as the host sends any byte over the virtual
+ * com port and repeats on every further byte.
+ */
+
+#include "dis/osal/io/vcom.hpp"
+#include "dis/osal/thread/semaphore.hpp"
+#include "dis/osal/utils/cycle_counter.hpp"
+#include "dis/osal/utils/histogram.hpp"
+
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <stream_buffer.h>
+#include <task.h>
+
+#include <Nucleo_F767ZI_GPIO.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <TIM9_UnderRTOS_Radar_ISR.h>
+#include <stm32f7xx_hal.h>
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <span>
+
+// 128 * 4 = 512 bytes
+//(recommended min stack size per task)
+#define STACK_SIZE 128
+
+namespace {
+
+using usb_port = dis::vcom<1024, 1024>;
+
+constexpr std::uint32_t samples_per_run = 10000;
+constexpr std::array<std::uint32_t, 4> rates_hz{100, 1000, 10000, 50000};
+constexpr std::chrono::milliseconds sample_timeout{100};
+constexpr std::uint32_t queue_depth = 8;
+
+enum class mechanism : std::uint8_t {
+    semaphore,
+    notification,
+    stream_buffer,
+    queue,
+};
+constexpr std::array mechanisms{mechanism::semaphore, mechanism::notification,
+                                mechanism::stream_buffer, mechanism::queue};
+
+constexpr const char* to_string(mechanism mech) noexcept {
+    switch (mech) {
+        case mechanism::semaphore: return "semaphore";
+        case mechanism::notification: return "notification";
+        case mechanism::stream_buffer: return "stream_buffer";
+        case mechanism::queue: return "queue";
+    }
+    return "unknown";
+}
+
+enum stage : std::size_t {
+    event_to_isr,
+    isr_to_give,
+    give_to_task,
+    event_to_task,
+    stage_count,
+};
+constexpr std::array<const char*, stage_count> stage_names{
+    "event_to_isr", "isr_to_give", "give_to_task", "event_to_task"};
+
+struct stamps {
+    std::uint32_t event;
+    std::uint32_t entry;
+    std::uint32_t give;
+};
+
+using latency_histogram = dis::histogram<>;
+
+std::array<latency_histogram, stage_count> s_histograms{};
+
+// shared between the ISR and the benchmark task
+volatile mechanism s_mechanism = mechanism::semaphore;
+stamps s_pending{};
+volatile bool s_pending_valid     = false;
+volatile std::uint32_t s_overruns = 0;
+
+TaskHandle_t s_task_handle         = nullptr;
+dis::binary_semaphore* s_semaphore = nullptr;
+QueueHandle_t s_queue              = nullptr;
+StreamBufferHandle_t s_stream      = nullptr;
+
+/// slot for the mechanisms which only signal, the task fetches the stamps
+inline bool publish(const stamps& st) noexcept {
+    if (s_pending_valid) {
+        return false;
+    }
+    s_pending       = st;
+    s_pending_valid = true;
+    return true;
+}
+
+void on_tim9_update(std::uint32_t event_cycles, std::uint32_t entry_cycles) {
+    stamps st{event_cycles, entry_cycles, 0};
+    BaseType_t woken = pdFALSE;
+    bool ok          = true;
+
+    switch (s_mechanism) {
+        case mechanism::semaphore:
+            st.give = dis::this_cpu::cycles();
+            ok      = publish(st);
+            if (ok) {
+                s_semaphore->release();
+            }
+            break;
+        case mechanism::notification:
+            st.give = dis::this_cpu::cycles();
+            ok      = publish(st);
+            if (ok) {
+                vTaskNotifyGiveFromISR(s_task_handle, &woken);
+            }
+            break;
+        case mechanism::stream_buffer:
+            st.give = dis::this_cpu::cycles();
+            ok = (xStreamBufferSendFromISR(s_stream, &st, sizeof(st),
+                                           &woken) == sizeof(st));
+            break;
+        case mechanism::queue:
+            st.give = dis::this_cpu::cycles();
+            ok      = (xQueueSendFromISR(s_queue, &st, &woken) == pdPASS);
+            break;
+    }
+
+    if (!ok) {
+        s_overruns = s_overruns + 1;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/// blocks until the next sample arrives, returns false on timeout
+bool wait_for_sample(mechanism mech, stamps& st, std::uint32_t& woken_at) {
+    const TickType_t timeout_ticks = dis::freertos::to_ticks(sample_timeout);
+    bool ok                        = false;
+    switch (mech) {
+        case mechanism::semaphore:
+            ok = s_semaphore->try_aquire_for(sample_timeout);
+            break;
+        case mechanism::notification:
+            ok = (ulTaskNotifyTake(pdTRUE, timeout_ticks) != 0);
+            break;
+        case mechanism::stream_buffer:
+            ok = (xStreamBufferReceive(s_stream, &st, sizeof(st),
+                                       timeout_ticks) == sizeof(st));
+            break;
+        case mechanism::queue:
+            ok = (xQueueReceive(s_queue, &st, timeout_ticks) == pdPASS);
+            break;
+    }
+    // as close as possible to the first instruction after the wake up
+    woken_at = dis::this_cpu::cycles();
+
+    if (ok && (mech == mechanism::semaphore ||
+               mech == mechanism::notification)) {
+        st              = s_pending;
+        s_pending_valid = false;
+    }
+    return ok;
+}
+
+void send(const char* text, int len) {
+    if (len > 0) {
+        usb_port port;
+        (void)dis::io::transmit(
+            port,
+            std::as_bytes(std::span{text, static_cast<std::size_t>(len)}),
+            dis::io::deadline::after(std::chrono::seconds{1}));
+    }
+}
+
+void report_histogram(mechanism mech, std::uint32_t rate, std::size_t stg) {
+    static latency_histogram::snapshot_type snapshot;
+    static std::array<std::byte, latency_histogram::snapshot_type::
+                                     max_serialized_size>
+        encoded;
+    static char line[256];
+
+    snapshot = s_histograms[stg].snapshot();
+    int len  = std::snprintf(
+        line, sizeof(line),
+        "hist mechanism=%s rate_hz=%" PRIu32 " stage=%s count=%" PRIu32
+        " min=%" PRIu32 " p50=%" PRIu32 " p99=%" PRIu32 " p999=%" PRIu32
+        " max=%" PRIu32 " data=",
+        to_string(mech), rate, stage_names[stg],
+        static_cast<std::uint32_t>(snapshot.count()), snapshot.min(),
+        snapshot.percentile(50.0), snapshot.percentile(99.0),
+        snapshot.percentile(99.9), snapshot.max());
+    send(line, len);
+
+    // the histogram is sent as hex encoded dis::histogram_snapshot
+    const std::size_t size    = snapshot.serialize(encoded);
+    constexpr const char* hex = "0123456789abcdef";
+    std::size_t pos           = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        const auto byte = static_cast<std::uint8_t>(encoded[i]);
+        line[pos++]     = hex[byte >> 4U];
+        line[pos++]     = hex[byte & 0x0FU];
+        if (pos >= sizeof(line) - 2) {
+            send(line, static_cast<int>(pos));
+            pos = 0;
+        }
+    }
+    line[pos++] = '\n';
+    send(line, static_cast<int>(pos));
+}
+
+void run(mechanism mech, std::uint32_t rate) {
+    for (auto& hist : s_histograms) {
+        hist.reset();
+    }
+    s_overruns      = 0;
+    s_pending_valid = false;
+    s_mechanism     = mech;
+    xQueueReset(s_queue);
+    xStreamBufferReset(s_stream);
+    (void)ulTaskNotifyTake(pdTRUE, 0);
+    (void)s_semaphore->try_aquire();
+
+    std::uint32_t samples  = 0;
+    std::uint32_t timeouts = 0;
+    // a rate TIM9 can not produce is reported as a run without samples
+    const bool started =
+        TIM9UnderRTOSRadarStart(rate,
+                                configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY,
+                                on_tim9_update) == HAL_OK;
+    while (started && samples < samples_per_run) {
+        stamps st{};
+        std::uint32_t woken_at = 0;
+        if (!wait_for_sample(mech, st, woken_at)) {
+            if (++timeouts > 10) {
+                break;
+            }
+            continue;
+        }
+        s_histograms[event_to_isr].record(st.entry - st.event);
+        s_histograms[isr_to_give].record(st.give - st.entry);
+        s_histograms[give_to_task].record(woken_at - st.give);
+        s_histograms[event_to_task].record(woken_at - st.event);
+        ++samples;
+    }
+    if (started) {
+        TIM9UnderRTOSRadarStop();
+    }
+
+    static char line[128];
+    const int len = std::snprintf(
+        line, sizeof(line),
+        "run mechanism=%s rate_hz=%" PRIu32 " samples=%" PRIu32
+        " overruns=%" PRIu32 " timeouts=%" PRIu32 "\n",
+        to_string(mech), rate, samples, static_cast<std::uint32_t>(s_overruns),
+        timeouts);
+    send(line, len);
+    for (std::size_t stg = 0; stg < stage_count; ++stg) {
+        report_histogram(mech, rate, stg);
+    }
+}
+
+void latency_task(void*) {
+    static char line[96];
+    while (true) {
+        // any byte from the host starts a benchmark
+        std::byte start{};
+        (void)usb_port::receive({&start, 1});
+
+        GreenLed.On();
+        const int len = std::snprintf(
+            line, sizeof(line),
+            "begin irq_latency version=1 cpu_hz=%" PRIu32 " samples=%" PRIu32
+            "\n",
+            dis::this_cpu::cycles_per_second(), samples_per_run);
+        send(line, len);
+        for (const auto mech : mechanisms) {
+            for (const auto rate : rates_hz) {
+                run(mech, rate);
+            }
+        }
+        send("end\n", 4);
+        GreenLed.Off();
+    }
+}
+
+}  // namespace
+
+int main(void) {
+    HWInit();
+    HAL_NVIC_SetPriorityGrouping(
+        NVIC_PRIORITYGROUP_4);  // ensure proper priority grouping for freeRTOS
+
+    static dis::binary_semaphore semaphore(0);
+    s_semaphore = &semaphore;
+    s_queue     = xQueueCreate(queue_depth, sizeof(stamps));
+    s_stream    = xStreamBufferCreate(queue_depth * sizeof(stamps),
+                                      sizeof(stamps));
+    assert_param(s_queue != NULL);
+    assert_param(s_stream != NULL);
+
+    usb_port::init(tskIDLE_PRIORITY + 2);
+
+    // the benchmark task preempts everything else, the USB transmit task only
+    // runs in between the runs
+    assert_param(xTaskCreate(latency_task, "latency", STACK_SIZE * 8, NULL,
+                             configMAX_PRIORITIES - 1,
+                             &s_task_handle) == pdPASS);
+
+    // start the scheduler - shouldn't return unless there's a problem
+    vTaskStartScheduler();
+
+    // if you've wound up here, there is likely an issue with overrunning the
+    // freeRTOS heap
+    while (1) {
+    }
+}
@@ -0,0 +1,220 @@
+/**
+ * UART echo on the DMA drivers
+ *
+ * USART2 (PD5 RX, PD6 TX, e.g. wired to an USB serial adapter) receives
+ * with dis::uart::receiver: the DMA writes a circular ring and the idle
+ * line and the half/full ring events hand every burst to a stream buffer
+ * in one piece.  The echo task reads each piece straight into a block of a
+ * dis::uart::tx_pool and queues it on dis::uart::transmitter, which sends
+ * the queued blocks back to back with the tx DMA.
+ *
+ * stdout goes to UART4 (PC10 TX) through dis::io::uart_dma_sink, the stats
+ * task prints the receive and transmit statistics there once a second.  The
+ * green LED toggles with every piece, the red one shows that the HAL
+ * reported a receive error (the receiver restarts by itself) or that a
+ * piece got lost.
+ */
+
+#include "dis/osal/io/retarget.hpp"
+#include "dis/osal/io/sink/uart_dma.hpp"
+#include "dis/osal/io/uart/receiver.hpp"
+#include "dis/osal/io/uart/transmitter.hpp"
+
+#include <FreeRTOS.h>
+#include <stream_buffer.h>
+#include <task.h>
+
+#include <Nucleo_F767ZI_GPIO.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <UartQuickDirtyInit.h>
+#include <stm32f7xx_hal.h>
+
+#include <array>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+
+// 128 * 4 = 512 bytes
+//(recommended min stack size per task)
+#define STACK_SIZE 128
+
+namespace {
+
+constexpr std::uint32_t baud_rate            = 921600;
+constexpr std::uint32_t console_baud_rate    = 115200;
+constexpr std::uint32_t console_irq_priority = 7;
+constexpr std::size_t ring_bytes             = 1024;
+constexpr std::size_t stream_bytes           = 2048;
+constexpr std::size_t tx_blocks              = 8;
+constexpr std::size_t tx_block_bytes         = 256;
+constexpr UBaseType_t echo_priority          = tskIDLE_PRIORITY + 3;
+constexpr UBaseType_t drain_priority         = tskIDLE_PRIORITY + 2;
+constexpr UBaseType_t stats_priority         = tskIDLE_PRIORITY + 1;
+
+UART_HandleTypeDef s_uart{};
+dis::uart::receiver<ring_bytes> s_rx{s_uart};
+dis::uart::transmitter<tx_blocks> s_tx{s_uart};
+dis::uart::tx_pool<tx_blocks, tx_block_bytes> s_pool{};
+
+UART_HandleTypeDef s_console_uart{};
+DMA_HandleTypeDef s_console_dma{};
+dis::io::uart_dma_sink s_console{s_console_uart};
+
+std::array<std::uint8_t, stream_bytes + 1> s_stream_data{};
+StaticStreamBuffer_t s_stream_control{};
+StreamBufferHandle_t s_stream = nullptr;
+
+/// UART4 with the tx DMA for HAL_UART_Transmit_DMA(), behind stdout
+void init_console() {
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    const dis::uart::tx_channel channel    = dis::uart::uart4_tx();
+    s_console_dma.Instance                 = channel.stream;
+    s_console_dma.Init.Channel             = channel.request;
+    s_console_dma.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+    s_console_dma.Init.PeriphInc           = DMA_PINC_DISABLE;
+    s_console_dma.Init.MemInc              = DMA_MINC_ENABLE;
+    s_console_dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    s_console_dma.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+    s_console_dma.Init.Mode                = DMA_NORMAL;
+    s_console_dma.Init.Priority            = DMA_PRIORITY_LOW;
+    s_console_dma.Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+    assert_param(HAL_DMA_Init(&s_console_dma) == HAL_OK);
+
+    STM_UartInitHandle(&s_console_uart, UART4, console_baud_rate,
+                       &s_console_dma, NULL);
+    HAL_NVIC_SetPriority(channel.dma_irq, console_irq_priority, 0);
+    HAL_NVIC_SetPriority(UART4_IRQn, console_irq_priority, 0);
+    HAL_NVIC_EnableIRQ(channel.dma_irq);
+    HAL_NVIC_EnableIRQ(UART4_IRQn);
+
+    dis::io::attach(dis::io::stream::out, s_console.get());
+    dis::io::start(drain_priority);
+}
+
+void echo_task(void*) {
+    bool led = false;
+    for (;;) {
+        const auto block = s_pool.allocate();
+        if (block.empty()) {
+            // every block is queued, the line is behind the receiver
+            vTaskDelay(1);
+            continue;
+        }
+        const std::size_t size = xStreamBufferReceive(
+            s_stream, block.data(), block.size(), portMAX_DELAY);
+        if (size == 0 || !s_tx.send(s_pool.descriptor(block, size))) {
+            s_pool.free(block);
+            RedLed.On();
+        }
+        led = !led;
+        led ? GreenLed.On() : GreenLed.Off();
+    }
+}
+
+void stats_task(void*) {
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(1000));
+
+        // the receive counters run since the start, the transmit ones per
+        // second
+        const dis::uart::rx_stats rx = s_rx.stats();
+        const dis::uart::tx_stats tx = s_tx.stats();
+        s_tx.clear_stats();
+        if (rx.errors != 0 || rx.dropped != 0) {
+            RedLed.On();
+        }
+        std::printf("rx bytes=%" PRIu32 " chunks=%" PRIu32 " idle=%" PRIu32
+                    " dropped=%" PRIu32 " errors=%" PRIu32 "\n",
+                    rx.bytes, rx.chunks, rx.idle, rx.dropped, rx.errors);
+        std::printf("tx bytes=%" PRIu32 " sent=%" PRIu32 " rejected=%" PRIu32
+                    " failed=%" PRIu32 " underruns=%" PRIu32
+                    " depth_max=%" PRIu32 " busy=%" PRIu32 "/1000\n",
+                    tx.bytes, tx.sent, tx.rejected, tx.failed, tx.underruns,
+                    tx.depth_max, tx.utilization_permille());
+    }
+}
+
+}  // namespace
+
+extern "C" {
+
+void USART2_IRQHandler(void) {
+    DIS_ISR_ENTER();
+    s_rx.uart_irq_from_isr();
+    DIS_ISR_EXIT();
+}
+
+void DMA1_Stream5_IRQHandler(void) {
+    DIS_ISR_ENTER();
+    s_rx.dma_irq_from_isr();
+    DIS_ISR_EXIT();
+}
+
+void DMA1_Stream6_IRQHandler(void) {
+    DIS_ISR_ENTER();
+    s_tx.dma_irq_from_isr();
+    DIS_ISR_EXIT();
+}
+
+void UART4_IRQHandler(void) {
+    DIS_ISR_ENTER();
+    HAL_UART_IRQHandler(&s_console_uart);
+    DIS_ISR_EXIT();
+}
+
+void DMA1_Stream4_IRQHandler(void) {
+    DIS_ISR_ENTER();
+    HAL_DMA_IRQHandler(&s_console_dma);
+    DIS_ISR_EXIT();
+}
+
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef* uart) {
+    s_rx.transfer_event_from_isr(uart);
+}
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef* uart) {
+    s_rx.transfer_event_from_isr(uart);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* uart) {
+    if (uart == &s_console_uart) {
+        s_console.transfer_done_from_isr();
+    }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* uart) {
+    s_rx.error_from_isr(uart);
+    if (uart == &s_console_uart) {
+        s_console.transfer_done_from_isr();
+    }
+}
+
+}  // extern "C"
+
+int main(void) {
+    HWInit();
+    HAL_NVIC_SetPriorityGrouping(
+        NVIC_PRIORITYGROUP_4);  // ensure proper priority grouping for freeRTOS
+
+    init_console();
+
+    s_stream = xStreamBufferCreateStatic(stream_bytes, 1, s_stream_data.data(),
+                                         &s_stream_control);
+    STM_UartInitHandle(&s_uart, USART2, baud_rate, NULL, NULL);
+    assert_param(s_tx.start(dis::uart::usart2_tx()));
+    assert_param(s_rx.start(dis::uart::usart2_rx(), s_stream));
+
+    assert_param(xTaskCreate(echo_task, "echo", STACK_SIZE * 2, NULL,
+                             echo_priority, NULL) == pdPASS);
+    assert_param(xTaskCreate(stats_task, "stats", STACK_SIZE * 4, NULL,
+                             stats_priority, NULL) == pdPASS);
+
+    // start the scheduler - shouldn't return unless there's a problem
+    vTaskStartScheduler();
+
+    // if you've wound up here, there is likely an issue with overrunning the
+    // freeRTOS heap
+    while (1) {
+    }
+}
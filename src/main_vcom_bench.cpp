@@ -0,0 +1,472 @@
+/**
+ * USB CDC throughput and latency benchmark of dis::vcom
+ *
+ * Driven by tools/vcom_bench with one command line per run, the firmware
+ * answers with text lines and streams blocks as described in
+ * dis/bench/vcom_block.hpp:
+ *
+ *   info
+ *     begin vcom_bench version=1 cpu_hz=216000000 tx_bytes=1024
+ *           tx_buffers=2 rx_bytes=1024
+ *   stream chunk=256 blocks=4096 in=1 out=1 load=0
+ *     sends `blocks` blocks of `chunk` bytes to the host (in) and receives
+ *     as many from the host (out) at the same time, then reports
+ *     result mode=stream chunk=256 blocks=4096 load=0 tx_blocks=4096
+ *            tx_timeouts=0 tx_us=... rx_blocks=4096 rx_lost=0 rx_bad=0
+ *            rx_us=... rx_dropped=0 rx_pauses=3 nak_ticks=12
+ *            usbtx_permille=14 isr_permille=120 idle_permille=700
+ *   ping chunk=64 blocks=1000 load=0
+ *     echoes every block of the host right away, the host measures the
+ *     round trip time, then reports
+ *     result mode=ping chunk=64 blocks=1000 load=0 echoed=1000 ...
+ *
+ * (each result is a single line).  The durations count from the command to
+ * the last block of the direction.  Utilization covers the whole run, see
+ * dis::stats::cpu_load_since(): the usbTx task, the interrupts (mostly the
+ * USB one) and what is left to the idle task.  With `load` a task above the
+ * USB transmit task burns that share (in 1/1000) of the CPU, to see how the
+ * port copes with a busy system.  Malformed commands are answered with a
+ * line starting with `error`.
+ *
+ * The buffers of the port are compile time parameters (VCOM_BENCH_*), meson
+ * builds one image per configuration, see vcom_bench_configs.
+ */
+
+#include "dis/bench/vcom_block.hpp"
+#include "dis/osal/io/vcom.hpp"
+#include "dis/osal/stats/cpu_load.hpp"
+#include "dis/osal/thread/semaphore.hpp"
+#include "dis/osal/utils/cycle_counter.hpp"
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <Nucleo_F767ZI_GPIO.h>
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#ifndef VCOM_BENCH_TX_BYTES
+#define VCOM_BENCH_TX_BYTES 1024
+#endif
+
+#ifndef VCOM_BENCH_TX_BUFFERS
+#define VCOM_BENCH_TX_BUFFERS 2
+#endif
+
+#ifndef VCOM_BENCH_RX_BYTES
+#define VCOM_BENCH_RX_BYTES 1024
+#endif
+
+// 128 * 4 = 512 bytes
+//(recommended min stack size per task)
+#define STACK_SIZE 128
+
+namespace {
+
+using usb_port = dis::vcom<VCOM_BENCH_TX_BYTES,
+                           VCOM_BENCH_RX_BYTES,
+                           VCOM_BENCH_TX_BUFFERS>;
+
+// the benchmark tasks run below the USB transmit task, the load above it
+constexpr UBaseType_t bench_priority = tskIDLE_PRIORITY + 1;
+constexpr UBaseType_t usb_priority   = tskIDLE_PRIORITY + 2;
+constexpr UBaseType_t load_priority  = tskIDLE_PRIORITY + 3;
+
+/// a block is one reservation of the port, so it is never split
+constexpr std::size_t max_block = usb_port::tx_bytes;
+/// the host stopped sending or reading
+constexpr std::chrono::seconds block_timeout{1};
+constexpr TickType_t load_period = 10;
+
+struct run_config {
+    std::uint32_t chunk{0};
+    std::uint32_t blocks{0};
+    bool in{false};
+    bool out{false};
+    std::uint32_t load{0};
+};
+
+struct tx_result {
+    std::uint32_t blocks{0};
+    std::uint32_t timeouts{0};
+    std::uint64_t cycles{0};
+};
+
+struct rx_result {
+    std::uint32_t blocks{0};
+    std::uint32_t lost{0};
+    std::uint32_t bad{0};
+    std::uint64_t cycles{0};
+};
+
+// shared with the transmit and the load task
+run_config s_config{};
+tx_result s_tx{};
+std::uint64_t s_run_start        = 0;
+volatile std::uint32_t s_load    = 0;
+TaskHandle_t s_tx_handle         = nullptr;
+TaskHandle_t s_load_handle       = nullptr;
+dis::binary_semaphore* s_tx_done = nullptr;
+
+std::array<std::byte, max_block> s_rx_block{};
+// kept off the stack of the benchmark task
+dis::stats::cpu_load_mark s_load_mark{};
+dis::stats::cpu_load_report s_load_report{};
+
+// a result line may be longer than the smallest transmit buffer, it goes
+// out in pieces, nothing else is sent while the reports are written
+void send(const char* text, int len) {
+    usb_port port;
+    const auto until = dis::io::deadline::after(block_timeout);
+    const auto size  = static_cast<std::size_t>(std::max(len, 0));
+    for (std::size_t sent = 0; sent < size; sent += usb_port::tx_bytes) {
+        const std::size_t chunk = std::min(size - sent, usb_port::tx_bytes);
+        if (dis::io::transmit(port,
+                              std::as_bytes(std::span{text + sent, chunk}),
+                              until) != chunk) {
+            break;
+        }
+    }
+}
+
+/// next command line of the host, without the line end
+std::string_view read_line() {
+    static std::array<char, 96> line{};
+    std::size_t size = 0;
+    for (;;) {
+        std::byte next{};
+        if (usb_port::receive({&next, 1}) == 0) {
+            continue;
+        }
+        const auto ch = static_cast<char>(next);
+        if (ch == '\n') {
+            return {line.data(), size};
+        }
+        if (ch != '\r' && size < line.size()) {
+            line[size++] = ch;
+        }
+    }
+}
+
+/// value of `name=` in a line of space separated key value pairs
+std::optional<std::uint32_t> field(std::string_view line,
+                                   std::string_view name) {
+    std::size_t pos = 0;
+    while (pos < line.size()) {
+        const std::size_t end = std::min(line.find(' ', pos), line.size());
+        const std::string_view token = line.substr(pos, end - pos);
+        if (token.size() > name.size() && token.starts_with(name) &&
+            token[name.size()] == '=') {
+            std::uint32_t value = 0;
+            const char* first   = token.data() + name.size() + 1;
+            const char* last    = token.data() + token.size();
+
+            const auto [ptr, ec] = std::from_chars(first, last, value);
+            if (ec != std::errc{} || ptr != last) {
+                return std::nullopt;
+            }
+            return value;
+        }
+        pos = end + 1;
+    }
+    return std::nullopt;
+}
+
+inline std::uint32_t to_us(std::uint64_t cycles) noexcept {
+    return static_cast<std::uint32_t>(
+        (cycles * 1'000'000U) / dis::this_cpu::cycles_per_second());
+}
+
+/// fills `block` from the host, false if the host stopped sending
+bool receive_block(std::span<std::byte> block) {
+    std::size_t size = 0;
+    while (size < block.size()) {
+        const std::size_t got = usb_port::receive(
+            block.subspan(size), dis::io::deadline::after(block_timeout));
+        if (got == 0) {
+            return false;
+        }
+        size += got;
+    }
+    return true;
+}
+
+/******************************** load ********************************/
+
+// busy for s_load / 1000 of every load_period
+void load_task(void*) {
+    const std::uint64_t period_cycles =
+        static_cast<std::uint64_t>(dis::this_cpu::cycles_per_second()) *
+        load_period / configTICK_RATE_HZ;
+    TickType_t last = xTaskGetTickCount();
+    while (true) {
+        const std::uint64_t busy  = period_cycles * s_load / 1000U;
+        const std::uint64_t start = dis::this_cpu::cycles64();
+        while (dis::this_cpu::cycles64() - start < busy) {
+        }
+        vTaskDelayUntil(&last, load_period);
+    }
+}
+
+void start_load(std::uint32_t load) {
+    s_load = load;
+    if (load > 0) {
+        assert_param(xTaskCreate(load_task, "load", STACK_SIZE, NULL,
+                                 load_priority, &s_load_handle) == pdPASS);
+    }
+}
+
+void stop_load() {
+    if (s_load_handle != nullptr) {
+        vTaskDelete(s_load_handle);
+        s_load_handle = nullptr;
+        // let the idle task free the TCB and stack of the load task
+        vTaskDelay(1);
+    }
+}
+
+/****************************** transmit ******************************/
+
+// streams the blocks of a run to the host, started by a notification
+void tx_task(void*) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        const run_config config = s_config;
+        s_tx                    = {};
+
+        for (std::uint32_t sequence = 0; sequence < config.blocks;
+             ++sequence) {
+            std::byte* block = usb_port::reserve(
+                config.chunk, dis::io::deadline::after(block_timeout));
+            if (block == nullptr) {
+                // the host does not read anymore, the missing blocks show
+                // up as lost on its side
+                ++s_tx.timeouts;
+                break;
+            }
+            dis::bench::fill_block({block, config.chunk}, sequence);
+            usb_port::commit(block);
+            ++s_tx.blocks;
+        }
+        s_tx.cycles = dis::this_cpu::cycles64() - s_run_start;
+        s_tx_done->release();
+    }
+}
+
+/******************************* runs *********************************/
+
+rx_result receive_stream(const run_config& config) {
+    rx_result rx{};
+    const std::span block{s_rx_block.data(), config.chunk};
+    std::uint32_t expected = 0;
+    while (expected < config.blocks) {
+        if (!receive_block(block)) {
+            break;
+        }
+        const auto check = dis::bench::check_block(block);
+        if (check.state != dis::bench::block_state::ok) {
+            ++rx.bad;
+            ++expected;
+            continue;
+        }
+        if (check.sequence > expected) {
+            rx.lost += check.sequence - expected;
+        }
+        expected = check.sequence + 1;
+        ++rx.blocks;
+    }
+    rx.cycles = dis::this_cpu::cycles64() - s_run_start;
+    // whatever did not arrive until the timeout
+    rx.lost += config.blocks - std::min(expected, config.blocks);
+    return rx;
+}
+
+/// share of `name` in the last utilization report
+std::uint32_t task_permille(std::string_view name) {
+    for (std::size_t idx = 0; idx < s_load_report.task_count; ++idx) {
+        const auto& task = s_load_report.tasks[idx];
+        if (task.name != nullptr && name == task.name) {
+            return task.permille;
+        }
+    }
+    return 0;
+}
+
+void run_stream(const run_config& config) {
+    static char line[384];
+
+    s_config                          = config;
+    const dis::vcom_rx_stats rx_begin = usb_port::rx_stats();
+    s_load_mark                       = dis::stats::mark_cpu_load();
+    s_run_start                       = dis::this_cpu::cycles64();
+    start_load(config.load);
+
+    if (config.in) {
+        xTaskNotifyGive(s_tx_handle);
+    }
+    const rx_result rx = config.out ? receive_stream(config) : rx_result{};
+    tx_result tx{};
+    if (config.in) {
+        s_tx_done->aquire();
+        tx = s_tx;
+    }
+
+    s_load_report = dis::stats::cpu_load_since(s_load_mark);
+    stop_load();
+    const dis::vcom_rx_stats rx_end = usb_port::rx_stats();
+
+    const int len = std::snprintf(
+        line, sizeof(line),
+        "result mode=stream chunk=%" PRIu32 " blocks=%" PRIu32
+        " load=%" PRIu32 " tx_blocks=%" PRIu32 " tx_timeouts=%" PRIu32
+        " tx_us=%" PRIu32 " rx_blocks=%" PRIu32 " rx_lost=%" PRIu32
+        " rx_bad=%" PRIu32 " rx_us=%" PRIu32 " rx_dropped=%" PRIu32
+        " rx_pauses=%" PRIu32 " nak_ticks=%" PRIu32
+        " usbtx_permille=%" PRIu32 " isr_permille=%" PRIu32
+        " idle_permille=%" PRIu32 "\n",
+        config.chunk, config.blocks, config.load, tx.blocks, tx.timeouts,
+        to_us(tx.cycles), rx.blocks, rx.lost, rx.bad, to_us(rx.cycles),
+        rx_end.dropped - rx_begin.dropped, rx_end.pauses - rx_begin.pauses,
+        rx_end.nak_ticks - rx_begin.nak_ticks, task_permille("usbTx"),
+        s_load_report.isr_permille, task_permille("IDLE"));
+    send(line, len);
+}
+
+void run_ping(const run_config& config) {
+    static char line[256];
+
+    std::uint32_t echoed      = 0;
+    std::uint32_t rx_timeouts = 0;
+    std::uint32_t tx_timeouts = 0;
+    s_load_mark               = dis::stats::mark_cpu_load();
+    start_load(config.load);
+
+    const std::span block{s_rx_block.data(), config.chunk};
+    while (echoed < config.blocks) {
+        if (!receive_block(block)) {
+            ++rx_timeouts;
+            break;
+        }
+        std::byte* echo = usb_port::reserve(
+            config.chunk, dis::io::deadline::after(block_timeout));
+        if (echo == nullptr) {
+            ++tx_timeouts;
+            break;
+        }
+        std::memcpy(echo, block.data(), block.size());
+        usb_port::commit(echo);
+        ++echoed;
+    }
+
+    s_load_report = dis::stats::cpu_load_since(s_load_mark);
+    stop_load();
+
+    const int len = std::snprintf(
+        line, sizeof(line),
+        "result mode=ping chunk=%" PRIu32 " blocks=%" PRIu32 " load=%" PRIu32
+        " echoed=%" PRIu32 " rx_timeouts=%" PRIu32 " tx_timeouts=%" PRIu32
+        " usbtx_permille=%" PRIu32 " isr_permille=%" PRIu32
+        " idle_permille=%" PRIu32 "\n",
+        config.chunk, config.blocks, config.load, echoed, rx_timeouts,
+        tx_timeouts, task_permille("usbTx"), s_load_report.isr_permille,
+        task_permille("IDLE"));
+    send(line, len);
+}
+
+/// parses the parameters shared by all runs, nullopt if invalid
+std::optional<run_config> parse_run(std::string_view command) {
+    run_config config{};
+    config.chunk  = field(command, "chunk").value_or(0);
+    config.blocks = field(command, "blocks").value_or(0);
+    config.in     = field(command, "in").value_or(1) != 0;
+    config.out    = field(command, "out").value_or(1) != 0;
+    config.load   = field(command, "load").value_or(0);
+    if (config.chunk < dis::bench::min_block_size ||
+        config.chunk > max_block || config.blocks == 0 ||
+        config.load >= 1000) {
+        return std::nullopt;
+    }
+    return config;
+}
+
+void bench_task(void*) {
+    static char line[160];
+    while (true) {
+        const std::string_view command = read_line();
+        int len                        = 0;
+
+        if (command == "info") {
+            len = std::snprintf(
+                line, sizeof(line),
+                "begin vcom_bench version=1 cpu_hz=%" PRIu32
+                " tx_bytes=%u tx_buffers=%u rx_bytes=%u\n",
+                dis::this_cpu::cycles_per_second(),
+                static_cast<unsigned>(usb_port::tx_bytes),
+                static_cast<unsigned>(usb_port::tx_buffers),
+                static_cast<unsigned>(usb_port::rx_bytes));
+            send(line, len);
+            continue;
+        }
+
+        const bool stream = command.starts_with("stream ");
+        const bool ping   = command.starts_with("ping ");
+        const auto config =
+            (stream || ping) ? parse_run(command) : std::nullopt;
+        if (!config) {
+            len = std::snprintf(
+                line, sizeof(line),
+                "error command=%.*s min_chunk=%u max_chunk=%u\n",
+                static_cast<int>(std::min<std::size_t>(command.size(), 64)),
+                command.data(),
+                static_cast<unsigned>(dis::bench::min_block_size),
+                static_cast<unsigned>(max_block));
+            send(line, len);
+            continue;
+        }
+
+        GreenLed.On();
+        if (stream) {
+            run_stream(*config);
+        } else {
+            run_ping(*config);
+        }
+        GreenLed.Off();
+    }
+}
+
+}  // namespace
+
+int main(void) {
+    HWInit();
+    HAL_NVIC_SetPriorityGrouping(
+        NVIC_PRIORITYGROUP_4);  // ensure proper priority grouping for freeRTOS
+
+    static dis::binary_semaphore tx_done(0);
+    s_tx_done = &tx_done;
+
+    usb_port::init(usb_priority);
+
+    assert_param(xTaskCreate(bench_task, "bench", STACK_SIZE * 4, NULL,
+                             bench_priority, NULL) == pdPASS);
+    assert_param(xTaskCreate(tx_task, "benchTx", STACK_SIZE * 2, NULL,
+                             bench_priority, &s_tx_handle) == pdPASS);
+
+    // start the scheduler - shouldn't return unless there's a problem
+    vTaskStartScheduler();
+
+    // if you've wound up here, there is likely an issue with overrunning the
+    // freeRTOS heap
+    while (1) {
+    }
+}
@@ -60,6 +60,12 @@ extern int errno;
 extern int __io_putchar(int ch) __attribute__((weak));
 extern int __io_getchar(void) __attribute__((weak));
 
+/* buffered stdio of dis::io (src/dis/osal/io/retarget.cpp), -1 if the
+   stream has no sink attached.  Only linked into the images which list
+   retarget_srcs, NULL otherwise */
+extern int dis_io_write(int file, const char *ptr, int len) __attribute__((weak));
+extern int dis_io_read(int file, char *ptr, int len) __attribute__((weak));
+
 register char * stack_ptr asm("sp");
 
 char *__env[1] = { 0 };
@@ -94,6 +100,12 @@ void _exit (int status)
 __attribute__((weak)) int _read(int file, char *ptr, int len)
 {
 	int DataIdx;
+	int received = (dis_io_read != NULL) ? dis_io_read(file, ptr, len) : -1;
+
+	if (received >= 0)
+	{
+		return received;
+	}
 
 	for (DataIdx = 0; DataIdx < len; DataIdx++)
 	{
@@ -106,6 +118,12 @@ return len;
 __attribute__((weak)) int _write(int file, char *ptr, int len)
 {
 	int DataIdx;
+	int written = (dis_io_write != NULL) ? dis_io_write(file, ptr, len) : -1;
+
+	if (written >= 0)
+	{
+		return written;
+	}
 
 	for (DataIdx = 0; DataIdx < len; DataIdx++)
 	{
@@ -0,0 +1,165 @@
+// dis::adc::block_handoff between a simulated circular DMA, which writes
+// the running sample number into two halves and signals each completed
+// half right away, and a consumer of varying speed.
+
+#include "check.hpp"
+
+#include "dis/osal/io/adc/block_handoff.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace {
+
+using dis::adc::block_count;
+using dis::adc::block_handoff;
+using dis::adc::block_ticket;
+using dis::adc::handoff_stats;
+
+constexpr std::size_t block_size = 16;
+
+void in_order() {
+    block_handoff handoff;
+    DIS_CHECK(!handoff.acquire().has_value());
+    for (std::uint32_t sequence = 0; sequence < 5; ++sequence) {
+        handoff.filled(sequence % block_count);
+        const std::optional<block_ticket> ticket = handoff.acquire();
+        DIS_CHECK(ticket.has_value());
+        if (ticket) {
+            DIS_CHECK_EQUAL(ticket->sequence, sequence);
+            DIS_CHECK_EQUAL(ticket->index, std::size_t{sequence % 2});
+            DIS_CHECK(handoff.release(*ticket));
+        }
+        DIS_CHECK(!handoff.acquire().has_value());
+    }
+    const handoff_stats stats = handoff.stats();
+    DIS_CHECK_EQUAL(stats.filled, 5U);
+    DIS_CHECK_EQUAL(stats.skipped, 0U);
+    DIS_CHECK_EQUAL(stats.torn, 0U);
+}
+
+void falls_behind() {
+    block_handoff handoff;
+    handoff.filled(0);
+    handoff.filled(1);
+    handoff.filled(0);
+    // only the newest block is still intact
+    const std::optional<block_ticket> ticket = handoff.acquire();
+    DIS_CHECK(ticket.has_value());
+    if (ticket) {
+        DIS_CHECK_EQUAL(ticket->sequence, 2U);
+        DIS_CHECK_EQUAL(ticket->index, std::size_t{0});
+        DIS_CHECK(handoff.release(*ticket));
+    }
+    DIS_CHECK_EQUAL(handoff.stats().skipped, 2U);
+    DIS_CHECK_EQUAL(handoff.stats().torn, 0U);
+}
+
+void torn_block() {
+    block_handoff handoff;
+    handoff.filled(0);
+    const std::optional<block_ticket> ticket = handoff.acquire();
+    DIS_CHECK(ticket.has_value());
+    // with the next block complete, the DMA writes into this half again
+    handoff.filled(1);
+    if (ticket) {
+        DIS_CHECK(!handoff.release(*ticket));
+    }
+    DIS_CHECK_EQUAL(handoff.stats().torn, 1U);
+
+    // a new transfer starts over at the first half
+    handoff.reset();
+    handoff.filled(0);
+    const std::optional<block_ticket> first = handoff.acquire();
+    DIS_CHECK(first.has_value() && first->sequence == 0);
+}
+
+void lost_event() {
+    // the interrupt of the second half got lost, the next one still tells
+    // which half is complete
+    block_handoff handoff;
+    handoff.filled(0);
+    handoff.filled(0);
+    DIS_CHECK_EQUAL(handoff.stats().filled, 3U);
+    const std::optional<block_ticket> ticket = handoff.acquire();
+    DIS_CHECK(ticket.has_value());
+    if (ticket) {
+        DIS_CHECK_EQUAL(ticket->sequence, 2U);
+        DIS_CHECK_EQUAL(ticket->index, std::size_t{0});
+    }
+}
+
+/// the DMA writes one sample per step, the consumer reads 0 to 2
+void simulated_dma() {
+    std::array<std::uint32_t, block_count * block_size> buffer{};
+    block_handoff handoff;
+
+    std::optional<block_ticket> ticket;
+    std::uint32_t written   = 0;
+    std::uint32_t random    = 11;
+    std::uint32_t read      = 0;
+    bool intact             = true;
+    std::uint32_t delivered = 0;
+    std::uint32_t released  = 0;
+    std::uint32_t next      = 0;
+    for (int step = 0; step < 200000; ++step) {
+        buffer[written % buffer.size()] = written;
+        ++written;
+        if (written % block_size == 0) {
+            handoff.filled((written / block_size - 1) % block_count);
+        }
+
+        random = random * 1664525U + 1013904223U;
+        // slower and faster than the DMA in phases
+        const std::uint32_t speed =
+            (step / 5000) % 2 == 0 ? (random >> 16U) % 3U : 1U;
+        for (std::uint32_t i = 0; i < speed; ++i) {
+            if (!ticket) {
+                ticket = handoff.acquire();
+                if (!ticket) {
+                    break;
+                }
+                DIS_CHECK(ticket->sequence >= next);
+                DIS_CHECK_EQUAL(ticket->index,
+                                std::size_t{ticket->sequence % block_count});
+                next   = ticket->sequence + 1;
+                read   = 0;
+                intact = true;
+                ++delivered;
+            }
+            const std::uint32_t expected = ticket->sequence * block_size + read;
+            intact = intact &&
+                     buffer[ticket->index * block_size + read] == expected;
+            if (++read == block_size) {
+                if (handoff.release(*ticket)) {
+                    // a block reported intact has to be
+                    DIS_CHECK(intact);
+                    ++released;
+                }
+                ticket.reset();
+            }
+        }
+    }
+
+    const handoff_stats stats = handoff.stats();
+    DIS_CHECK_EQUAL(stats.filled, written / block_size);
+    DIS_CHECK(stats.skipped > 0);
+    DIS_CHECK(stats.torn > 0);
+    DIS_CHECK(released > 0);
+    // every block got either handed out or skipped
+    DIS_CHECK_EQUAL(delivered + stats.skipped, next);
+    DIS_CHECK_EQUAL(released + stats.torn + (ticket ? 1U : 0U), delivered);
+}
+
+}  // namespace
+
+int main() {
+    in_order();
+    falls_behind();
+    torn_block();
+    lost_event();
+    simulated_dma();
+    return dis::test::result();
+}
@@ -0,0 +1,73 @@
+#ifndef DIS_TESTS_CHECK_HPP
+#define DIS_TESTS_CHECK_HPP
+
+// NOTE: the host tests run without exceptions like the firmware, so a failed
+// check is reported and counted, the test goes on and main() returns
+// dis::test::result().
+
+#include <cstdio>
+#include <type_traits>
+
+namespace dis::test {
+
+inline int s_failures = 0;
+
+inline void fail(const char* file, int line, const char* expression) noexcept {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    ++s_failures;
+}
+
+template <class T>
+void print(const T& value) noexcept {
+    if constexpr (std::is_same_v<T, bool>) {
+        std::fprintf(stderr, "%s", value ? "true" : "false");
+    } else if constexpr (std::is_floating_point_v<T>) {
+        std::fprintf(stderr, "%g", static_cast<double>(value));
+    } else if constexpr (std::is_signed_v<T>) {
+        std::fprintf(stderr, "%lld", static_cast<long long>(value));
+    } else if constexpr (std::is_unsigned_v<T>) {
+        std::fprintf(stderr, "%llu", static_cast<unsigned long long>(value));
+    } else {
+        std::fprintf(stderr, "?");
+    }
+}
+
+template <class A, class B>
+void check_equal(const A& actual,
+                 const B& expected,
+                 const char* file,
+                 int line,
+                 const char* expression) noexcept {
+    if (actual == expected) {
+        return;
+    }
+    fail(file, line, expression);
+    std::fprintf(stderr, "  actual ");
+    print(actual);
+    std::fprintf(stderr, ", expected ");
+    print(expected);
+    std::fprintf(stderr, "\n");
+}
+
+/// exit code of the test, 1 if any check failed
+[[nodiscard]] inline int result() noexcept {
+    if (s_failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", s_failures);
+    }
+    return s_failures == 0 ? 0 : 1;
+}
+
+}  // namespace dis::test
+
+#define DIS_CHECK(expression)                                       \
+    do {                                                            \
+        if (!(expression)) {                                        \
+            ::dis::test::fail(__FILE__, __LINE__, #expression);     \
+        }                                                           \
+    } while (0)
+
+#define DIS_CHECK_EQUAL(actual, expected)                            \
+    ::dis::test::check_equal((actual), (expected), __FILE__, __LINE__, \
+                             #actual " == " #expected)
+
+#endif  // DIS_TESTS_CHECK_HPP
@@ -0,0 +1,153 @@
+// Frames of dis::io::mux split up again by the demultiplexer of
+// tools/vcom_demux, from a stream cut at arbitrary points and with garbage,
+// broken and lost frames in between.
+
+#include "check.hpp"
+
+#include "demux.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace {
+
+using namespace dis::io::mux;
+
+struct received {
+    std::uint8_t channel;
+    std::vector<std::byte> payload;
+};
+
+[[nodiscard]] std::vector<std::byte> payload_of(std::uint8_t channel,
+                                                std::uint16_t sequence,
+                                                std::size_t size) {
+    std::vector<std::byte> payload(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        payload[i] = static_cast<std::byte>((channel * 31U + sequence + i) &
+                                            0xFFU);
+    }
+    return payload;
+}
+
+/// appends a frame as the multiplexer puts it on the link
+void append(std::vector<std::byte>& stream,
+            std::uint8_t channel,
+            std::uint16_t sequence,
+            std::span<const std::byte> payload) {
+    const std::size_t at = stream.size();
+    stream.resize(at + header_size + payload.size());
+    encode({channel, static_cast<std::uint16_t>(payload.size()), sequence},
+           stream.data() + at);
+    std::copy(payload.begin(), payload.end(),
+              stream.begin() + static_cast<std::ptrdiff_t>(at + header_size));
+    seal(stream.data() + at, payload.size());
+}
+
+void frames_in_pieces() {
+    std::vector<std::byte> stream;
+    std::vector<received> expected;
+    for (std::uint16_t sequence = 0; sequence < 50; ++sequence) {
+        for (std::uint8_t channel = 0; channel < 3; ++channel) {
+            const std::size_t size = (sequence * 37U + channel * 11U) % 300U;
+            auto payload           = payload_of(channel, sequence, size);
+            append(stream, channel, sequence, payload);
+            expected.push_back({channel, std::move(payload)});
+        }
+    }
+
+    std::vector<received> got;
+    demultiplexer demux(
+        [&](std::uint8_t channel, std::span<const std::byte> payload) {
+            got.push_back({channel, {payload.begin(), payload.end()}});
+        });
+    // pieces from 1 byte up to several frames
+    std::uint32_t random = 1;
+    for (std::size_t pos = 0; pos < stream.size();) {
+        random                = random * 1664525U + 1013904223U;
+        const std::size_t len = std::min<std::size_t>(
+            1 + (random >> 20U) % 700U, stream.size() - pos);
+        demux.feed({stream.data() + pos, len});
+        pos += len;
+    }
+
+    DIS_CHECK_EQUAL(got.size(), expected.size());
+    for (std::size_t i = 0; i < got.size() && i < expected.size(); ++i) {
+        DIS_CHECK_EQUAL(got[i].channel, expected[i].channel);
+        DIS_CHECK(got[i].payload == expected[i].payload);
+    }
+    for (std::uint8_t channel = 0; channel < 3; ++channel) {
+        const link_stats& stats = demux.channels().at(channel);
+        DIS_CHECK_EQUAL(stats.frames, 50U);
+        DIS_CHECK_EQUAL(stats.lost, 0U);
+    }
+    DIS_CHECK_EQUAL(demux.skipped(), 0U);
+    DIS_CHECK_EQUAL(demux.bad_checks(), 0U);
+}
+
+void resynchronizes() {
+    std::vector<std::byte> stream;
+    // starts in the middle of a frame, which contains the sync byte
+    const std::vector<std::byte> garbage{std::byte{0x12}, std::byte{0xA5},
+                                         std::byte{0x00}, std::byte{0x34}};
+    stream.insert(stream.end(), garbage.begin(), garbage.end());
+    append(stream, 1, 7, payload_of(1, 7, 20));
+
+    // a frame with a broken payload is skipped and counted
+    const std::size_t broken = stream.size();
+    append(stream, 1, 8, payload_of(1, 8, 20));
+    stream[broken + header_size + 3] ^= std::byte{0x40};
+
+    // two frames of channel 2 lost on the link
+    append(stream, 2, 0, payload_of(2, 0, 5));
+    append(stream, 2, 3, payload_of(2, 3, 5));
+    append(stream, 1, 9, payload_of(1, 9, 20));
+
+    // the garbage announces 0xA534 bytes, more than the firmware sends
+    std::vector<received> got;
+    demultiplexer demux(
+        [&](std::uint8_t channel, std::span<const std::byte> payload) {
+            got.push_back({channel, {payload.begin(), payload.end()}});
+        },
+        64);
+    demux.feed(stream);
+
+    DIS_CHECK_EQUAL(got.size(), std::size_t{4});
+    if (got.size() == 4) {
+        DIS_CHECK(got[0].payload == payload_of(1, 7, 20));
+        DIS_CHECK(got[1].payload == payload_of(2, 0, 5));
+        DIS_CHECK(got[2].payload == payload_of(2, 3, 5));
+        DIS_CHECK(got[3].payload == payload_of(1, 9, 20));
+    }
+    DIS_CHECK_EQUAL(demux.channels().at(1).lost, 1U);
+    DIS_CHECK_EQUAL(demux.channels().at(2).lost, 2U);
+    DIS_CHECK_EQUAL(demux.bad_checks(), 1U);
+    // the garbage and the whole broken frame
+    DIS_CHECK_EQUAL(demux.skipped(), garbage.size() + header_size + 20);
+}
+
+void rejects_oversized_headers() {
+    // a header announcing more than the firmware sends is taken as garbage,
+    // the whole frame is skipped
+    std::vector<std::byte> stream;
+    append(stream, 0, 0, payload_of(0, 0, 64));
+    append(stream, 0, 1, payload_of(0, 1, 10));
+
+    std::size_t frames = 0;
+    demultiplexer demux(
+        [&](std::uint8_t, std::span<const std::byte>) { ++frames; }, 32);
+    demux.feed(stream);
+    DIS_CHECK_EQUAL(frames, std::size_t{1});
+    DIS_CHECK_EQUAL(demux.skipped(), header_size + 64);
+}
+
+}  // namespace
+
+int main() {
+    frames_in_pieces();
+    resynchronizes();
+    rejects_oversized_headers();
+    return dis::test::result();
+}
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Runs one round of the host build of src/main_dsp_bench.cpp, whose virtual
+com port is stdin and stdout, and fails unless every kernel matched its
+reference bit by bit."""
+
+import re
+import subprocess
+import sys
+import threading
+
+
+def main():
+    exe = sys.argv[1]
+    bench = subprocess.Popen([exe], stdin=subprocess.PIPE,
+                             stdout=subprocess.PIPE, stderr=sys.stderr)
+    # the bench runs until it gets killed
+    timer = threading.Timer(60, bench.kill)
+    timer.start()
+    try:
+        # any byte starts the suite
+        bench.stdin.write(b"\n")
+        bench.stdin.flush()
+        kernels = []
+        mismatches = None
+        for raw in bench.stdout:
+            line = raw.decode(errors="replace").rstrip()
+            match = re.match(r"kernel name=(\S+) param=(\d+) exact=(\w+)",
+                             line)
+            if match:
+                sys.stderr.write(line + "\n")
+                kernels.append(match.groups())
+                continue
+            match = re.match(r"end mismatches=(\d+)", line)
+            if match:
+                mismatches = int(match.group(1))
+                break
+    finally:
+        timer.cancel()
+        bench.kill()
+        bench.wait()
+
+    if mismatches is None:
+        sys.exit("dsp_bench ended without a result")
+    if not kernels:
+        sys.exit("dsp_bench ran no kernel")
+    inexact = ["{} ({})".format(name, param)
+               for name, param, exact in kernels if exact != "yes"]
+    if inexact or mismatches != 0:
+        sys.exit("not bit exact: {}".format(", ".join(inexact)))
+
+
+if __name__ == "__main__":
+    main()
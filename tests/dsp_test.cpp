@@ -0,0 +1,149 @@
+// The q15 and q31 kernels of dis::dsp against their ref:: counterparts on
+// odd sizes: block sizes and tap counts which are not a multiple of the
+// unrolling, filter input in pieces which split the internal blocks and
+// the decimation phase.  The dsp_bench test only covers even sizes.
+
+#include "check.hpp"
+
+#include "dis/dsp/fir.hpp"
+#include "dis/dsp/reference.hpp"
+#include "dis/dsp/simd.hpp"
+#include "dis/dsp/statistics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace {
+
+using dis::dsp::q15_t;
+using dis::dsp::q31_t;
+
+constexpr std::size_t input_size = 101;
+// none of them a multiple of the block size or of the decimation
+constexpr std::array<std::size_t, 7> pieces{1, 2, 3, 5, 8, 13, 4};
+
+/// pseudo random full scale samples, now and then the extremes
+template <class SAMPLE_T, std::size_t SIZE_V>
+std::array<SAMPLE_T, SIZE_V> samples(std::uint32_t seed) noexcept {
+    using limits = std::numeric_limits<SAMPLE_T>;
+    std::array<SAMPLE_T, SIZE_V> result{};
+    for (std::size_t i = 0; i < SIZE_V; ++i) {
+        seed = seed * 1664525U + 1013904223U;
+        if (i % 7 == 3) {
+            result[i] = (i % 2 == 0) ? limits::min() : limits::max();
+        } else if constexpr (sizeof(SAMPLE_T) == 2) {
+            result[i] = static_cast<SAMPLE_T>(seed >> 16U);
+        } else {
+            result[i] = static_cast<SAMPLE_T>(seed);
+        }
+    }
+    return result;
+}
+
+void smlad_full_scale() {
+    namespace simd = dis::dsp::simd;
+    const simd::q15x2_t min = simd::pack_q15x2(INT16_MIN, INT16_MIN);
+    // 2^31 wraps like on the target
+    DIS_CHECK_EQUAL(simd::smlad(min, min, 0), INT32_MIN);
+    DIS_CHECK_EQUAL(simd::smlad(min, min, -1), INT32_MAX);
+    DIS_CHECK_EQUAL(simd::smlald(min, min, 0), std::int64_t{1} << 31U);
+}
+
+template <class SAMPLE_T,
+          std::size_t TAPS_V,
+          std::size_t BLOCK_V,
+          std::size_t DECIMATION_V>
+void fir_matches_reference() {
+    const auto taps  = samples<SAMPLE_T, TAPS_V>(TAPS_V);
+    const auto input = samples<SAMPLE_T, input_size>(BLOCK_V);
+    dis::dsp::ref::fir<SAMPLE_T, TAPS_V, DECIMATION_V> ref{taps};
+    dis::dsp::fir<SAMPLE_T, TAPS_V, BLOCK_V, DECIMATION_V> opt{taps};
+
+    std::array<SAMPLE_T, input_size> ref_out{};
+    std::array<SAMPLE_T, input_size> opt_out{};
+    std::size_t ref_written = 0;
+    std::size_t opt_written = 0;
+    std::size_t done        = 0;
+    for (std::size_t i = 0; done < input_size; ++i) {
+        const std::size_t size = std::min(pieces[i % pieces.size()],
+                                          input_size - done);
+        const std::span piece{input.data() + done, size};
+        ref_written += ref.process(
+            piece, std::span{ref_out}.subspan(ref_written));
+        opt_written += opt.process(
+            piece, std::span{opt_out}.subspan(opt_written));
+        done += size;
+    }
+
+    DIS_CHECK_EQUAL(ref_written, input_size / DECIMATION_V);
+    DIS_CHECK_EQUAL(opt_written, ref_written);
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < ref_written; ++i) {
+        mismatches += ref_out[i] != opt_out[i] ? 1 : 0;
+    }
+    DIS_CHECK_EQUAL(mismatches, std::size_t{0});
+}
+
+void fir_odd_sizes() {
+    // the q15 dot product takes four, two and one tap at a time
+    fir_matches_reference<q15_t, 5, 5, 1>();
+    fir_matches_reference<q15_t, 6, 5, 1>();
+    fir_matches_reference<q15_t, 7, 5, 1>();
+    fir_matches_reference<q15_t, 7, 5, 3>();
+    fir_matches_reference<q15_t, 7, 16, 4>();
+    fir_matches_reference<q31_t, 7, 5, 1>();
+    fir_matches_reference<q31_t, 7, 5, 3>();
+}
+
+template <class SAMPLE_T, class MEAN_F, class RMS_F, class MIN_MAX_F>
+void statistics_match_reference(MEAN_F mean, RMS_F rms, MIN_MAX_F min_max) {
+    const auto same = [&](std::span<const SAMPLE_T> block) {
+        const auto expected = dis::dsp::ref::extremes(block);
+        const auto actual   = min_max(block);
+        DIS_CHECK_EQUAL(mean(block), dis::dsp::ref::mean(block));
+        DIS_CHECK_EQUAL(rms(block), dis::dsp::ref::rms(block));
+        DIS_CHECK_EQUAL(actual.min, expected.min);
+        DIS_CHECK_EQUAL(actual.max, expected.max);
+    };
+
+    const auto input = samples<SAMPLE_T, input_size>(42);
+    for (std::size_t size = 0; size < 12; ++size) {
+        same(std::span{input.data(), size});
+    }
+    same(input);
+
+    // the odd tail alone holds the extremes and moves the mean
+    using limits = std::numeric_limits<SAMPLE_T>;
+    std::array<SAMPLE_T, input_size> tail{};
+    for (const std::size_t size : {std::size_t{5}, input_size}) {
+        tail[size - 1] = limits::min();
+        same(std::span{tail.data(), size});
+        tail[size - 1] = limits::max();
+        same(std::span{tail.data(), size});
+        tail[size - 1] = 0;
+    }
+}
+
+void statistics_odd_sizes() {
+    statistics_match_reference<q15_t>(
+        [](std::span<const q15_t> s) { return dis::dsp::mean_q15(s); },
+        [](std::span<const q15_t> s) { return dis::dsp::rms_q15(s); },
+        [](std::span<const q15_t> s) { return dis::dsp::min_max_q15(s); });
+    statistics_match_reference<q31_t>(
+        [](std::span<const q31_t> s) { return dis::dsp::mean_q31(s); },
+        [](std::span<const q31_t> s) { return dis::dsp::rms_q31(s); },
+        [](std::span<const q31_t> s) { return dis::dsp::min_max_q31(s); });
+}
+
+}  // namespace
+
+int main() {
+    smlad_full_scale();
+    fir_odd_sizes();
+    statistics_odd_sizes();
+    return dis::test::result();
+}
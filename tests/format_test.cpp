@@ -0,0 +1,276 @@
+// dis::format_to against the output of std::format.  The expected strings
+// are the ones of std::format, with a standard library that has it they are
+// checked against it as well.  Integers and fixed point are also swept
+// against printf, which formats them the same way.
+
+#include "check.hpp"
+
+#include "dis/osal/utils/format.hpp"
+
+#include <array>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+#if __has_include(<format>)
+#include <format>
+#endif
+
+namespace {
+
+std::array<char, 512> s_buffer;
+
+template <class... ARG_Ts>
+void check_format(const char* file,
+                  int line,
+                  std::string_view expected,
+                  dis::format_string<ARG_Ts...> fmt,
+                  const ARG_Ts&... args) {
+    const auto res = dis::format_to(s_buffer, fmt, args...);
+    const std::string_view actual(s_buffer.data(),
+                                  static_cast<std::size_t>(res.out -
+                                                           s_buffer.data()));
+    if (actual != expected || res.size != expected.size()) {
+        dis::test::fail(file, line, fmt.get().data());
+        std::fprintf(stderr, "  actual \"%.*s\", expected \"%.*s\"\n",
+                     static_cast<int>(actual.size()), actual.data(),
+                     static_cast<int>(expected.size()), expected.data());
+    }
+#if defined(__cpp_lib_format)
+    const std::string reference =
+        std::vformat(fmt.get(), std::make_format_args(args...));
+    if (reference != expected) {
+        dis::test::fail(file, line, "expectation differs from std::format");
+        std::fprintf(stderr, "  std::format \"%s\"\n", reference.c_str());
+    }
+#endif
+}
+
+#define CHECK_FORMAT(expected, ...) \
+    check_format(__FILE__, __LINE__, expected, __VA_ARGS__)
+
+void integers() {
+    CHECK_FORMAT("42", "{}", 42);
+    CHECK_FORMAT("-42", "{}", -42);
+    CHECK_FORMAT("0", "{}", 0U);
+    CHECK_FORMAT("-9223372036854775808", "{}",
+                 std::numeric_limits<std::int64_t>::min());
+    CHECK_FORMAT("18446744073709551615", "{}",
+                 std::numeric_limits<std::uint64_t>::max());
+    CHECK_FORMAT("-128 255", "{} {}", std::int8_t{-128}, std::uint8_t{255});
+    CHECK_FORMAT("ff FF 377 11111111", "{:x} {:X} {:o} {:b}", 255, 255, 255,
+                 255);
+    CHECK_FORMAT("-ff", "{:x}", -255);
+    CHECK_FORMAT("A", "{:c}", 65);
+}
+
+void alignment_and_fill() {
+    CHECK_FORMAT("   42", "{:5}", 42);
+    CHECK_FORMAT("42   ", "{:<5}", 42);
+    CHECK_FORMAT(" 42  ", "{:^5}", 42);
+    CHECK_FORMAT("**42**", "{:*^6}", 42);
+    CHECK_FORMAT("**42***", "{:*^7}", 42);
+    CHECK_FORMAT("  -42", "{:>5}", -42);
+    CHECK_FORMAT("12345", "{:3}", 12345);
+    CHECK_FORMAT("abc  |", "{:5}|", "abc");
+    CHECK_FORMAT("--abc--", "{:-^7}", std::string_view("abc"));
+    CHECK_FORMAT("ab", "{:.2}", "abc");
+    CHECK_FORMAT("  ab", "{:>4.2}", "abc");
+}
+
+void sign_alternate_and_zero() {
+    CHECK_FORMAT("+5 -5 +0", "{:+} {:+} {:+}", 5, -5, 0);
+    CHECK_FORMAT(" 5 -5", "{: } {: }", 5, -5);
+    CHECK_FORMAT("5 -5", "{:-} {:-}", 5, -5);
+    CHECK_FORMAT("0xff 0XFF 0b101 0B101", "{:#x} {:#X} {:#b} {:#B}", 255, 255,
+                 5, 5);
+    CHECK_FORMAT("010 0", "{:#o} {:#o}", 8, 0);
+    CHECK_FORMAT("-0xff", "{:#x}", -255);
+    CHECK_FORMAT("-0000042", "{:08}", -42);
+    CHECK_FORMAT("+00042", "{:+06}", 42);
+    CHECK_FORMAT("0x000000ff", "{:#010x}", 255);
+    CHECK_FORMAT("-0x00ff", "{:#07x}", -255);
+    // an alignment disables the zero padding
+    CHECK_FORMAT("42      ", "{:<08}", 42);
+    CHECK_FORMAT("**-42", "{:*>05}", -42);
+}
+
+void bool_and_char() {
+    CHECK_FORMAT("true false", "{} {}", true, false);
+    CHECK_FORMAT("true  | false", "{:6}| {:s}", true, false);
+    CHECK_FORMAT(" false", "{:>6}", false);
+    CHECK_FORMAT("1 0x1 0", "{:d} {:#x} {:b}", true, true, false);
+    CHECK_FORMAT("a", "{}", 'a');
+    CHECK_FORMAT("a  |  a", "{:3}|{:>3}", 'a', 'a');
+    CHECK_FORMAT("97 0x61 +97", "{:d} {:#x} {:+d}", 'a', 'a', 'a');
+    CHECK_FORMAT("0000097", "{:07d}", 'a');
+}
+
+void fixed_point() {
+    CHECK_FORMAT("3.14", "{:.2f}", 3.14159);
+    CHECK_FORMAT("1.500000", "{:f}", 1.5);
+    CHECK_FORMAT("1.500000", "{:f}", 1.5F);
+    // the exact value is rounded half to even
+    CHECK_FORMAT("0 2 2", "{:.0f} {:.0f} {:.0f}", 0.5, 1.5, 2.5);
+    CHECK_FORMAT("0.2 0.38", "{:.1f} {:.2f}", 0.25, 0.375);
+    // 0.15 is slightly below, 0.35 slightly above
+    CHECK_FORMAT("0.1 0.3", "{:.1f} {:.1f}", 0.15, 0.35);
+    CHECK_FORMAT("2.", "{:#.0f}", 2.0);
+    CHECK_FORMAT("+0.2 -0.0", "{:+.1f} {:.1f}", 0.25, -0.0);
+    CHECK_FORMAT("-003.500", "{:08.3f}", -3.5);
+    CHECK_FORMAT("     2.2|2.2     |  2.2   ", "{:>8.1f}|{:<8.1f}|{:^8.1f}",
+                 2.25, 2.25, 2.25);
+    CHECK_FORMAT("0.000000001", "{:.9f}", 1e-9);
+    CHECK_FORMAT("100000000000000000000", "{:.0f}", 1e20);
+    CHECK_FORMAT("18446744073709551616.000", "{:.3f}", 18446744073709551616.0);
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    CHECK_FORMAT("inf -INF nan NAN", "{:f} {:F} {:f} {:F}", inf, -inf, nan,
+                 nan);
+    CHECK_FORMAT("+inf", "{:+f}", inf);
+    // no zero padding for inf and nan
+    CHECK_FORMAT("     inf", "{:08f}", inf);
+}
+
+void pointers_and_braces() {
+    CHECK_FORMAT("0x0", "{}", nullptr);
+    CHECK_FORMAT("  0x10", "{:>6}", reinterpret_cast<const void*>(0x10));
+    CHECK_FORMAT("{}", "{{}}");
+    CHECK_FORMAT("a{1}b", "a{{{}}}b", 1);
+}
+
+void truncation() {
+    std::array<char, 4> small{};
+    const auto res = dis::format_to(small, "{}-{}", 123, 456);
+    DIS_CHECK_EQUAL(res.size, std::size_t{7});
+    DIS_CHECK(res.out == small.data() + small.size());
+    DIS_CHECK(std::string_view(small.data(), small.size()) == "123-");
+
+    const auto padded = dis::format_to(small, "{:>10}", 1);
+    DIS_CHECK_EQUAL(padded.size, std::size_t{10});
+    DIS_CHECK(std::string_view(small.data(), small.size()) == "    ");
+
+    // no buffer at all, a null pointer, still counts the whole output
+    const auto none = dis::format_to({}, "{}-{:>5}", "abc", 1);
+    DIS_CHECK_EQUAL(none.size, std::size_t{9});
+    DIS_CHECK(none.out == nullptr);
+
+    // an empty string_view may be a null pointer as well
+    const auto empty = dis::format_to(small, "{}|{:2}", std::string_view{},
+                                      std::string_view{});
+    DIS_CHECK_EQUAL(empty.size, std::size_t{3});
+    DIS_CHECK(std::string_view(small.data(), empty.size) == "|  ");
+}
+
+/// std::format rejects these, which it can only do by throwing
+void char_out_of_range() {
+    std::array<char, 8> text{};
+    auto res = dis::format_to(text, "{:c}|{:c}", -63, 256);
+    DIS_CHECK(std::string_view(text.data(), res.size) == "?|?");
+    res = dis::format_to(text, "{:c}{:c}", std::int8_t{-1}, 0xFFU);
+    DIS_CHECK(std::string_view(text.data(), res.size) == "?\xFF");
+    res = dis::format_to(text, "{:>3c}",
+                         std::numeric_limits<std::int64_t>::min());
+    DIS_CHECK(std::string_view(text.data(), res.size) == "  ?");
+}
+
+std::uint64_t s_random = 0x853C49E6748FEA9BULL;
+
+std::uint64_t next_random() {
+    // xorshift64
+    s_random ^= s_random << 13U;
+    s_random ^= s_random >> 7U;
+    s_random ^= s_random << 17U;
+    return s_random;
+}
+
+void integer_sweep() {
+    char expected[64];
+    for (int n = 0; n < 20000; ++n) {
+        // all magnitudes, not only the large ones
+        const auto value = static_cast<std::int64_t>(next_random() >>
+                                                     (next_random() % 64));
+        const std::int64_t signed_value = (n & 1) != 0 ? -value : value;
+        const auto res = dis::format_to(s_buffer, "{} {:x} {:o}",
+                                        signed_value,
+                                        static_cast<std::uint64_t>(value),
+                                        static_cast<std::uint64_t>(value));
+        const int len = std::snprintf(
+            expected, sizeof(expected), "%" PRId64 " %" PRIx64 " %" PRIo64,
+            signed_value, static_cast<std::uint64_t>(value),
+            static_cast<std::uint64_t>(value));
+        if (std::string_view(s_buffer.data(),
+                             static_cast<std::size_t>(res.out -
+                                                      s_buffer.data())) !=
+            std::string_view(expected, static_cast<std::size_t>(len))) {
+            dis::test::fail(__FILE__, __LINE__, expected);
+        }
+    }
+}
+
+void fixed_point_sweep() {
+    // glibc prints the exactly rounded value like std::format
+    static char expected[512];
+    for (int n = 0; n < 20000; ++n) {
+        double value = 0;
+        do {
+            const std::uint64_t bits = next_random();
+            std::memcpy(&value, &bits, sizeof(value));
+        } while (!std::isfinite(value));
+        // mostly values of a sensible size, some from the whole range
+        if (n % 8 != 0) {
+            int exponent = 0;
+            value        = std::ldexp(std::frexp(value, &exponent),
+                                      static_cast<int>(next_random() % 80) - 40);
+        }
+        // the precision is part of the compile time format string
+        const int precision = n % 10;
+        std::size_t size    = 0;
+        switch (precision) {
+#define FIXED_CASE(P)                                            \
+    case P:                                                      \
+        size = dis::format_to(s_buffer, "{:." #P "f}", value).size; \
+        break;
+            FIXED_CASE(0)
+            FIXED_CASE(1)
+            FIXED_CASE(2)
+            FIXED_CASE(3)
+            FIXED_CASE(4)
+            FIXED_CASE(5)
+            FIXED_CASE(6)
+            FIXED_CASE(7)
+            FIXED_CASE(8)
+            FIXED_CASE(9)
+#undef FIXED_CASE
+            default: break;
+        }
+        const int len =
+            std::snprintf(expected, sizeof(expected), "%.*f", precision, value);
+        if (std::string_view(s_buffer.data(), size) !=
+            std::string_view(expected, static_cast<std::size_t>(len))) {
+            dis::test::fail(__FILE__, __LINE__, expected);
+            std::fprintf(stderr, "  actual \"%.*s\"\n", static_cast<int>(size),
+                         s_buffer.data());
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    integers();
+    alignment_and_fill();
+    sign_alternate_and_zero();
+    bool_and_char();
+    fixed_point();
+    pointers_and_braces();
+    truncation();
+    char_out_of_range();
+    integer_sweep();
+    fixed_point_sweep();
+    return dis::test::result();
+}
@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+"""Runs a host tool on a recording under tests/data and compares its stdout
+with the expected output checked in next to it:
+
+    golden_test.py EXPECTED TOOL [ARGS...]
+"""
+
+import difflib
+import pathlib
+import subprocess
+import sys
+
+
+def main():
+    expected_path, *command = sys.argv[1:]
+    result = subprocess.run(command, capture_output=True, timeout=60)
+    sys.stderr.write(result.stderr.decode(errors="replace"))
+    if result.returncode != 0:
+        sys.exit("{} exited with {}".format(command[0], result.returncode))
+
+    expected = pathlib.Path(expected_path).read_text().splitlines()
+    actual = result.stdout.decode(errors="replace").splitlines()
+    if actual != expected:
+        diff = difflib.unified_diff(expected, actual, expected_path, "output",
+                                    lineterm="", n=1)
+        sys.stderr.write("\n".join(list(diff)[:40]) + "\n")
+        sys.exit("the output differs from {}".format(expected_path))
+
+
+if __name__ == "__main__":
+    main()
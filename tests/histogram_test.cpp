@@ -0,0 +1,90 @@
+// Percentile bounds of dis::histogram_snapshot.
+
+#include "check.hpp"
+
+#include "dis/osal/utils/histogram.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// every value below 2^4 has its own bucket, so percentiles are exact there
+using snapshot = dis::histogram_snapshot<4, 32>;
+
+void percentiles_of_ten_samples() {
+    snapshot h;
+    for (std::uint32_t v = 1; v <= 10; ++v) {
+        h.record(v);
+    }
+    DIS_CHECK_EQUAL(h.percentile(0.0), 1U);
+    DIS_CHECK_EQUAL(h.percentile(10.0), 1U);
+    DIS_CHECK_EQUAL(h.percentile(10.1), 2U);
+    DIS_CHECK_EQUAL(h.percentile(15.0), 2U);
+    DIS_CHECK_EQUAL(h.percentile(50.0), 5U);
+    DIS_CHECK_EQUAL(h.percentile(90.0), 9U);
+    DIS_CHECK_EQUAL(h.percentile(90.01), 10U);
+    DIS_CHECK_EQUAL(h.percentile(100.0), 10U);
+    // out of range requests are clamped
+    DIS_CHECK_EQUAL(h.percentile(-5.0), 1U);
+    DIS_CHECK_EQUAL(h.percentile(250.0), 10U);
+}
+
+void rank_rounds_up() {
+    // 3 samples: 50% needs 1.5 samples, i.e. the second one, rounding to the
+    // nearest rank gave the first for 16.7% and less
+    snapshot h;
+    h.record(1);
+    h.record(2);
+    h.record(3);
+    DIS_CHECK_EQUAL(h.percentile(33.3), 1U);
+    DIS_CHECK_EQUAL(h.percentile(33.4), 2U);
+    DIS_CHECK_EQUAL(h.percentile(50.0), 2U);
+    DIS_CHECK_EQUAL(h.percentile(66.7), 3U);
+    DIS_CHECK_EQUAL(h.percentile(99.9), 3U);
+
+    // whole percentages of round totals hit the rank exactly, 7% of 100
+    // is rank 7 (7.000000000000001 with percent / 100 first)
+    snapshot hundred;
+    for (std::uint32_t v = 0; v < 100; ++v) {
+        hundred.record(v < 7 ? 1 : 2);
+    }
+    DIS_CHECK_EQUAL(hundred.percentile(7.0), 1U);
+    DIS_CHECK_EQUAL(hundred.percentile(7.5), 2U);
+}
+
+void percentile_is_never_too_small() {
+    // a percentile reports the highest value of its bucket
+    snapshot h;
+    for (std::uint32_t v = 1000; v < 2000; ++v) {
+        h.record(v);
+    }
+    for (const double p : {1.0, 25.0, 50.0, 75.0, 99.0, 99.9, 100.0}) {
+        const auto exact =
+            static_cast<std::uint32_t>(1000 + std::ceil(p * 10.0) - 1);
+        const std::uint32_t reported = h.percentile(p);
+        DIS_CHECK(reported >= exact);
+        // at most one bucket width (1/16 of the value) too large
+        DIS_CHECK(reported - exact <= exact / 16);
+    }
+    DIS_CHECK_EQUAL(h.percentile(100.0), h.max());
+    DIS_CHECK(h.percentile(0.0) >= h.min());
+}
+
+void single_sample_and_empty() {
+    snapshot h;
+    DIS_CHECK_EQUAL(h.percentile(50.0), 0U);
+    h.record(7);
+    DIS_CHECK_EQUAL(h.percentile(0.0), 7U);
+    DIS_CHECK_EQUAL(h.percentile(100.0), 7U);
+}
+
+}  // namespace
+
+int main() {
+    percentiles_of_ten_samples();
+    rank_rounds_up();
+    percentile_is_never_too_small();
+    single_sample_and_empty();
+    return dis::test::result();
+}
@@ -0,0 +1,55 @@
+// Two threads log at the same time into the dis::log ring, the dump is
+// written to the file given as argument and decoded by log_test.py with
+// tools/log_decode and this executable as ELF file.  The statements fit
+// into the ring, so nothing gets overwritten.
+
+#include "dis/osal/log/log.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <latch>
+#include <span>
+#include <thread>
+
+namespace {
+
+constexpr unsigned messages = 50;
+
+// two slots per message, one per start
+static_assert(2 * (1 + 2 * messages) <= dis::log::slot_capacity);
+
+void log_thread(unsigned thread, std::latch& go) {
+    go.arrive_and_wait();
+    DIS_LOG_WARN("thread {} start", thread);
+    for (unsigned i = 0; i < messages; ++i) {
+        DIS_LOG_INFO("thread {} message {} of {} {:x}", thread, i, messages,
+                     0xC0DE0000U + i);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s log.bin\n", argv[0]);
+        return 1;
+    }
+
+    std::latch go{2};
+    std::thread first(log_thread, 0U, std::ref(go));
+    std::thread second(log_thread, 1U, std::ref(go));
+    first.join();
+    second.join();
+
+    dis::log::stop();
+    const std::span<const std::byte> dump = dis::log::dump();
+    std::FILE* file = std::fopen(argv[1], "wb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "can not open %s\n", argv[1]);
+        return 1;
+    }
+    const bool written =
+        std::fwrite(dump.data(), 1, dump.size(), file) == dump.size();
+    return std::fclose(file) == 0 && written ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Runs tests/log_test.cpp, decodes its dump with tools/log_decode and checks
+that every statement of both threads arrived whole and in order:
+
+    log_test.py LOG_TEST LOG_DECODE
+"""
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+MESSAGES = 50
+
+
+def main():
+    exe, decoder = sys.argv[1:]
+    with tempfile.TemporaryDirectory() as directory:
+        dump = os.path.join(directory, "log.bin")
+        subprocess.run([exe, dump], check=True, timeout=60)
+        result = subprocess.run([decoder, exe, dump], capture_output=True,
+                                timeout=60)
+    sys.stderr.write(result.stderr.decode(errors="replace"))
+    if result.returncode != 0:
+        sys.exit("log_decode exited with {}".format(result.returncode))
+
+    started = set()
+    received = {0: [], 1: []}
+    for line in result.stdout.decode(errors="replace").splitlines():
+        match = re.search(r"\] WARN  \S+:\d+: thread (\d) start$", line)
+        if match:
+            started.add(int(match.group(1)))
+            continue
+        match = re.search(r"\] INFO  \S+:\d+: "
+                          r"thread (\d) message (\d+) of (\d+) ([0-9a-f]+)$",
+                          line)
+        if not match:
+            sys.exit("unexpected line: " + line)
+        thread, index, total, tag = match.groups()
+        if int(total) != MESSAGES or int(tag, 16) != 0xC0DE0000 + int(index):
+            sys.exit("garbled arguments: " + line)
+        if int(thread) not in started:
+            sys.exit("message before the start: " + line)
+        received[int(thread)].append(int(index))
+
+    if started != {0, 1}:
+        sys.exit("started threads: {}".format(sorted(started)))
+    for thread, indices in received.items():
+        if indices != list(range(MESSAGES)):
+            sys.exit("thread {} logged {}".format(thread, indices))
+
+
+if __name__ == "__main__":
+    main()
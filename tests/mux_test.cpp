@@ -0,0 +1,153 @@
+// dis::io::mux::multiplexer over dis::vcom on the simulated USB bus, run by
+// mux_test.py, which splits stdout with tools/vcom_demux and checks the
+// channels.  Channels 0 and 1 carry frames of `frame_of`, channel 2 the
+// `pattern` byte stream written through its sink in pieces larger than a
+// frame.  The producers retry whatever a full queue did not take, so every
+// channel has to arrive complete.  The messages go to stderr.
+
+#include "check.hpp"
+
+#include "dis/osal/io/mux/multiplexer.hpp"
+#include "dis/osal/io/vcom.hpp"
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+
+namespace {
+
+using usb_port = dis::vcom<256, 256>;
+using mux_type = dis::io::mux::multiplexer<usb_port, 3, 1024>;
+
+constexpr UBaseType_t usb_priority  = tskIDLE_PRIORITY + 4;
+constexpr UBaseType_t mux_priority  = tskIDLE_PRIORITY + 3;
+constexpr UBaseType_t test_priority = tskIDLE_PRIORITY + 2;
+constexpr std::uint16_t frame_count = 300;
+constexpr std::size_t stream_pieces = 40;
+constexpr std::size_t stream_piece  = 600;
+static_assert(stream_piece > mux_type::max_payload);
+
+mux_type s_mux{{{
+    {.priority = 1, .weight = 1},
+    {.priority = 0, .weight = 3},
+    {.priority = 0, .weight = 1},
+}}};
+
+TaskHandle_t s_main_handle = nullptr;
+
+/// payload of frame `sequence` of `channel`, see mux_test.py
+std::size_t frame_of(std::size_t channel,
+                     std::uint16_t sequence,
+                     std::span<std::byte> out) {
+    const std::size_t size =
+        1 + (sequence * 37U + channel * 11U) % mux_type::max_payload;
+    for (std::size_t i = 0; i < size; ++i) {
+        out[i] = static_cast<std::byte>((channel * 31U + sequence + i) & 0xFFU);
+    }
+    return size;
+}
+
+[[nodiscard]] std::byte pattern(std::size_t offset) noexcept {
+    return static_cast<std::byte>((offset + (offset >> 8U)) & 0xFFU);
+}
+
+void frame_task(void* arg) {
+    const auto channel = reinterpret_cast<std::uintptr_t>(arg);
+    std::array<std::byte, mux_type::max_payload + 1> frame{};
+    std::uint32_t retries = 0;
+    for (std::uint16_t sequence = 0; sequence < frame_count; ++sequence) {
+        const std::size_t size = frame_of(channel, sequence, frame);
+        // a frame larger than the payload limit is refused, not split
+        if (sequence == 0) {
+            DIS_CHECK_EQUAL(dis::io::transmit(s_mux.channel(channel), frame),
+                            std::size_t{0});
+        }
+        while (dis::io::transmit(s_mux.channel(channel),
+                                 std::span{frame.data(), size}) != size) {
+            ++retries;
+            vTaskDelay(1);
+        }
+    }
+    std::fprintf(stderr, "channel=%u retries=%" PRIu32 "\n",
+                 static_cast<unsigned>(channel), retries);
+    xTaskNotifyGive(s_main_handle);
+    vTaskDelete(nullptr);
+}
+
+void stream_task(void*) {
+    const dis::io::sink device = s_mux.channel(2).get_sink();
+    std::array<char, stream_piece> piece{};
+    std::size_t offset = 0;
+    for (std::size_t n = 0; n < stream_pieces; ++n) {
+        for (std::size_t i = 0; i < piece.size(); ++i) {
+            piece[i] = static_cast<char>(pattern(offset + i));
+        }
+        std::size_t written = 0;
+        while (written < piece.size()) {
+            written += device.write(device.context, piece.data() + written,
+                                    piece.size() - written);
+            if (written < piece.size()) {
+                vTaskDelay(1);
+            }
+        }
+        offset += piece.size();
+    }
+    xTaskNotifyGive(s_main_handle);
+    vTaskDelete(nullptr);
+}
+
+void main_task(void*) {
+    s_main_handle = xTaskGetCurrentTaskHandle();
+    s_mux.start(mux_priority);
+    for (std::uintptr_t channel = 0; channel < 2; ++channel) {
+        assert_param(xTaskCreate(frame_task, "frames",
+                                 configMINIMAL_STACK_SIZE * 4,
+                                 reinterpret_cast<void*>(channel),
+                                 test_priority, nullptr) == pdPASS);
+    }
+    assert_param(xTaskCreate(stream_task, "stream",
+                             configMINIMAL_STACK_SIZE * 4, nullptr,
+                             test_priority, nullptr) == pdPASS);
+    for (int done = 0; done < 3; ++done) {
+        (void)ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    }
+
+    // time for the pump and the bus to move the rest
+    vTaskDelay(pdMS_TO_TICKS(200));
+    for (std::size_t channel = 0; channel < 3; ++channel) {
+        const dis::io::mux::channel_stats stats = s_mux.stats(channel);
+        std::fprintf(stderr,
+                     "channel=%zu frames=%" PRIu32 " bytes=%" PRIu32
+                     " dropped=%" PRIu32 "\n",
+                     channel, stats.frames, stats.bytes, stats.dropped);
+    }
+    DIS_CHECK_EQUAL(s_mux.stats(0).frames, std::uint32_t{frame_count});
+    DIS_CHECK_EQUAL(s_mux.stats(1).frames, std::uint32_t{frame_count});
+    DIS_CHECK_EQUAL(s_mux.stats(2).bytes,
+                    std::uint32_t{stream_pieces * stream_piece});
+    std::fprintf(stderr, "frames=%u stream=%zu\n",
+                 static_cast<unsigned>(frame_count),
+                 stream_pieces * stream_piece);
+    std::exit(dis::test::result());
+}
+
+}  // namespace
+
+int main() {
+    HWInit();
+    usb_port::init(usb_priority);
+    assert_param(xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE * 4,
+                             nullptr, test_priority + 1, nullptr) == pdPASS);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""Runs tests/mux_test.cpp, splits its output with tools/vcom_demux and
+checks the data of every channel."""
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+# mux_type::max_payload, a 256 byte transfer less the frame header
+MAX_PAYLOAD = 248
+
+
+def frame_of(channel, sequence):
+    size = 1 + (sequence * 37 + channel * 11) % MAX_PAYLOAD
+    return bytes((channel * 31 + sequence + i) & 0xFF for i in range(size))
+
+
+def pattern(size):
+    return bytes(((i + (i >> 8)) & 0xFF) for i in range(size))
+
+
+def main():
+    exe, demux = sys.argv[1:3]
+    result = subprocess.run([exe], capture_output=True, timeout=60)
+    err = result.stderr.decode(errors="replace")
+    sys.stderr.write(err)
+    if result.returncode != 0:
+        sys.exit("mux_test exited with {}".format(result.returncode))
+    frames, stream = map(int, re.search(r"frames=(\d+) stream=(\d+)",
+                                        err).groups())
+
+    with tempfile.TemporaryDirectory() as tmp:
+        prefix = os.path.join(tmp, "channel")
+        split = subprocess.run([demux, "--prefix", prefix, "--max-payload",
+                                str(MAX_PAYLOAD)], input=result.stdout,
+                               capture_output=True, timeout=60)
+        report = split.stderr.decode(errors="replace")
+        sys.stderr.write(report)
+        if split.returncode != 0:
+            sys.exit("vcom_demux exited with {}".format(split.returncode))
+        if "skipped=0 bad_checks=0" not in report:
+            sys.exit("the link carried garbage")
+        for lost in re.findall(r"lost=(\d+)", report):
+            if int(lost) != 0:
+                sys.exit("frames lost on the link")
+
+        expected = {
+            0: b"".join(frame_of(0, seq) for seq in range(frames)),
+            1: b"".join(frame_of(1, seq) for seq in range(frames)),
+            2: pattern(stream),
+        }
+        for channel, data in expected.items():
+            with open("{}{}.bin".format(prefix, channel), "rb") as file:
+                if file.read() != data:
+                    sys.exit("channel {} differs".format(channel))
+
+
+if __name__ == "__main__":
+    main()
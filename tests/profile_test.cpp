@@ -0,0 +1,116 @@
+// DIS_PROFILE_SCOPE and DIS_PROFILE_COUNTER built with DIS_PROFILE_LEVEL 2,
+// the sites are found through dis::stats::profile_sites() like the firmware
+// does it.
+
+#include "check.hpp"
+
+#include "dis/osal/stats/profile.hpp"
+
+#include <time.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+using dis::stats::profile_kind;
+using dis::stats::profile_site;
+
+static_assert(DIS_PROFILE_LEVEL == 2, "built with the wrong level");
+
+profile_site* find(const char* name) noexcept {
+    for (profile_site& site : dis::stats::profile_sites()) {
+        if (std::strcmp(site.name, name) == 0) {
+            return &site;
+        }
+    }
+    return nullptr;
+}
+
+void count(std::uint32_t value) noexcept {
+    DIS_PROFILE_COUNTER("test_counter", value, dis::stats::profile_level<2>{});
+    // above the level, never recorded
+    DIS_PROFILE_COUNTER("test_level_3", value, dis::stats::profile_level<3>{});
+}
+
+void sleep_for(long nanoseconds) noexcept {
+    DIS_PROFILE_SCOPE("test_scope");
+    timespec duration{0, nanoseconds};
+    while (nanosleep(&duration, &duration) != 0) {
+    }
+}
+
+void counter() {
+    for (std::uint32_t value : {0U, 1U, 5U, 6U, 7U, 1000U, 0xFFFFFFFFU}) {
+        count(value);
+    }
+
+    const profile_site* site = find("test_counter");
+    DIS_CHECK(site != nullptr);
+    // only an unoptimized build keeps the unused site
+    const profile_site* above = find("test_level_3");
+    DIS_CHECK(above == nullptr || above->count == 0);
+    if (site == nullptr) {
+        return;
+    }
+    DIS_CHECK(site->kind == profile_kind::counter);
+    DIS_CHECK_EQUAL(site->count, 7U);
+    DIS_CHECK_EQUAL(site->min, 0U);
+    DIS_CHECK_EQUAL(site->max, 0xFFFFFFFFU);
+    DIS_CHECK_EQUAL(site->sum, std::uint64_t{0xFFFFFFFFU} + 1019U);
+    DIS_CHECK_EQUAL(site->mean(), static_cast<std::uint32_t>(
+                                      (std::uint64_t{0xFFFFFFFFU} + 1019U) / 7));
+
+    // bucket i takes the samples with bit_width i, the last one the rest
+    std::uint32_t total = 0;
+    for (std::size_t bucket = 0; bucket < profile_site::bucket_count;
+         ++bucket) {
+        total += site->histogram[bucket];
+    }
+    DIS_CHECK_EQUAL(total, 7U);
+    DIS_CHECK_EQUAL(site->histogram[0], 1U);
+    DIS_CHECK_EQUAL(site->histogram[1], 1U);
+    DIS_CHECK_EQUAL(site->histogram[3], 3U);
+    DIS_CHECK_EQUAL(site->histogram[10], 1U);
+    DIS_CHECK_EQUAL(site->histogram[profile_site::bucket_count - 1], 1U);
+
+    dis::stats::profile_reset();
+    DIS_CHECK_EQUAL(site->count, 0U);
+    DIS_CHECK_EQUAL(site->sum, std::uint64_t{0});
+    DIS_CHECK_EQUAL(site->max, 0U);
+    DIS_CHECK_EQUAL(site->histogram[3], 0U);
+    DIS_CHECK_EQUAL(site->mean(), 0U);
+}
+
+void scope() {
+    // the host counts nanoseconds as cycles
+    constexpr long short_sleep = 1000000;
+    constexpr long long_sleep  = 4000000;
+    sleep_for(short_sleep);
+    sleep_for(long_sleep);
+
+    const profile_site* site = find("test_scope");
+    DIS_CHECK(site != nullptr);
+    if (site == nullptr) {
+        return;
+    }
+    DIS_CHECK(site->kind == profile_kind::scope);
+    DIS_CHECK_EQUAL(site->count, 2U);
+    DIS_CHECK(site->min >= short_sleep);
+    DIS_CHECK(site->min < long_sleep);
+    DIS_CHECK(site->max >= long_sleep);
+    // generous, the test machine may be busy
+    DIS_CHECK(site->max < 100 * long_sleep);
+    DIS_CHECK_EQUAL(site->mean(),
+                    static_cast<std::uint32_t>(site->sum / site->count));
+    DIS_CHECK(site->histogram[std::bit_width(site->min)] > 0);
+    DIS_CHECK(site->histogram[std::bit_width(site->max)] > 0);
+}
+
+}  // namespace
+
+int main() {
+    counter();
+    scope();
+    return dis::test::result();
+}
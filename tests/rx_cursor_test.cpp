@@ -0,0 +1,122 @@
+// Chunking of dis::uart::rx_cursor against a simulated circular DMA stream,
+// whose counter (NDTR) reads either 0 or the ring size right at the wrap.
+
+#include "check.hpp"
+
+#include "dis/osal/io/uart/rx_cursor.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using dis::uart::rx_cursor;
+using dis::uart::rx_ranges;
+
+constexpr std::size_t ring_size = 64;
+
+void single_parts() {
+    rx_cursor cursor{ring_size};
+    DIS_CHECK(cursor.advance(ring_size).empty());
+
+    rx_ranges ranges = cursor.advance(ring_size - 10);
+    DIS_CHECK_EQUAL(ranges.first.offset, std::size_t{0});
+    DIS_CHECK_EQUAL(ranges.first.size, std::size_t{10});
+    DIS_CHECK_EQUAL(ranges.second.size, std::size_t{0});
+
+    // nothing new
+    DIS_CHECK(cursor.advance(ring_size - 10).empty());
+
+    // up to the end of the ring, the counter reads 0 before the reload
+    ranges = cursor.advance(0);
+    DIS_CHECK_EQUAL(ranges.first.offset, std::size_t{10});
+    DIS_CHECK_EQUAL(ranges.first.size, ring_size - 10);
+    DIS_CHECK_EQUAL(ranges.second.size, std::size_t{0});
+    DIS_CHECK_EQUAL(cursor.position(), std::size_t{0});
+
+    // and the reloaded counter is the same position
+    DIS_CHECK(cursor.advance(ring_size).empty());
+}
+
+void wrapping_parts() {
+    rx_cursor cursor{ring_size};
+    (void)cursor.advance(ring_size - 50);
+
+    // from 50 over the end to 6
+    rx_ranges ranges = cursor.advance(ring_size - 6);
+    DIS_CHECK_EQUAL(ranges.first.offset, std::size_t{50});
+    DIS_CHECK_EQUAL(ranges.first.size, std::size_t{14});
+    DIS_CHECK_EQUAL(ranges.second.offset, std::size_t{0});
+    DIS_CHECK_EQUAL(ranges.second.size, std::size_t{6});
+    DIS_CHECK_EQUAL(ranges.size(), std::size_t{20});
+
+    // a restarted stream begins at the start of the ring again
+    cursor.reset();
+    ranges = cursor.advance(ring_size - 3);
+    DIS_CHECK_EQUAL(ranges.first.offset, std::size_t{0});
+    DIS_CHECK_EQUAL(ranges.first.size, std::size_t{3});
+}
+
+void whole_ring_is_invisible() {
+    // documented limit: a writer a whole lap ahead shows no data at all
+    rx_cursor cursor{ring_size};
+    (void)cursor.advance(ring_size - 20);
+    DIS_CHECK(cursor.advance(ring_size - 20).empty());
+}
+
+/// DMA writing `stream` into the ring, the reader polls at random points
+void simulated_stream() {
+    std::array<std::uint8_t, ring_size> ring{};
+    std::vector<std::uint8_t> sent;
+    std::vector<std::uint8_t> received;
+    rx_cursor cursor{ring_size};
+
+    std::uint32_t random = 7;
+    std::size_t written  = 0;
+    for (int poll = 0; poll < 20000; ++poll) {
+        random = random * 1664525U + 1013904223U;
+        // up to a byte less than the ring between two polls, often exactly
+        // up to the end of the ring
+        std::size_t burst = (random >> 16U) % ring_size;
+        if ((random & 3U) == 0) {
+            burst = ring_size - written % ring_size;
+            burst = burst == ring_size ? 0 : burst;
+        }
+        for (std::size_t i = 0; i < burst; ++i) {
+            const auto value = static_cast<std::uint8_t>(written * 7 + 3);
+            ring[written % ring_size] = value;
+            sent.push_back(value);
+            ++written;
+        }
+
+        // right at the wrap the counter reads either 0 or the full size
+        std::size_t remaining = ring_size - written % ring_size;
+        if (remaining == ring_size && (random & 0x100U) != 0) {
+            remaining = 0;
+        }
+
+        const rx_ranges ranges = cursor.advance(remaining);
+        DIS_CHECK_EQUAL(ranges.size(), burst);
+        DIS_CHECK(ranges.first.offset + ranges.first.size <= ring_size);
+        DIS_CHECK(ranges.second.size == 0 || ranges.second.offset == 0);
+        for (const auto& range : {ranges.first, ranges.second}) {
+            for (std::size_t i = 0; i < range.size; ++i) {
+                received.push_back(ring[range.offset + i]);
+            }
+        }
+        DIS_CHECK_EQUAL(cursor.position(), written % ring_size);
+    }
+    DIS_CHECK(received == sent);
+}
+
+}  // namespace
+
+int main() {
+    single_parts();
+    wrapping_parts();
+    whole_ring_is_invisible();
+    simulated_stream();
+    return dis::test::result();
+}
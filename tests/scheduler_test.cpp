@@ -0,0 +1,116 @@
+// Channel selection of dis::io::mux::scheduler: strict priority between the
+// levels, weighted shares within a level and no credit for idle channels.
+
+#include "check.hpp"
+
+#include "dis/osal/io/mux/scheduler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace {
+
+using dis::io::mux::scheduler;
+
+/// backlogged channels with frames of a fixed size, 0 for an idle one
+template <std::size_t CHANNELS_V>
+struct link_model {
+    scheduler<CHANNELS_V> sched;
+    std::array<std::size_t, CHANNELS_V> frame{};
+    std::array<std::uint64_t, CHANNELS_V> bytes{};
+
+    std::optional<std::size_t> step() {
+        const auto next =
+            sched.next([this](std::size_t channel) { return frame[channel]; });
+        if (next) {
+            sched.sent(*next, frame[*next]);
+            bytes[*next] += frame[*next];
+        }
+        return next;
+    }
+};
+
+void nothing_to_send() {
+    link_model<2> l{scheduler<2>{{{{0, 1}, {1, 1}}}, 512}};
+    DIS_CHECK(!l.step().has_value());
+}
+
+void strict_priority() {
+    // the order of the channels does not matter, only the priority
+    link_model<3> l{scheduler<3>{{{{0, 1}, {2, 1}, {1, 5}}}, 512}};
+    l.frame = {100, 100, 100};
+    for (int i = 0; i < 100; ++i) {
+        DIS_CHECK_EQUAL(l.step().value_or(9), std::size_t{1});
+    }
+    l.frame[1] = 0;
+    for (int i = 0; i < 100; ++i) {
+        DIS_CHECK_EQUAL(l.step().value_or(9), std::size_t{2});
+    }
+    // a higher level preempts in the middle of the round of a lower one
+    l.frame[1] = 100;
+    DIS_CHECK_EQUAL(l.step().value_or(9), std::size_t{1});
+    l.frame = {100, 0, 0};
+    DIS_CHECK_EQUAL(l.step().value_or(9), std::size_t{0});
+}
+
+void weights_share_the_level() {
+    // different frame sizes, even larger than the quantum, do not matter
+    link_model<3> l{scheduler<3>{{{{0, 1}, {0, 2}, {0, 4}}}, 512}};
+    l.frame = {64, 300, 1000};
+    for (int i = 0; i < 20000; ++i) {
+        (void)l.step();
+    }
+    const double total = static_cast<double>(l.bytes[0] + l.bytes[1] +
+                                             l.bytes[2]);
+    const std::array<double, 3> share{1.0 / 7, 2.0 / 7, 4.0 / 7};
+    for (std::size_t channel = 0; channel < 3; ++channel) {
+        const double actual = static_cast<double>(l.bytes[channel]) / total;
+        const double error  = actual - share[channel];
+        DIS_CHECK(error > -0.01 && error < 0.01);
+    }
+
+    // equal weights get equal bytes, not equal frames
+    link_model<2> even{scheduler<2>{{{{0, 1}, {0, 1}}}, 256}};
+    even.frame = {1500, 100};
+    for (int i = 0; i < 10000; ++i) {
+        (void)even.step();
+    }
+    const double ratio = static_cast<double>(even.bytes[0]) /
+                         static_cast<double>(even.bytes[1]);
+    DIS_CHECK(ratio > 0.99 && ratio < 1.01);
+}
+
+void idle_channels_save_no_credit() {
+    link_model<2> l{scheduler<2>{{{{0, 1}, {0, 1}}}, 500}};
+    l.frame = {0, 100};
+    for (int i = 0; i < 1000; ++i) {
+        DIS_CHECK_EQUAL(l.step().value_or(9), std::size_t{1});
+    }
+
+    // back from idle channel 0 gets one quantum per round like channel 1,
+    // not the rounds it missed
+    l.frame[0]       = 100;
+    std::size_t run  = 0;
+    std::size_t most = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (l.step().value_or(9) == 0) {
+            most = std::max(most, ++run);
+        } else {
+            run = 0;
+        }
+    }
+    DIS_CHECK(most <= 500 / 100);
+}
+
+}  // namespace
+
+int main() {
+    nothing_to_send();
+    strict_priority();
+    weights_share_the_level();
+    idle_channels_save_no_credit();
+    return dis::test::result();
+}
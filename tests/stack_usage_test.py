@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Checks of tools/stack_usage.py on a hand written call graph."""
+
+import importlib.util
+import os
+import pathlib
+import sys
+import tempfile
+import unittest
+
+SCRIPT = pathlib.Path(sys.argv.pop(1) if len(sys.argv) > 1 else
+                      pathlib.Path(__file__).parent.parent / "tools" /
+                      "stack_usage.py")
+spec = importlib.util.spec_from_file_location("stack_usage", SCRIPT)
+stack_usage = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(stack_usage)
+
+LISTING = """\
+08000100 <caller>:
+ 8000100:\tbl\t8000200 <callee>
+ 8000104:\tbls.n\t8000300 <other>
+ 8000106:\tblt.w\t8000400 <tail>
+ 800010a:\tblx\t8000500 <veneer>
+ 800010e:\tbeq.n\t8000108 <caller+0x8>
+08000200 <callee>:
+ 8000200:\tbx\tlr
+08000300 <other>:
+ 8000300:\tbx\tlr
+08000400 <tail>:
+ 8000400:\tbx\tlr
+08000500 <veneer>:
+ 8000500:\tbx\tlr
+"""
+
+
+class CallGraph(unittest.TestCase):
+    def test_conditional_branches_are_no_calls(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            listing = pathlib.Path(tmp, "listing.txt")
+            listing.write_text(LISTING)
+            objdump = pathlib.Path(tmp, "objdump")
+            objdump.write_text("#!/bin/sh\ncat '{}'\n".format(listing))
+            os.chmod(objdump, 0o755)
+            calls, tail_calls, _ = stack_usage.read_call_graph(str(objdump),
+                                                               "image.elf")
+        self.assertEqual(calls["caller"], {"callee", "veneer"})
+        self.assertEqual(tail_calls["caller"], {"other", "tail"})
+
+
+class WorstCase(unittest.TestCase):
+    def test_no_result_cached_while_recursion_is_cut(self):
+        # a -> b -> c -> b (recursion) and a -> c: the depth of c seen from
+        # inside b lacks b, it must not be reused for the edge a -> c
+        frames = {"a": 1, "b": 10, "c": 100}
+        calls = {"a": {"b", "c"}, "b": {"c"}, "c": {"b"}}
+        analysis = stack_usage.StackAnalysis(frames, calls, {})
+        self.assertEqual(analysis.worst_case("a"), 111)
+        self.assertEqual(analysis.worst_case("c"), 110)
+        self.assertEqual(analysis.path["a"], ["a", "b", "c"])
+        self.assertEqual(analysis.recursive, {"b", "c"})
+
+    def test_tail_call_does_not_add_the_frame(self):
+        analysis = stack_usage.StackAnalysis({"a": 8, "b": 16}, {},
+                                             {"a": {"b"}})
+        self.assertEqual(analysis.worst_case("a"), 16)
+
+
+class Resolve(unittest.TestCase):
+    calls = {
+        "{anonymous}::tx_task(void*)": set(),
+        "dis::detail::{anonymous}::tx_task(void*)": set(),
+        "TaskA": set(),
+    }
+
+    def test_names(self):
+        self.assertEqual(stack_usage.resolve("TaskA", self.calls), "TaskA")
+        self.assertEqual(stack_usage.resolve("tx_task", self.calls),
+                         "{anonymous}::tx_task(void*)")
+        self.assertEqual(
+            stack_usage.resolve("dis::detail::tx_task", self.calls),
+            "dis::detail::{anonymous}::tx_task(void*)")
+
+    def test_anonymous_namespace_spellings_match(self):
+        self.assertEqual(
+            stack_usage.function_key("void {anonymous}::f(int)"),
+            stack_usage.function_key("(anonymous namespace)::f(int)"))
+
+
+class ExitStatus(unittest.TestCase):
+    """A task stack which is too small has to fail the build."""
+
+    def run_main(self, words, *extra):
+        with tempfile.TemporaryDirectory() as tmp:
+            listing = pathlib.Path(tmp, "listing.txt")
+            listing.write_text("08000100 <task>:\n"
+                               " 8000100:\tbl\t8000200 <callee>\n"
+                               "08000200 <callee>:\n"
+                               " 8000200:\tbx\tlr\n")
+            objdump = pathlib.Path(tmp, "objdump")
+            objdump.write_text("#!/bin/sh\ncat '{}'\n".format(listing))
+            os.chmod(objdump, 0o755)
+            pathlib.Path(tmp, "task.su").write_text(
+                "task.c:1:6:task\t64\tstatic\n"
+                "task.c:9:6:callee\t400\tstatic\n")
+            argv = ["stack_usage.py", "--elf", "image.elf",
+                    "--objdump", str(objdump), "--su-dir", tmp,
+                    "--task", "task={}".format(words),
+                    "--output", str(pathlib.Path(tmp, "image.stack")),
+                    *extra]
+            saved, sys.argv = sys.argv, argv
+            try:
+                return stack_usage.main()
+            finally:
+                sys.argv = saved
+
+    def test_too_small_fails(self):
+        self.assertEqual(self.run_main(64), 1)
+
+    def test_warn_only(self):
+        self.assertEqual(self.run_main(64, "--warn-only"), 0)
+
+    def test_large_enough(self):
+        self.assertEqual(self.run_main(256), 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
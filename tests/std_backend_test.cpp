@@ -0,0 +1,152 @@
+// dis::mutex, dis::counting_semaphore and dis::this_thread over the standard
+// library backend: producers and consumers on std::thread pass numbered
+// items through a bounded ring.  Built with DIS_OSAL_BACKEND_STD and without
+// any FreeRTOS header, run under the sanitizers of the host build.
+
+#include "check.hpp"
+
+#include "dis/osal/thread/mutex.hpp"
+#include "dis/osal/thread/semaphore.hpp"
+#include "dis/osal/thread/thread.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+static_assert(std::is_same_v<dis::default_backend, dis::std_backend>);
+
+constexpr std::size_t ring_size          = 8;
+constexpr std::size_t producers          = 3;
+constexpr std::size_t consumers          = 2;
+constexpr std::uint32_t items_per_thread = 20000;
+
+class ring {
+public:
+    void push(std::uint32_t item) noexcept {
+        m_free.aquire();
+        {
+            std::lock_guard lock{m_lock};
+            m_items[m_head++ % ring_size] = item;
+        }
+        m_used.release();
+    }
+
+    /// false once nothing arrived for a while
+    bool pop(std::uint32_t& item) noexcept {
+        if (!m_used.try_aquire_for(500ms)) {
+            return false;
+        }
+        {
+            std::lock_guard lock{m_lock};
+            item = m_items[m_tail++ % ring_size];
+        }
+        m_free.release();
+        return true;
+    }
+
+private:
+    dis::mutex m_lock;
+    dis::counting_semaphore<ring_size> m_free{ring_size};
+    dis::counting_semaphore<ring_size> m_used{0};
+    std::array<std::uint32_t, ring_size> m_items{};
+    std::size_t m_head{0};
+    std::size_t m_tail{0};
+};
+
+void producer_consumer() {
+    ring items;
+    std::array<std::vector<std::uint32_t>, consumers> received{};
+
+    std::vector<std::thread> threads;
+    for (std::size_t consumer = 0; consumer < consumers; ++consumer) {
+        threads.emplace_back([&items, &list = received[consumer]] {
+            std::uint32_t item = 0;
+            while (items.pop(item)) {
+                list.push_back(item);
+            }
+        });
+    }
+    for (std::size_t producer = 0; producer < producers; ++producer) {
+        threads.emplace_back([&items, producer] {
+            for (std::uint32_t i = 0; i < items_per_thread; ++i) {
+                items.push(static_cast<std::uint32_t>(producer) *
+                               items_per_thread +
+                           i);
+                if (i % 1000 == 0) {
+                    dis::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // every item arrives exactly once, in order per producer and consumer
+    std::vector<std::uint8_t> seen(producers * items_per_thread, 0);
+    for (const std::vector<std::uint32_t>& list : received) {
+        std::array<std::int64_t, producers> last{};
+        last.fill(-1);
+        for (const std::uint32_t item : list) {
+            DIS_CHECK(item < seen.size());
+            if (item >= seen.size()) {
+                continue;
+            }
+            ++seen[item];
+            const std::size_t producer = item / items_per_thread;
+            DIS_CHECK(static_cast<std::int64_t>(item) > last[producer]);
+            last[producer] = item;
+        }
+    }
+    std::size_t once = 0;
+    for (const std::uint8_t count : seen) {
+        once += count == 1 ? 1 : 0;
+    }
+    DIS_CHECK_EQUAL(once, seen.size());
+}
+
+void timeouts() {
+    dis::mutex lock;
+    lock.lock();
+    std::thread other([&lock] {
+        DIS_CHECK(!lock.try_lock());
+        DIS_CHECK(!lock.try_lock_for(10ms));
+    });
+    other.join();
+    lock.unlock();
+    DIS_CHECK(lock.try_lock());
+    lock.unlock();
+
+    dis::binary_semaphore empty{0};
+    const auto start = std::chrono::steady_clock::now();
+    DIS_CHECK(!empty.try_aquire());
+    DIS_CHECK(!empty.try_aquire_for(20ms));
+    DIS_CHECK(std::chrono::steady_clock::now() - start >= 20ms);
+
+    // a give on a full semaphore is lost, like on the kernel
+    dis::binary_semaphore full{1};
+    full.release();
+    DIS_CHECK(full.try_aquire());
+    DIS_CHECK(!full.try_aquire());
+
+    const auto before = std::chrono::steady_clock::now();
+    dis::this_thread::sleep_for(15ms);
+    DIS_CHECK(std::chrono::steady_clock::now() - before >= 15ms);
+}
+
+}  // namespace
+
+int main() {
+    producer_consumer();
+    timeouts();
+    return dis::test::result();
+}
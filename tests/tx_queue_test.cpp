@@ -0,0 +1,242 @@
+// dis::uart::tx_queue in front of a simulated line: the test moves the clock
+// and completes the transfers itself, the line refuses the starts it is
+// told to.
+
+#include "check.hpp"
+
+#include "dis/osal/io/uart/tx_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace {
+
+using dis::uart::tx_descriptor;
+using dis::uart::tx_stats;
+
+struct sim_line {
+    bool start(std::span<const std::byte> data) noexcept {
+        if (refuse != 0) {
+            --refuse;
+            return false;
+        }
+        DIS_CHECK(!in_flight);
+        in_flight = true;
+        started.push_back(data.data());
+        return true;
+    }
+
+    [[nodiscard]] std::uint64_t now() noexcept { return clock; }
+
+    [[nodiscard]] std::uint32_t lock() noexcept {
+        DIS_CHECK(!locked);
+        locked = true;
+        return 0;
+    }
+
+    void unlock(std::uint32_t) noexcept {
+        DIS_CHECK(locked);
+        locked = false;
+    }
+
+    /// number of the next starts to refuse
+    int refuse{0};
+    bool in_flight{false};
+    bool locked{false};
+    std::uint64_t clock{0};
+    std::vector<const std::byte*> started;
+};
+
+static_assert(dis::uart::tx_line<sim_line>);
+
+using queue_type = dis::uart::tx_queue<4, sim_line>;
+
+struct finished {
+    const std::byte* data;
+    bool sent;
+};
+
+struct producer {
+    explicit producer(queue_type& owner) noexcept : queue(&owner) {}
+
+    std::vector<finished> done;
+    queue_type* queue{nullptr};
+    /// data submitted from within the next `done`
+    std::span<const std::byte> refill{};
+};
+
+void on_done(void* context, const tx_descriptor& descriptor,
+             bool sent) noexcept {
+    auto& self = *static_cast<producer*>(context);
+    DIS_CHECK(!self.queue->line().locked);
+    self.done.push_back({descriptor.data.data(), sent});
+    if (!self.refill.empty()) {
+        const std::span<const std::byte> data = self.refill;
+        self.refill                           = {};
+        DIS_CHECK(self.queue->submit({data, &on_done, context}));
+    }
+}
+
+/// the line took the transfer, it ends after `ticks`
+void finish(queue_type& queue, std::uint64_t ticks, bool sent = true) {
+    sim_line& line = queue.line();
+    DIS_CHECK(line.in_flight);
+    line.clock += ticks;
+    line.in_flight = false;
+    queue.complete(sent);
+}
+
+std::array<std::array<std::byte, 100>, 6> s_data{};
+
+[[nodiscard]] std::span<const std::byte> data(std::size_t index,
+                                              std::size_t size = 100) {
+    return std::span{s_data[index]}.first(size);
+}
+
+void back_to_back() {
+    queue_type queue;
+    producer owner{queue};
+    for (std::size_t i = 0; i < 3; ++i) {
+        DIS_CHECK(queue.submit({data(i, 10 * (i + 1)), &on_done, &owner}));
+    }
+    // only the first one goes out, the others follow on its completion
+    DIS_CHECK_EQUAL(queue.line().started.size(), std::size_t{1});
+    DIS_CHECK_EQUAL(queue.depth(), std::size_t{3});
+
+    finish(queue, 10);
+    DIS_CHECK_EQUAL(queue.line().started.size(), std::size_t{2});
+    finish(queue, 10);
+    finish(queue, 10);
+    DIS_CHECK_EQUAL(queue.depth(), std::size_t{0});
+
+    DIS_CHECK_EQUAL(owner.done.size(), std::size_t{3});
+    const std::size_t count =
+        std::min(owner.done.size(), queue.line().started.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        DIS_CHECK(owner.done[i].data == data(i).data());
+        DIS_CHECK(owner.done[i].sent);
+        DIS_CHECK(queue.line().started[i] == data(i).data());
+    }
+
+    // the line idles a quarter of the time
+    queue.line().clock += 10;
+    const tx_stats stats = queue.stats();
+    DIS_CHECK_EQUAL(stats.queued, 3U);
+    DIS_CHECK_EQUAL(stats.sent, 3U);
+    DIS_CHECK_EQUAL(stats.bytes, 60U);
+    DIS_CHECK_EQUAL(stats.failed, 0U);
+    DIS_CHECK_EQUAL(stats.underruns, 1U);
+    DIS_CHECK_EQUAL(stats.depth_max, 3U);
+    DIS_CHECK_EQUAL(stats.busy, std::uint64_t{30});
+    DIS_CHECK_EQUAL(stats.elapsed, std::uint64_t{40});
+    DIS_CHECK_EQUAL(stats.utilization_permille(), 750U);
+}
+
+void refused() {
+    queue_type queue;
+    producer owner{queue};
+    DIS_CHECK(!queue.submit({data(0, 0), &on_done, &owner}));
+    std::vector<std::byte> large(queue_type::max_transfer + 1);
+    DIS_CHECK(!queue.submit({large, &on_done, &owner}));
+    for (std::size_t i = 0; i < 4; ++i) {
+        DIS_CHECK(queue.submit({data(i), &on_done, &owner}));
+    }
+    DIS_CHECK(!queue.submit({data(4), &on_done, &owner}));
+
+    // `done` is only called for the queued ones
+    DIS_CHECK(owner.done.empty());
+    const tx_stats stats = queue.stats();
+    DIS_CHECK_EQUAL(stats.rejected, 3U);
+    DIS_CHECK_EQUAL(stats.queued, 4U);
+    DIS_CHECK_EQUAL(stats.depth_max, 4U);
+}
+
+void failed_starts() {
+    queue_type queue;
+    producer owner{queue};
+
+    // an idle line refusing the start fails the descriptor within submit
+    queue.line().refuse = 1;
+    DIS_CHECK(queue.submit({data(0), &on_done, &owner}));
+    DIS_CHECK_EQUAL(owner.done.size(), std::size_t{1});
+    DIS_CHECK(!owner.done.empty() && !owner.done[0].sent);
+    DIS_CHECK_EQUAL(queue.depth(), std::size_t{0});
+
+    // the completion skips every descriptor the line refuses, up to one it
+    // takes
+    for (std::size_t i = 1; i < 5; ++i) {
+        DIS_CHECK(queue.submit({data(i), &on_done, &owner}));
+    }
+    queue.line().refuse = 2;
+    finish(queue, 5);
+    DIS_CHECK_EQUAL(owner.done.size(), std::size_t{4});
+    if (owner.done.size() == 4) {
+        DIS_CHECK(owner.done[1].data == data(1).data() && owner.done[1].sent);
+        DIS_CHECK(owner.done[2].data == data(2).data() && !owner.done[2].sent);
+        DIS_CHECK(owner.done[3].data == data(3).data() && !owner.done[3].sent);
+    }
+    DIS_CHECK_EQUAL(queue.depth(), std::size_t{1});
+    DIS_CHECK(queue.line().started.back() == data(4).data());
+
+    // an aborted transfer, then a refused start, empties the queue
+    DIS_CHECK(queue.submit({data(5), &on_done, &owner}));
+    queue.line().refuse = 1;
+    finish(queue, 5, false);
+    DIS_CHECK_EQUAL(owner.done.size(), std::size_t{6});
+    if (owner.done.size() == 6) {
+        DIS_CHECK(!owner.done[4].sent && !owner.done[5].sent);
+    }
+    DIS_CHECK_EQUAL(queue.depth(), std::size_t{0});
+    DIS_CHECK(!queue.line().in_flight);
+
+    const tx_stats stats = queue.stats();
+    DIS_CHECK_EQUAL(stats.sent, 1U);
+    DIS_CHECK_EQUAL(stats.failed, 5U);
+    DIS_CHECK_EQUAL(stats.underruns, 2U);
+    DIS_CHECK_EQUAL(stats.busy, std::uint64_t{10});
+}
+
+void refill_from_done() {
+    // a producer queueing its next buffer from `done` keeps the line busy
+    queue_type queue;
+    producer owner{queue};
+    DIS_CHECK(queue.submit({data(0), &on_done, &owner}));
+    DIS_CHECK(queue.submit({data(1), &on_done, &owner}));
+    for (std::size_t i = 2; i < 6; ++i) {
+        owner.refill = data(i);
+        finish(queue, 10);
+    }
+    DIS_CHECK_EQUAL(queue.depth(), std::size_t{2});
+    finish(queue, 10);
+    finish(queue, 10);
+
+    DIS_CHECK_EQUAL(owner.done.size(), std::size_t{6});
+    DIS_CHECK_EQUAL(queue.line().started.size(), std::size_t{6});
+    for (std::size_t i = 0; i < owner.done.size(); ++i) {
+        DIS_CHECK(owner.done[i].data == data(i).data());
+    }
+    const tx_stats stats = queue.stats();
+    DIS_CHECK_EQUAL(stats.underruns, 1U);
+    DIS_CHECK_EQUAL(stats.utilization_permille(), 1000U);
+
+    // a new interval starts from the current time
+    queue.line().clock += 20;
+    queue.clear_stats();
+    queue.line().clock += 20;
+    DIS_CHECK_EQUAL(queue.stats().elapsed, std::uint64_t{20});
+    DIS_CHECK_EQUAL(queue.stats().utilization_permille(), 0U);
+}
+
+}  // namespace
+
+int main() {
+    back_to_back();
+    refused();
+    failed_starts();
+    refill_from_done();
+    return dis::test::result();
+}
@@ -0,0 +1,290 @@
+// dis::vcom on the simulated USB bus of the host build (see
+// host/bsp/usbd_conf_sim.c), stdin and stdout are the host end of the
+// virtual com port.  Run by vcom_test.py, which feeds and checks the data:
+//   zlp  sends transfers which are a multiple of the packet size, the bus
+//        aborts if one of them is not ended by a zero length packet
+//   nak  reads slower than the host sends, the OUT endpoint has to pause
+//        (NAK) instead of dropping data
+//   frame  frames are queued whole or not at all, also when they are too
+//        large or the deadline passes while the buffers are full
+//   stress  producers of three priorities send records while a busy task
+//        preempts the low ones, the records must arrive whole and the high
+//        priority producer must not wait for a preempted one
+// The messages go to stderr, stdout carries the USB data.
+
+#include "check.hpp"
+
+#include "dis/osal/io/vcom.hpp"
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <Nucleo_F767ZI_Init.h>
+#include <stm32f7xx_hal.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <string_view>
+
+namespace {
+
+// four packets per transfer, so full buffers need a zero length packet
+using usb_port = dis::vcom<256, 256>;
+
+constexpr UBaseType_t usb_priority  = tskIDLE_PRIORITY + 4;
+constexpr UBaseType_t test_priority = tskIDLE_PRIORITY + 2;
+
+/// the data stream of all tests, not periodic within 256 bytes
+[[nodiscard]] std::byte pattern(std::size_t offset) noexcept {
+    return static_cast<std::byte>((offset + (offset >> 8U)) & 0xFFU);
+}
+
+std::size_t s_offset = 0;
+
+void send(std::size_t size) {
+    static std::array<std::byte, 4 * usb_port::tx_bytes> frame{};
+    for (std::size_t i = 0; i < size; ++i) {
+        frame[i] = pattern(s_offset + i);
+    }
+    usb_port port;
+    const std::size_t sent =
+        dis::io::transmit(port, std::span{frame.data(), size});
+    DIS_CHECK_EQUAL(sent, size);
+    s_offset += size;
+}
+
+[[noreturn]] void finish() {
+    // time for the bus to move the rest, it takes 19 packets per ms
+    vTaskDelay(pdMS_TO_TICKS(100));
+    std::fprintf(stderr, "total=%zu\n", s_offset);
+    std::exit(dis::test::result());
+}
+
+void zlp_task(void*) {
+    // single transfers, each one sent on its own
+    for (const std::size_t size : {64U, 128U, 1U, 192U, 256U, 63U, 64U}) {
+        send(size);
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    // full buffers back to back, chained by the transfer complete interrupt
+    for (int i = 0; i < 16; ++i) {
+        send(usb_port::tx_bytes);
+    }
+    vTaskDelay(pdMS_TO_TICKS(20));
+    // the next transfer starts only after the zero length packet
+    send(1);
+    finish();
+}
+
+void frame_task(void*) {
+    static std::array<std::byte, usb_port::tx_bytes + 1> frame{};
+    usb_port port;
+    DIS_CHECK_EQUAL(dis::io::transmit(port, frame), std::size_t{0});
+
+    // back to back with a deadline which already passed, the bus takes
+    // 0.2ms for a buffer, so the ring runs full and frames get rejected
+    constexpr std::array<std::size_t, 4> sizes{usb_port::tx_bytes, 100, 200,
+                                               1};
+    std::size_t rejected = 0;
+    for (std::size_t i = 0; i < 64; ++i) {
+        const std::size_t size = sizes[i % sizes.size()];
+        for (std::size_t j = 0; j < size; ++j) {
+            frame[j] = pattern(s_offset + j);
+        }
+        const std::size_t sent = dis::io::transmit(
+            port, std::span{frame.data(), size},
+            dis::io::deadline::at(xTaskGetTickCount()));
+        if (sent == 0) {
+            ++rejected;
+        } else {
+            DIS_CHECK_EQUAL(sent, size);
+            s_offset += size;
+        }
+    }
+    std::fprintf(stderr, "rejected=%zu\n", rejected);
+    DIS_CHECK(rejected > 0);
+    finish();
+}
+
+std::size_t s_nak_size = 0;
+
+void nak_task(void*) {
+    std::size_t received = 0;
+    std::size_t mismatch = 0;
+    while (received < s_nak_size) {
+        std::array<std::byte, 48> chunk{};
+        const std::size_t size = usb_port::receive(
+            chunk, dis::io::deadline::after(std::chrono::seconds(5)));
+        if (size == 0) {
+            break;
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            mismatch += chunk[i] != pattern(received + i) ? 1 : 0;
+        }
+        received += size;
+        // a 256 byte buffer fills up in well below a ms on the bus
+        if (received % 1024 < chunk.size()) {
+            vTaskDelay(pdMS_TO_TICKS(3));
+        }
+    }
+
+    const dis::vcom_rx_stats stats = usb_port::rx_stats();
+    std::fprintf(stderr,
+                 "received=%zu bytes=%" PRIu32 " dropped=%" PRIu32
+                 " pauses=%" PRIu32 " nak_ticks=%" PRIu32 "\n",
+                 received, stats.bytes, stats.dropped, stats.pauses,
+                 stats.nak_ticks);
+    DIS_CHECK_EQUAL(received, s_nak_size);
+    DIS_CHECK_EQUAL(mismatch, std::size_t{0});
+    DIS_CHECK_EQUAL(stats.bytes, s_nak_size);
+    DIS_CHECK_EQUAL(stats.dropped, 0U);
+    DIS_CHECK(stats.pauses > 0);
+    DIS_CHECK(stats.nak_ticks > 0);
+    finish();
+}
+
+// stress: records of `magic, producer, sequence (16 bit little endian),
+// size (8 bit), payload, sum of the payload`, see vcom_test.py
+constexpr std::uint8_t record_magic          = 0xA5;
+constexpr std::size_t low_producers          = 6;
+constexpr std::size_t high_producers         = 2;
+constexpr std::uint16_t records_per_producer = 200;
+constexpr UBaseType_t low_priority           = tskIDLE_PRIORITY + 1;
+constexpr UBaseType_t busy_priority          = tskIDLE_PRIORITY + 2;
+constexpr UBaseType_t high_priority          = tskIDLE_PRIORITY + 3;
+// the busy task runs for 30ms at a time, a full buffer takes about 0.2ms on
+// the bus
+constexpr TickType_t busy_time     = pdMS_TO_TICKS(30);
+constexpr TickType_t max_high_wait = pdMS_TO_TICKS(15);
+
+TaskHandle_t s_stress_handle = nullptr;
+volatile bool s_stress_done  = false;
+std::array<TickType_t, high_producers> s_high_wait{};
+
+void producer_task(void* arg) {
+    const auto id =
+        static_cast<std::uint8_t>(reinterpret_cast<std::uintptr_t>(arg));
+    std::uint32_t random = 0x9E3779B9U * (id + 1U);
+    std::array<std::byte, 5 + 255 + 1> record{};
+    usb_port port;
+    for (std::uint16_t seq = 0; seq < records_per_producer; ++seq) {
+        random = random * 1664525U + 1013904223U;
+        const auto size = static_cast<std::uint8_t>(1 + (random >> 24U) % 200U);
+        record[0]       = std::byte{record_magic};
+        record[1]       = std::byte{id};
+        record[2]       = static_cast<std::byte>(seq & 0xFFU);
+        record[3]       = static_cast<std::byte>(seq >> 8U);
+        record[4]       = std::byte{size};
+        std::uint8_t sum = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto value = static_cast<std::uint8_t>(id + seq + i);
+            record[5 + i]    = std::byte{value};
+            sum              = static_cast<std::uint8_t>(sum + value);
+        }
+        record[5U + size] = std::byte{sum};
+
+        const TickType_t start = xTaskGetTickCount();
+        if (id < low_producers && (seq & 1U) != 0) {
+            // a slow writer in place, the busy task gets ready meanwhile but
+            // does not preempt it
+            std::byte* reserved = usb_port::reserve(6U + size);
+            DIS_CHECK(reserved != nullptr);
+            if (reserved != nullptr) {
+                std::copy_n(record.data(), 6U + size, reserved);
+                const auto until = std::chrono::steady_clock::now() +
+                                   std::chrono::microseconds(500);
+                while (std::chrono::steady_clock::now() < until) {
+                }
+                usb_port::commit(reserved);
+            }
+        } else {
+            const std::size_t sent =
+                dis::io::transmit(port, std::span{record.data(), 6U + size});
+            DIS_CHECK_EQUAL(sent, 6U + size);
+        }
+        if (id >= low_producers) {
+            auto& wait = s_high_wait[id - low_producers];
+            wait       = std::max(wait, xTaskGetTickCount() - start);
+            // spread over the whole test
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+    }
+    xTaskNotifyGive(s_stress_handle);
+    vTaskDelete(nullptr);
+}
+
+/// keeps the low priority producers from running, now and then for long
+void busy_task(void*) {
+    std::uint32_t random = 12345;
+    while (!s_stress_done) {
+        random = random * 1664525U + 1013904223U;
+        vTaskDelay(pdMS_TO_TICKS(2) + (random >> 24U) % 8U);
+        const TickType_t until = xTaskGetTickCount() + busy_time;
+        while (xTaskGetTickCount() < until) {
+        }
+    }
+    vTaskDelete(nullptr);
+}
+
+void stress_task(void*) {
+    s_stress_handle = xTaskGetCurrentTaskHandle();
+    for (std::size_t id = 0; id < low_producers + high_producers; ++id) {
+        assert_param(
+            xTaskCreate(producer_task, "producer", configMINIMAL_STACK_SIZE * 4,
+                        reinterpret_cast<void*>(id),
+                        id < low_producers ? low_priority : high_priority,
+                        nullptr) == pdPASS);
+    }
+    assert_param(xTaskCreate(busy_task, "busy", configMINIMAL_STACK_SIZE * 2,
+                             nullptr, busy_priority, nullptr) == pdPASS);
+    for (std::size_t done = 0; done < low_producers + high_producers;
+         ++done) {
+        (void)ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    }
+    s_stress_done = true;
+
+    for (std::size_t i = 0; i < high_producers; ++i) {
+        std::fprintf(stderr, "high_wait_ticks=%" PRIu32 "\n",
+                     static_cast<std::uint32_t>(s_high_wait[i]));
+        DIS_CHECK(s_high_wait[i] <= max_high_wait);
+    }
+    std::fprintf(stderr, "producers=%zu records=%u\n",
+                 low_producers + high_producers,
+                 static_cast<unsigned>(records_per_producer));
+    finish();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::string_view mode = argc > 1 ? argv[1] : "";
+    TaskFunction_t test         = nullptr;
+    if (mode == "zlp") {
+        test = zlp_task;
+    } else if (mode == "frame") {
+        test = frame_task;
+    } else if (mode == "stress") {
+        test = stress_task;
+    } else if (mode == "nak" && argc > 2) {
+        test       = nak_task;
+        s_nak_size = std::strtoul(argv[2], nullptr, 10);
+    } else {
+        std::fprintf(stderr, "usage: %s zlp | frame | nak <bytes> | stress\n",
+                     argv[0]);
+        return 2;
+    }
+
+    HWInit();
+    usb_port::init(usb_priority);
+    assert_param(xTaskCreate(test, "test", configMINIMAL_STACK_SIZE * 4,
+                             nullptr, test_priority, nullptr) == pdPASS);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Runs tests/vcom_test.cpp and checks the data it sent over the simulated
+USB bus, see the modes there."""
+
+import re
+import subprocess
+import sys
+
+
+def pattern(size, offset=0):
+    return bytes(((i + (i >> 8)) & 0xFF) for i in range(offset, offset + size))
+
+
+def run(exe, mode, *args, data=b""):
+    result = subprocess.run([exe, mode, *args], input=data,
+                            capture_output=True, timeout=60)
+    sys.stderr.write(result.stderr.decode(errors="replace"))
+    if result.returncode != 0:
+        sys.exit("{} exited with {}".format(mode, result.returncode))
+    return result.stdout, result.stderr.decode(errors="replace")
+
+
+def check_stream(out, err):
+    total = int(re.search(r"total=(\d+)", err).group(1))
+    if len(out) != total:
+        sys.exit("received {} of {} bytes".format(len(out), total))
+    if out != pattern(total):
+        first = next(i for i, (a, b) in enumerate(zip(out, pattern(total)))
+                     if a != b)
+        sys.exit("data differs at byte {}".format(first))
+
+
+def check_records(out, err):
+    """Every record has to be whole and each producer's in order."""
+    producers, records = map(int, re.search(r"producers=(\d+) records=(\d+)",
+                                            err).groups())
+    expected = [0] * producers
+    pos = 0
+    while pos < len(out):
+        if out[pos] != 0xA5 or pos + 5 > len(out):
+            sys.exit("no record at byte {}".format(pos))
+        producer, seq, size = out[pos + 1], out[pos + 2] | out[pos + 3] << 8, \
+            out[pos + 4]
+        payload = out[pos + 5:pos + 5 + size]
+        if (producer >= producers or seq != expected[producer] or
+                payload != bytes((producer + seq + i) & 0xFF
+                                 for i in range(size)) or
+                out[pos + 5 + size] != sum(payload) & 0xFF):
+            sys.exit("broken record of producer {} at byte {}".format(
+                producer, pos))
+        expected[producer] += 1
+        pos += 6 + size
+    if expected != [records] * producers:
+        sys.exit("records missing: {}".format(expected))
+
+
+def main():
+    exe, mode = sys.argv[1:3]
+    if mode in ("zlp", "frame"):
+        check_stream(*run(exe, mode))
+    elif mode == "stress":
+        check_records(*run(exe, mode))
+    elif mode == "nak":
+        # more than the stdin buffer of the simulation and the pipe hold
+        size = 256 * 1024
+        run(exe, mode, str(size), data=pattern(size))
+    else:
+        sys.exit("unknown mode " + mode)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,285 @@
+// Evaluates recordings of the irq_latency benchmark (src/main_irq_latency.cpp)
+//
+//   stty -F /dev/ttyACM0 raw && cat /dev/ttyACM0 > run.log &
+//   echo > /dev/ttyACM0
+//   irq_latency_report [--csv] [--slo PERCENTILE=MICROSECONDS] run.log...
+//
+// A recording consists of lines like
+//   begin irq_latency version=1 cpu_hz=216000000 samples=10000
+//   run mechanism=queue rate_hz=1000 samples=10000 overruns=0 timeouts=0
+//   hist mechanism=queue rate_hz=1000 stage=event_to_task count=... data=HEX
+//   end
+// where data is a serialized dis::histogram_snapshot.  Histograms of the same
+// mechanism, rate and stage are merged over all given recordings.  With
+// --slo the event_to_task percentile is checked against the limit and the
+// exit code is 2 if any configuration misses it.
+
+#include "dis/osal/utils/histogram.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using snapshot = dis::histogram_snapshot<>;
+
+constexpr std::uint32_t default_cpu_hz = 216'000'000;
+
+struct key {
+    std::string mechanism;
+    std::uint32_t rate_hz;
+    std::string stage;
+
+    auto operator<=>(const key&) const = default;
+};
+
+struct run_stats {
+    std::uint64_t samples{0};
+    std::uint64_t overruns{0};
+    std::uint64_t timeouts{0};
+};
+
+struct recording {
+    std::uint32_t cpu_hz{0};
+    std::map<key, snapshot> histograms{};
+    std::map<std::tuple<std::string, std::uint32_t>, run_stats> runs{};
+};
+
+struct slo {
+    double percentile;
+    double limit_us;
+};
+
+/// value of `name=` in a line of space separated key value pairs
+std::optional<std::string_view> field(std::string_view line,
+                                      std::string_view name) {
+    std::size_t pos = 0;
+    while (pos < line.size()) {
+        const std::size_t end = std::min(line.find(' ', pos), line.size());
+        const std::string_view token = line.substr(pos, end - pos);
+        if (token.size() > name.size() && token.starts_with(name) &&
+            token[name.size()] == '=') {
+            return token.substr(name.size() + 1);
+        }
+        pos = end + 1;
+    }
+    return std::nullopt;
+}
+
+std::uint32_t number(std::string_view line, std::string_view name) {
+    const auto value = field(line, name);
+    return value ? static_cast<std::uint32_t>(
+                       std::strtoul(std::string(*value).c_str(), nullptr, 10))
+                 : 0;
+}
+
+std::optional<std::vector<std::byte>> from_hex(std::string_view hex) {
+    if (hex.size() % 2 != 0) {
+        return std::nullopt;
+    }
+    const auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    };
+
+    std::vector<std::byte> result;
+    result.reserve(hex.size() / 2);
+    for (std::size_t i = 0; i < hex.size(); i += 2) {
+        const int high = nibble(hex[i]);
+        const int low  = nibble(hex[i + 1]);
+        if (high < 0 || low < 0) {
+            return std::nullopt;
+        }
+        result.push_back(static_cast<std::byte>((high << 4) | low));
+    }
+    return result;
+}
+
+bool parse_file(const char* path, recording& rec) {
+    std::ifstream input(path);
+    if (!input) {
+        std::fprintf(stderr, "error: can not open %s\n", path);
+        return false;
+    }
+
+    std::string text;
+    unsigned line_number = 0;
+    while (std::getline(input, text)) {
+        ++line_number;
+        std::string_view line = text;
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+            line.remove_suffix(1);
+        }
+
+        if (line.starts_with("begin ")) {
+            const std::uint32_t hz = number(line, "cpu_hz");
+            if (rec.cpu_hz != 0 && hz != rec.cpu_hz) {
+                std::fprintf(stderr,
+                             "warning: %s:%u: cpu_hz %u differs from %u\n",
+                             path, line_number, hz, rec.cpu_hz);
+            }
+            rec.cpu_hz = hz;
+        } else if (line.starts_with("run ")) {
+            const auto mech = field(line, "mechanism");
+            if (!mech) {
+                continue;
+            }
+            auto& stats = rec.runs[{std::string(*mech),
+                                    number(line, "rate_hz")}];
+            stats.samples += number(line, "samples");
+            stats.overruns += number(line, "overruns");
+            stats.timeouts += number(line, "timeouts");
+        } else if (line.starts_with("hist ")) {
+            const auto mech  = field(line, "mechanism");
+            const auto stage = field(line, "stage");
+            const auto data  = field(line, "data");
+            const auto bytes = data ? from_hex(*data) : std::nullopt;
+            const auto hist =
+                bytes ? snapshot::deserialize(*bytes) : std::nullopt;
+            if (!mech || !stage || !hist) {
+                // incomplete lines happen if the recording started late
+                std::fprintf(stderr, "warning: %s:%u: skipping broken line\n",
+                             path, line_number);
+                continue;
+            }
+            rec.histograms[{std::string(*mech), number(line, "rate_hz"),
+                            std::string(*stage)}]
+                .merge(*hist);
+        }
+    }
+    return true;
+}
+
+bool parse_slo(std::string_view text, slo& result) {
+    const std::size_t eq = text.find('=');
+    if (eq == std::string_view::npos) {
+        return false;
+    }
+    char* end = nullptr;
+    const std::string percentile(text.substr(0, eq));
+    const std::string limit(text.substr(eq + 1));
+    result.percentile = std::strtod(percentile.c_str(), &end);
+    if (end == percentile.c_str() || result.percentile <= 0.0 ||
+        result.percentile > 100.0) {
+        return false;
+    }
+    result.limit_us = std::strtod(limit.c_str(), &end);
+    return end != limit.c_str() && result.limit_us > 0.0;
+}
+
+void usage(const char* self) {
+    std::fprintf(stderr,
+                 "usage: %s [--csv] [--slo PERCENTILE=MICROSECONDS] "
+                 "recording...\n",
+                 self);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool csv = false;
+    std::vector<slo> slos;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--csv") {
+            csv = true;
+        } else if (arg == "--slo" && i + 1 < argc) {
+            slo limit{};
+            if (!parse_slo(argv[++i], limit)) {
+                std::fprintf(stderr, "error: invalid slo '%s'\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            slos.push_back(limit);
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    recording rec;
+    for (const char* path : files) {
+        if (!parse_file(path, rec)) {
+            return EXIT_FAILURE;
+        }
+    }
+    if (rec.histograms.empty()) {
+        std::fprintf(stderr, "error: no histograms found\n");
+        return EXIT_FAILURE;
+    }
+
+    const double cpu_hz =
+        rec.cpu_hz != 0 ? rec.cpu_hz : static_cast<double>(default_cpu_hz);
+    const auto us = [cpu_hz](std::uint32_t cycles) {
+        return static_cast<double>(cycles) * 1e6 / cpu_hz;
+    };
+
+    if (csv) {
+        std::printf("mechanism,rate_hz,stage,count,min_us,p50_us,p90_us,"
+                    "p99_us,p999_us,max_us\n");
+    } else {
+        std::printf("%-14s %8s %-14s %8s %9s %9s %9s %9s %9s %9s\n",
+                    "mechanism", "rate_hz", "stage", "count", "min[us]",
+                    "p50[us]", "p90[us]", "p99[us]", "p99.9[us]", "max[us]");
+    }
+    const char* format = csv ? "%s,%u,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"
+                             : "%-14s %8u %-14s %8llu %9.3f %9.3f %9.3f "
+                               "%9.3f %9.3f %9.3f\n";
+    for (const auto& [k, hist] : rec.histograms) {
+        std::printf(format, k.mechanism.c_str(), k.rate_hz, k.stage.c_str(),
+                    static_cast<unsigned long long>(hist.count()),
+                    us(hist.min()), us(hist.percentile(50.0)),
+                    us(hist.percentile(90.0)), us(hist.percentile(99.0)),
+                    us(hist.percentile(99.9)), us(hist.max()));
+    }
+
+    int result = EXIT_SUCCESS;
+    for (const auto& [k, stats] : rec.runs) {
+        if (stats.overruns != 0 || stats.timeouts != 0) {
+            std::fprintf(stderr,
+                         "note: %s at %u Hz: %llu overruns, %llu timeouts\n",
+                         std::get<0>(k).c_str(), std::get<1>(k),
+                         static_cast<unsigned long long>(stats.overruns),
+                         static_cast<unsigned long long>(stats.timeouts));
+        }
+    }
+    for (const auto& limit : slos) {
+        for (const auto& [k, hist] : rec.histograms) {
+            if (k.stage != "event_to_task") {
+                continue;
+            }
+            const double value = us(hist.percentile(limit.percentile));
+            if (value > limit.limit_us) {
+                std::fprintf(stderr,
+                             "SLO MISSED: %s at %u Hz: p%g = %.3f us > %.3f "
+                             "us\n",
+                             k.mechanism.c_str(), k.rate_hz, limit.percentile,
+                             value, limit.limit_us);
+                result = 2;
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,523 @@
+// Decodes a dump of the dis::log ring (see dis/osal/log/format.hpp) with the
+// help of the site descriptions in the ELF file of the firmware
+//
+//   log_decode [--cpu-hz HZ] firmware.elf log.bin
+
+#include "dis/osal/log/format.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace dis::log;
+
+constexpr std::uint32_t default_cpu_hz = 216'000'000;
+
+template <typename T>
+bool read_at(const std::vector<char>& data, std::size_t offset, T& out) {
+    if (offset + sizeof(T) > data.size() || offset + sizeof(T) < offset) {
+        return false;
+    }
+    std::memcpy(&out, data.data() + offset, sizeof(T));
+    return true;
+}
+
+std::optional<std::vector<char>> read_file(const char* path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        std::fprintf(stderr, "error: can not open %s\n", path);
+        return std::nullopt;
+    }
+    return std::vector<char>{std::istreambuf_iterator<char>(input),
+                             std::istreambuf_iterator<char>()};
+}
+
+/// the few parts of an ELF file (32 or 64 bit, little endian) we need
+class elf_file {
+public:
+    struct section {
+        std::string name;
+        std::uint32_t type;
+        std::uint64_t flags;
+        std::uint64_t address;
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    bool parse(std::vector<char> data) {
+        m_data = std::move(data);
+        if (m_data.size() < 16 ||
+            std::memcmp(m_data.data(), "\177ELF", 4) != 0) {
+            std::fprintf(stderr, "error: not an ELF file\n");
+            return false;
+        }
+        if (m_data[5] != 1) {
+            std::fprintf(stderr, "error: big endian ELF files are not "
+                                 "supported\n");
+            return false;
+        }
+        const bool is64 = m_data[4] == 2;
+
+        std::uint64_t shoff     = 0;
+        std::uint16_t shentsize = 0;
+        std::uint16_t shnum     = 0;
+        std::uint16_t shstrndx  = 0;
+        if (is64) {
+            read_at(m_data, 0x28, shoff);
+            read_at(m_data, 0x3A, shentsize);
+            read_at(m_data, 0x3C, shnum);
+            read_at(m_data, 0x3E, shstrndx);
+        } else {
+            std::uint32_t shoff32 = 0;
+            read_at(m_data, 0x20, shoff32);
+            read_at(m_data, 0x2E, shentsize);
+            read_at(m_data, 0x30, shnum);
+            read_at(m_data, 0x32, shstrndx);
+            shoff = shoff32;
+        }
+
+        std::vector<std::uint32_t> name_offsets;
+        for (std::uint16_t i = 0; i < shnum; ++i) {
+            const std::size_t base = shoff + std::size_t{i} * shentsize;
+            section sec{};
+            std::uint32_t name = 0;
+            bool ok            = read_at(m_data, base, name);
+            ok = ok && read_at(m_data, base + 4, sec.type);
+            if (is64) {
+                ok = ok && read_at(m_data, base + 0x08, sec.flags) &&
+                     read_at(m_data, base + 0x10, sec.address) &&
+                     read_at(m_data, base + 0x18, sec.offset) &&
+                     read_at(m_data, base + 0x20, sec.size);
+            } else {
+                std::uint32_t flags = 0, address = 0, offset = 0, size = 0;
+                ok = ok && read_at(m_data, base + 0x08, flags) &&
+                     read_at(m_data, base + 0x0C, address) &&
+                     read_at(m_data, base + 0x10, offset) &&
+                     read_at(m_data, base + 0x14, size);
+                sec.flags   = flags;
+                sec.address = address;
+                sec.offset  = offset;
+                sec.size    = size;
+            }
+            if (!ok) {
+                std::fprintf(stderr, "error: truncated section headers\n");
+                return false;
+            }
+            name_offsets.push_back(name);
+            m_sections.push_back(sec);
+        }
+        if (shstrndx >= m_sections.size()) {
+            std::fprintf(stderr, "error: no section names\n");
+            return false;
+        }
+        const section& names = m_sections[shstrndx];
+        for (std::size_t i = 0; i < m_sections.size(); ++i) {
+            m_sections[i].name =
+                string_at(names.offset + name_offsets[i],
+                          names.offset + names.size);
+        }
+        return true;
+    }
+
+    [[nodiscard]] const section* find(std::string_view name) const {
+        for (const auto& sec : m_sections) {
+            if (sec.name == name) {
+                return &sec;
+            }
+        }
+        return nullptr;
+    }
+
+    /// NUL terminated string at the file offset, limited by end
+    [[nodiscard]] std::string string_at(std::uint64_t offset,
+                                        std::uint64_t end) const {
+        end = std::min<std::uint64_t>(end, m_data.size());
+        std::string result;
+        for (; offset < end && m_data[offset] != '\0'; ++offset) {
+            result += m_data[offset];
+        }
+        return result;
+    }
+
+    /// string at a target address, e.g. a string literal passed as argument
+    [[nodiscard]] std::optional<std::string> string_at_address(
+        std::uint64_t address) const {
+        constexpr std::uint32_t sht_nobits = 8;
+        constexpr std::uint64_t shf_alloc  = 2;
+        for (const auto& sec : m_sections) {
+            if ((sec.flags & shf_alloc) == 0 || sec.type == sht_nobits ||
+                address < sec.address || address >= sec.address + sec.size) {
+                continue;
+            }
+            return string_at(sec.offset + (address - sec.address),
+                             sec.offset + sec.size);
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::vector<char> m_data{};
+    std::vector<section> m_sections{};
+};
+
+/// a decoded site description
+struct site {
+    level lvl;
+    std::string codes;
+    std::string file;
+    std::string line;
+    std::string format;
+};
+
+std::optional<site> read_site(const elf_file& elf,
+                              const elf_file::section& sites,
+                              std::uint16_t id) {
+    if (id >= sites.size) {
+        return std::nullopt;
+    }
+    const std::uint64_t end = sites.offset + sites.size;
+    std::uint64_t offset    = sites.offset + id;
+    auto next               = [&] {
+        std::string text = elf.string_at(offset, end);
+        offset += text.size() + 1;
+        return text;
+    };
+    const std::string head = next();
+    if (head.empty() || head[0] < '1' || head[0] > '4') {
+        return std::nullopt;
+    }
+    site result{static_cast<level>(head[0] - '0'), head.substr(1), "", "",
+                ""};
+    result.file   = next();
+    result.line   = next();
+    result.format = next();
+    return result;
+}
+
+const char* level_name(level lvl) {
+    switch (lvl) {
+        case level::error: return "ERROR";
+        case level::warning: return "WARN ";
+        case level::info: return "INFO ";
+        case level::debug: return "DEBUG";
+        default: return "?    ";
+    }
+}
+
+class formatter {
+public:
+    formatter(const elf_file& elf, std::size_t pointer_words)
+        : m_elf(elf), m_pointer_words(pointer_words) {}
+
+    /// returns false if the arguments do not match the description
+    bool format(const site& where,
+                const std::vector<std::uint32_t>& words,
+                std::string& out) const {
+        std::size_t arg  = 0;
+        std::size_t word = 0;
+        const std::string& fmt = where.format;
+        for (std::size_t i = 0; i < fmt.size(); ++i) {
+            const char c = fmt[i];
+            if ((c == '{' || c == '}') && i + 1 < fmt.size() &&
+                fmt[i + 1] == c) {
+                out += c;
+                ++i;
+                continue;
+            }
+            if (c != '{') {
+                out += c;
+                continue;
+            }
+            const std::size_t close = fmt.find('}', i);
+            if (close == std::string::npos || arg >= where.codes.size()) {
+                return false;
+            }
+            std::string_view spec(fmt.data() + i + 1, close - i - 1);
+            if (!spec.empty() && spec.front() == ':') {
+                spec.remove_prefix(1);
+            }
+            if (!field(where.codes[arg++], spec, words, word, out)) {
+                return false;
+            }
+            i = close;
+        }
+        return arg == where.codes.size() && word == words.size();
+    }
+
+private:
+    bool field(char code,
+               std::string_view spec,
+               const std::vector<std::uint32_t>& words,
+               std::size_t& word,
+               std::string& out) const {
+        const std::size_t count = code == 'I' || code == 'U' || code == 'd'
+                                      ? 2
+                                  : code == 's' || code == 'p'
+                                      ? m_pointer_words
+                                      : 1;
+        if (word + count > words.size()) {
+            return false;
+        }
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            value |= std::uint64_t{words[word + i]} << (32 * i);
+        }
+        word += count;
+
+        // [0][WIDTH][.PRECISION][TYPE] translated to printf
+        char type = '\0';
+        if (!spec.empty() && std::string_view("bcdefgopsuxEGX").find(
+                                 spec.back()) != std::string_view::npos) {
+            type = spec.back();
+            spec.remove_suffix(1);
+        }
+        const std::string prefix = "%" + std::string(spec);
+
+        char buffer[512];
+        switch (code) {
+            case 'b':
+                std::snprintf(buffer, sizeof(buffer), (prefix + "s").c_str(),
+                              value != 0 ? "true" : "false");
+                break;
+            case 'c':
+                std::snprintf(buffer, sizeof(buffer),
+                              (prefix + (type == '\0' ? 'c' : type)).c_str(),
+                              static_cast<int>(value));
+                break;
+            case 'i':
+            case 'u':
+            case 'I':
+            case 'U': {
+                std::int64_t number = static_cast<std::int64_t>(value);
+                if (code == 'i') {
+                    number = static_cast<std::int32_t>(value);
+                } else if (code == 'u') {
+                    number = static_cast<std::uint32_t>(value);
+                }
+                if (type == 'b') {
+                    integer_binary(spec, static_cast<std::uint64_t>(number),
+                                   out);
+                    return true;
+                }
+                const bool is_signed = code == 'i' || code == 'I';
+                char conv            = is_signed ? 'd' : 'u';
+                if (type == 'x' || type == 'X' || type == 'o') {
+                    conv = type;
+                    if (code == 'i') {
+                        // hex of the 32 bit representation
+                        number = static_cast<std::uint32_t>(number);
+                    }
+                } else if (type == 'c') {
+                    conv = 'c';
+                }
+                std::snprintf(buffer, sizeof(buffer),
+                              (prefix + "ll" + conv).c_str(),
+                              static_cast<long long>(number));
+                break;
+            }
+            case 'f':
+            case 'd': {
+                double number = 0;
+                if (code == 'f') {
+                    float single = 0;
+                    const auto bits = static_cast<std::uint32_t>(value);
+                    std::memcpy(&single, &bits, sizeof(single));
+                    number = single;
+                } else {
+                    std::memcpy(&number, &value, sizeof(number));
+                }
+                const char conv = std::string_view("eEfgG").find(type) !=
+                                              std::string_view::npos &&
+                                          type != '\0'
+                                      ? type
+                                      : 'g';
+                std::snprintf(buffer, sizeof(buffer),
+                              (prefix + conv).c_str(), number);
+                break;
+            }
+            case 's': {
+                const auto text = m_elf.string_at_address(value);
+                if (text) {
+                    std::snprintf(buffer, sizeof(buffer),
+                                  (prefix + "s").c_str(), text->c_str());
+                } else {
+                    std::snprintf(buffer, sizeof(buffer),
+                                  "<string at 0x%" PRIx64 ">", value);
+                }
+                break;
+            }
+            case 'p':
+                std::snprintf(buffer, sizeof(buffer), "0x%0*" PRIx64,
+                              static_cast<int>(m_pointer_words * 8), value);
+                break;
+            default: return false;
+        }
+        out += buffer;
+        return true;
+    }
+
+    static void integer_binary(std::string_view spec,
+                               std::uint64_t value,
+                               std::string& out) {
+        std::string digits;
+        do {
+            digits.insert(digits.begin(), (value & 1U) != 0 ? '1' : '0');
+            value >>= 1U;
+        } while (value != 0);
+        const bool zero  = !spec.empty() && spec.front() == '0';
+        const auto width = std::strtoul(std::string(spec).c_str(), nullptr,
+                                        10);
+        if (digits.size() < width) {
+            digits.insert(digits.begin(), width - digits.size(),
+                          zero ? '0' : ' ');
+        }
+        out += digits;
+    }
+
+    const elf_file& m_elf;
+    std::size_t m_pointer_words;
+};
+
+void usage(const char* self) {
+    std::fprintf(stderr,
+                 "usage: %s [--cpu-hz HZ] firmware.elf log.bin\n", self);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::uint32_t cpu_hz = 0;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--cpu-hz" && i + 1 < argc) {
+            cpu_hz = static_cast<std::uint32_t>(
+                std::strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.size() != 2) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto image = read_file(files[0]);
+    auto data  = read_file(files[1]);
+    if (!image || !data) {
+        return EXIT_FAILURE;
+    }
+    const bool is64 = image->size() > 4 && (*image)[4] == 2;
+    elf_file elf;
+    if (!elf.parse(std::move(*image))) {
+        return EXIT_FAILURE;
+    }
+    const elf_file::section* sites = elf.find(elf_site_section);
+    if (sites == nullptr) {
+        sites = elf.find(site_section);
+    }
+    if (sites == nullptr) {
+        std::fprintf(stderr, "error: %s has no dis::log sites\n", files[0]);
+        return EXIT_FAILURE;
+    }
+
+    dump_header hdr{};
+    if (!read_at(*data, 0, hdr) || hdr.magic != dump_magic) {
+        std::fprintf(stderr, "error: not a dis::log dump\n");
+        return EXIT_FAILURE;
+    }
+    if (hdr.version != dump_version || hdr.slot_size != sizeof(slot) ||
+        hdr.slot_capacity == 0) {
+        std::fprintf(stderr, "error: unsupported dump version %u\n",
+                     hdr.version);
+        return EXIT_FAILURE;
+    }
+    if (cpu_hz == 0) {
+        cpu_hz = hdr.cpu_hz != 0 ? hdr.cpu_hz : default_cpu_hz;
+    }
+
+    const std::uint32_t count = std::min(hdr.slots_written, hdr.slot_capacity);
+    const std::uint32_t first = hdr.slots_written > hdr.slot_capacity
+                                    ? hdr.slots_written % hdr.slot_capacity
+                                    : 0;
+    std::vector<slot> slots(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const std::uint32_t idx = (first + i) % hdr.slot_capacity;
+        if (!read_at(*data, sizeof(dump_header) + idx * sizeof(slot),
+                     slots[i])) {
+            std::fprintf(stderr, "error: truncated slot ring\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    const formatter fmt(elf, is64 ? 2 : 1);
+    std::size_t records = 0;
+    std::size_t broken  = 0;
+    std::uint64_t now   = 0;
+    std::optional<std::uint32_t> last;
+    for (std::size_t i = 0; i < slots.size();) {
+        const slot& head = slots[i++];
+        if (head.kind != slot_kind::head) {
+            // the head of this record was overwritten
+            continue;
+        }
+        std::vector<std::uint32_t> words;
+        for (std::size_t w = 0; w < head.words && w < head_words; ++w) {
+            words.push_back(head.data[1 + w]);
+        }
+        bool complete = true;
+        while (words.size() < head.words) {
+            if (i >= slots.size() ||
+                slots[i].kind != slot_kind::continuation) {
+                complete = false;
+                break;
+            }
+            for (std::size_t w = 0;
+                 w < continuation_words && words.size() < head.words; ++w) {
+                words.push_back(slots[i].data[w]);
+            }
+            ++i;
+        }
+
+        // the 32 bit timestamps are unwrapped on the assumption that two
+        // consecutive records are less than 2^32 cycles apart
+        if (last) {
+            now += static_cast<std::uint32_t>(head.data[0] - *last);
+        }
+        last = head.data[0];
+
+        const auto where = read_site(elf, *sites, head.id);
+        std::string text;
+        if (!complete || !where || !fmt.format(*where, words, text)) {
+            std::printf("[%12.6f] ?     unknown record (site 0x%04x, %u "
+                        "words)\n",
+                        static_cast<double>(now) / cpu_hz, head.id,
+                        head.words);
+            ++broken;
+            continue;
+        }
+        std::printf("[%12.6f] %s %s:%s: %s\n",
+                    static_cast<double>(now) / cpu_hz,
+                    level_name(where->lvl), where->file.c_str(),
+                    where->line.c_str(), text.c_str());
+        ++records;
+    }
+    std::fprintf(stderr, "%zu records, %zu undecodable, %u slots written, "
+                         "%u Hz\n",
+                 records, broken, hdr.slots_written, cpu_hz);
+    return broken == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
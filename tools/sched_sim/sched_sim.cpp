@@ -0,0 +1,1030 @@
+// Deterministic virtual time simulation of the FreeRTOS scheduler
+//
+//   sched_sim [--seed N] [--duration-ms N] [--csv] model.sched
+//
+// Replays a model of tasks, mutexes and interrupts on a discrete event model
+// of the kernel and reports the response time distribution and the deadline
+// misses of every task, so a priority assignment can be checked before it is
+// flashed.  The kernel settings (priorities, tick rate, preemption, time
+// slicing, interrupt priorities) are taken from include/FreeRTOSConfig.h.
+// All randomness (execution times, interrupt jitter) is drawn from one
+// generator seeded by --seed, so a run is reproduced exactly by its seed.
+//
+// A model consists of lines like (times in microseconds, '#' comments)
+//   kernel tick_us=2 switch_us=0.5
+//   task name=control priority=20 period_us=1000 body=120,spi:40,30 bcet=0.8
+//   task name=rx priority=30 deadline_us=500 body=50
+//   isr name=uart irq_priority=6 period_us=250 jitter_us=50 wcet_us=3 wakes=rx
+//
+// - kernel: execution time of the tick interrupt and of a context switch
+// - task: fixed priority task, either periodic (vTaskDelayUntil, the period
+//   is rounded to ticks) or woken through a binary semaphore given by an isr
+//   (wakes=).  The body is a list of compute segments, NAME:US holds the
+//   mutex NAME (priority inheritance) for that segment.  Every segment takes
+//   between bcet times and the full value.  Optional: deadline_us (defaults
+//   to the period), offset_us.
+// - isr: interrupt with NVIC priority irq_priority, triggered every
+//   period_us plus up to jitter_us.  Optional: offset_us (defaults to the
+//   period), bcet, wakes.
+//
+// The exit code is 2 if any task missed a deadline.
+//
+// Model simplifications: mutexes are not nested, kernel critical sections do
+// not mask interrupts, the idle task always yields and a context switch is
+// charged whenever a task is switched in.
+
+#include "dis/osal/utils/histogram.hpp"
+
+// the kernel configuration of the firmware, the port types are not needed
+// besides the tick type used by configTICK_RATE_HZ
+using TickType_t = std::uint32_t;
+#include <FreeRTOSConfig.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// defaults of FreeRTOS.h for settings FreeRTOSConfig.h may leave out
+#ifndef configUSE_TIME_SLICING
+#define configUSE_TIME_SLICING 1
+#endif
+
+namespace {
+
+using time_ns = std::int64_t;
+
+constexpr unsigned max_priorities      = configMAX_PRIORITIES;
+constexpr time_ns tick_period          = 1'000'000'000 / configTICK_RATE_HZ;
+constexpr bool use_preemption          = (configUSE_PREEMPTION == 1);
+constexpr bool use_time_slicing        = (configUSE_TIME_SLICING == 1);
+constexpr bool use_mutexes             = (configUSE_MUTEXES == 1);
+constexpr unsigned irq_priority_levels = 1U << configPRIO_BITS;
+constexpr unsigned tick_irq_priority =
+    configLIBRARY_LOWEST_INTERRUPT_PRIORITY;
+constexpr unsigned max_syscall_irq_priority =
+    configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY;
+
+constexpr time_ns never = std::numeric_limits<time_ns>::max();
+
+/********************************* model **********************************/
+
+struct segment {
+    int mutex{-1};
+    time_ns duration{0};
+};
+
+struct task_model {
+    std::string name{};
+    unsigned priority{0};
+    time_ns period{0};  // 0 for tasks woken by an isr
+    time_ns deadline{0};
+    time_ns offset{0};
+    double bcet{1.0};
+    std::vector<segment> body{};
+};
+
+struct isr_model {
+    std::string name{};
+    unsigned irq_priority{0};
+    time_ns period{0};
+    time_ns jitter{0};
+    time_ns offset{0};
+    time_ns wcet{0};
+    double bcet{1.0};
+    int wakes{-1};
+};
+
+struct model {
+    time_ns tick_cost{0};
+    time_ns switch_cost{0};
+    std::vector<task_model> tasks{};
+    std::vector<isr_model> isrs{};
+    std::vector<std::string> mutexes{};
+};
+
+/// value of `name=` in a line of space separated key value pairs
+std::optional<std::string_view> field(std::string_view line,
+                                      std::string_view name) {
+    std::size_t pos = 0;
+    while (pos < line.size()) {
+        const std::size_t end = std::min(line.find(' ', pos), line.size());
+        const std::string_view token = line.substr(pos, end - pos);
+        if (token.size() > name.size() && token.starts_with(name) &&
+            token[name.size()] == '=') {
+            return token.substr(name.size() + 1);
+        }
+        pos = end + 1;
+    }
+    return std::nullopt;
+}
+
+std::optional<double> real(std::string_view text) {
+    const std::string value(text);
+    char* end           = nullptr;
+    const double result = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || result < 0.0) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+std::optional<time_ns> micros(std::string_view text) {
+    const auto value = real(text);
+    if (!value) {
+        return std::nullopt;
+    }
+    return static_cast<time_ns>(std::llround(*value * 1000.0));
+}
+
+class model_parser {
+public:
+    model_parser(const char* path, model& result) noexcept
+        : m_path{path}, m_model{result} {}
+
+    bool parse() {
+        std::ifstream input(m_path);
+        if (!input) {
+            std::fprintf(stderr, "error: can not open %s\n", m_path);
+            return false;
+        }
+
+        // tasks may be referenced by an isr before they are declared
+        std::vector<std::pair<std::size_t, std::string>> wakes;
+        std::vector<unsigned> wakes_lines;
+
+        std::string text;
+        while (std::getline(input, text)) {
+            ++m_line;
+            std::string_view line = text;
+            line = line.substr(0, line.find('#'));
+            const auto blank = [](char c) {
+                return c == ' ' || c == '\t' || c == '\r';
+            };
+            while (!line.empty() && blank(line.back())) {
+                line.remove_suffix(1);
+            }
+            while (!line.empty() && blank(line.front())) {
+                line.remove_prefix(1);
+            }
+            if (line.empty()) {
+                continue;
+            }
+
+            if (line.starts_with("kernel ")) {
+                if (!optional_time(line, "tick_us", m_model.tick_cost) ||
+                    !optional_time(line, "switch_us", m_model.switch_cost)) {
+                    return false;
+                }
+            } else if (line.starts_with("task ")) {
+                if (!parse_task(line)) {
+                    return false;
+                }
+            } else if (line.starts_with("isr ")) {
+                std::string target;
+                if (!parse_isr(line, target)) {
+                    return false;
+                }
+                if (!target.empty()) {
+                    wakes.emplace_back(m_model.isrs.size() - 1, target);
+                    wakes_lines.push_back(m_line);
+                }
+            } else {
+                return error("unknown line");
+            }
+        }
+
+        for (std::size_t i = 0; i < wakes.size(); ++i) {
+            m_line                  = wakes_lines[i];
+            const auto& [isr, name] = wakes[i];
+            const auto task = std::find_if(
+                m_model.tasks.begin(), m_model.tasks.end(),
+                [&name](const task_model& t) { return t.name == name; });
+            if (task == m_model.tasks.end()) {
+                return error("wakes unknown task");
+            }
+            if (task->period != 0) {
+                return error("wakes a periodic task");
+            }
+            m_model.isrs[isr].wakes =
+                static_cast<int>(task - m_model.tasks.begin());
+        }
+        for (const auto& task : m_model.tasks) {
+            const bool woken = std::any_of(
+                m_model.isrs.begin(), m_model.isrs.end(),
+                [&](const isr_model& isr) {
+                    return isr.wakes >= 0 &&
+                           m_model.tasks[isr.wakes].name == task.name;
+                });
+            if (task.period == 0 && !woken) {
+                std::fprintf(stderr,
+                             "warning: %s: task %s has no period and no isr "
+                             "wakes it\n",
+                             m_path, task.name.c_str());
+            }
+        }
+        if (m_model.tasks.empty()) {
+            std::fprintf(stderr, "error: %s: no tasks\n", m_path);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool error(const char* message) const {
+        std::fprintf(stderr, "error: %s:%u: %s\n", m_path, m_line, message);
+        return false;
+    }
+
+    bool optional_time(std::string_view line,
+                       std::string_view name,
+                       time_ns& value) const {
+        const auto text = field(line, name);
+        if (!text) {
+            return true;
+        }
+        const auto parsed = micros(*text);
+        if (!parsed) {
+            return error("invalid time");
+        }
+        value = *parsed;
+        return true;
+    }
+
+    bool optional_bcet(std::string_view line, double& value) const {
+        const auto text = field(line, "bcet");
+        if (!text) {
+            return true;
+        }
+        const auto parsed = real(*text);
+        if (!parsed || *parsed > 1.0) {
+            return error("bcet must be between 0 and 1");
+        }
+        value = *parsed;
+        return true;
+    }
+
+    bool parse_task(std::string_view line) {
+        task_model task;
+        const auto name     = field(line, "name");
+        const auto priority = field(line, "priority");
+        const auto body     = field(line, "body");
+        if (!name || !priority || !body) {
+            return error("task needs name, priority and body");
+        }
+        task.name = std::string(*name);
+        const auto prio = real(*priority);
+        if (!prio || *prio != std::floor(*prio) || *prio >= max_priorities) {
+            return error("priority must be below configMAX_PRIORITIES");
+        }
+        task.priority = static_cast<unsigned>(*prio);
+
+        if (!optional_time(line, "period_us", task.period) ||
+            !optional_time(line, "offset_us", task.offset) ||
+            !optional_bcet(line, task.bcet)) {
+            return false;
+        }
+        task.deadline = task.period;
+        if (!optional_time(line, "deadline_us", task.deadline)) {
+            return false;
+        }
+        if (task.deadline == 0) {
+            return error("tasks without period need deadline_us");
+        }
+        if (task.period % tick_period != 0 || task.offset % tick_period != 0) {
+            std::fprintf(stderr,
+                         "warning: %s:%u: period and offset of %s are "
+                         "rounded up to ticks\n",
+                         m_path, m_line, task.name.c_str());
+        }
+
+        std::size_t pos = 0;
+        while (pos <= body->size()) {
+            const std::size_t end =
+                std::min(body->find(',', pos), body->size());
+            const std::string_view item = body->substr(pos, end - pos);
+            const std::size_t colon     = item.find(':');
+            const bool locked           = colon != std::string_view::npos;
+            const auto duration =
+                micros(locked ? item.substr(colon + 1) : item);
+            segment seg;
+            if (!duration) {
+                return error("invalid body");
+            }
+            seg.duration = *duration;
+            if (locked) {
+                if (!use_mutexes) {
+                    return error("configUSE_MUTEXES is 0");
+                }
+                seg.mutex = mutex_id(item.substr(0, colon));
+            }
+            task.body.push_back(seg);
+            pos = end + 1;
+        }
+        m_model.tasks.push_back(std::move(task));
+        return true;
+    }
+
+    bool parse_isr(std::string_view line, std::string& wakes) {
+        isr_model isr;
+        const auto name     = field(line, "name");
+        const auto priority = field(line, "irq_priority");
+        if (!name || !priority) {
+            return error("isr needs name, irq_priority, period_us and wcet_us");
+        }
+        isr.name        = std::string(*name);
+        const auto prio = real(*priority);
+        if (!prio || *prio != std::floor(*prio) ||
+            *prio >= irq_priority_levels) {
+            return error("irq_priority out of range of configPRIO_BITS");
+        }
+        isr.irq_priority = static_cast<unsigned>(*prio);
+        if (!optional_time(line, "period_us", isr.period) ||
+            !optional_time(line, "jitter_us", isr.jitter) ||
+            !optional_time(line, "offset_us", isr.offset) ||
+            !optional_time(line, "wcet_us", isr.wcet) ||
+            !optional_bcet(line, isr.bcet)) {
+            return false;
+        }
+        if (isr.period == 0 || isr.wcet == 0) {
+            return error("isr needs name, irq_priority, period_us and wcet_us");
+        }
+        if (isr.jitter >= isr.period) {
+            return error("jitter_us must be below period_us");
+        }
+        if (isr.offset == 0) {
+            isr.offset = isr.period;
+        }
+        if (const auto target = field(line, "wakes")) {
+            // the FromISR API asserts in vPortValidateInterruptPriority()
+            if (isr.irq_priority < max_syscall_irq_priority) {
+                return error(
+                    "isr calls the kernel with an irq_priority above "
+                    "configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY");
+            }
+            wakes = std::string(*target);
+        }
+        m_model.isrs.push_back(std::move(isr));
+        return true;
+    }
+
+    int mutex_id(std::string_view name) {
+        auto& names = m_model.mutexes;
+        const auto it = std::find(names.begin(), names.end(), name);
+        if (it != names.end()) {
+            return static_cast<int>(it - names.begin());
+        }
+        names.emplace_back(name);
+        return static_cast<int>(names.size() - 1);
+    }
+
+    const char* m_path;
+    model& m_model;
+    unsigned m_line{0};
+};
+
+/******************************* simulator ********************************/
+
+/// splitmix64, the sequence only depends on the seed
+class random_source {
+public:
+    explicit random_source(std::uint64_t seed) noexcept : m_state{seed} {}
+
+    std::uint64_t next() noexcept {
+        std::uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /// uniform in [low, high]
+    time_ns between(time_ns low, time_ns high) noexcept {
+        if (high <= low) {
+            return low;
+        }
+        const auto range = static_cast<std::uint64_t>(high - low) + 1;
+        return low + static_cast<time_ns>(next() % range);
+    }
+
+    time_ns execution(time_ns wcet, double bcet) noexcept {
+        const auto low = static_cast<time_ns>(
+            std::llround(static_cast<double>(wcet) * bcet));
+        return between(low, wcet);
+    }
+
+private:
+    std::uint64_t m_state;
+};
+
+using response_histogram = dis::histogram_snapshot<7>;
+
+enum class task_state { ready, delayed, waiting_event, waiting_mutex };
+
+struct task_run {
+    const task_model* model{nullptr};
+    task_state state{task_state::delayed};
+    unsigned priority{0};  // including inherited priority
+
+    // current job
+    bool in_job{false};
+    time_ns release{0};
+    std::size_t segment{0};
+    time_ns remaining{0};
+    bool holds{false};
+    time_ns blocked_since{0};
+    time_ns blocking{0};
+
+    // releases which happened while the task was busy
+    std::int64_t next_release_tick{0};
+    std::int64_t period_ticks{0};
+    std::deque<time_ns> backlog{};
+    bool event_pending{false};
+    time_ns event_time{0};
+
+    // statistics
+    response_histogram responses{};
+    std::uint64_t jobs{0};
+    std::uint64_t misses{0};
+    std::uint64_t lost_events{0};
+    time_ns min_response{never};
+    time_ns max_response{0};
+    time_ns max_blocking{0};
+    time_ns cpu{0};
+};
+
+struct mutex_run {
+    int owner{-1};
+    std::vector<int> waiters{};
+};
+
+/// interrupt source, the tick is the first one
+struct source_run {
+    std::string name{};
+    unsigned irq_priority{0};
+    time_ns period{0};
+    time_ns jitter{0};
+    time_ns wcet{0};
+    double bcet{1.0};
+    int wakes{-1};
+
+    time_ns nominal{0};  // nominal time of the next trigger
+    time_ns next{0};     // the same including jitter
+    bool pending{false};
+    time_ns pending_since{0};
+
+    std::uint64_t count{0};
+    std::uint64_t overruns{0};
+    time_ns max_latency{0};
+    time_ns cpu{0};
+};
+
+struct active_isr {
+    std::size_t source;
+    time_ns remaining;
+    time_ns triggered;
+};
+
+class simulator {
+public:
+    simulator(const model& m, std::uint64_t seed) : m_random{seed} {
+        m_switch_cost = m.switch_cost;
+        m_mutexes.resize(m.mutexes.size());
+
+        for (const auto& t : m.tasks) {
+            task_run run;
+            run.model        = &t;
+            run.priority     = t.priority;
+            run.period_ticks = (t.period + tick_period - 1) / tick_period;
+            run.next_release_tick =
+                (t.offset + tick_period - 1) / tick_period;
+            run.state = t.period != 0 ? task_state::delayed
+                                      : task_state::waiting_event;
+            m_tasks.push_back(std::move(run));
+        }
+
+        source_run tick;
+        tick.name         = "tick";
+        tick.irq_priority = tick_irq_priority;
+        tick.period       = tick_period;
+        tick.wcet         = m.tick_cost;
+        tick.nominal      = tick_period;
+        tick.next         = tick_period;
+        m_sources.push_back(std::move(tick));
+        for (const auto& i : m.isrs) {
+            source_run run;
+            run.name         = i.name;
+            run.irq_priority = i.irq_priority;
+            run.period       = i.period;
+            run.jitter       = i.jitter;
+            run.wcet         = i.wcet;
+            run.bcet         = i.bcet;
+            run.wakes        = i.wakes;
+            run.nominal      = i.offset;
+            run.next         = i.offset + m_random.between(0, i.jitter);
+            m_sources.push_back(std::move(run));
+        }
+    }
+
+    void run(time_ns end) {
+        // tasks without offset are released when the scheduler starts
+        for (std::size_t id = 0; id < m_tasks.size(); ++id) {
+            release_periodic(static_cast<int>(id));
+        }
+
+        while (true) {
+            dispatch_interrupts();
+            if (m_isrs.empty()) {
+                reschedule();
+                while (m_current >= 0 && m_switch_left == 0 &&
+                       !acquire(m_current)) {
+                    reschedule();
+                }
+            }
+
+            time_ns next_trigger = never;
+            for (const auto& s : m_sources) {
+                next_trigger = std::min(next_trigger, s.next);
+            }
+            time_ns work = never;
+            if (!m_isrs.empty()) {
+                work = m_isrs.back().remaining;
+            } else if (m_current >= 0) {
+                work = m_switch_left > 0 ? m_switch_left
+                                         : m_tasks[m_current].remaining;
+            }
+
+            const time_ns step =
+                std::min({next_trigger - m_now, work, end - m_now});
+            account(step);
+            m_now += step;
+
+            if (!m_isrs.empty()) {
+                if (m_isrs.back().remaining == 0) {
+                    finish_isr();
+                }
+            } else if (m_current >= 0 && m_switch_left == 0 &&
+                       m_tasks[m_current].remaining == 0) {
+                finish_segment(m_current);
+            }
+            for (auto& s : m_sources) {
+                if (s.next == m_now) {
+                    trigger(s);
+                }
+            }
+            if (m_now >= end) {
+                break;
+            }
+        }
+
+        // unfinished jobs which are already late count as misses
+        for (auto& t : m_tasks) {
+            if (t.in_job && m_now - t.release > t.model->deadline) {
+                ++t.misses;
+            }
+            for (const time_ns release : t.backlog) {
+                if (m_now - release > t.model->deadline) {
+                    ++t.misses;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] const std::vector<task_run>& tasks() const noexcept {
+        return m_tasks;
+    }
+    [[nodiscard]] const std::vector<source_run>& sources() const noexcept {
+        return m_sources;
+    }
+    [[nodiscard]] time_ns switch_time() const noexcept { return m_switch_cpu; }
+    [[nodiscard]] std::uint64_t switches() const noexcept { return m_switches; }
+    [[nodiscard]] time_ns idle_time() const noexcept { return m_idle; }
+
+private:
+    /************************ ready lists ************************/
+
+    void make_ready(int id) {
+        m_tasks[id].state = task_state::ready;
+        m_ready[m_tasks[id].priority].push_back(id);
+    }
+
+    void unready(int id, task_state state) {
+        auto& list = m_ready[m_tasks[id].priority];
+        list.erase(std::find(list.begin(), list.end(), id));
+        m_tasks[id].state = state;
+    }
+
+    // like prvAddTaskToReadyList(), the task goes to the end of its new list
+    void set_priority(int id, unsigned priority) {
+        auto& t = m_tasks[id];
+        if (t.state == task_state::ready) {
+            unready(id, task_state::ready);
+            t.priority = priority;
+            make_ready(id);
+        } else {
+            t.priority = priority;
+        }
+    }
+
+    void rotate(unsigned priority) {
+        auto& list = m_ready[priority];
+        if (list.size() > 1) {
+            list.push_back(list.front());
+            list.pop_front();
+        }
+    }
+
+    [[nodiscard]] int pick() const {
+        if (!use_preemption && m_current >= 0 &&
+            m_tasks[m_current].state == task_state::ready) {
+            return m_current;
+        }
+        for (unsigned prio = max_priorities; prio-- > 0;) {
+            if (!m_ready[prio].empty()) {
+                return m_ready[prio].front();
+            }
+        }
+        return -1;
+    }
+
+    void reschedule() {
+        const int next = pick();
+        if (next != m_current) {
+            m_current     = next;
+            m_switch_left = next >= 0 ? m_switch_cost : 0;
+            if (next >= 0) {
+                ++m_switches;
+            }
+        }
+    }
+
+    /************************* mutexes **************************/
+
+    // takes the mutex of the current segment, blocks the task if it is held
+    bool acquire(int id) {
+        auto& t         = m_tasks[id];
+        const int mutex = t.model->body[t.segment].mutex;
+        if (mutex < 0 || t.holds) {
+            return true;
+        }
+        auto& m = m_mutexes[mutex];
+        if (m.owner < 0) {
+            m.owner = id;
+            t.holds = true;
+            return true;
+        }
+
+        unready(id, task_state::waiting_mutex);
+        t.blocked_since = m_now;
+        m.waiters.push_back(id);
+        // xTaskPriorityInherit()
+        if (m_tasks[m.owner].priority < t.priority) {
+            set_priority(m.owner, t.priority);
+        }
+        return false;
+    }
+
+    void release_mutex(int id, int mutex) {
+        auto& t = m_tasks[id];
+        auto& m = m_mutexes[mutex];
+        m.owner = -1;
+        t.holds = false;
+        // xTaskPriorityDisinherit(), mutexes are not nested
+        if (t.priority != t.model->priority) {
+            set_priority(id, t.model->priority);
+        }
+        if (m.waiters.empty()) {
+            return;
+        }
+
+        // the event list is ordered by priority, FIFO for equal ones; the
+        // woken task takes the mutex once it runs
+        auto best = m.waiters.begin();
+        for (auto it = m.waiters.begin(); it != m.waiters.end(); ++it) {
+            if (m_tasks[*it].priority > m_tasks[*best].priority) {
+                best = it;
+            }
+        }
+        const int waiter = *best;
+        m.waiters.erase(best);
+        m_tasks[waiter].blocking += m_now - m_tasks[waiter].blocked_since;
+        make_ready(waiter);
+    }
+
+    /*************************** jobs ***************************/
+
+    void start_job(int id, time_ns release) {
+        auto& t    = m_tasks[id];
+        t.in_job   = true;
+        t.release  = release;
+        t.blocking = 0;
+        t.segment  = 0;
+        enter_segment(t);
+    }
+
+    void enter_segment(task_run& t) {
+        t.remaining = m_random.execution(t.model->body[t.segment].duration,
+                                         t.model->bcet);
+        t.holds = false;
+    }
+
+    void finish_segment(int id) {
+        auto& t = m_tasks[id];
+        if (t.holds) {
+            release_mutex(id, t.model->body[t.segment].mutex);
+        }
+        if (++t.segment < t.model->body.size()) {
+            enter_segment(t);
+            return;
+        }
+
+        const time_ns response = m_now - t.release;
+        t.responses.record(static_cast<std::uint32_t>(std::min<time_ns>(
+            response, std::numeric_limits<std::uint32_t>::max())));
+        ++t.jobs;
+        t.min_response = std::min(t.min_response, response);
+        t.max_response = std::max(t.max_response, response);
+        t.max_blocking = std::max(t.max_blocking, t.blocking);
+        if (response > t.model->deadline) {
+            ++t.misses;
+        }
+        t.in_job = false;
+
+        if (t.model->period != 0) {
+            if (!t.backlog.empty()) {
+                // vTaskDelayUntil() returns at once, but still yields
+                start_job(id, t.backlog.front());
+                t.backlog.pop_front();
+                rotate(t.priority);
+            } else {
+                unready(id, task_state::delayed);
+            }
+        } else if (t.event_pending) {
+            t.event_pending = false;
+            start_job(id, t.event_time);
+            rotate(t.priority);
+        } else {
+            unready(id, task_state::waiting_event);
+        }
+    }
+
+    void release_periodic(int id) {
+        auto& t = m_tasks[id];
+        if (t.model->period == 0) {
+            return;
+        }
+        while (t.next_release_tick <= m_tick_count) {
+            const time_ns release = t.next_release_tick * tick_period;
+            if (t.state == task_state::delayed) {
+                start_job(id, release);
+                make_ready(id);
+            } else {
+                t.backlog.push_back(release);
+            }
+            t.next_release_tick += t.period_ticks;
+        }
+    }
+
+    // xSemaphoreGiveFromISR() on a binary semaphore
+    void give(int id, time_ns event) {
+        auto& t = m_tasks[id];
+        if (t.state == task_state::waiting_event) {
+            start_job(id, event);
+            make_ready(id);
+        } else if (!t.event_pending) {
+            t.event_pending = true;
+            t.event_time    = event;
+        } else {
+            ++t.lost_events;
+        }
+    }
+
+    /************************ interrupts ************************/
+
+    void trigger(source_run& s) {
+        if (s.pending) {
+            ++s.overruns;
+        } else {
+            s.pending       = true;
+            s.pending_since = s.next;
+        }
+        s.nominal += s.period;
+        s.next = s.nominal + m_random.between(0, s.jitter);
+    }
+
+    // NVIC: lower numbers win, ties go to the lower source (SysTick first)
+    void dispatch_interrupts() {
+        while (true) {
+            std::size_t best = m_sources.size();
+            for (std::size_t i = 0; i < m_sources.size(); ++i) {
+                const bool higher =
+                    best == m_sources.size() ||
+                    m_sources[i].irq_priority < m_sources[best].irq_priority;
+                if (m_sources[i].pending && higher) {
+                    best = i;
+                }
+            }
+            if (best == m_sources.size() ||
+                (!m_isrs.empty() && m_sources[best].irq_priority >=
+                                        m_sources[m_isrs.back().source]
+                                            .irq_priority)) {
+                return;
+            }
+            auto& s       = m_sources[best];
+            s.pending     = false;
+            s.max_latency = std::max(s.max_latency, m_now - s.pending_since);
+            m_isrs.push_back(
+                {best, m_random.execution(s.wcet, s.bcet), s.pending_since});
+        }
+    }
+
+    void finish_isr() {
+        const active_isr isr = m_isrs.back();
+        m_isrs.pop_back();
+        auto& s = m_sources[isr.source];
+        ++s.count;
+        if (isr.source == 0) {
+            tick();
+        } else if (s.wakes >= 0) {
+            give(s.wakes, isr.triggered);
+        }
+    }
+
+    // xTaskIncrementTick()
+    void tick() {
+        ++m_tick_count;
+        for (std::size_t id = 0; id < m_tasks.size(); ++id) {
+            release_periodic(static_cast<int>(id));
+        }
+        if (use_preemption && use_time_slicing && m_current >= 0 &&
+            m_tasks[m_current].state == task_state::ready) {
+            rotate(m_tasks[m_current].priority);
+        }
+    }
+
+    /*************************************************************/
+
+    void account(time_ns step) {
+        if (!m_isrs.empty()) {
+            m_isrs.back().remaining -= step;
+            m_sources[m_isrs.back().source].cpu += step;
+        } else if (m_current < 0) {
+            m_idle += step;
+        } else if (m_switch_left > 0) {
+            m_switch_left -= step;
+            m_switch_cpu += step;
+        } else {
+            m_tasks[m_current].remaining -= step;
+            m_tasks[m_current].cpu += step;
+        }
+    }
+
+    random_source m_random;
+    time_ns m_switch_cost{0};
+
+    std::vector<task_run> m_tasks{};
+    std::vector<mutex_run> m_mutexes{};
+    std::vector<source_run> m_sources{};
+    std::array<std::deque<int>, max_priorities> m_ready{};
+    std::vector<active_isr> m_isrs{};
+
+    time_ns m_now{0};
+    std::int64_t m_tick_count{0};
+    int m_current{-1};
+    time_ns m_switch_left{0};
+
+    time_ns m_switch_cpu{0};
+    time_ns m_idle{0};
+    std::uint64_t m_switches{0};
+};
+
+/********************************* report *********************************/
+
+double us(time_ns value) { return static_cast<double>(value) / 1000.0; }
+
+double percent(time_ns part, time_ns total) {
+    return total > 0 ? 100.0 * static_cast<double>(part) /
+                           static_cast<double>(total)
+                     : 0.0;
+}
+
+void report(const simulator& sim, time_ns duration, bool csv) {
+    if (csv) {
+        std::printf("task,priority,period_us,deadline_us,jobs,misses,lost,"
+                    "min_us,p50_us,p90_us,p99_us,max_us,max_blocking_us,"
+                    "cpu_percent\n");
+    } else {
+        std::printf("%-14s %4s %10s %10s %8s %6s %5s %9s %9s %9s %9s %9s "
+                    "%9s %6s\n",
+                    "task", "prio", "period[us]", "dline[us]", "jobs",
+                    "misses", "lost", "min[us]", "p50[us]", "p90[us]",
+                    "p99[us]", "max[us]", "block[us]", "cpu[%]");
+    }
+    const char* format =
+        csv ? "%s,%u,%.3f,%.3f,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,"
+              "%.2f\n"
+            : "%-14s %4u %10.1f %10.1f %8llu %6llu %5llu %9.1f %9.1f %9.1f "
+              "%9.1f %9.1f %9.1f %6.2f\n";
+    for (const auto& t : sim.tasks()) {
+        const time_ns min = t.jobs != 0 ? t.min_response : 0;
+        // the histogram reports the upper bound of a bucket
+        const auto quantile = [&t, min](double p) {
+            return us(std::clamp<time_ns>(t.responses.percentile(p), min,
+                                          t.max_response));
+        };
+        std::printf(format, t.model->name.c_str(), t.model->priority,
+                    us(t.model->period), us(t.model->deadline),
+                    static_cast<unsigned long long>(t.jobs),
+                    static_cast<unsigned long long>(t.misses),
+                    static_cast<unsigned long long>(t.lost_events), us(min),
+                    quantile(50.0), quantile(90.0), quantile(99.0),
+                    us(t.max_response), us(t.max_blocking),
+                    percent(t.cpu, duration));
+    }
+    if (csv) {
+        return;
+    }
+
+    std::printf("\n%-14s %4s %10s %8s %9s %12s %6s\n", "isr", "prio",
+                "period[us]", "count", "overruns", "latency[us]", "cpu[%]");
+    for (const auto& s : sim.sources()) {
+        std::printf("%-14s %4u %10.1f %8llu %9llu %12.1f %6.2f\n",
+                    s.name.c_str(), s.irq_priority, us(s.period),
+                    static_cast<unsigned long long>(s.count),
+                    static_cast<unsigned long long>(s.overruns),
+                    us(s.max_latency), percent(s.cpu, duration));
+    }
+    std::printf("\nswitches=%llu switch_cpu=%.2f%% idle=%.2f%%\n",
+                static_cast<unsigned long long>(sim.switches()),
+                percent(sim.switch_time(), duration),
+                percent(sim.idle_time(), duration));
+}
+
+void usage(const char* self) {
+    std::fprintf(stderr,
+                 "usage: %s [--seed N] [--duration-ms N] [--csv] model\n",
+                 self);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool csv                  = false;
+    std::uint64_t seed        = 1;
+    std::uint64_t duration_ms = 10'000;
+    const char* path          = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--csv") {
+            csv = true;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--duration-ms" && i + 1 < argc) {
+            duration_ms = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else if (path == nullptr) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (path == nullptr || duration_ms == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    model m;
+    if (!model_parser(path, m).parse()) {
+        return EXIT_FAILURE;
+    }
+
+    const time_ns duration = static_cast<time_ns>(duration_ms) * 1'000'000;
+    simulator sim(m, seed);
+    sim.run(duration);
+
+    if (!csv) {
+        std::printf("sched_sim version=1 seed=%llu duration_ms=%llu "
+                    "tick_hz=%u priorities=%u preemption=%d time_slicing=%d\n",
+                    static_cast<unsigned long long>(seed),
+                    static_cast<unsigned long long>(duration_ms),
+                    static_cast<unsigned>(configTICK_RATE_HZ), max_priorities,
+                    use_preemption ? 1 : 0, use_time_slicing ? 1 : 0);
+    }
+    report(sim, duration, csv);
+
+    const bool missed =
+        std::any_of(sim.tasks().begin(), sim.tasks().end(),
+                    [](const task_run& t) { return t.misses != 0; });
+    return missed ? 2 : EXIT_SUCCESS;
+}
@@ -0,0 +1,336 @@
+#!/usr/bin/env python3
+"""Worst-case stack depth report for the firmware images.
+
+Combines the per-function frame sizes emitted by gcc's ``-fstack-usage``
+(``*.su`` files next to the object files) with a static call graph that is
+extracted from the ``objdump -d`` disassembly of the linked ELF file.
+
+For every FreeRTOS task entry point and every interrupt handler the deepest
+call chain is computed.  Tasks are compared against their configured stack
+depth (in ``StackType_t`` words) and flagged if the configuration is too small
+or grossly oversized.
+
+The analysis is conservative but not complete:
+  - indirect calls (``blx rN``, function pointers, virtual calls) can not be
+    followed and are listed as such,
+  - recursion is detected and reported, the recursive edge is ignored,
+  - functions without ``.su`` information (assembly, libc) count as zero and
+    are listed as unknown.
+"""
+
+import argparse
+import pathlib
+import re
+import subprocess
+import sys
+
+# frame stacked by the core when a task gets interrupted (extended frame with
+# lazy FPU state: r0-r3, r12, lr, pc, xpsr, s0-s15, fpscr, reserved)
+EXCEPTION_FRAME_BYTES = 26 * 4
+# registers saved by xPortPendSVHandler on the task stack (r4-r11, r14 and
+# s16-s31 if the task used the FPU)
+CONTEXT_SWITCH_BYTES = (9 + 16) * 4
+
+SU_LINE = re.compile(r"^(?P<location>.*):(?P<name>[^:]+?)\t(?P<size>\d+)\t(?P<kind>\S+)$")
+FUNC_HEADER = re.compile(r"^[0-9a-f]+ <(?P<name>[^>]+)>:$")
+# thumb2 (bl, b.w, bne.n, ...) and x86 (call, jmp, jne, ...) for host builds,
+# the condition codes are spelled out, "bls"/"blt" are branches, not calls
+CALL_INSN = re.compile(r"\t(?P<op>blx?|b(?:eq|ne|cs|hs|cc|lo|mi|pl|vs|vc|hi|ls"
+                       r"|ge|lt|gt|le|al)?(?:\.[nw])?|call|j[a-z]+)"
+                       r"\s+[0-9a-f]+ <(?P<target>[^>+]+)"
+                       r"(?P<offset>\+0x[0-9a-f]+)?>")
+CALL_OPS = ("bl", "blx", "call")
+INDIRECT_INSN = re.compile(r"\t(?:blx\s+(?:r\d+|ip|lr)\b|call\s+\*)")
+CONFIG_DEFINE = re.compile(r"^#define\s+(?P<name>\w+)\s+(?P<value>.+?)\s*$")
+ISR_NAME = re.compile(r".*_(IRQ)?Handler$")
+
+
+def function_key(name):
+    """Normalizes a function name so .su and objdump -C names can be matched.
+
+    C names are used as they are.  For C++ the .su file contains the return
+    type ("void TaskA(void*)") while objdump prints "TaskA(void*)", and the
+    two spell anonymous namespaces differently.
+    """
+    name = name.strip().replace("(anonymous namespace)", "{anonymous}")
+    paren = name.find("(")
+    if paren < 0:
+        return name
+
+    depth = 0
+    for idx in range(paren - 1, -1, -1):
+        char = name[idx]
+        if char in ">)":
+            depth += 1
+        elif char in "<(":
+            depth -= 1
+        elif char == " " and depth == 0:
+            return name[idx + 1:]
+    return name
+
+
+def read_stack_usage(su_dirs):
+    frames = {}
+    dynamic = set()
+    for su_dir in su_dirs:
+        for su_file in pathlib.Path(su_dir).rglob("*.su"):
+            for line in su_file.read_text(errors="replace").splitlines():
+                match = SU_LINE.match(line)
+                if not match:
+                    continue
+                key = function_key(match.group("name"))
+                size = int(match.group("size"))
+                # static functions may exist more than once, keep the worst
+                frames[key] = max(size, frames.get(key, 0))
+                if match.group("kind").startswith("dynamic") and \
+                        "bounded" not in match.group("kind"):
+                    dynamic.add(key)
+    return frames, dynamic
+
+
+def read_call_graph(objdump, elf):
+    listing = subprocess.run([objdump, "-d", "-C", "--no-show-raw-insn", elf],
+                             check=True, capture_output=True,
+                             text=True).stdout
+    calls = {}
+    tail_calls = {}
+    indirect = set()
+    current = None
+    for line in listing.splitlines():
+        header = FUNC_HEADER.match(line)
+        if header:
+            current = function_key(header.group("name"))
+            calls.setdefault(current, set())
+            tail_calls.setdefault(current, set())
+            continue
+        if current is None:
+            continue
+
+        if INDIRECT_INSN.search(line):
+            indirect.add(current)
+            continue
+
+        call = CALL_INSN.search(line)
+        if not call:
+            continue
+        target = function_key(call.group("target"))
+        if call.group("op") in CALL_OPS:
+            if target != current:
+                calls[current].add(target)
+        elif target != current and not call.group("offset"):
+            # branch to the start of another function: tail call, the frame of
+            # the caller is already released at this point
+            tail_calls[current].add(target)
+    return calls, tail_calls, indirect
+
+
+class StackAnalysis:
+    def __init__(self, frames, calls, tail_calls):
+        self.frames = frames
+        self.calls = calls
+        self.tail_calls = tail_calls
+        self.depth = {}
+        self.path = {}
+        self._cache = {}
+        self.recursive = set()
+        self.unknown = set()
+
+    def worst_case(self, func):
+        """Returns the worst-case depth (bytes) of func and records its path."""
+        depth, path, _ = self._visit(func, [])
+        self.depth[func] = depth
+        self.path[func] = path
+        return depth
+
+    def _visit(self, func, active):
+        """Returns (depth, path, cut) of func.
+
+        `cut` tells that a recursion was cut off below func.  The depth then
+        depends on the path func was reached on, e.g. b in a -> b -> c -> b
+        counts c once but c in a -> c -> b -> c counts b once, so only results
+        without a cut are cached.
+        """
+        if func in self._cache:
+            return self._cache[func] + (False,)
+        if func in active:
+            self.recursive.add(func)
+            return 0, [func], True
+
+        if func not in self.frames and func in self.calls:
+            self.unknown.add(func)
+        own = self.frames.get(func, 0)
+
+        active.append(func)
+        worst, worst_path, cut = own, [func], False
+        for callee in sorted(self.calls.get(func, ())):
+            depth, path, callee_cut = self._visit(callee, active)
+            cut |= callee_cut
+            if own + depth > worst:
+                worst, worst_path = own + depth, [func] + path
+        for callee in sorted(self.tail_calls.get(func, ())):
+            depth, path, callee_cut = self._visit(callee, active)
+            cut |= callee_cut
+            if depth > worst:
+                worst, worst_path = depth, [func] + path
+        active.pop()
+
+        if not cut:
+            self._cache[func] = worst, worst_path
+        return worst, worst_path, cut
+
+    def reaches(self, func, candidates):
+        seen, todo = set(), [func]
+        while todo:
+            current = todo.pop()
+            if current in seen:
+                continue
+            seen.add(current)
+            todo.extend(self.calls.get(current, ()))
+            todo.extend(self.tail_calls.get(current, ()))
+        return sorted(seen & candidates)
+
+
+def resolve(name, calls):
+    """Allows task entries without their parameter list and namespaces.
+
+    "bench_task" matches "{anonymous}::bench_task(void*)", a qualified name
+    like "dis::detail::tx_task" picks one of several static functions.
+    """
+    if name in calls:
+        return name
+
+    def plain(key):
+        return key.replace("{anonymous}::", "")
+
+    for matches in ((key for key in calls if plain(key).startswith(name + "(")),
+                    (key for key in calls
+                     if ("::" + plain(key)).find("::" + name + "(") >= 0)):
+        overloads = sorted(matches)
+        if overloads:
+            return overloads[0]
+    return name
+
+
+def read_freertos_config(path):
+    values = {}
+    for line in pathlib.Path(path).read_text(errors="replace").splitlines():
+        match = CONFIG_DEFINE.match(line.strip())
+        if not match:
+            continue
+        # last number skips casts like ((uint16_t)128)
+        digits = re.findall(r"\d+", match.group("value"))
+        if digits:
+            values[match.group("name")] = int(digits[-1])
+    return values
+
+
+def parse_tasks(task_args, config, word_size):
+    tasks = {}
+    if config:
+        if "configMINIMAL_STACK_SIZE" in config:
+            tasks["prvIdleTask"] = config["configMINIMAL_STACK_SIZE"]
+        if config.get("configUSE_TIMERS", 0) and \
+                "configTIMER_TASK_STACK_DEPTH" in config:
+            tasks["prvTimerTask"] = config["configTIMER_TASK_STACK_DEPTH"]
+    for task in task_args:
+        name, _, words = task.partition("=")
+        tasks[function_key(name)] = int(words)
+    return {name: words * word_size for name, words in tasks.items()}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--elf", required=True)
+    parser.add_argument("--objdump", default="objdump")
+    parser.add_argument("--su-dir", action="append", default=[],
+                        help="directory searched recursively for *.su files")
+    parser.add_argument("--freertos-config",
+                        help="FreeRTOSConfig.h used for the idle/timer task")
+    parser.add_argument("--task", action="append", default=[],
+                        help="task entry point and its stack depth in words, "
+                             "e.g. usbTxTask=256")
+    parser.add_argument("--word-size", type=int, default=4)
+    parser.add_argument("--oversize-factor", type=float, default=2.0,
+                        help="flag tasks configured larger than factor * need")
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--warn-only", action="store_true",
+                        help="exit with 0 even if a task stack is too small")
+    args = parser.parse_args()
+
+    frames, dynamic = read_stack_usage(args.su_dir or ["."])
+    calls, tail_calls, indirect = read_call_graph(args.objdump, args.elf)
+    config = read_freertos_config(args.freertos_config) \
+        if args.freertos_config else {}
+    tasks = parse_tasks(args.task, config, args.word_size)
+    analysis = StackAnalysis(frames, calls, tail_calls)
+
+    task_overhead = EXCEPTION_FRAME_BYTES + CONTEXT_SWITCH_BYTES
+    lines = [
+        "worst-case stack usage of {}".format(pathlib.Path(args.elf).name),
+        "task stacks include {} bytes for the exception frame and the "
+        "context saved by PendSV".format(task_overhead),
+        "",
+        "{:<32} {:>9} {:>9} {:>9}  {}".format("task", "need", "config",
+                                              "margin", "status"),
+    ]
+
+    failed = False
+    for task, configured in sorted(tasks.items()):
+        task = resolve(task, calls)
+        if task not in calls:
+            lines.append("{:<32} {:>9} {:>9} {:>9}  {}".format(
+                task, "-", configured, "-", "not linked"))
+            continue
+        need = analysis.worst_case(task) + task_overhead
+        if need > configured:
+            status = "TOO SMALL"
+            failed = True
+        elif configured > need * args.oversize_factor:
+            status = "OVERSIZED (need {} words)".format(
+                -(-need // args.word_size))
+        else:
+            status = "ok"
+        lines.append("{:<32} {:>9} {:>9} {:>9}  {}".format(
+            task, need, configured, configured - need, status))
+
+    isrs = sorted(name for name in calls if ISR_NAME.match(name))
+    lines += ["", "{:<32} {:>9}".format("interrupt handler", "need")]
+    for isr in isrs:
+        need = analysis.worst_case(isr)
+        lines.append("{:<32} {:>9}".format(isr, need))
+    lines.append("{:<32} {:>9}  (sum of all handlers, upper bound for the "
+                 "main stack with nesting)".format(
+                     "all nested", sum(analysis.depth[i] for i in isrs)))
+
+    lines += ["", "worst-case call chains:"]
+    for entry in sorted(resolve(t, calls) for t in tasks) + isrs:
+        if entry not in analysis.path:
+            continue
+        lines.append("  {}: {}".format(entry, " -> ".join(analysis.path[entry])))
+
+    interesting = {resolve(t, calls) for t in tasks} | set(isrs)
+    for title, candidates in (("indirect calls (not followed)", indirect),
+                              ("dynamic stack allocation", dynamic),
+                              ("recursion (ignored edge)", analysis.recursive),
+                              ("no stack usage information",
+                               analysis.unknown)):
+        affected = {}
+        for entry in sorted(interesting & set(analysis.path)):
+            hits = analysis.reaches(entry, set(candidates))
+            if hits:
+                affected[entry] = hits
+        if affected:
+            lines += ["", title + ":"]
+            for entry, hits in affected.items():
+                lines.append("  {}: {}".format(entry, ", ".join(hits)))
+
+    pathlib.Path(args.output).write_text("\n".join(lines) + "\n")
+    if failed:
+        print("stack_usage: at least one task stack is too small, see {}"
+              .format(args.output), file=sys.stderr)
+        return 0 if args.warn_only else 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,371 @@
+// Converts a dump of the dis::trace flight recorder (see
+// dis/osal/trace/format.hpp) into the Chrome trace event format, which can be
+// opened with chrome://tracing or https://ui.perfetto.dev
+//
+//   trace2chrome [--cpu-hz HZ] trace.bin [trace.json]
+
+#include "dis/osal/trace/format.hpp"
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace dis::trace;
+
+constexpr std::uint32_t default_cpu_hz = 216'000'000;
+constexpr int task_pid                 = 1;
+constexpr int isr_pid                  = 2;
+
+struct name_key {
+    bool task;
+    std::uint16_t id;
+    auto operator<=>(const name_key&) const = default;
+};
+
+struct dump {
+    dump_header header{};
+    std::map<name_key, std::string> names{};
+    std::vector<event> events{};  // oldest first
+};
+
+template <typename T>
+bool read_at(const std::vector<char>& data, std::size_t offset, T& out) {
+    if (offset + sizeof(T) > data.size()) {
+        return false;
+    }
+    std::memcpy(&out, data.data() + offset, sizeof(T));
+    return true;
+}
+
+bool parse(const std::vector<char>& data, dump& result) {
+    auto& hdr = result.header;
+    if (!read_at(data, 0, hdr) || hdr.magic != dump_magic) {
+        std::fprintf(stderr, "error: not a dis::trace dump\n");
+        return false;
+    }
+    if (hdr.version != dump_version || hdr.event_size != sizeof(event)) {
+        std::fprintf(stderr, "error: unsupported dump version %u\n",
+                     hdr.version);
+        return false;
+    }
+
+    std::size_t offset = sizeof(dump_header);
+    const std::uint32_t name_count =
+        std::min(hdr.names_written, hdr.name_capacity);
+    for (std::uint32_t i = 0; i < hdr.name_capacity; ++i) {
+        name_entry entry{};
+        if (!read_at(data, offset + i * sizeof(name_entry), entry)) {
+            std::fprintf(stderr, "error: truncated name table\n");
+            return false;
+        }
+        if (i < name_count) {
+            const bool task = entry.kind == object_kind::task;
+            result.names[{task, entry.id}] = std::string(
+                entry.name, strnlen(entry.name, sizeof(entry.name)));
+        }
+    }
+    offset += hdr.name_capacity * sizeof(name_entry);
+
+    const std::uint32_t count =
+        std::min(hdr.events_written, hdr.event_capacity);
+    const std::uint32_t first =
+        hdr.events_written > hdr.event_capacity
+            ? hdr.events_written % hdr.event_capacity
+            : 0;
+    result.events.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const std::uint32_t slot = (first + i) % hdr.event_capacity;
+        event evt{};
+        if (!read_at(data, offset + slot * sizeof(event), evt)) {
+            std::fprintf(stderr, "error: truncated event ring\n");
+            return false;
+        }
+        result.events.push_back(evt);
+    }
+    return true;
+}
+
+std::string json_escape(std::string_view text) {
+    std::string result;
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            result += buffer;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+const char* event_name(event_type type) {
+    switch (type) {
+        case event_type::task_create: return "task_create";
+        case event_type::task_delete: return "task_delete";
+        case event_type::task_delay: return "task_delay";
+        case event_type::task_suspend: return "task_suspend";
+        case event_type::task_resume: return "task_resume";
+        case event_type::task_ready: return "task_ready";
+        case event_type::task_notify: return "task_notify";
+        case event_type::task_notify_take: return "task_notify_take";
+        case event_type::task_notify_block: return "task_notify_block";
+        case event_type::object_create: return "object_create";
+        case event_type::object_delete: return "object_delete";
+        case event_type::queue_send: return "queue_send";
+        case event_type::queue_send_failed: return "queue_send_failed";
+        case event_type::queue_send_from_isr: return "queue_send_from_isr";
+        case event_type::queue_receive: return "queue_receive";
+        case event_type::queue_receive_failed: return "queue_receive_failed";
+        case event_type::queue_receive_from_isr:
+            return "queue_receive_from_isr";
+        case event_type::queue_block_send: return "queue_block_send";
+        case event_type::queue_block_receive: return "queue_block_receive";
+        case event_type::stream_send: return "stream_send";
+        case event_type::stream_send_from_isr: return "stream_send_from_isr";
+        case event_type::stream_receive: return "stream_receive";
+        case event_type::stream_receive_from_isr:
+            return "stream_receive_from_isr";
+        case event_type::stream_block_send: return "stream_block_send";
+        case event_type::stream_block_receive: return "stream_block_receive";
+        case event_type::user: return "user";
+        default: return "unknown";
+    }
+}
+
+bool is_task_event(event_type type) {
+    return type >= event_type::task_switched_in &&
+           type < event_type::isr_enter;
+}
+
+class chrome_writer {
+public:
+    chrome_writer(std::FILE* out, const dump& trace, std::uint32_t cpu_hz)
+        : m_out(out), m_trace(trace), m_cpu_hz(cpu_hz) {}
+
+    void write() {
+        std::fprintf(m_out,
+                     "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        metadata(task_pid, -1, "process_name", "tasks");
+        metadata(isr_pid, -1, "process_name", "interrupts");
+        for (const auto& [key, name] : m_trace.names) {
+            if (key.task) {
+                metadata(task_pid, key.id, "thread_name", name);
+            }
+        }
+
+        std::uint64_t now  = 0;
+        std::uint32_t last = m_trace.events.empty()
+                                 ? 0
+                                 : m_trace.events.front().timestamp;
+        for (const auto& evt : m_trace.events) {
+            // the 32 bit timestamps are unwrapped on the assumption that two
+            // consecutive events are less than 2^31 cycles apart, a stamp
+            // behind the last one (recorded by an older target) is clamped
+            const auto delta = static_cast<std::int32_t>(evt.timestamp - last);
+            if (delta > 0) {
+                now += static_cast<std::uint32_t>(delta);
+                last = evt.timestamp;
+            }
+            handle(evt, now);
+        }
+
+        if (m_current_task >= 0) {
+            slice_end(task_pid, m_current_task, now);
+        }
+        while (!m_isr_stack.empty()) {
+            slice_end(isr_pid, m_isr_stack.back(), now);
+            m_isr_stack.pop_back();
+        }
+        std::fprintf(m_out, "\n]}\n");
+    }
+
+private:
+    void handle(const event& evt, std::uint64_t now) {
+        switch (evt.type) {
+            case event_type::task_switched_in:
+                if (m_current_task == evt.id) {
+                    return;
+                }
+                if (m_current_task >= 0) {
+                    slice_end(task_pid, m_current_task, now);
+                }
+                m_current_task = evt.id;
+                slice_begin(task_pid, evt.id, task_name(evt.id), now);
+                return;
+            case event_type::isr_enter:
+                m_isr_stack.push_back(evt.id);
+                slice_begin(isr_pid, evt.id, isr_name(evt.id), now);
+                return;
+            case event_type::isr_exit:
+                if (!m_isr_stack.empty()) {
+                    slice_end(isr_pid, m_isr_stack.back(), now);
+                    m_isr_stack.pop_back();
+                }
+                return;
+            default: instant(evt, now); return;
+        }
+    }
+
+    std::string task_name(std::uint16_t id) const {
+        const auto it = m_trace.names.find({true, id});
+        return it != m_trace.names.end() ? it->second
+                                         : "task " + std::to_string(id);
+    }
+
+    std::string object_name(std::uint16_t id) const {
+        const auto it = m_trace.names.find({false, id});
+        return it != m_trace.names.end() ? it->second
+                                         : "object " + std::to_string(id);
+    }
+
+    static std::string isr_name(std::uint16_t exception) {
+        switch (exception) {
+            case 11: return "SVCall";
+            case 14: return "PendSV";
+            case 15: return "SysTick";
+            default:
+                return exception >= 16
+                           ? "IRQ " + std::to_string(exception - 16)
+                           : "exception " + std::to_string(exception);
+        }
+    }
+
+    void instant(const event& evt, std::uint64_t now) {
+        const std::string subject = is_task_event(evt.type)
+                                        ? task_name(evt.id)
+                                        : object_name(evt.id);
+        int pid = task_pid;
+        int tid = m_current_task;
+        if (!m_isr_stack.empty()) {
+            pid = isr_pid;
+            tid = m_isr_stack.back();
+        }
+        separator();
+        std::fprintf(m_out,
+                     "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,"
+                     "\"tid\":%d,\"ts\":%.3f,\"args\":{\"id\":%u,"
+                     "\"subject\":\"%s\",\"detail\":%u}}",
+                     event_name(evt.type), pid, tid, micros(now), evt.id,
+                     json_escape(subject).c_str(), evt.detail);
+    }
+
+    void slice_begin(int pid, int tid, const std::string& name,
+                     std::uint64_t now) {
+        separator();
+        std::fprintf(m_out,
+                     "{\"name\":\"%s\",\"ph\":\"B\",\"pid\":%d,\"tid\":%d,"
+                     "\"ts\":%.3f}",
+                     json_escape(name).c_str(), pid, tid, micros(now));
+    }
+
+    void slice_end(int pid, int tid, std::uint64_t now) {
+        separator();
+        std::fprintf(m_out,
+                     "{\"ph\":\"E\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}", pid,
+                     tid, micros(now));
+    }
+
+    void metadata(int pid, int tid, const char* kind,
+                  const std::string& name) {
+        separator();
+        std::fprintf(m_out,
+                     "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                     "\"args\":{\"name\":\"%s\"}}",
+                     kind, pid, tid < 0 ? 0 : tid, json_escape(name).c_str());
+    }
+
+    void separator() {
+        if (m_first) {
+            m_first = false;
+        } else {
+            std::fprintf(m_out, ",\n");
+        }
+    }
+
+    [[nodiscard]] double micros(std::uint64_t cycles) const {
+        return static_cast<double>(cycles) * 1e6 / m_cpu_hz;
+    }
+
+    std::FILE* m_out;
+    const dump& m_trace;
+    std::uint32_t m_cpu_hz;
+    bool m_first         = true;
+    int m_current_task   = -1;
+    std::vector<int> m_isr_stack{};
+};
+
+void usage(const char* self) {
+    std::fprintf(stderr, "usage: %s [--cpu-hz HZ] trace.bin [trace.json]\n",
+                 self);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::uint32_t cpu_hz = 0;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--cpu-hz" && i + 1 < argc) {
+            cpu_hz = static_cast<std::uint32_t>(
+                std::strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty() || files.size() > 2) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream input(files[0], std::ios::binary);
+    if (!input) {
+        std::fprintf(stderr, "error: can not open %s\n", files[0]);
+        return EXIT_FAILURE;
+    }
+    const std::vector<char> data{std::istreambuf_iterator<char>(input),
+                                 std::istreambuf_iterator<char>()};
+
+    dump trace;
+    if (!parse(data, trace)) {
+        return EXIT_FAILURE;
+    }
+    if (cpu_hz == 0) {
+        cpu_hz = trace.header.cpu_hz != 0 ? trace.header.cpu_hz
+                                          : default_cpu_hz;
+    }
+
+    std::FILE* out = stdout;
+    if (files.size() == 2) {
+        out = std::fopen(files[1], "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "error: can not open %s\n", files[1]);
+            return EXIT_FAILURE;
+        }
+    }
+    chrome_writer(out, trace, cpu_hz).write();
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    std::fprintf(stderr, "%zu events, %zu names, %u Hz\n",
+                 trace.events.size(), trace.names.size(), cpu_hz);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,576 @@
+// Drives the USB CDC benchmark firmware (src/main_vcom_bench.cpp)
+//
+//   vcom_bench [--chunks N,N,...] [--bytes N] [--pings N] [--load PERMILLE]
+//              [--csv] TARGET...
+//
+// A target is either the tty of the board (e.g. /dev/ttyACM0, it is switched
+// to raw mode) or a host build of the firmware (e.g.
+// build-posix/host/vcom_bench_1024x2_1024), which is started on a pseudo
+// terminal: its stdin and stdout are the virtual com port, so the benchmark
+// also runs in CI without a board.  The targets are measured one after the
+// other, pass the host builds of all buffer configurations to sweep them.
+//
+// For every chunk size (sizes above the transmit buffer of the target are
+// skipped)
+//  - --bytes are streamed in both directions at the same time in blocks of
+//    the chunk size: MB/s from the host's view (in) and the device's (out),
+//    lost and corrupted blocks per direction
+//  - --pings blocks are echoed one at a time: round trip min/median/p99
+//  - the firmware reports the utilization during the stream, of its usbTx
+//    task, of the interrupts and of the CPU as a whole (all but idle)
+// With --load the firmware burns that share (in 1/1000) of the CPU in a task
+// above the USB transmit task during the runs.
+//
+// The exit code is 1 on errors, 2 if any block got lost or corrupted.
+
+#include "dis/bench/vcom_block.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/// the device answers within its block timeout (1s) plus the USB latency
+constexpr int reply_timeout_ms   = 3000;
+constexpr int handshake_attempts = 3;
+
+struct options {
+    std::vector<std::size_t> chunks{16, 64, 256, 1024, 4096};
+    std::size_t bytes{1U << 20U};
+    std::size_t pings{200};
+    unsigned load{0};
+    bool csv{false};
+};
+
+struct device_info {
+    std::size_t tx_bytes{0};
+    std::size_t tx_buffers{0};
+    std::size_t rx_bytes{0};
+};
+
+struct row {
+    std::size_t chunk{0};
+    double in_mbps{0};
+    double out_mbps{0};
+    std::uint64_t in_lost{0};
+    std::uint64_t in_bad{0};
+    std::uint64_t out_lost{0};
+    std::uint64_t out_bad{0};
+    double rtt_min_us{0};
+    double rtt_median_us{0};
+    double rtt_p99_us{0};
+    std::uint64_t ping_lost{0};
+    double usbtx_percent{0};
+    double isr_percent{0};
+    double cpu_percent{0};
+};
+
+void usage(const char* name) {
+    std::fprintf(stderr,
+                 "usage: %s [--chunks N,N,...] [--bytes N] [--pings N] "
+                 "[--load PERMILLE] [--csv] TARGET...\n",
+                 name);
+}
+
+/// value of `name=` in a line of space separated key value pairs
+std::optional<std::string_view> field(std::string_view line,
+                                      std::string_view name) {
+    std::size_t pos = 0;
+    while (pos < line.size()) {
+        const std::size_t end = std::min(line.find(' ', pos), line.size());
+        const std::string_view token = line.substr(pos, end - pos);
+        if (token.size() > name.size() && token.starts_with(name) &&
+            token[name.size()] == '=') {
+            return token.substr(name.size() + 1);
+        }
+        pos = end + 1;
+    }
+    return std::nullopt;
+}
+
+std::uint64_t number(std::string_view line, std::string_view name) {
+    const auto value = field(line, name);
+    return value ? std::strtoull(std::string(*value).c_str(), nullptr, 10)
+                 : 0U;
+}
+
+std::vector<std::size_t> parse_list(const char* text) {
+    std::vector<std::size_t> values;
+    const char* pos = text;
+    while (*pos != '\0') {
+        char* end = nullptr;
+        values.push_back(std::strtoul(pos, &end, 0));
+        if (end == pos) {
+            return {};
+        }
+        pos = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+}
+
+/// the serial line to one target, the process of a host build included
+class serial_line {
+public:
+    serial_line() = default;
+
+    serial_line(const serial_line&)            = delete;
+    serial_line& operator=(const serial_line&) = delete;
+
+    ~serial_line() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+        if (m_child > 0) {
+            ::kill(m_child, SIGTERM);
+            ::waitpid(m_child, nullptr, 0);
+        }
+    }
+
+    bool open(const char* target) {
+        struct stat info {};
+        if (::stat(target, &info) != 0) {
+            std::fprintf(stderr, "error: can not find %s\n", target);
+            return false;
+        }
+        return S_ISCHR(info.st_mode) ? open_tty(target) : spawn(target);
+    }
+
+    /// writes all of `data`, false if the line is gone
+    bool write(std::span<const std::byte> data) const {
+        while (!data.empty()) {
+            const ssize_t result = ::write(m_fd, data.data(), data.size());
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0) {
+                return false;
+            }
+            data = data.subspan(static_cast<std::size_t>(result));
+        }
+        return true;
+    }
+
+    bool write(std::string_view text) const {
+        return write(std::as_bytes(std::span{text.data(), text.size()}));
+    }
+
+    /// fills `data`, false if nothing arrived for `timeout_ms`
+    bool read(std::span<std::byte> data, int timeout_ms) const {
+        while (!data.empty()) {
+            pollfd request{m_fd, POLLIN, 0};
+            const int ready = ::poll(&request, 1, timeout_ms);
+            if (ready < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ready <= 0) {
+                return false;
+            }
+            const ssize_t result = ::read(m_fd, data.data(), data.size());
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0) {
+                return false;
+            }
+            data = data.subspan(static_cast<std::size_t>(result));
+        }
+        return true;
+    }
+
+    /// appends up to the line end to `line` (which may hold its start)
+    bool read_line(std::string& line, int timeout_ms) const {
+        for (;;) {
+            std::byte next{};
+            if (!read({&next, 1}, timeout_ms)) {
+                return false;
+            }
+            const auto ch = static_cast<char>(next);
+            if (ch == '\n') {
+                return true;
+            }
+            if (ch != '\r') {
+                line.push_back(ch);
+            }
+        }
+    }
+
+private:
+    static bool make_raw(int fd) {
+        termios mode{};
+        if (::tcgetattr(fd, &mode) != 0) {
+            return false;
+        }
+        ::cfmakeraw(&mode);
+        return ::tcsetattr(fd, TCSANOW, &mode) == 0;
+    }
+
+    bool open_tty(const char* path) {
+        m_fd = ::open(path, O_RDWR | O_NOCTTY);
+        if (m_fd < 0 || !make_raw(m_fd)) {
+            std::fprintf(stderr, "error: can not open %s\n", path);
+            return false;
+        }
+        // drop what the device sent before
+        (void)::tcflush(m_fd, TCIOFLUSH);
+        return true;
+    }
+
+    /// starts the host build with a pseudo terminal as stdin and stdout
+    bool spawn(const char* program) {
+        m_fd = ::posix_openpt(O_RDWR | O_NOCTTY);
+        if (m_fd < 0 || ::grantpt(m_fd) != 0 || ::unlockpt(m_fd) != 0) {
+            std::fprintf(stderr, "error: no pseudo terminal for %s\n",
+                         program);
+            return false;
+        }
+        // raw before the program starts, so nothing gets echoed
+        const int terminal = ::open(::ptsname(m_fd), O_RDWR | O_NOCTTY);
+        if (terminal < 0 || !make_raw(terminal)) {
+            std::fprintf(stderr, "error: no pseudo terminal for %s\n",
+                         program);
+            return false;
+        }
+
+        m_child = ::fork();
+        if (m_child == 0) {
+            ::setsid();
+            ::dup2(terminal, STDIN_FILENO);
+            ::dup2(terminal, STDOUT_FILENO);
+            ::close(terminal);
+            ::close(m_fd);
+            ::execl(program, program, static_cast<char*>(nullptr));
+            std::fprintf(stderr, "error: can not run %s\n", program);
+            std::_Exit(EXIT_FAILURE);
+        }
+        ::close(terminal);
+        if (m_child < 0) {
+            std::fprintf(stderr, "error: can not run %s\n", program);
+            return false;
+        }
+        return true;
+    }
+
+    int m_fd{-1};
+    pid_t m_child{-1};
+};
+
+/// reads the next text line, skipping leftovers of an aborted run
+std::optional<std::string> expect_line(const serial_line& line,
+                                       std::string_view prefix) {
+    for (;;) {
+        std::string text;
+        if (!line.read_line(text, reply_timeout_ms)) {
+            return std::nullopt;
+        }
+        if (text.starts_with(prefix)) {
+            return text;
+        }
+        if (text.starts_with("error")) {
+            std::fprintf(stderr, "device: %s\n", text.c_str());
+            return std::nullopt;
+        }
+    }
+}
+
+std::optional<device_info> handshake(const serial_line& line) {
+    for (int attempt = 0; attempt < handshake_attempts; ++attempt) {
+        // the line end terminates whatever a previous session left behind
+        if (!line.write("\ninfo\n")) {
+            return std::nullopt;
+        }
+        for (;;) {
+            std::string text;
+            if (!line.read_line(text, reply_timeout_ms)) {
+                break;
+            }
+            if (text.starts_with("begin vcom_bench")) {
+                return device_info{number(text, "tx_bytes"),
+                                   number(text, "tx_buffers"),
+                                   number(text, "rx_bytes")};
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+double percent(std::string_view line, std::string_view name) {
+    return static_cast<double>(number(line, name)) / 10.0;
+}
+
+double mbps(std::uint64_t bytes, double seconds) {
+    return seconds > 0 ? static_cast<double>(bytes) / seconds / 1e6 : 0.0;
+}
+
+/// both directions at once, fills the stream columns of `result`
+bool run_stream(const serial_line& line,
+                const options& opts,
+                std::size_t chunk,
+                row& result) {
+    const std::size_t blocks = std::max<std::size_t>(opts.bytes / chunk, 1);
+    char command[128];
+    std::snprintf(command, sizeof(command),
+                  "stream chunk=%zu blocks=%zu in=1 out=1 load=%u\n", chunk,
+                  blocks, opts.load);
+    if (!line.write(command)) {
+        return false;
+    }
+    const auto start = clock_type::now();
+
+    std::atomic<bool> written{true};
+    std::thread writer([&line, &written, chunk, blocks] {
+        std::vector<std::byte> block(chunk);
+        for (std::size_t sequence = 0; sequence < blocks; ++sequence) {
+            dis::bench::fill_block(block,
+                                   static_cast<std::uint32_t>(sequence));
+            if (!line.write(block)) {
+                written = false;
+                return;
+            }
+        }
+    });
+
+    std::vector<std::byte> block(chunk);
+    std::uint64_t expected = 0;
+    std::uint64_t received = 0;
+    auto last              = start;
+    std::string text;
+    bool ok = true;
+    while (expected < blocks) {
+        const auto head = std::span{block}.first(dis::bench::block_header);
+        if (!line.read(head, reply_timeout_ms)) {
+            ok = false;
+            break;
+        }
+        const auto check = dis::bench::check_block(head);
+        if (check.state != dis::bench::block_state::ok) {
+            // the device gave up early, this is its result line
+            text.assign(reinterpret_cast<const char*>(head.data()),
+                        head.size());
+            break;
+        }
+        if (!line.read(std::span{block}.subspan(head.size()),
+                       reply_timeout_ms)) {
+            ok = false;
+            break;
+        }
+        if (dis::bench::check_block(block).state !=
+            dis::bench::block_state::ok) {
+            ++result.in_bad;
+        } else {
+            ++received;
+        }
+        if (check.sequence > expected) {
+            result.in_lost += check.sequence - expected;
+        }
+        expected = check.sequence + 1U;
+        last     = clock_type::now();
+    }
+    writer.join();
+    result.in_lost += blocks - std::min<std::uint64_t>(expected, blocks);
+
+    if (!ok || !written) {
+        std::fprintf(stderr, "error: stream chunk=%zu stalled\n", chunk);
+        return false;
+    }
+    if (text.empty() || !text.starts_with("result")) {
+        const auto reply = expect_line(line, "result mode=stream");
+        if (!reply) {
+            return false;
+        }
+        text = *reply;
+    } else if (!line.read_line(text, reply_timeout_ms)) {
+        return false;
+    }
+
+    result.in_mbps =
+        mbps(received * chunk, std::chrono::duration<double>(last - start)
+                                   .count());
+    result.out_mbps = mbps(number(text, "rx_blocks") * chunk,
+                           static_cast<double>(number(text, "rx_us")) / 1e6);
+    result.out_lost      = number(text, "rx_lost");
+    result.out_bad       = number(text, "rx_bad");
+    result.usbtx_percent = percent(text, "usbtx_permille");
+    result.isr_percent   = percent(text, "isr_permille");
+    result.cpu_percent   = 100.0 - percent(text, "idle_permille");
+    return true;
+}
+
+/// one block at a time, fills the round trip columns of `result`
+bool run_ping(const serial_line& line,
+              const options& opts,
+              std::size_t chunk,
+              row& result) {
+    if (opts.pings == 0) {
+        return true;
+    }
+    char command[128];
+    std::snprintf(command, sizeof(command),
+                  "ping chunk=%zu blocks=%zu load=%u\n", chunk, opts.pings,
+                  opts.load);
+    if (!line.write(command)) {
+        return false;
+    }
+
+    std::vector<std::byte> block(chunk);
+    std::vector<std::byte> echo(chunk);
+    std::vector<double> rtt_us;
+    rtt_us.reserve(opts.pings);
+    for (std::size_t sequence = 0; sequence < opts.pings; ++sequence) {
+        dis::bench::fill_block(block, static_cast<std::uint32_t>(sequence));
+        const auto sent = clock_type::now();
+        if (!line.write(block) || !line.read(echo, reply_timeout_ms)) {
+            std::fprintf(stderr, "error: ping chunk=%zu stalled\n", chunk);
+            return false;
+        }
+        rtt_us.push_back(std::chrono::duration<double, std::micro>(
+                             clock_type::now() - sent)
+                             .count());
+        if (echo != block) {
+            ++result.ping_lost;
+        }
+    }
+    if (!expect_line(line, "result mode=ping")) {
+        return false;
+    }
+
+    std::sort(rtt_us.begin(), rtt_us.end());
+    result.rtt_min_us    = rtt_us.front();
+    result.rtt_median_us = rtt_us[rtt_us.size() / 2];
+    result.rtt_p99_us    = rtt_us[(rtt_us.size() * 99) / 100];
+    return true;
+}
+
+void print_header(bool csv) {
+    if (csv) {
+        std::printf(
+            "config,chunk,in_mbps,out_mbps,in_lost,in_bad,out_lost,out_bad,"
+            "rtt_min_us,rtt_median_us,rtt_p99_us,ping_bad,usbtx_percent,"
+            "isr_percent,cpu_percent\n");
+        return;
+    }
+    std::printf(
+        "%-14s %6s %8s %8s %8s %8s %9s %9s %9s %7s %7s %7s\n", "config",
+        "chunk", "in MB/s", "out MB/s", "in lost", "out lost", "rtt min",
+        "rtt med", "rtt p99", "usbTx%", "isr%", "cpu%");
+}
+
+void print_row(bool csv, const device_info& info, const row& res) {
+    char config[32];
+    std::snprintf(config, sizeof(config), "%zux%zu/%zu", info.tx_bytes,
+                  info.tx_buffers, info.rx_bytes);
+    if (csv) {
+        std::printf("%s,%zu,%.3f,%.3f,%" PRIu64 ",%" PRIu64 ",%" PRIu64
+                    ",%" PRIu64 ",%.1f,%.1f,%.1f,%" PRIu64 ",%.1f,%.1f,%.1f\n",
+                    config, res.chunk, res.in_mbps, res.out_mbps, res.in_lost,
+                    res.in_bad, res.out_lost, res.out_bad, res.rtt_min_us,
+                    res.rtt_median_us, res.rtt_p99_us, res.ping_lost,
+                    res.usbtx_percent, res.isr_percent, res.cpu_percent);
+        return;
+    }
+    // lost and corrupted blocks are summed up per direction
+    std::printf(
+        "%-14s %6zu %8.3f %8.3f %8" PRIu64 " %8" PRIu64
+        " %9.0f %9.0f %9.0f %7.1f %7.1f %7.1f\n",
+        config, res.chunk, res.in_mbps, res.out_mbps, res.in_lost + res.in_bad,
+        res.out_lost + res.out_bad + res.ping_lost, res.rtt_min_us,
+        res.rtt_median_us, res.rtt_p99_us, res.usbtx_percent,
+        res.isr_percent, res.cpu_percent);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    options opts{};
+    std::vector<const char*> targets;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--chunks" && i + 1 < argc) {
+            opts.chunks = parse_list(argv[++i]);
+        } else if (arg == "--bytes" && i + 1 < argc) {
+            opts.bytes = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--pings" && i + 1 < argc) {
+            opts.pings = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--load" && i + 1 < argc) {
+            opts.load =
+                static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "--csv") {
+            opts.csv = true;
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else if (!arg.starts_with("--")) {
+            targets.push_back(argv[i]);
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (targets.empty() || opts.chunks.empty() || opts.load >= 1000) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // a board which got unplugged must not kill us
+    ::signal(SIGPIPE, SIG_IGN);
+
+    bool losses = false;
+    print_header(opts.csv);
+    for (const char* target : targets) {
+        serial_line line;
+        if (!line.open(target)) {
+            return EXIT_FAILURE;
+        }
+        const auto info = handshake(line);
+        if (!info) {
+            std::fprintf(stderr, "error: no vcom_bench firmware on %s\n",
+                         target);
+            return EXIT_FAILURE;
+        }
+
+        for (const std::size_t chunk : opts.chunks) {
+            if (chunk < dis::bench::min_block_size || chunk > info->tx_bytes) {
+                std::fprintf(stderr,
+                             "%s: chunk %zu skipped, the blocks are %zu to "
+                             "%zu bytes\n",
+                             target, chunk, dis::bench::min_block_size,
+                             info->tx_bytes);
+                continue;
+            }
+            row result{};
+            result.chunk = chunk;
+            if (!run_stream(line, opts, chunk, result) ||
+                !run_ping(line, opts, chunk, result)) {
+                return EXIT_FAILURE;
+            }
+            print_row(opts.csv, *info, result);
+            std::fflush(stdout);
+            losses = losses || result.in_lost + result.in_bad +
+                                       result.out_lost + result.out_bad +
+                                       result.ping_lost >
+                                   0;
+        }
+    }
+    return losses ? 2 : EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+#include "demux.hpp"
+
+namespace dis::io::mux {
+
+void demultiplexer::feed(std::span<const std::byte> data) {
+    m_pending.insert(m_pending.end(), data.begin(), data.end());
+
+    std::size_t pos = 0;
+    while (m_pending.size() - pos >= header_size) {
+        const std::byte* frame = m_pending.data() + pos;
+        if (frame[0] != std::byte{frame_sync}) {
+            ++pos;
+            ++m_skipped;
+            continue;
+        }
+        const header head = decode(frame);
+        if (head.size > m_max_payload) {
+            ++pos;
+            ++m_skipped;
+            continue;
+        }
+        if (m_pending.size() - pos < header_size + head.size) {
+            break;
+        }
+        std::uint16_t crc = crc16({frame, 6});
+        crc = crc16({frame + header_size, head.size}, crc);
+        if (crc != check_of(frame)) {
+            ++pos;
+            ++m_skipped;
+            ++m_bad_checks;
+            continue;
+        }
+
+        deliver(head, {frame + header_size, head.size});
+        pos += header_size + head.size;
+    }
+    m_pending.erase(m_pending.begin(),
+                    m_pending.begin() + static_cast<std::ptrdiff_t>(pos));
+}
+
+void demultiplexer::deliver(const header& head,
+                            std::span<const std::byte> payload) {
+    link_stats& stats = m_channels[head.channel];
+    auto expected     = m_expected.find(head.channel);
+    if (expected != m_expected.end()) {
+        stats.lost +=
+            static_cast<std::uint16_t>(head.sequence - expected->second);
+    }
+    m_expected[head.channel] = static_cast<std::uint16_t>(head.sequence + 1);
+    ++stats.frames;
+    stats.bytes += payload.size();
+    m_on_frame(head.channel, payload);
+}
+
+}  // namespace dis::io::mux
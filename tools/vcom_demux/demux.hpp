@@ -0,0 +1,68 @@
+#ifndef TOOLS_VCOM_DEMUX_DEMUX_HPP
+#define TOOLS_VCOM_DEMUX_DEMUX_HPP
+
+// Host side of dis::io::mux, splits the byte stream of the link into the
+// frames of the logical channels (see dis/osal/io/mux/format.hpp)
+
+#include "dis/osal/io/mux/format.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace dis::io::mux {
+
+struct link_stats {
+    std::uint64_t frames{0};
+    std::uint64_t bytes{0};
+    /// frames missing according to the sequence numbers
+    std::uint64_t lost{0};
+};
+
+class demultiplexer {
+public:
+    using handler = std::function<void(std::uint8_t channel,
+                                       std::span<const std::byte> payload)>;
+
+    /**
+     * `max_payload` is the largest payload the firmware sends (the
+     * multiplexer's max_payload), a header announcing more is taken as
+     * garbage right away instead of waiting for the payload.
+     */
+    explicit demultiplexer(handler on_frame,
+                           std::size_t max_payload = max_frame_payload)
+        : m_on_frame(std::move(on_frame)), m_max_payload(max_payload) {}
+
+    /// takes the next piece of the stream, calls the handler per frame
+    void feed(std::span<const std::byte> data);
+
+    [[nodiscard]] const std::map<std::uint8_t, link_stats>& channels()
+        const noexcept {
+        return m_channels;
+    }
+    /// bytes thrown away while searching for the next frame
+    [[nodiscard]] std::uint64_t skipped() const noexcept { return m_skipped; }
+    /// candidate frames with a wrong check
+    [[nodiscard]] std::uint64_t bad_checks() const noexcept {
+        return m_bad_checks;
+    }
+
+private:
+    void deliver(const header& head, std::span<const std::byte> payload);
+
+    handler m_on_frame;
+    std::size_t m_max_payload;
+    std::vector<std::byte> m_pending{};
+    std::map<std::uint8_t, link_stats> m_channels{};
+    std::map<std::uint8_t, std::uint16_t> m_expected{};
+    std::uint64_t m_skipped{0};
+    std::uint64_t m_bad_checks{0};
+};
+
+}  // namespace dis::io::mux
+
+#endif  // TOOLS_VCOM_DEMUX_DEMUX_HPP
@@ -0,0 +1,165 @@
+// Splits the stream of dis::io::mux::multiplexer (see
+// dis/osal/io/mux/format.hpp) into its logical channels
+//
+//   stty -F /dev/ttyACM0 raw
+//   vcom_demux [--prefix PATH] [--channel N] [--max-payload BYTES] [INPUT]
+//
+// Without --channel the payload of every channel N is appended to the file
+// PATH<N>.bin (the prefix defaults to "channel"), with --channel only
+// channel N is written to stdout, e.g. to follow the log channel.  The input
+// defaults to stdin.  At the end of the input (or on Ctrl-C) the frames,
+// bytes and frames lost on the link per channel and the bytes skipped while
+// searching for frames are printed to stderr.
+
+#include "demux.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+volatile sig_atomic_t s_stop = 0;
+
+void usage(const char* name) {
+    std::fprintf(stderr,
+                 "usage: %s [--prefix PATH] [--channel N] "
+                 "[--max-payload BYTES] [INPUT]\n",
+                 name);
+}
+
+void on_signal(int) { s_stop = 1; }
+
+class channel_files {
+public:
+    explicit channel_files(std::string prefix) : m_prefix(std::move(prefix)) {}
+
+    channel_files(const channel_files&)            = delete;
+    channel_files& operator=(const channel_files&) = delete;
+
+    ~channel_files() {
+        for (auto& [channel, file] : m_files) {
+            std::fclose(file);
+        }
+    }
+
+    bool write(std::uint8_t channel, std::span<const std::byte> payload) {
+        auto found = m_files.find(channel);
+        if (found == m_files.end()) {
+            const std::string path =
+                m_prefix + std::to_string(channel) + ".bin";
+            std::FILE* file = std::fopen(path.c_str(), "ab");
+            if (file == nullptr) {
+                std::fprintf(stderr, "error: can not open %s\n", path.c_str());
+                return false;
+            }
+            found = m_files.emplace(channel, file).first;
+        }
+        return std::fwrite(payload.data(), 1, payload.size(), found->second) ==
+               payload.size();
+    }
+
+private:
+    std::string m_prefix;
+    std::map<std::uint8_t, std::FILE*> m_files{};
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string prefix = "channel";
+    std::optional<unsigned long> only;
+    std::size_t max_payload = dis::io::mux::max_frame_payload;
+    const char* input       = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--prefix" && i + 1 < argc) {
+            prefix = argv[++i];
+        } else if (arg == "--channel" && i + 1 < argc) {
+            only = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--max-payload" && i + 1 < argc) {
+            max_payload = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else if (input == nullptr && !arg.starts_with("--")) {
+            input = argv[i];
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int fd = STDIN_FILENO;
+    if (input != nullptr) {
+        fd = ::open(input, O_RDONLY);
+        if (fd < 0) {
+            std::fprintf(stderr, "error: can not open %s\n", input);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // no SA_RESTART, so a blocking read of a tty returns on Ctrl-C
+    struct sigaction action {};
+    action.sa_handler = on_signal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    channel_files files(prefix);
+    bool failed = false;
+    dis::io::mux::demultiplexer demux(
+        [&](std::uint8_t channel, std::span<const std::byte> payload) {
+            if (only) {
+                if (channel == *only) {
+                    failed |= std::fwrite(payload.data(), 1, payload.size(),
+                                          stdout) != payload.size();
+                    std::fflush(stdout);
+                }
+            } else {
+                failed |= !files.write(channel, payload);
+            }
+        },
+        max_payload);
+
+    std::array<std::byte, 4096> buffer{};
+    while (s_stop == 0 && !failed) {
+        const ssize_t got = ::read(fd, buffer.data(), buffer.size());
+        if (got == 0) {
+            break;
+        }
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::fprintf(stderr, "error: read failed: %s\n",
+                         std::strerror(errno));
+            failed = true;
+            break;
+        }
+        demux.feed({buffer.data(), static_cast<std::size_t>(got)});
+    }
+
+    for (const auto& [channel, stats] : demux.channels()) {
+        std::fprintf(stderr,
+                     "channel=%u frames=%" PRIu64 " bytes=%" PRIu64
+                     " lost=%" PRIu64 "\n",
+                     static_cast<unsigned>(channel), stats.frames,
+                     stats.bytes, stats.lost);
+    }
+    std::fprintf(stderr, "skipped=%" PRIu64 " bad_checks=%" PRIu64 "\n",
+                 demux.skipped(), demux.bad_checks());
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}